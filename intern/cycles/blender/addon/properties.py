@@ -391,6 +391,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=0.0, max=1.0,
         default=0.01,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights based on their distance, orientation and power relative to the shading point, "
+        "reducing noise in scenes with many lights. Not used when sampling all lights",
+        default=False,
+    )
 
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
@@ -794,6 +800,20 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read image file tiles on demand at the resolution needed for rendering, "
+        "instead of loading full images into memory (CPU only)",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Texture Cache Size",
+        description="Maximum memory used for image tiles read by the texture cache, in megabytes",
+        default=1024,
+        min=16, max=65536,
+        subtype='UNSIGNED',
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
@@ -79,7 +79,11 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
 {
   /* Test if we can instance or if the object is modified. */
   BL::ID b_ob_data = b_ob.data();
-  BL::ID b_key_id = (BKE_object_is_modified(b_ob)) ? b_ob_instance : b_ob_data;
+  /* Geometry instanced by geometry nodes can be shared with other instances, even though the
+   * object owning it is modified. */
+  const bool is_instanced_data = b_ob_data.ptr.data != b_ob_instance.data().ptr.data;
+  BL::ID b_key_id = (!is_instanced_data && BKE_object_is_modified(b_ob)) ? b_ob_instance :
+                                                                           b_ob_data;
   Geometry::Type geom_type = determine_geom_type(b_ob, use_particle_hair);
   GeometryKey key(b_key_id.ptr.data, geom_type);
 
@@ -111,7 +115,9 @@ Geometry *BlenderSync::sync_geometry(BL::Depsgraph &b_depsgraph,
   }
   else {
     /* Test if we need to update existing geometry. */
-    sync = geometry_map.update(geom, b_key_id);
+    /* Instanced data has no update tags of its own, it changes when the owner is updated. */
+    sync = is_instanced_data ? geometry_map.update(geom, b_key_id, b_ob_instance) :
+                               geometry_map.update(geom, b_key_id);
   }
 
   if (!sync) {
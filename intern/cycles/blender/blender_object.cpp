@@ -112,6 +112,12 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
   BL::Object b_ob = b_instance.object();
   BL::Object b_parent = is_instance ? b_instance.parent() : b_instance.object();
   BL::Object b_ob_instance = is_instance ? b_instance.instance_object() : b_ob;
+  /* Geometry instanced by geometry nodes replaces the data of the instance object. That data is
+   * only referenced by b_ob, so the geometry is synced from it. This is fine because geometry
+   * sync is not deferred for instances. */
+  const bool is_instanced_data = is_instance &&
+                                 b_ob.data().ptr.data != b_ob_instance.data().ptr.data;
+  BL::Object b_ob_geometry = is_instanced_data ? b_ob : b_ob_instance;
   const bool motion = motion_time != 0.0f;
   /*const*/ Transform tfm = get_transform(b_ob.matrix_world());
   int *persistent_id = NULL;
@@ -208,7 +214,7 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
       /* mesh deformation */
       if (object->get_geometry())
         sync_geometry_motion(b_depsgraph,
-                             b_ob_instance,
+                             b_ob_geometry,
                              object,
                              motion_time,
                              use_particle_hair,
@@ -229,7 +235,7 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
    * b_ob_instance is the original object and will remain valid for deferred geometry
    * sync. */
   Geometry *geometry = sync_geometry(b_depsgraph,
-                                     b_ob_instance,
+                                     b_ob_geometry,
                                      b_ob_instance,
                                      object_updated,
                                      use_particle_hair,
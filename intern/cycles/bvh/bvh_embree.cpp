@@ -67,12 +67,17 @@ static_assert(Object::MAX_MOTION_STEPS == Geometry::MAX_MOTION_STEPS,
  */
 static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
 {
+  CCLIntersectContext *ctx = ((IntersectContext *)args->context)->userRayExt;
+  if (ctx->type == CCLIntersectContext::RAY_REGULAR) {
+    /* Nothing to do here, also called with packets of rays by the split kernel streams. */
+    return;
+  }
+
   /* Current implementation in Cycles assumes only single-ray intersection queries. */
   assert(args->N == 1);
 
   const RTCRay *ray = (RTCRay *)args->ray;
   RTCHit *hit = (RTCHit *)args->hit;
-  CCLIntersectContext *ctx = ((IntersectContext *)args->context)->userRayExt;
   KernelGlobals *kg = ctx->kg;
 
   switch (ctx->type) {
@@ -223,26 +228,32 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
 
 static void rtc_filter_func_thick_curve(const RTCFilterFunctionNArguments *args)
 {
-  const RTCRay *ray = (RTCRay *)args->ray;
-  RTCHit *hit = (RTCHit *)args->hit;
+  /* Called with packets of rays when the split kernel traces ray streams. */
+  RTCRayN *ray = args->ray;
+  RTCHitN *hit = args->hit;
+  const unsigned int N = args->N;
+
+  for (unsigned int i = 0; i < N; i++) {
+    if (args->valid[i] == 0) {
+      continue;
+    }
 
-  /* Always ignore backfacing intersections. */
-  if (dot(make_float3(ray->dir_x, ray->dir_y, ray->dir_z),
-          make_float3(hit->Ng_x, hit->Ng_y, hit->Ng_z)) > 0.0f) {
-    *args->valid = 0;
-    return;
+    /* Always ignore backfacing intersections. */
+    const float3 dir = make_float3(
+        RTCRayN_dir_x(ray, N, i), RTCRayN_dir_y(ray, N, i), RTCRayN_dir_z(ray, N, i));
+    const float3 Ng = make_float3(
+        RTCHitN_Ng_x(hit, N, i), RTCHitN_Ng_y(hit, N, i), RTCHitN_Ng_z(hit, N, i));
+    if (dot(dir, Ng) > 0.0f) {
+      args->valid[i] = 0;
+    }
   }
 }
 
 static void rtc_filter_occluded_func_thick_curve(const RTCFilterFunctionNArguments *args)
 {
-  const RTCRay *ray = (RTCRay *)args->ray;
-  RTCHit *hit = (RTCHit *)args->hit;
-
   /* Always ignore backfacing intersections. */
-  if (dot(make_float3(ray->dir_x, ray->dir_y, ray->dir_z),
-          make_float3(hit->Ng_x, hit->Ng_y, hit->Ng_z)) > 0.0f) {
-    *args->valid = 0;
+  rtc_filter_func_thick_curve(args);
+  if (args->N == 1 && *args->valid == 0) {
     return;
   }
 
@@ -1626,7 +1626,9 @@ int2 CPUSplitKernel::split_kernel_global_size(device_memory & /*kg*/,
                                               device_memory & /*data*/,
                                               DeviceTask & /*task*/)
 {
-  return make_int2(1, 1);
+  /* Wavefront of paths per thread. Large enough to sort rays by shader and trace them in
+   * streams, small enough to keep the path state of all threads in memory. */
+  return make_int2(64, 4);
 }
 
 uint64_t CPUSplitKernel::state_buffer_size(device_memory &kernel_globals,
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "kernel_light_tree.h"
 #include "kernel_light_background.h"
 
 CCL_NAMESPACE_BEGIN
@@ -37,8 +38,13 @@ typedef struct LightSample {
 
 /* Regular Light */
 
-ccl_device_inline bool lamp_light_sample(
-    KernelGlobals *kg, int lamp, float randu, float randv, float3 P, LightSample *ls)
+ccl_device_inline bool lamp_light_sample(KernelGlobals *kg,
+                                         int lamp,
+                                         float randu,
+                                         float randv,
+                                         float3 P,
+                                         float select_pdf,
+                                         LightSample *ls)
 {
   const ccl_global KernelLight *klight = &kernel_tex_fetch(__lights, lamp);
   LightType type = (LightType)klight->type;
@@ -153,7 +159,7 @@ ccl_device_inline bool lamp_light_sample(
     }
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= select_pdf;
 
   return (ls->pdf > 0.0f);
 }
@@ -291,7 +297,12 @@ ccl_device bool lamp_light_eval(
     return false;
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  if (kernel_data.integrator.use_light_tree) {
+    ls->pdf *= light_tree_lamp_pdf(kg, P, lamp);
+  }
+  else {
+    ls->pdf *= kernel_data.integrator.pdf_lights;
+  }
 
   return true;
 }
@@ -328,12 +339,22 @@ ccl_device_inline bool triangle_world_space_vertices(
   return has_motion;
 }
 
-ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg,
-                                                const float3 Ng,
+/* Probability of picking the triangle for light sampling, from the light tree or proportional
+ * to the area of the triangle at the center frame. */
+ccl_device_inline float triangle_light_select_pdf(KernelGlobals *kg,
+                                                  const float area_pre,
+                                                  const float tree_pdf)
+{
+  return (kernel_data.integrator.use_light_tree) ?
+             tree_pdf :
+             area_pre * kernel_data.integrator.pdf_triangles;
+}
+
+ccl_device_inline float triangle_light_pdf_area(const float3 Ng,
                                                 const float3 I,
-                                                float t)
+                                                float t,
+                                                float pdf)
 {
-  float pdf = kernel_data.integrator.pdf_triangles;
   float cos_pi = fabsf(dot(Ng, I));
 
   if (cos_pi == 0.0f)
@@ -358,10 +379,15 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
   const float3 N = cross(e0, e1);
   const float distance_to_plane = fabsf(dot(N, sd->I * t)) / dot(N, N);
 
+  /* sd contains the point on the light source
+   * calculate Px, the point that we're shading */
+  const float3 Px = sd->P + sd->I * t;
+  float tree_pdf = 0.0f;
+  if (kernel_data.integrator.use_light_tree) {
+    tree_pdf = light_tree_triangle_pdf(kg, Px, sd->object, sd->prim);
+  }
+
   if (longest_edge_squared > distance_to_plane * distance_to_plane) {
-    /* sd contains the point on the light source
-     * calculate Px, the point that we're shading */
-    const float3 Px = sd->P + sd->I * t;
     const float3 v0_p = V[0] - Px;
     const float3 v1_p = V[1] - Px;
     const float3 v2_p = V[2] - Px;
@@ -389,25 +415,25 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
       else {
         area = 0.5f * len(N);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = triangle_light_select_pdf(kg, area, tree_pdf);
       return pdf / solid_angle;
     }
   }
   else {
-    float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t);
+    const float area = 0.5f * len(N);
+    if (UNLIKELY(area == 0.0f)) {
+      return 0.0f;
+    }
+    float area_pre = area;
     if (has_motion) {
-      const float area = 0.5f * len(N);
-      if (UNLIKELY(area == 0.0f)) {
-        return 0.0f;
-      }
       /* scale the PDF.
        * area = the area the sample was taken from
        * area_pre = the are from which pdf_triangles was calculated from */
       triangle_world_space_vertices(kg, sd->object, sd->prim, -1.0f, V);
-      const float area_pre = triangle_area(V[0], V[1], V[2]);
-      pdf = pdf * area_pre / area;
+      area_pre = triangle_area(V[0], V[1], V[2]);
     }
-    return pdf;
+    const float pdf = triangle_light_select_pdf(kg, area_pre, tree_pdf) / area;
+    return triangle_light_pdf_area(sd->Ng, sd->I, t, pdf);
   }
 }
 
@@ -418,7 +444,8 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
                                                   float randv,
                                                   float time,
                                                   LightSample *ls,
-                                                  const float3 P)
+                                                  const float3 P,
+                                                  const float tree_pdf)
 {
   /* A naive heuristic to decide between costly solid angle sampling
    * and simple area sampling, comparing the distance to the triangle plane
@@ -542,7 +569,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
         triangle_world_space_vertices(kg, object, prim, -1.0f, V);
         area = triangle_area(V[0], V[1], V[2]);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = triangle_light_select_pdf(kg, area, tree_pdf);
       ls->pdf = pdf / solid_angle;
     }
   }
@@ -564,15 +591,20 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
     ls->P = u * V[0] + v * V[1] + t * V[2];
     /* compute incoming direction, distance and pdf */
     ls->D = normalize_len(ls->P - P, &ls->t);
-    ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t);
-    if (has_motion && area != 0.0f) {
+    if (UNLIKELY(area == 0.0f)) {
+      ls->pdf = 0.0f;
+      return;
+    }
+    float area_pre = area;
+    if (has_motion) {
       /* scale the PDF.
        * area = the area the sample was taken from
        * area_pre = the are from which pdf_triangles was calculated from */
       triangle_world_space_vertices(kg, object, prim, -1.0f, V);
-      const float area_pre = triangle_area(V[0], V[1], V[2]);
-      ls->pdf = ls->pdf * area_pre / area;
+      area_pre = triangle_area(V[0], V[1], V[2]);
     }
+    const float pdf = triangle_light_select_pdf(kg, area_pre, tree_pdf) / area;
+    ls->pdf = triangle_light_pdf_area(ls->Ng, -ls->D, ls->t, pdf);
     ls->u = u;
     ls->v = v;
   }
@@ -632,9 +664,21 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
                                       int bounce,
                                       LightSample *ls)
 {
+  /* Probability of picking the light, the light tree depends on the shading point. */
+  float select_pdf = kernel_data.integrator.pdf_lights;
+
   if (lamp < 0) {
     /* sample index */
-    int index = light_distribution_sample(kg, &randu);
+    int index;
+    if (kernel_data.integrator.use_light_tree) {
+      index = light_tree_sample(kg, &randu, P, &select_pdf);
+      if (index < 0) {
+        return false;
+      }
+    }
+    else {
+      index = light_distribution_sample(kg, &randu);
+    }
 
     /* fetch light data */
     const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
@@ -645,7 +689,7 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
       int object = kdistribution->mesh_light.object_id;
       int shader_flag = kdistribution->mesh_light.shader_flag;
 
-      triangle_light_sample(kg, prim, object, randu, randv, time, ls, P);
+      triangle_light_sample(kg, prim, object, randu, randv, time, ls, P, select_pdf);
       ls->shader |= shader_flag;
       return (ls->pdf > 0.0f);
     }
@@ -657,7 +701,7 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
     return false;
   }
 
-  return lamp_light_sample(kg, lamp, randu, randv, P, ls);
+  return lamp_light_sample(kg, lamp, randu, randv, P, select_pdf, ls);
 }
 
 ccl_device_inline int light_select_num_samples(KernelGlobals *kg, int index)
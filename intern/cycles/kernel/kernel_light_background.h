@@ -421,10 +421,15 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
     }
   }
 
+  /* Probability of picking the background light. */
+  const float pdf_select = (kernel_data.integrator.use_light_tree) ?
+                               light_tree_distant_pdf(kg) :
+                               kernel_data.integrator.pdf_lights;
+
   float pdf_fac = (portal_method_pdf + sun_method_pdf + map_method_pdf);
   if (pdf_fac == 0.0f) {
     /* Use uniform as a fallback if we can't use any strategy. */
-    return kernel_data.integrator.pdf_lights / M_4PI_F;
+    return pdf_select / M_4PI_F;
   }
 
   pdf_fac = 1.0f / pdf_fac;
@@ -440,7 +445,7 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
     pdf += background_map_pdf(kg, direction) * map_method_pdf;
   }
 
-  return pdf * kernel_data.integrator.pdf_lights;
+  return pdf * pdf_select;
 }
 
 #endif
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Hierarchy over the lights and emissive triangles of the light distribution, traversed to
+ * pick a light with probability proportional to an estimate of its contribution at the shading
+ * point, based on distance, orientation and power. Uses the importance measure from:
+ *
+ * Alejandro Conty Estevez and Christopher Kulla.
+ * Importance Sampling of Many Lights with Adaptive Tree Splitting.
+ *
+ * The shading normal is not taken into account, so that the same probability can be computed
+ * from the ray origin for multiple importance sampling. Distant and background lights can't be
+ * bounded, they are stored after the emitters of the tree and picked uniformly. */
+
+ccl_device float light_tree_node_importance(const float3 P,
+                                            const ccl_global KernelLightTreeNode *knode)
+{
+  const float3 bbox_min = make_float3(
+      knode->bounds_min[0], knode->bounds_min[1], knode->bounds_min[2]);
+  const float3 bbox_max = make_float3(
+      knode->bounds_max[0], knode->bounds_max[1], knode->bounds_max[2]);
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius_squared = 0.25f * len_squared(bbox_max - bbox_min);
+
+  float distance;
+  const float3 D = safe_normalize_len(P - centroid, &distance);
+  const float distance_squared = distance * distance;
+
+  /* Angle subtended by the bounds, covering all directions when inside. */
+  float theta_u = M_PI_F;
+  if (distance_squared > radius_squared) {
+    theta_u = safe_asinf(sqrtf(radius_squared) / distance);
+  }
+
+  /* Smallest possible angle between the emitter normals and the shading point. */
+  const float theta = safe_acosf(dot(axis, D));
+  const float theta_i = max(theta - knode->theta_o - theta_u, 0.0f);
+  if (theta_i >= knode->theta_e) {
+    return 0.0f;
+  }
+
+  /* Clamp distance to avoid the importance going to infinity close to the emitters. */
+  return knode->energy * cosf(theta_i) / max(distance_squared, max(radius_squared, 1e-8f));
+}
+
+ccl_device_inline float light_tree_distant_pdf(KernelGlobals *kg)
+{
+  return kernel_data.integrator.pdf_light_tree_distant /
+         kernel_data.integrator.num_light_tree_distant;
+}
+
+/* Returns the index in the light distribution, or -1 if no light contributes to the shading
+ * point. The random number is rescaled so it can be reused for sampling the light. */
+ccl_device int light_tree_sample(KernelGlobals *kg, float *randu, const float3 P, float *pdf)
+{
+  const int num_emitters = kernel_data.integrator.num_light_tree_emitters;
+  const int num_distant = kernel_data.integrator.num_light_tree_distant;
+  float r = *randu;
+  *pdf = 1.0f;
+
+  if (num_distant > 0) {
+    const float pdf_distant = kernel_data.integrator.pdf_light_tree_distant;
+    if (r < pdf_distant) {
+      r /= pdf_distant;
+      const int index = min((int)(r * num_distant), num_distant - 1);
+      *randu = r * num_distant - index;
+      *pdf = light_tree_distant_pdf(kg);
+      return kernel_tex_fetch(__light_tree_emitters, num_emitters + index).distribution_index;
+    }
+    r = (r - pdf_distant) / (1.0f - pdf_distant);
+    *pdf = 1.0f - pdf_distant;
+  }
+
+  if (num_emitters == 0) {
+    return -1;
+  }
+
+  /* Descend into the children with probability proportional to their importance. */
+  int node_index = 0;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, 0);
+
+  while (knode->num_emitters == 0) {
+    const int left_index = node_index + 1;
+    const int right_index = knode->child_index;
+    const float importance_left = light_tree_node_importance(
+        P, &kernel_tex_fetch(__light_tree_nodes, left_index));
+    const float importance_right = light_tree_node_importance(
+        P, &kernel_tex_fetch(__light_tree_nodes, right_index));
+    const float importance_total = importance_left + importance_right;
+
+    if (importance_total == 0.0f) {
+      return -1;
+    }
+
+    const float prob_left = importance_left / importance_total;
+    if (r < prob_left) {
+      r /= prob_left;
+      node_index = left_index;
+      *pdf *= prob_left;
+    }
+    else {
+      r = (r - prob_left) / (1.0f - prob_left);
+      node_index = right_index;
+      *pdf *= 1.0f - prob_left;
+    }
+
+    knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  }
+
+  if (knode->energy == 0.0f) {
+    return -1;
+  }
+
+  /* Pick an emitter in the leaf proportional to its energy. */
+  const int first_emitter = knode->child_index;
+  float energy = r * knode->energy;
+
+  for (int i = 0; i < knode->num_emitters; i++) {
+    const ccl_global KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                          first_emitter + i);
+    if (energy < kemitter->energy || i == knode->num_emitters - 1) {
+      *randu = (kemitter->energy > 0.0f) ? min(energy / kemitter->energy, 1.0f) : 0.0f;
+      *pdf *= kemitter->energy / knode->energy;
+      return kemitter->distribution_index;
+    }
+    energy -= kemitter->energy;
+  }
+
+  return -1;
+}
+
+/* Probability of light_tree_sample picking the light with the given distribution index. */
+ccl_device float light_tree_pdf(KernelGlobals *kg, const float3 P, const int distribution_index)
+{
+  const int emitter_index = kernel_tex_fetch(__light_to_tree, distribution_index);
+  const ccl_global KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                        emitter_index);
+  if (kemitter->leaf_index < 0) {
+    return light_tree_distant_pdf(kg);
+  }
+
+  int node_index = kemitter->leaf_index;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes,
+                                                                  node_index);
+  if (knode->energy == 0.0f) {
+    return 0.0f;
+  }
+
+  float pdf = kemitter->energy / knode->energy;
+  if (kernel_data.integrator.num_light_tree_distant > 0) {
+    pdf *= 1.0f - kernel_data.integrator.pdf_light_tree_distant;
+  }
+
+  /* Walk up to the root, multiplying the probability of picking each node. */
+  while (node_index != 0) {
+    const int parent_index = knode->parent_index;
+    const ccl_global KernelLightTreeNode *kparent = &kernel_tex_fetch(__light_tree_nodes,
+                                                                      parent_index);
+    const int left_index = parent_index + 1;
+    const int right_index = kparent->child_index;
+    const float importance_left = light_tree_node_importance(
+        P, &kernel_tex_fetch(__light_tree_nodes, left_index));
+    const float importance_right = light_tree_node_importance(
+        P, &kernel_tex_fetch(__light_tree_nodes, right_index));
+    const float importance_total = importance_left + importance_right;
+
+    if (importance_total == 0.0f) {
+      return 0.0f;
+    }
+
+    pdf *= ((node_index == left_index) ? importance_left : importance_right) / importance_total;
+
+    node_index = parent_index;
+    knode = kparent;
+  }
+
+  return pdf;
+}
+
+ccl_device float light_tree_lamp_pdf(KernelGlobals *kg, const float3 P, const int lamp)
+{
+  /* Lamps are stored after the emissive triangles in the light distribution. */
+  const int index = kernel_data.integrator.num_distribution -
+                    kernel_data.integrator.num_all_lights + lamp;
+  return light_tree_pdf(kg, P, index);
+}
+
+ccl_device float light_tree_triangle_pdf(KernelGlobals *kg,
+                                         const float3 P,
+                                         const int object,
+                                         const int prim)
+{
+  /* Emissive triangles of an object are stored contiguously in the light distribution, sorted
+   * by primitive index. */
+  uint first = kernel_tex_fetch(__light_tree_object_offset, object);
+  uint last = kernel_tex_fetch(__light_tree_object_offset, object + 1);
+  const uint end = last;
+
+  while (first < last) {
+    const uint middle = (first + last) >> 1;
+    if (kernel_tex_fetch(__light_distribution, middle).prim < prim) {
+      first = middle + 1;
+    }
+    else {
+      last = middle;
+    }
+  }
+
+  if (first == end || kernel_tex_fetch(__light_distribution, first).prim != prim) {
+    return 0.0f;
+  }
+
+  return light_tree_pdf(kg, P, first);
+}
+
+CCL_NAMESPACE_END
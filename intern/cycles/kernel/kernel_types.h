@@ -1387,6 +1387,12 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
+  /* light tree */
+  int use_light_tree;
+  int num_light_tree_emitters;
+  int num_light_tree_distant;
+  float pdf_light_tree_distant;
+
   int pad1, pad2;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
@@ -1548,6 +1554,33 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Node of the light tree. Inner nodes store the index of their second child, the first child
+ * directly follows the node. Leaves store a range of emitters. */
+typedef struct KernelLightTreeNode {
+  float bounds_min[3];
+  float energy;
+  float bounds_max[3];
+  /* Spread of the emitter normals around the axis. */
+  float theta_o;
+  float axis[3];
+  /* Angle beyond the normals in which light is emitted. */
+  float theta_e;
+  int child_index;
+  int num_emitters;
+  int parent_index;
+  int pad;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+typedef struct KernelLightTreeEmitter {
+  float energy;
+  int distribution_index;
+  /* Leaf containing the emitter, or -1 for distant lights which are not part of the tree. */
+  int leaf_index;
+  int pad;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
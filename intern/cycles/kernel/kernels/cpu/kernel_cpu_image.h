@@ -23,6 +23,8 @@
 #  include <nanovdb/util/SampleFromVoxels.h>
 #endif
 
+#include "util/util_texture_cache.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -584,10 +586,23 @@ template<typename T> struct NanoVDBInterpolator {
 
 #undef SET_CUBIC_SPLINE_WEIGHTS
 
+ccl_device float4 kernel_tex_image_cache_lookup(
+    const TextureInfo &info, float x, float y, float2 dx, float2 dy)
+{
+  float r[4];
+  texture_cache_lookup(info.cache, x, y, dx.x, dx.y, dy.x, dy.y, r);
+  return make_float4(r[0], r[1], r[2], r[3]);
+}
+
 ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
+  if (info.cache) {
+    return kernel_tex_image_cache_lookup(
+        info, x, y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f));
+  }
+
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF:
       return TextureInterpolator<half>::interp(info, x, y);
@@ -612,6 +627,25 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+ccl_device bool kernel_tex_image_is_cached(KernelGlobals *kg, int id)
+{
+  return kernel_tex_fetch(__texture_info, id).cache != 0;
+}
+
+/* Lookup with derivatives of the texture coordinates, which select the MIP level for images
+ * sampled through the texture cache. Other images ignore the derivatives. */
+ccl_device float4 kernel_tex_image_interp_filtered(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+
+  if (info.cache) {
+    return kernel_tex_image_cache_lookup(info, x, y, dx, dy);
+  }
+
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
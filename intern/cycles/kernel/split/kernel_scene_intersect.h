@@ -16,6 +16,122 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Make regenerated rays active, returns false if the ray does not need to be traced. */
+ccl_device_inline bool kernel_scene_intersect_activate(KernelGlobals *kg, int ray_index)
+{
+  /* All regenerated rays become active here */
+  if (IS_STATE(kernel_split_state.ray_state, ray_index, RAY_REGENERATED)) {
+#ifdef __BRANCHED_PATH__
+    if (kernel_split_state.branched_state[ray_index].waiting_on_shared_samples) {
+      kernel_split_path_end(kg, ray_index);
+    }
+    else
+#endif /* __BRANCHED_PATH__ */
+    {
+      ASSIGN_RAY_STATE(kernel_split_state.ray_state, ray_index, RAY_ACTIVE);
+    }
+  }
+
+  return IS_STATE(kernel_split_state.ray_state, ray_index, RAY_ACTIVE);
+}
+
+#ifdef __SPLIT_RAY_STREAMS__
+ccl_device_noinline void kernel_scene_intersect_stream_trace(KernelGlobals *kg,
+                                                             const int *ray_indices,
+                                                             RTCRayHit *ray_hits,
+                                                             const int num_rays,
+                                                             const bool coherent)
+{
+  PROFILING_INIT(kg, PROFILING_INTERSECT);
+
+  CCLIntersectContext ctx(kg, CCLIntersectContext::RAY_REGULAR);
+  IntersectContext rtc_ctx(&ctx);
+  if (coherent) {
+    rtc_ctx.context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+  }
+
+  rtcIntersect1M(
+      kernel_data.bvh.scene, &rtc_ctx.context, ray_hits, num_rays, sizeof(RTCRayHit));
+
+  for (int i = 0; i < num_rays; i++) {
+    const int ray_index = ray_indices[i];
+    RTCRayHit *ray_hit = &ray_hits[i];
+
+    Intersection isect;
+    isect.t = ray_hit->ray.tfar;
+    if (ray_hit->hit.geomID != RTC_INVALID_GEOMETRY_ID &&
+        ray_hit->hit.primID != RTC_INVALID_GEOMETRY_ID) {
+      kernel_embree_convert_hit(kg, &ray_hit->ray, &ray_hit->hit, &isect);
+    }
+    else {
+      ASSIGN_RAY_STATE(kernel_split_state.ray_state, ray_index, RAY_HIT_BACKGROUND);
+    }
+    kernel_split_state.isect[ray_index] = isect;
+  }
+}
+
+/* Gather the active rays of the whole wavefront and trace them in streams. */
+ccl_device void kernel_scene_intersect_stream(KernelGlobals *kg, char use_queues_flag)
+{
+  PROFILING_INIT(kg, PROFILING_SCENE_INTERSECT);
+
+  int ray_indices[SPLIT_RAY_STREAM_SIZE];
+  RTCRayHit ray_hits[SPLIT_RAY_STREAM_SIZE];
+  int num_rays = 0;
+  /* Camera rays start from the same point, Embree can trace those as coherent packets. */
+  bool coherent = true;
+
+  const int num_work_items = ccl_global_size(0) * ccl_global_size(1);
+  for (int tid = 0; tid < num_work_items; tid++) {
+    int ray_index = tid;
+    if (use_queues_flag) {
+      ray_index = get_ray_index(kg,
+                                tid,
+                                QUEUE_ACTIVE_AND_REGENERATED_RAYS,
+                                kernel_split_state.queue_data,
+                                kernel_split_params.queue_size,
+                                0);
+      if (ray_index == QUEUE_EMPTY_SLOT) {
+        continue;
+      }
+    }
+
+    if (!kernel_scene_intersect_activate(kg, ray_index)) {
+      continue;
+    }
+
+    ccl_global PathState *state = &kernel_split_state.path_state[ray_index];
+    Ray ray = kernel_split_state.ray[ray_index];
+
+    uint visibility = path_state_ray_visibility(kg, state);
+    if (path_state_ao_bounce(kg, state)) {
+      visibility = PATH_RAY_SHADOW;
+      ray.t = kernel_data.background.ao_distance;
+    }
+
+    if (!scene_intersect_valid(&ray)) {
+      ASSIGN_RAY_STATE(kernel_split_state.ray_state, ray_index, RAY_HIT_BACKGROUND);
+      continue;
+    }
+
+    kernel_embree_setup_rayhit(ray, ray_hits[num_rays], visibility);
+    ray_indices[num_rays] = ray_index;
+    coherent = coherent && (state->flag & PATH_RAY_CAMERA);
+    num_rays++;
+
+    if (num_rays == SPLIT_RAY_STREAM_SIZE) {
+      kernel_scene_intersect_stream_trace(kg, ray_indices, ray_hits, num_rays, coherent);
+      num_rays = 0;
+      coherent = true;
+    }
+  }
+
+  if (num_rays > 0) {
+    kernel_scene_intersect_stream_trace(kg, ray_indices, ray_hits, num_rays, coherent);
+  }
+}
+#endif /* __SPLIT_RAY_STREAMS__ */
+
 /* This kernel takes care of scene_intersect function.
  *
  * This kernel changes the ray_state of RAY_REGENERATED rays to RAY_ACTIVE.
@@ -29,6 +145,16 @@ ccl_device void kernel_scene_intersect(KernelGlobals *kg)
   char local_use_queues_flag = *kernel_split_params.use_queues_flag;
   ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
+#ifdef __SPLIT_RAY_STREAMS__
+  if (kernel_data.bvh.scene) {
+    /* Work items run one after the other on the CPU, so the first one traces all rays. */
+    if (ccl_global_id(0) == 0 && ccl_global_id(1) == 0) {
+      kernel_scene_intersect_stream(kg, local_use_queues_flag);
+    }
+    return;
+  }
+#endif /* __SPLIT_RAY_STREAMS__ */
+
   int ray_index = ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0);
   if (local_use_queues_flag) {
     ray_index = get_ray_index(kg,
@@ -43,20 +169,7 @@ ccl_device void kernel_scene_intersect(KernelGlobals *kg)
     }
   }
 
-  /* All regenerated rays become active here */
-  if (IS_STATE(kernel_split_state.ray_state, ray_index, RAY_REGENERATED)) {
-#ifdef __BRANCHED_PATH__
-    if (kernel_split_state.branched_state[ray_index].waiting_on_shared_samples) {
-      kernel_split_path_end(kg, ray_index);
-    }
-    else
-#endif /* __BRANCHED_PATH__ */
-    {
-      ASSIGN_RAY_STATE(kernel_split_state.ray_state, ray_index, RAY_ACTIVE);
-    }
-  }
-
-  if (!IS_STATE(kernel_split_state.ray_state, ray_index, RAY_ACTIVE)) {
+  if (!kernel_scene_intersect_activate(kg, ray_index)) {
     return;
   }
 
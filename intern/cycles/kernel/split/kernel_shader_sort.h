@@ -14,6 +14,10 @@
  * limitations under the License.
  */
 
+#ifdef __KERNEL_CPU__
+#  include <algorithm>
+#endif
+
 CCL_NAMESPACE_BEGIN
 
 ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSortLocals *locals)
@@ -54,7 +58,6 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
   }
   ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
-  /* skip sorting for cpu split kernel */
 #  ifdef __KERNEL_OPENCL__
 
   /* bitonic sort */
@@ -77,6 +80,17 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
       }
     }
   }
+#  else
+  /* A single work item handles the whole block on the CPU, so sort it directly. Ties are
+   * ordered by index to keep rays of the same shader in their original order. Entries past
+   * the end of the queue are already in place. */
+  const int num_sort = min((int)(qsize - offset), SHADER_SORT_BLOCK_SIZE);
+  std::sort(local_index,
+            local_index + num_sort,
+            [local_value](const ushort a, const ushort b) {
+              return (local_value[a] < local_value[b]) ||
+                     (local_value[a] == local_value[b] && a < b);
+            });
 #  endif /* __KERNEL_OPENCL__ */
 
   /* copy to destination */
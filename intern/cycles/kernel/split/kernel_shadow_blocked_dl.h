@@ -16,43 +16,33 @@
 
 CCL_NAMESPACE_BEGIN
 
-/* Shadow ray cast for direct visible light. */
-ccl_device void kernel_shadow_blocked_dl(KernelGlobals *kg)
+/* Accumulate the light of a shadow ray whose occlusion was tested. */
+ccl_device_inline void kernel_shadow_blocked_dl_accum(KernelGlobals *kg,
+                                                      int ray_index,
+                                                      bool blocked,
+                                                      float3 shadow)
 {
-  unsigned int dl_queue_length = kernel_split_params.queue_index[QUEUE_SHADOW_RAY_CAST_DL_RAYS];
-  ccl_barrier(CCL_LOCAL_MEM_FENCE);
+  ccl_global PathState *state = &kernel_split_state.path_state[ray_index];
+  PathRadiance *L = &kernel_split_state.path_radiance[ray_index];
+  float3 throughput = kernel_split_state.throughput[ray_index];
+  BsdfEval L_light = kernel_split_state.bsdf_eval[ray_index];
+  bool is_lamp = kernel_split_state.is_lamp[ray_index];
 
-  int ray_index = QUEUE_EMPTY_SLOT;
-  int thread_index = ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0);
-  if (thread_index < dl_queue_length) {
-    ray_index = get_ray_index(kg,
-                              thread_index,
-                              QUEUE_SHADOW_RAY_CAST_DL_RAYS,
-                              kernel_split_state.queue_data,
-                              kernel_split_params.queue_size,
-                              1);
+  if (!blocked) {
+    /* accumulate */
+    path_radiance_accum_light(kg, L, state, throughput, &L_light, shadow, 1.0f, is_lamp);
   }
-
-#ifdef __BRANCHED_PATH__
-  /* TODO(mai): move this somewhere else? */
-  if (thread_index == 0) {
-    /* Clear QUEUE_INACTIVE_RAYS before next kernel. */
-    kernel_split_params.queue_index[QUEUE_INACTIVE_RAYS] = 0;
+  else {
+    path_radiance_accum_total_light(L, state, throughput, &L_light);
   }
-#endif /* __BRANCHED_PATH__ */
-
-  if (ray_index == QUEUE_EMPTY_SLOT)
-    return;
+}
 
+ccl_device void kernel_shadow_blocked_dl_ray(KernelGlobals *kg, int ray_index)
+{
   ccl_global PathState *state = &kernel_split_state.path_state[ray_index];
   Ray ray = kernel_split_state.light_ray[ray_index];
-  PathRadiance *L = &kernel_split_state.path_radiance[ray_index];
   ShaderData *sd = kernel_split_sd(sd, ray_index);
-  float3 throughput = kernel_split_state.throughput[ray_index];
-
-  BsdfEval L_light = kernel_split_state.bsdf_eval[ray_index];
   ShaderData *emission_sd = AS_SHADER_DATA(&kernel_split_state.sd_DL_shadow[ray_index]);
-  bool is_lamp = kernel_split_state.is_lamp[ray_index];
 
 #if defined(__BRANCHED_PATH__) || defined(__SHADOW_TRICKS__)
   bool use_branched = false;
@@ -76,6 +66,8 @@ ccl_device void kernel_shadow_blocked_dl(KernelGlobals *kg)
 #  endif /* __BRANCHED_PATH__ */
 
   if (use_branched) {
+    PathRadiance *L = &kernel_split_state.path_radiance[ray_index];
+    float3 throughput = kernel_split_state.throughput[ray_index];
     kernel_branched_path_surface_connect_light(
         kg, sd, emission_sd, state, throughput, 1.0f, L, all);
   }
@@ -84,15 +76,147 @@ ccl_device void kernel_shadow_blocked_dl(KernelGlobals *kg)
   {
     /* trace shadow ray */
     float3 shadow;
+    bool blocked = shadow_blocked(kg, sd, emission_sd, state, &ray, &shadow);
+    kernel_shadow_blocked_dl_accum(kg, ray_index, blocked, shadow);
+  }
+}
+
+#ifdef __SPLIT_RAY_STREAMS__
+/* Opaque shadow rays of the regular path tracing integrator only need an occlusion test, those
+ * are traced in streams. Transparent shadows record and shade all hits of a ray, and the
+ * branched integrator traces multiple rays per light sample, those are traced one by one. */
+ccl_device_inline bool kernel_shadow_blocked_dl_use_stream(KernelGlobals *kg, int ray_index)
+{
+#  ifdef __TRANSPARENT_SHADOWS__
+  if (kernel_data.integrator.transparent_shadows) {
+    return false;
+  }
+#  endif
+#  ifdef __SHADOW_TRICKS__
+  if (kernel_split_state.path_state[ray_index].flag & PATH_RAY_SHADOW_CATCHER) {
+    return false;
+  }
+#  endif
+#  ifdef __BRANCHED_PATH__
+  if (kernel_data.integrator.branched) {
+    return false;
+  }
+#  endif
+  const ccl_global Ray *ray = &kernel_split_state.light_ray[ray_index];
+  return ray->t != 0.0f && scene_intersect_valid(ray);
+}
+
+ccl_device_noinline void kernel_shadow_blocked_dl_stream_trace(KernelGlobals *kg,
+                                                               const int *ray_indices,
+                                                               RTCRay *rays,
+                                                               const int num_rays)
+{
+  PROFILING_INIT(kg, PROFILING_INTERSECT);
 
-    if (!shadow_blocked(kg, sd, emission_sd, state, &ray, &shadow)) {
-      /* accumulate */
-      path_radiance_accum_light(kg, L, state, throughput, &L_light, shadow, 1.0f, is_lamp);
+  CCLIntersectContext ctx(kg, CCLIntersectContext::RAY_REGULAR);
+  IntersectContext rtc_ctx(&ctx);
+  rtcOccluded1M(kernel_data.bvh.scene, &rtc_ctx.context, rays, num_rays, sizeof(RTCRay));
+
+  for (int i = 0; i < num_rays; i++) {
+    const int ray_index = ray_indices[i];
+    /* rtcOccluded1M sets tfar to -inf if a hit was found. */
+    const bool blocked = rays[i].tfar < 0.0f;
+    float3 shadow = one_float3();
+
+#  ifdef __VOLUME__
+    ccl_global PathState *state = &kernel_split_state.path_state[ray_index];
+    if (!blocked && state->volume_stack[0].shader != SHADER_NONE) {
+      /* Apply attenuation from current volume shader, like shadow_blocked_opaque(). */
+      ShaderData *emission_sd = AS_SHADER_DATA(&kernel_split_state.sd_DL_shadow[ray_index]);
+      Ray ray = kernel_split_state.light_ray[ray_index];
+      kernel_volume_shadow(kg, emission_sd, state, &ray, &shadow);
     }
-    else {
-      path_radiance_accum_total_light(L, state, throughput, &L_light);
+#  endif
+
+    kernel_shadow_blocked_dl_accum(kg, ray_index, blocked, shadow);
+  }
+}
+
+/* Gather the shadow rays of the whole queue and trace them in streams. */
+ccl_device void kernel_shadow_blocked_dl_stream(KernelGlobals *kg, unsigned int dl_queue_length)
+{
+  int ray_indices[SPLIT_RAY_STREAM_SIZE];
+  RTCRay rays[SPLIT_RAY_STREAM_SIZE];
+  int num_rays = 0;
+
+  for (int tid = 0; tid < (int)dl_queue_length; tid++) {
+    const int ray_index = get_ray_index(kg,
+                                        tid,
+                                        QUEUE_SHADOW_RAY_CAST_DL_RAYS,
+                                        kernel_split_state.queue_data,
+                                        kernel_split_params.queue_size,
+                                        1);
+    if (ray_index == QUEUE_EMPTY_SLOT) {
+      continue;
+    }
+
+    if (!kernel_shadow_blocked_dl_use_stream(kg, ray_index)) {
+      kernel_shadow_blocked_dl_ray(kg, ray_index);
+      continue;
+    }
+
+    kernel_embree_setup_ray(
+        kernel_split_state.light_ray[ray_index], rays[num_rays], PATH_RAY_SHADOW_OPAQUE);
+    ray_indices[num_rays] = ray_index;
+    num_rays++;
+
+    if (num_rays == SPLIT_RAY_STREAM_SIZE) {
+      kernel_shadow_blocked_dl_stream_trace(kg, ray_indices, rays, num_rays);
+      num_rays = 0;
+    }
+  }
+
+  if (num_rays > 0) {
+    kernel_shadow_blocked_dl_stream_trace(kg, ray_indices, rays, num_rays);
+  }
+}
+#endif /* __SPLIT_RAY_STREAMS__ */
+
+/* Shadow ray cast for direct visible light. */
+ccl_device void kernel_shadow_blocked_dl(KernelGlobals *kg)
+{
+  unsigned int dl_queue_length = kernel_split_params.queue_index[QUEUE_SHADOW_RAY_CAST_DL_RAYS];
+  ccl_barrier(CCL_LOCAL_MEM_FENCE);
+
+  int thread_index = ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0);
+
+#ifdef __BRANCHED_PATH__
+  /* TODO(mai): move this somewhere else? */
+  if (thread_index == 0) {
+    /* Clear QUEUE_INACTIVE_RAYS before next kernel. */
+    kernel_split_params.queue_index[QUEUE_INACTIVE_RAYS] = 0;
+  }
+#endif /* __BRANCHED_PATH__ */
+
+#ifdef __SPLIT_RAY_STREAMS__
+  if (kernel_data.bvh.scene) {
+    /* Work items run one after the other on the CPU, so the first one traces all rays. */
+    if (thread_index == 0) {
+      kernel_shadow_blocked_dl_stream(kg, dl_queue_length);
     }
+    return;
+  }
+#endif /* __SPLIT_RAY_STREAMS__ */
+
+  int ray_index = QUEUE_EMPTY_SLOT;
+  if (thread_index < dl_queue_length) {
+    ray_index = get_ray_index(kg,
+                              thread_index,
+                              QUEUE_SHADOW_RAY_CAST_DL_RAYS,
+                              kernel_split_state.queue_data,
+                              kernel_split_params.queue_size,
+                              1);
   }
+
+  if (ray_index == QUEUE_EMPTY_SLOT)
+    return;
+
+  kernel_shadow_blocked_dl_ray(kg, ray_index);
 }
 
 CCL_NAMESPACE_END
@@ -55,6 +55,13 @@
 #endif
 // clang-format on
 
+/* On the CPU with Embree, all rays of the wavefront are traced together as ray streams.
+ * Embree splits them into packets matching the SIMD width of the CPU. */
+#if defined(__KERNEL_CPU__) && defined(__EMBREE__) && !defined(__KERNEL_DEBUG__)
+#  define __SPLIT_RAY_STREAMS__
+#  define SPLIT_RAY_STREAM_SIZE 64
+#endif
+
 CCL_NAMESPACE_BEGIN
 
 ccl_device_inline void kernel_split_path_end(KernelGlobals *kg, int ray_index)
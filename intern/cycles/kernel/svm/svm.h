@@ -395,6 +395,9 @@ ccl_device_noinline void svm_eval_nodes(
       case NODE_MATH:
         svm_node_math(kg, sd, stack, node.y, node.z, node.w, &offset);
         break;
+      case NODE_MATH_CHAIN:
+        svm_node_math_chain(kg, sd, stack, node.y, node.z, &offset);
+        break;
       case NODE_VECTOR_MATH:
         svm_node_vector_math(kg, sd, stack, node.y, node.z, node.w, &offset);
         break;
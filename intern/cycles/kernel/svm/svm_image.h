@@ -16,14 +16,19 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+ccl_device float4 svm_image_texture_filtered(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy, uint flags)
 {
   if (id == -1) {
     return make_float4(
         TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
   }
 
+#ifdef __KERNEL_CPU__
+  float4 r = kernel_tex_image_interp_filtered(kg, id, x, y, dx, dy);
+#else
   float4 r = kernel_tex_image_interp(kg, id, x, y);
+#endif
   const float alpha = r.w;
 
   if ((flags & NODE_IMAGE_ALPHA_UNASSOCIATE) && alpha != 1.0f && alpha != 0.0f) {
@@ -38,6 +43,64 @@ ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y,
   return r;
 }
 
+ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+{
+  return svm_image_texture_filtered(
+      kg, id, x, y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f), flags);
+}
+
+#ifdef __KERNEL_CPU__
+/* Derivatives of the texture coordinates for MIP level selection in the texture cache. The SVM
+ * stack does not store derivatives, so the compiler finds the attribute the coordinates are
+ * read from, and the linear part of the mappings applied to it. Only the X and Y rows of the
+ * transform are used by flat projection. */
+ccl_device_noinline void svm_image_derivatives(KernelGlobals *kg,
+                                               ShaderData *sd,
+                                               uint attr_id,
+                                               float4 tfm_x,
+                                               float4 tfm_y,
+                                               float2 *dx,
+                                               float2 *dy)
+{
+  if (sd->object == OBJECT_NONE) {
+    return;
+  }
+
+  const AttributeDescriptor desc = find_attribute(kg, sd, attr_id);
+  if (desc.offset == ATTR_STD_NOT_FOUND) {
+    return;
+  }
+
+  float3 dadx, dady;
+  if (desc.type == NODE_ATTR_FLOAT) {
+    float fdx, fdy;
+    primitive_surface_attribute_float(kg, sd, desc, &fdx, &fdy);
+    dadx = make_float3(fdx, fdx, fdx);
+    dady = make_float3(fdy, fdy, fdy);
+  }
+  else if (desc.type == NODE_ATTR_FLOAT2) {
+    float2 fdx, fdy;
+    primitive_surface_attribute_float2(kg, sd, desc, &fdx, &fdy);
+    dadx = make_float3(fdx.x, fdx.y, 0.0f);
+    dady = make_float3(fdy.x, fdy.y, 0.0f);
+  }
+  else if (desc.type == NODE_ATTR_FLOAT4 || desc.type == NODE_ATTR_RGBA) {
+    float4 fdx, fdy;
+    primitive_surface_attribute_float4(kg, sd, desc, &fdx, &fdy);
+    dadx = float4_to_float3(fdx);
+    dady = float4_to_float3(fdy);
+  }
+  else {
+    primitive_surface_attribute_float3(kg, sd, desc, &dadx, &dady);
+  }
+
+  const float3 row_x = float4_to_float3(tfm_x);
+  const float3 row_y = float4_to_float3(tfm_y);
+  *dx = make_float2(dot(row_x, dadx), dot(row_y, dadx));
+  *dy = make_float2(dot(row_x, dady), dot(row_y, dady));
+}
+#endif
+
 /* Remap coordinate from 0..1 box to -1..-1 */
 ccl_device_inline float3 texco_remap_square(float3 co)
 {
@@ -52,6 +115,31 @@ ccl_device void svm_node_tex_image(
   svm_unpack_node_uchar4(node.z, &co_offset, &out_offset, &alpha_offset, &flags);
 
   float3 co = stack_load_float3(stack, co_offset);
+  if (flags & NODE_IMAGE_TRANSFORM) {
+    /* Texture mapping fused into the node, stored before the tile nodes. */
+    Transform tfm;
+    tfm.x = read_node_float(kg, offset);
+    tfm.y = read_node_float(kg, offset);
+    tfm.z = read_node_float(kg, offset);
+    co = transform_point(&tfm, co);
+  }
+
+#ifdef __KERNEL_CPU__
+  /* Attribute and transform to compute the derivatives of the coordinates from. */
+  uint derivatives_attr = ATTR_STD_NOT_FOUND;
+  float4 derivatives_tfm_x = zero_float4(), derivatives_tfm_y = zero_float4();
+  if (flags & NODE_IMAGE_DERIVATIVES) {
+    derivatives_attr = read_node(kg, offset).x;
+    derivatives_tfm_x = read_node_float(kg, offset);
+    derivatives_tfm_y = read_node_float(kg, offset);
+  }
+#else
+  /* Only used by the texture cache of the CPU device. */
+  if (flags & NODE_IMAGE_DERIVATIVES) {
+    *offset += 3;
+  }
+#endif
+
   float2 tex_co;
   if (node.w == NODE_IMAGE_PROJ_SPHERE) {
     co = texco_remap_square(co);
@@ -108,7 +196,15 @@ ccl_device void svm_node_tex_image(
     id = -num_nodes;
   }
 
-  float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags);
+  float2 dx = make_float2(0.0f, 0.0f), dy = make_float2(0.0f, 0.0f);
+#ifdef __KERNEL_CPU__
+  if ((flags & NODE_IMAGE_DERIVATIVES) && id != -1 && kernel_tex_image_is_cached(kg, id)) {
+    svm_image_derivatives(
+        kg, sd, derivatives_attr, derivatives_tfm_x, derivatives_tfm_y, &dx, &dy);
+  }
+#endif
+
+  float4 f = svm_image_texture_filtered(kg, id, tex_co.x, tex_co.y, dx, dy, flags);
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
@@ -27,14 +27,61 @@ ccl_device void svm_node_math(KernelGlobals *kg,
   uint a_stack_offset, b_stack_offset, c_stack_offset;
   svm_unpack_node_uchar3(inputs_stack_offsets, &a_stack_offset, &b_stack_offset, &c_stack_offset);
 
-  float a = stack_load_float(stack, a_stack_offset);
-  float b = stack_load_float(stack, b_stack_offset);
-  float c = stack_load_float(stack, c_stack_offset);
+  /* Unlinked inputs are stored in an extra node instead of the stack. */
+  uint4 defaults = make_uint4(0, 0, 0, 0);
+  if (!stack_valid(a_stack_offset) || !stack_valid(b_stack_offset) ||
+      !stack_valid(c_stack_offset)) {
+    defaults = read_node(kg, offset);
+  }
+
+  float a = stack_load_float_default(stack, a_stack_offset, defaults.x);
+  float b = stack_load_float_default(stack, b_stack_offset, defaults.y);
+  float c = stack_load_float_default(stack, c_stack_offset, defaults.z);
   float result = svm_math((NodeMathType)type, a, b, c);
 
   stack_store_float(stack, result_stack_offset, result);
 }
 
+/* Sequence of math operations where each one takes the result of the previous one as input,
+ * keeping the intermediate results out of the stack. Every operation is stored in a node with
+ * the type, the input stack offsets with the index of the chained input, and the values of up
+ * to two unlinked inputs in order. */
+ccl_device void svm_node_math_chain(KernelGlobals *kg,
+                                    ShaderData *sd,
+                                    float *stack,
+                                    uint num_operations,
+                                    uint result_stack_offset,
+                                    int *offset)
+{
+  float result = 0.0f;
+
+  for (uint i = 0; i < num_operations; i++) {
+    uint4 node = read_node(kg, offset);
+    uint stack_offsets[3], chain_input;
+    svm_unpack_node_uchar4(
+        node.y, &stack_offsets[0], &stack_offsets[1], &stack_offsets[2], &chain_input);
+
+    float inputs[3];
+    uint default_value = node.z;
+    for (uint j = 0; j < 3; j++) {
+      if (j == chain_input) {
+        inputs[j] = result;
+      }
+      else if (stack_valid(stack_offsets[j])) {
+        inputs[j] = stack_load_float(stack, stack_offsets[j]);
+      }
+      else {
+        inputs[j] = __uint_as_float(default_value);
+        default_value = node.w;
+      }
+    }
+
+    result = svm_math((NodeMathType)node.x, inputs[0], inputs[1], inputs[2]);
+  }
+
+  stack_store_float(stack, result_stack_offset, result);
+}
+
 ccl_device void svm_node_vector_math(KernelGlobals *kg,
                                      ShaderData *sd,
                                      float *stack,
@@ -105,6 +105,7 @@ typedef enum ShaderNodeType {
   NODE_CLOSURE_VOLUME,
   NODE_PRINCIPLED_VOLUME,
   NODE_MATH,
+  NODE_MATH_CHAIN,
   NODE_VECTOR_MATH,
   NODE_RGB_RAMP,
   NODE_GAMMA,
@@ -482,6 +483,9 @@ typedef enum NodeImageProjection {
 typedef enum NodeImageFlags {
   NODE_IMAGE_COMPRESS_AS_SRGB = 1,
   NODE_IMAGE_ALPHA_UNASSOCIATE = 2,
+  /* Texture mapping transform stored after the node, applied to the coordinates. */
+  NODE_IMAGE_TRANSFORM = 4,
+  NODE_IMAGE_DERIVATIVES = 8,
 } NodeImageFlags;
 
 typedef enum NodeEnvironmentProjection {
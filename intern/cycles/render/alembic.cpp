@@ -23,8 +23,11 @@
 #include "render/scene.h"
 #include "render/shader.h"
 
+#include "util/util_algorithm.h"
 #include "util/util_foreach.h"
+#include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_task.h"
 #include "util/util_transform.h"
 #include "util/util_vector.h"
 
@@ -169,8 +172,61 @@ void CachedData::set_time_sampling(TimeSampling time_sampling)
   }
 }
 
-/* get the sample times to load data for the given the start and end frame of the procedural */
-static set<chrono_t> get_relevant_sample_times(AlembicProcedural *proc,
+void CachedData::remove_data_outside(const TimeRange &range)
+{
+  curve_first_key.remove_data_outside(range);
+  curve_keys.remove_data_outside(range);
+  curve_radius.remove_data_outside(range);
+  curve_shader.remove_data_outside(range);
+  num_ngons.remove_data_outside(range);
+  shader.remove_data_outside(range);
+  subd_creases_edge.remove_data_outside(range);
+  subd_creases_weight.remove_data_outside(range);
+  subd_face_corners.remove_data_outside(range);
+  subd_num_corners.remove_data_outside(range);
+  subd_ptex_offset.remove_data_outside(range);
+  subd_smooth.remove_data_outside(range);
+  subd_start_corner.remove_data_outside(range);
+  triangles.remove_data_outside(range);
+  triangles_loops.remove_data_outside(range);
+  vertices.remove_data_outside(range);
+
+  for (CachedAttribute &attr : attributes) {
+    attr.data.remove_data_outside(range);
+  }
+}
+
+size_t CachedData::memory_used() const
+{
+  size_t mem = 0;
+
+  mem += curve_first_key.memory_used();
+  mem += curve_keys.memory_used();
+  mem += curve_radius.memory_used();
+  mem += curve_shader.memory_used();
+  mem += num_ngons.memory_used();
+  mem += shader.memory_used();
+  mem += subd_creases_edge.memory_used();
+  mem += subd_creases_weight.memory_used();
+  mem += subd_face_corners.memory_used();
+  mem += subd_num_corners.memory_used();
+  mem += subd_ptex_offset.memory_used();
+  mem += subd_smooth.memory_used();
+  mem += subd_start_corner.memory_used();
+  mem += transforms.memory_used();
+  mem += triangles.memory_used();
+  mem += triangles_loops.memory_used();
+  mem += vertices.memory_used();
+
+  for (const CachedAttribute &attr : attributes) {
+    mem += attr.data.memory_used();
+  }
+
+  return mem;
+}
+
+/* get the sample times to load data for in the given time range */
+static set<chrono_t> get_relevant_sample_times(const TimeRange &range,
                                                const TimeSampling &time_sampling,
                                                size_t num_samples)
 {
@@ -181,11 +237,11 @@ static set<chrono_t> get_relevant_sample_times(AlembicProcedural *proc,
     return result;
   }
 
-  double start_frame = (double)(proc->get_start_frame() / proc->get_frame_rate());
-  double end_frame = (double)((proc->get_end_frame() + 1) / proc->get_frame_rate());
+  size_t start_index = time_sampling.getFloorIndex(range.start, num_samples).first;
+  size_t end_index = time_sampling.getCeilIndex(range.end, num_samples).first;
 
-  size_t start_index = time_sampling.getFloorIndex(start_frame, num_samples).first;
-  size_t end_index = time_sampling.getCeilIndex(end_frame, num_samples).first;
+  /* Always load at least one sample, for ranges past the end of the animation. */
+  end_index = max(end_index, start_index + 1);
 
   for (size_t i = start_index; i < end_index; ++i) {
     result.insert(time_sampling.getSampleTime(i));
@@ -366,7 +422,7 @@ static Transform make_transform(const M44d &a, float scale)
   return trans;
 }
 
-static void add_uvs(AlembicProcedural *proc,
+static void add_uvs(const TimeRange &range,
                     const IV2fGeomParam &uvs,
                     CachedData &cached_data,
                     Progress &progress)
@@ -394,13 +450,17 @@ static void add_uvs(AlembicProcedural *proc,
   CachedData::CachedAttribute &attr = cached_data.add_attribute(ustring(name), time_sampling);
   attr.std = ATTR_STD_UV;
 
-  ccl::set<chrono_t> times = get_relevant_sample_times(proc, time_sampling, uvs.getNumSamples());
+  ccl::set<chrono_t> times = get_relevant_sample_times(range, time_sampling, uvs.getNumSamples());
 
   foreach (chrono_t time, times) {
     if (progress.get_cancel()) {
       return;
     }
 
+    if (attr.data.has_data_for_time(time)) {
+      continue;
+    }
+
     const ISampleSelector iss = ISampleSelector(time);
     const IV2fGeomParam::Sample sample = uvs.getExpandedValue(iss);
 
@@ -630,7 +690,27 @@ bool AlembicObject::has_data_loaded() const
   return data_loaded;
 }
 
+void AlembicObject::clear_cache()
+{
+  cached_data.clear();
+  data_loaded = false;
+  has_animated_data = false;
+  need_shader_update = true;
+}
+
+void AlembicObject::copy_sockets_for_loading()
+{
+  shader_names.clear();
+
+  foreach (Node *node, get_used_shaders()) {
+    shader_names.push_back(node->name);
+  }
+
+  loaded_radius_scale = radius_scale;
+}
+
 void AlembicObject::update_shader_attributes(const ICompoundProperty &arb_geom_params,
+                                             const TimeRange &range,
                                              Progress &progress)
 {
   AttributeRequestSet requested_attributes = get_requested_attributes();
@@ -652,7 +732,7 @@ void AlembicObject::update_shader_attributes(const ICompoundProperty &arb_geom_p
       continue;
     }
 
-    read_attribute(arb_geom_params, attr.name, progress);
+    read_attribute(arb_geom_params, attr.name, range, progress);
   }
 
   cached_data.invalidate_last_loaded_time(true);
@@ -678,15 +758,15 @@ void AlembicObject::read_face_sets(SchemaType &schema,
   foreach (const std::string &face_set_name, face_sets) {
     int shader_index = 0;
 
-    foreach (Node *node, get_used_shaders()) {
-      if (node->name == face_set_name) {
+    foreach (const ustring &shader_name, shader_names) {
+      if (shader_name == face_set_name) {
         break;
       }
 
       ++shader_index;
     }
 
-    if (shader_index >= get_used_shaders().size()) {
+    if (shader_index >= shader_names.size()) {
       /* use the first shader instead if none was found */
       shader_index = 0;
     }
@@ -714,20 +794,46 @@ void AlembicObject::read_face_sets(SchemaType &schema,
   }
 }
 
-void AlembicObject::load_all_data(AlembicProcedural *proc,
-                                  IPolyMeshSchema &schema,
-                                  float scale,
-                                  Progress &progress)
+void AlembicObject::load_data(const TimeRange &range,
+                              float scale,
+                              float default_radius,
+                              Progress &progress)
 {
-  cached_data.clear();
+  const ObjectHeader &header = iobject.getHeader();
+
+  if (IPolyMesh::matches(header)) {
+    IPolyMesh polymesh(iobject, Alembic::Abc::kWrapExisting);
+    IPolyMeshSchema schema = polymesh.getSchema();
+    load_data(range, schema, scale, progress);
+  }
+  else if (ICurves::matches(header)) {
+    ICurves curves(iobject, Alembic::Abc::kWrapExisting);
+    ICurvesSchema schema = curves.getSchema();
+    load_data(range, schema, scale, progress, default_radius);
+  }
+  else if (ISubD::matches(header)) {
+    ISubD subd_mesh(iobject, Alembic::Abc::kWrapExisting);
+    ISubDSchema schema = subd_mesh.getSchema();
+    load_data(range, schema, scale, progress);
+  }
+}
 
+void AlembicObject::load_data(const TimeRange &range,
+                              IPolyMeshSchema &schema,
+                              float scale,
+                              Progress &progress)
+{
   const TimeSamplingPtr time_sampling = schema.getTimeSampling();
   cached_data.set_time_sampling(*time_sampling);
 
   const IN3fGeomParam &normals = schema.getNormalsParam();
 
   ccl::set<chrono_t> times = get_relevant_sample_times(
-      proc, *time_sampling, schema.getNumSamples());
+      range, *time_sampling, schema.getNumSamples());
+
+  if (schema.getNumSamples() > 1) {
+    has_animated_data = true;
+  }
 
   /* read topology */
   foreach (chrono_t time, times) {
@@ -735,6 +841,10 @@ void AlembicObject::load_all_data(AlembicProcedural *proc,
       return;
     }
 
+    if (cached_data.vertices.has_data_for_time(time)) {
+      continue;
+    }
+
     const ISampleSelector iss = ISampleSelector(time);
     const IPolyMeshSchema::Sample sample = schema.getValue(iss);
 
@@ -767,7 +877,19 @@ void AlembicObject::load_all_data(AlembicProcedural *proc,
     return;
   }
 
-  update_shader_attributes(schema.getArbGeomParams(), progress);
+  /* Attributes requested by the shaders are first read in update_shader_attributes, read them
+   * for the new time points as well. */
+  vector<ustring> attribute_names;
+
+  foreach (const CachedData::CachedAttribute &attr, cached_data.attributes) {
+    if (attr.std == ATTR_STD_NONE) {
+      attribute_names.push_back(attr.name);
+    }
+  }
+
+  foreach (const ustring &attr_name, attribute_names) {
+    read_attribute(schema.getArbGeomParams(), attr_name, range, progress);
+  }
 
   if (progress.get_cancel()) {
     return;
@@ -776,32 +898,38 @@ void AlembicObject::load_all_data(AlembicProcedural *proc,
   const IV2fGeomParam &uvs = schema.getUVsParam();
 
   if (uvs.valid()) {
-    add_uvs(proc, uvs, cached_data, progress);
+    if (uvs.getNumSamples() > 1) {
+      has_animated_data = true;
+    }
+
+    add_uvs(range, uvs, cached_data, progress);
   }
 
   if (progress.get_cancel()) {
     return;
   }
 
-  setup_transform_cache(scale);
+  if (!data_loaded) {
+    setup_transform_cache(scale);
+  }
 
   data_loaded = true;
 }
 
-void AlembicObject::load_all_data(AlembicProcedural *proc,
-                                  ISubDSchema &schema,
-                                  float scale,
-                                  Progress &progress)
+void AlembicObject::load_data(const TimeRange &range,
+                              ISubDSchema &schema,
+                              float scale,
+                              Progress &progress)
 {
-  cached_data.clear();
-
-  AttributeRequestSet requested_attributes = get_requested_attributes();
-
   const TimeSamplingPtr time_sampling = schema.getTimeSampling();
   cached_data.set_time_sampling(*time_sampling);
 
   ccl::set<chrono_t> times = get_relevant_sample_times(
-      proc, *time_sampling, schema.getNumSamples());
+      range, *time_sampling, schema.getNumSamples());
+
+  if (schema.getNumSamples() > 1) {
+    has_animated_data = true;
+  }
 
   /* read topology */
   foreach (chrono_t time, times) {
@@ -809,6 +937,10 @@ void AlembicObject::load_all_data(AlembicProcedural *proc,
       return;
     }
 
+    if (cached_data.vertices.has_data_for_time(time)) {
+      continue;
+    }
+
     const ISampleSelector iss = ISampleSelector(time);
     const ISubDSchema::Sample sample = schema.getValue(iss);
 
@@ -919,30 +1051,38 @@ void AlembicObject::load_all_data(AlembicProcedural *proc,
     return;
   }
 
-  setup_transform_cache(scale);
+  if (!data_loaded) {
+    setup_transform_cache(scale);
+  }
 
   data_loaded = true;
 }
 
-void AlembicObject::load_all_data(AlembicProcedural *proc,
-                                  const ICurvesSchema &schema,
-                                  float scale,
-                                  Progress &progress,
-                                  float default_radius)
+void AlembicObject::load_data(const TimeRange &range,
+                              const ICurvesSchema &schema,
+                              float scale,
+                              Progress &progress,
+                              float default_radius)
 {
-  cached_data.clear();
-
   const TimeSamplingPtr time_sampling = schema.getTimeSampling();
   cached_data.set_time_sampling(*time_sampling);
 
   ccl::set<chrono_t> times = get_relevant_sample_times(
-      proc, *time_sampling, schema.getNumSamples());
+      range, *time_sampling, schema.getNumSamples());
+
+  if (schema.getNumSamples() > 1) {
+    has_animated_data = true;
+  }
 
   foreach (chrono_t time, times) {
     if (progress.get_cancel()) {
       return;
     }
 
+    if (cached_data.curve_keys.has_data_for_time(time)) {
+      continue;
+    }
+
     const ISampleSelector iss = ISampleSelector(time);
     const ICurvesSchema::Sample sample = schema.getValue(iss);
 
@@ -982,7 +1122,7 @@ void AlembicObject::load_all_data(AlembicProcedural *proc,
           radius = (*radiuses)[offset + j];
         }
 
-        curve_radius.push_back_reserved(radius * radius_scale);
+        curve_radius.push_back_reserved(radius * loaded_radius_scale);
       }
 
       curve_first_key.push_back_reserved(offset);
@@ -999,7 +1139,13 @@ void AlembicObject::load_all_data(AlembicProcedural *proc,
 
   // TODO(@kevindietrich): attributes, need example files
 
-  setup_transform_cache(scale);
+  if (progress.get_cancel()) {
+    return;
+  }
+
+  if (!data_loaded) {
+    setup_transform_cache(scale);
+  }
 
   data_loaded = true;
 }
@@ -1061,6 +1207,7 @@ AttributeRequestSet AlembicObject::get_requested_attributes()
 
 void AlembicObject::read_attribute(const ICompoundProperty &arb_geom_params,
                                    const ustring &attr_name,
+                                   const TimeRange &range,
                                    Progress &progress)
 {
   const PropertyHeader *prop = arb_geom_params.getPropertyHeader(attr_name.c_str());
@@ -1075,18 +1222,27 @@ void AlembicObject::read_attribute(const ICompoundProperty &arb_geom_params,
     CachedData::CachedAttribute &attribute = cached_data.add_attribute(attr_name,
                                                                        *param.getTimeSampling());
 
-    for (size_t i = 0; i < param.getNumSamples(); ++i) {
+    if (param.getNumSamples() > 1) {
+      has_animated_data = true;
+    }
+
+    ccl::set<chrono_t> times = get_relevant_sample_times(
+        range, *param.getTimeSampling(), param.getNumSamples());
+
+    foreach (chrono_t time, times) {
       if (progress.get_cancel()) {
         return;
       }
 
-      ISampleSelector iss = ISampleSelector(index_t(i));
+      if (attribute.data.has_data_for_time(time)) {
+        continue;
+      }
+
+      ISampleSelector iss = ISampleSelector(time);
 
       IV2fGeomParam::Sample sample;
       param.getIndexed(sample, iss);
 
-      const chrono_t time = param.getTimeSampling()->getSampleTime(index_t(i));
-
       if (param.getScope() == kFacevaryingScope) {
         V2fArraySamplePtr values = sample.getVals();
         UInt32ArraySamplePtr indices = sample.getIndices();
@@ -1130,18 +1286,27 @@ void AlembicObject::read_attribute(const ICompoundProperty &arb_geom_params,
     CachedData::CachedAttribute &attribute = cached_data.add_attribute(attr_name,
                                                                        *param.getTimeSampling());
 
-    for (size_t i = 0; i < param.getNumSamples(); ++i) {
+    if (param.getNumSamples() > 1) {
+      has_animated_data = true;
+    }
+
+    ccl::set<chrono_t> times = get_relevant_sample_times(
+        range, *param.getTimeSampling(), param.getNumSamples());
+
+    foreach (chrono_t time, times) {
       if (progress.get_cancel()) {
         return;
       }
 
-      ISampleSelector iss = ISampleSelector(index_t(i));
+      if (attribute.data.has_data_for_time(time)) {
+        continue;
+      }
+
+      ISampleSelector iss = ISampleSelector(time);
 
       IC3fGeomParam::Sample sample;
       param.getIndexed(sample, iss);
 
-      const chrono_t time = param.getTimeSampling()->getSampleTime(index_t(i));
-
       C3fArraySamplePtr values = sample.getVals();
 
       attribute.std = ATTR_STD_NONE;
@@ -1186,18 +1351,27 @@ void AlembicObject::read_attribute(const ICompoundProperty &arb_geom_params,
     CachedData::CachedAttribute &attribute = cached_data.add_attribute(attr_name,
                                                                        *param.getTimeSampling());
 
-    for (size_t i = 0; i < param.getNumSamples(); ++i) {
+    if (param.getNumSamples() > 1) {
+      has_animated_data = true;
+    }
+
+    ccl::set<chrono_t> times = get_relevant_sample_times(
+        range, *param.getTimeSampling(), param.getNumSamples());
+
+    foreach (chrono_t time, times) {
       if (progress.get_cancel()) {
         return;
       }
 
-      ISampleSelector iss = ISampleSelector(index_t(i));
+      if (attribute.data.has_data_for_time(time)) {
+        continue;
+      }
+
+      ISampleSelector iss = ISampleSelector(time);
 
       IC4fGeomParam::Sample sample;
       param.getIndexed(sample, iss);
 
-      const chrono_t time = param.getTimeSampling()->getSampleTime(index_t(i));
-
       C4fArraySamplePtr values = sample.getVals();
 
       attribute.std = ATTR_STD_NONE;
@@ -1297,6 +1471,10 @@ NODE_DEFINE(AlembicProcedural)
   SOCKET_FLOAT(default_radius, "Default Radius", 0.01f);
   SOCKET_FLOAT(scale, "Scale", 1.0f);
 
+  SOCKET_BOOLEAN(use_streaming, "Use Streaming", false);
+  SOCKET_INT(prefetch_frames, "Prefetch Frames", 4);
+  SOCKET_INT(cache_memory_limit, "Cache Memory Limit", 4096);
+
   SOCKET_NODE_ARRAY(objects, "Objects", &AlembicObject::node_type);
 
   return type;
@@ -1306,10 +1484,17 @@ AlembicProcedural::AlembicProcedural() : Procedural(node_type)
 {
   objects_loaded = false;
   scene_ = nullptr;
+  prefetch_loaded_end = 0.0;
+  prefetch_finished = true;
 }
 
 AlembicProcedural::~AlembicProcedural()
 {
+  if (prefetch_thread) {
+    prefetch_progress.set_cancel("Deleting procedural");
+    prefetch_thread->join();
+  }
+
   ccl::set<Geometry *> geometries_set;
   ccl::set<Object *> objects_set;
   ccl::set<AlembicObject *> abc_objects_set;
@@ -1364,9 +1549,16 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     return;
   }
 
+  const chrono_t frame_time = (chrono_t)((frame - frame_offset) / frame_rate);
+
+  /* The background thread must be done with the objects and the archive before they are used. */
+  wait_for_prefetch(frame_time);
+
   if (!archive.valid()) {
     Alembic::AbcCoreFactory::IFactory factory;
     factory.setPolicy(Alembic::Abc::ErrorHandler::kQuietNoopPolicy);
+    /* Allow reading multiple objects in parallel from Ogawa archives. */
+    factory.setOgawaNumStreams(max(TaskScheduler::num_threads(), 1));
     archive = factory.getArchive(filepath.c_str());
 
     if (!archive.valid()) {
@@ -1382,7 +1574,35 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     objects_loaded = true;
   }
 
-  const chrono_t frame_time = (chrono_t)((frame - frame_offset) / frame_rate);
+  /* Read the data of the objects in parallel, the nodes are then updated serially. */
+  const TimeRange range = get_load_range(frame_time);
+  TaskPool pool;
+
+  foreach (Node *node, objects) {
+    AlembicObject *object = static_cast<AlembicObject *>(node);
+
+    if (!object->iobject.valid()) {
+      continue;
+    }
+
+    const bool need_reload = use_streaming_is_modified() ||
+                             (ICurves::matches(object->iobject.getHeader()) &&
+                              (default_radius_is_modified() ||
+                               object->radius_scale_is_modified()));
+
+    if (need_reload) {
+      object->clear_cache();
+    }
+    else if (object->has_data_loaded() && !use_streaming) {
+      continue;
+    }
+
+    object->copy_sockets_for_loading();
+
+    pool.push([=, &progress]() { object->load_data(range, scale, default_radius, progress); });
+  }
+
+  pool.wait_work();
 
   foreach (Node *node, objects) {
     AlembicObject *object = static_cast<AlembicObject *>(node);
@@ -1410,6 +1630,27 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     object->clear_modified();
   }
 
+  if (use_streaming) {
+    /* Evict the frames before the current one and the ones after the prefetch window, then the
+     * furthest frames until the cache fits in memory again. */
+    const size_t memory_limit = (size_t)cache_memory_limit * 1024 * 1024;
+
+    for (int num_frames = prefetch_frames;; --num_frames) {
+      const TimeRange cache_range = {range.start, get_load_range(frame_time, num_frames).end};
+
+      foreach (Node *node, objects) {
+        AlembicObject *object = static_cast<AlembicObject *>(node);
+        object->get_cached_data().remove_data_outside(cache_range);
+      }
+
+      if (num_frames <= 0 || memory_used() <= memory_limit) {
+        break;
+      }
+    }
+
+    start_prefetch(frame_time);
+  }
+
   clear_modified();
 }
 
@@ -1462,6 +1703,129 @@ void AlembicProcedural::load_objects(Progress &progress)
   }
 }
 
+TimeRange AlembicProcedural::get_load_range(double frame_time, int frame_index) const
+{
+  const double start_time = (double)(start_frame / frame_rate);
+  const double end_time = (double)((end_frame + 1) / frame_rate);
+
+  if (!use_streaming) {
+    return {start_time, end_time};
+  }
+
+  /* Frames outside of the animation range use the data of the nearest frame in the range. */
+  const double frame_duration = 1.0 / frame_rate;
+  double time = frame_time + frame_index * frame_duration;
+  time = max(min(time, end_time - frame_duration), start_time);
+
+  return {time, time + frame_duration};
+}
+
+void AlembicProcedural::start_prefetch(double frame_time)
+{
+  vector<AlembicObject *> abc_objects;
+
+  foreach (Node *node, objects) {
+    AlembicObject *object = static_cast<AlembicObject *>(node);
+
+    if (object->has_data_loaded() && !object->is_constant()) {
+      abc_objects.push_back(object);
+    }
+  }
+
+  if (abc_objects.empty() || prefetch_frames <= 0) {
+    return;
+  }
+
+  /* Copy the sockets, as they may be modified while the thread is running. */
+  vector<TimeRange> frame_ranges;
+
+  for (int i = 1; i <= prefetch_frames; ++i) {
+    frame_ranges.push_back(get_load_range(frame_time, i));
+  }
+
+  const float load_scale = scale;
+  const float load_default_radius = default_radius;
+  const size_t memory_limit = (size_t)cache_memory_limit * 1024 * 1024;
+
+  prefetch_range = {frame_ranges.front().start, frame_ranges.back().end};
+  prefetch_loaded_end = prefetch_range.start;
+  prefetch_finished = false;
+  prefetch_progress.reset();
+
+  prefetch_thread.reset(new thread([=]() {
+    foreach (const TimeRange &range, frame_ranges) {
+      size_t mem = 0;
+
+      foreach (AlembicObject *object, abc_objects) {
+        mem += object->get_cached_data().memory_used();
+      }
+
+      if (mem >= memory_limit) {
+        VLOG(1) << "Alembic cache memory limit reached, stopped prefetching at " << range.start
+                << " seconds.";
+        break;
+      }
+
+      TaskPool pool;
+
+      foreach (AlembicObject *object, abc_objects) {
+        pool.push([=]() {
+          object->load_data(range, load_scale, load_default_radius, prefetch_progress);
+        });
+      }
+
+      pool.wait_work();
+
+      if (prefetch_progress.get_cancel()) {
+        break;
+      }
+
+      thread_scoped_lock lock(prefetch_mutex);
+      prefetch_loaded_end = range.end;
+      prefetch_cond.notify_all();
+    }
+
+    thread_scoped_lock lock(prefetch_mutex);
+    prefetch_finished = true;
+    prefetch_cond.notify_all();
+  }));
+}
+
+void AlembicProcedural::wait_for_prefetch(double frame_time)
+{
+  if (!prefetch_thread) {
+    return;
+  }
+
+  /* Frames are read in order, so only wait until the requested one is read, if it is being
+   * prefetched, and cancel the reading of the next ones. Prefetching restarts from the requested
+   * frame once it is synchronized. */
+  const double time = get_load_range(frame_time).start;
+
+  if (time >= prefetch_range.start && time < prefetch_range.end) {
+    thread_scoped_lock lock(prefetch_mutex);
+    while (!prefetch_finished && prefetch_loaded_end <= time) {
+      prefetch_cond.wait(lock);
+    }
+  }
+
+  prefetch_progress.set_cancel("Frame synchronization");
+  prefetch_thread->join();
+  prefetch_thread.reset();
+}
+
+size_t AlembicProcedural::memory_used() const
+{
+  size_t mem = 0;
+
+  foreach (Node *node, objects) {
+    AlembicObject *object = static_cast<AlembicObject *>(node);
+    mem += object->get_cached_data().memory_used();
+  }
+
+  return mem;
+}
+
 void AlembicProcedural::read_mesh(Scene *scene,
                                   AlembicObject *abc_object,
                                   Abc::chrono_t frame_time,
@@ -1496,17 +1860,13 @@ void AlembicProcedural::read_mesh(Scene *scene,
   CachedData &cached_data = abc_object->get_cached_data();
   IPolyMeshSchema schema = polymesh.getSchema();
 
-  if (!abc_object->has_data_loaded()) {
-    abc_object->load_all_data(this, schema, scale, progress);
+  if (abc_object->need_shader_update) {
+    abc_object->update_shader_attributes(
+        schema.getArbGeomParams(), get_load_range(frame_time), progress);
   }
-  else {
-    if (abc_object->need_shader_update) {
-      abc_object->update_shader_attributes(schema.getArbGeomParams(), progress);
-    }
 
-    if (scale_is_modified()) {
-      abc_object->setup_transform_cache(scale);
-    }
+  if (scale_is_modified()) {
+    abc_object->setup_transform_cache(scale);
   }
 
   /* update sockets */
@@ -1591,17 +1951,13 @@ void AlembicProcedural::read_subd(Scene *scene,
     mesh = static_cast<Mesh *>(abc_object->get_object()->get_geometry());
   }
 
-  if (!abc_object->has_data_loaded()) {
-    abc_object->load_all_data(this, schema, scale, progress);
+  if (abc_object->need_shader_update) {
+    abc_object->update_shader_attributes(
+        schema.getArbGeomParams(), get_load_range(frame_time), progress);
   }
-  else {
-    if (abc_object->need_shader_update) {
-      abc_object->update_shader_attributes(schema.getArbGeomParams(), progress);
-    }
 
-    if (scale_is_modified()) {
-      abc_object->setup_transform_cache(scale);
-    }
+  if (scale_is_modified()) {
+    abc_object->setup_transform_cache(scale);
   }
 
   mesh->set_subd_max_level(abc_object->get_subd_max_level());
@@ -1616,7 +1972,7 @@ void AlembicProcedural::read_subd(Scene *scene,
 
   /* Cycles overwrites the original triangles when computing displacement, so we always have to
    * repass the data if something is animated (vertices most likely) to avoid buffer overflows. */
-  if (!cached_data.is_constant()) {
+  if (!abc_object->is_constant()) {
     cached_data.invalidate_last_loaded_time();
 
     /* remove previous triangles, if any */
@@ -1689,7 +2045,6 @@ void AlembicProcedural::read_curves(Scene *scene,
                                     Abc::chrono_t frame_time,
                                     Progress &progress)
 {
-  ICurves curves(abc_object->iobject, Alembic::Abc::kWrapExisting);
   Hair *hair;
 
   /* create a hair node in the scene if not already done */
@@ -1714,16 +2069,8 @@ void AlembicProcedural::read_curves(Scene *scene,
     hair = static_cast<Hair *>(abc_object->get_object()->get_geometry());
   }
 
-  ICurvesSchema schema = curves.getSchema();
-
-  if (!abc_object->has_data_loaded() || default_radius_is_modified() ||
-      abc_object->radius_scale_is_modified()) {
-    abc_object->load_all_data(this, schema, scale, progress, default_radius);
-  }
-  else {
-    if (scale_is_modified()) {
-      abc_object->setup_transform_cache(scale);
-    }
+  if (scale_is_modified()) {
+    abc_object->setup_transform_cache(scale);
   }
 
   CachedData &cached_data = abc_object->get_cached_data();
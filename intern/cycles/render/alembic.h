@@ -19,8 +19,11 @@
 #include "graph/node.h"
 #include "render/attribute.h"
 #include "render/procedural.h"
+#include "util/util_progress.h"
 #include "util/util_set.h"
+#include "util/util_thread.h"
 #include "util/util_transform.h"
+#include "util/util_unique_ptr.h"
 #include "util/util_vector.h"
 
 #ifdef WITH_ALEMBIC
@@ -33,7 +36,6 @@ CCL_NAMESPACE_BEGIN
 class AlembicProcedural;
 class Geometry;
 class Object;
-class Progress;
 class Shader;
 
 using MatrixSampleMap = std::map<Alembic::Abc::chrono_t, Alembic::Abc::M44d>;
@@ -45,11 +47,18 @@ template<typename> struct is_array : public std::false_type {
 template<typename T> struct is_array<array<T>> : public std::true_type {
 };
 
+/* Range of animation time in seconds to load data for, the end is exclusive. */
+struct TimeRange {
+  double start = 0.0;
+  double end = 0.0;
+};
+
 /* Store the data set for an animation at every time points, or at the beginning of the animation
  * for constant data.
  *
- * The data is supposed to be stored in chronological order, and is looked up using the current
- * animation time in seconds using the TimeSampling from the Alembic property. */
+ * The data is stored in chronological order, and is looked up using the current animation time in
+ * seconds. Only a subset of the time points may be loaded, in which case the nearest one is used.
+ */
 template<typename T> class DataStore {
   struct DataTimePair {
     double time = 0;
@@ -61,6 +70,52 @@ template<typename T> class DataStore {
 
   double last_loaded_time = std::numeric_limits<double>::max();
 
+  /* Index of the data with the time nearest to the specified one, the data must not be empty. */
+  size_t nearest_index(double time) const
+  {
+    size_t index = lower_bound_index(time);
+
+    if (index == data.size()) {
+      return index - 1;
+    }
+
+    if (index > 0 && time - data[index - 1].time < data[index].time - time) {
+      return index - 1;
+    }
+
+    return index;
+  }
+
+  /* Index of the first data whose time is not less than the specified one. */
+  size_t lower_bound_index(double time) const
+  {
+    size_t first = 0;
+    size_t last = data.size();
+
+    while (first < last) {
+      const size_t middle = (first + last) / 2;
+
+      if (data[middle].time < time) {
+        first = middle + 1;
+      }
+      else {
+        last = middle;
+      }
+    }
+
+    return first;
+  }
+
+  static void move_data(T &to, T &from)
+  {
+    if constexpr (is_array<T>::value) {
+      to.steal_data(from);
+    }
+    else {
+      to = from;
+    }
+  }
+
  public:
   void set_time_sampling(Alembic::AbcCoreAbstract::TimeSampling time_sampling_)
   {
@@ -80,9 +135,7 @@ template<typename T> class DataStore {
       return nullptr;
     }
 
-    std::pair<size_t, Alembic::Abc::chrono_t> index_pair;
-    index_pair = time_sampling.getNearIndex(time, data.size());
-    DataTimePair &data_pair = data[index_pair.first];
+    DataTimePair &data_pair = data[nearest_index(time)];
 
     if (last_loaded_time == data_pair.time) {
       return nullptr;
@@ -101,22 +154,81 @@ template<typename T> class DataStore {
       return nullptr;
     }
 
-    std::pair<size_t, Alembic::Abc::chrono_t> index_pair;
-    index_pair = time_sampling.getNearIndex(time, data.size());
-    DataTimePair &data_pair = data[index_pair.first];
+    DataTimePair &data_pair = data[nearest_index(time)];
     return &data_pair.data;
   }
 
+  bool has_data_for_time(double time) const
+  {
+    const size_t index = lower_bound_index(time);
+    return index < data.size() && data[index].time == time;
+  }
+
+  /* Add the data for the specified time, replacing any existing data for this time. Data is
+   * usually added in chronological order, but earlier times can be added when streaming. */
   void add_data(T &data_, double time)
   {
-    if constexpr (is_array<T>::value) {
-      data.emplace_back();
-      data.back().data.steal_data(data_);
-      data.back().time = time;
+    size_t index = lower_bound_index(time);
+
+    if (index < data.size() && data[index].time == time) {
+      move_data(data[index].data, data_);
+      return;
+    }
+
+    data.emplace_back();
+
+    /* Shift the later time points, stealing the arrays to avoid copying them. */
+    for (size_t i = data.size() - 1; i > index; --i) {
+      data[i].time = data[i - 1].time;
+      move_data(data[i].data, data[i - 1].data);
+    }
+
+    data[index].time = time;
+    move_data(data[index].data, data_);
+  }
+
+  /* Remove the data for the time points outside of the range. The time point right before the
+   * start of the range is kept as it is the nearest one for times at the start of the range. If
+   * no time point overlaps with the range, as for constant data, everything is kept. */
+  void remove_data_outside(const TimeRange &range)
+  {
+    size_t first = 0;
+    while (first + 1 < data.size() && data[first + 1].time <= range.start) {
+      ++first;
+    }
+
+    size_t last = first;
+    while (last < data.size() && data[last].time < range.end) {
+      ++last;
+    }
+
+    if (last == first || (first == 0 && last == data.size())) {
       return;
     }
 
-    data.push_back({time, data_});
+    vector<DataTimePair> kept_data(last - first);
+
+    for (size_t i = first; i < last; ++i) {
+      kept_data[i - first].time = data[i].time;
+      move_data(kept_data[i - first].data, data[i].data);
+    }
+
+    data.swap(kept_data);
+  }
+
+  size_t memory_used() const
+  {
+    if constexpr (is_array<T>::value) {
+      size_t mem = 0;
+
+      for (const DataTimePair &data_pair : data) {
+        mem += data_pair.data.size() * sizeof(*data_pair.data.data());
+      }
+
+      return mem;
+    }
+
+    return data.size() * sizeof(T);
   }
 
   bool is_constant() const
@@ -189,7 +301,7 @@ struct CachedData {
   DataStore<array<int>> curve_shader;
 
   struct CachedAttribute {
-    AttributeStandard std;
+    AttributeStandard std = ATTR_STD_NONE;
     AttributeElement element;
     TypeDesc type_desc;
     ustring name;
@@ -208,6 +320,11 @@ struct CachedData {
   void invalidate_last_loaded_time(bool attributes_only = false);
 
   void set_time_sampling(Alembic::AbcCoreAbstract::TimeSampling time_sampling);
+
+  /* Remove the data outside of the range, except for the transforms which are small. */
+  void remove_data_outside(const TimeRange &range);
+
+  size_t memory_used() const;
 };
 
 /* Representation of an Alembic object for the AlembicProcedural.
@@ -247,24 +364,37 @@ class AlembicObject : public Node {
   void set_object(Object *object);
   Object *get_object();
 
-  void load_all_data(AlembicProcedural *proc,
-                     Alembic::AbcGeom::IPolyMeshSchema &schema,
-                     float scale,
-                     Progress &progress);
-  void load_all_data(AlembicProcedural *proc,
-                     Alembic::AbcGeom::ISubDSchema &schema,
-                     float scale,
-                     Progress &progress);
-  void load_all_data(AlembicProcedural *proc,
-                     const Alembic::AbcGeom::ICurvesSchema &schema,
-                     float scale,
-                     Progress &progress,
-                     float default_radius);
+  /* Load the data for the time points in the range that are not loaded yet. This does not access
+   * the sockets, so it can run in a background thread while they are synchronized. */
+  void load_data(const TimeRange &range, float scale, float default_radius, Progress &progress);
+  void load_data(const TimeRange &range,
+                 Alembic::AbcGeom::IPolyMeshSchema &schema,
+                 float scale,
+                 Progress &progress);
+  void load_data(const TimeRange &range,
+                 Alembic::AbcGeom::ISubDSchema &schema,
+                 float scale,
+                 Progress &progress);
+  void load_data(const TimeRange &range,
+                 const Alembic::AbcGeom::ICurvesSchema &schema,
+                 float scale,
+                 Progress &progress,
+                 float default_radius);
+
+  /* Remove all the data, to reload it from scratch. */
+  void clear_cache();
 
   bool has_data_loaded() const;
 
+  /* Copy the sockets used when loading the data. */
+  void copy_sockets_for_loading();
+
   bool need_shader_update = true;
 
+  /* Copies of the names of the used shaders and of the radius scale, used when loading data. */
+  vector<ustring> shader_names;
+  float loaded_radius_scale = 1.0f;
+
   MatrixSampleMap xform_samples;
   Alembic::AbcGeom::IObject iobject;
   Transform xform;
@@ -276,20 +406,26 @@ class AlembicObject : public Node {
 
   bool is_constant() const
   {
-    return cached_data.is_constant();
+    return !has_animated_data && cached_data.is_constant();
   }
 
   Object *object = nullptr;
 
   bool data_loaded = false;
 
+  /* Whether any of the Alembic properties has multiple samples. When streaming only a few of them
+   * are cached at once, so the cached data alone can't tell. */
+  bool has_animated_data = false;
+
   CachedData cached_data;
 
   void update_shader_attributes(const Alembic::AbcGeom::ICompoundProperty &arb_geom_params,
+                                const TimeRange &range,
                                 Progress &progress);
 
   void read_attribute(const Alembic::AbcGeom::ICompoundProperty &arb_geom_params,
                       const ustring &attr_name,
+                      const TimeRange &range,
                       Progress &progress);
 
   template<typename SchemaType>
@@ -307,9 +443,15 @@ class AlembicObject : public Node {
  * Every object desired to be rendered should be passed as an AlembicObject through the objects
  * socket.
  *
- * This procedural will load the data set for the entire animation in memory on the first frame,
- * and directly set the data for the new frames on the created Nodes if needed. This allows for
- * faster updates between frames as it avoids reseeking the data on disk.
+ * By default, this procedural will load the data set for the entire animation in memory on the
+ * first frame, and directly set the data for the new frames on the created Nodes if needed. This
+ * allows for faster updates between frames as it avoids reseeking the data on disk.
+ *
+ * For animations too large to fit in memory, streaming only keeps the data around the current
+ * frame. The next frames are read in a background thread while the current one is rendered, until
+ * the prefetch window or the memory limit is reached, and previous frames are evicted.
+ *
+ * In both cases the objects are read in parallel.
  */
 class AlembicProcedural : public Procedural {
   Alembic::AbcGeom::IArchive archive;
@@ -348,6 +490,16 @@ class AlembicProcedural : public Procedural {
    * software. */
   NODE_SOCKET_API(float, scale)
 
+  /* Only keep the data for the frames around the current one in memory. */
+  NODE_SOCKET_API(bool, use_streaming)
+
+  /* Number of frames after the current one to read in the background when streaming. */
+  NODE_SOCKET_API(int, prefetch_frames)
+
+  /* Maximum size in megabytes of the cached data when streaming. The current frame is always
+   * loaded, prefetching stops when the limit is reached. */
+  NODE_SOCKET_API(int, cache_memory_limit)
+
   AlembicProcedural();
   ~AlembicProcedural();
 
@@ -368,6 +520,28 @@ class AlembicProcedural : public Procedural {
   /* Load the data for all the objects whose data has not yet been loaded. */
   void load_objects(Progress &progress);
 
+  /* Range of time to load data for: the entire animation, or the frame at the given time when
+   * streaming. */
+  TimeRange get_load_range(double frame_time, int frame_index = 0) const;
+
+  /* Read the data of the objects for the next frames, in a background thread. */
+  void start_prefetch(double frame_time);
+
+  /* Wait until the frame is read if it is one being prefetched, then stop the prefetching. */
+  void wait_for_prefetch(double frame_time);
+
+  size_t memory_used() const;
+
+  unique_ptr<thread> prefetch_thread;
+  Progress prefetch_progress;
+  TimeRange prefetch_range;
+
+  /* End of the frames read so far by the prefetch thread, and whether it is done reading. */
+  thread_mutex prefetch_mutex;
+  thread_condition_variable prefetch_cond;
+  double prefetch_loaded_end;
+  bool prefetch_finished;
+
   /* Traverse the Alembic hierarchy to lookup the IObjects for the AlembicObjects that were
    * specified in our objects socket, and accumulate all of the transformations samples along the
    * way for each IObject. */
@@ -41,6 +41,7 @@
 #include "util/util_logging.h"
 #include "util/util_progress.h"
 #include "util/util_task.h"
+#include "util/util_tbb.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -62,6 +63,7 @@ Geometry::Geometry(const NodeType *node_type, const Type type)
 {
   need_update_rebuild = false;
   need_update_bvh_for_offset = false;
+  need_update_device_offsets = false;
 
   transform_applied = false;
   transform_negative_scaled = false;
@@ -973,6 +975,10 @@ void GeometryManager::mesh_calc_offset(Scene *scene, BVHLayout bvh_layout)
     if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
       Mesh *mesh = static_cast<Mesh *>(geom);
 
+      if (mesh->vert_offset != vert_size || mesh->prim_offset != tri_size) {
+        mesh->need_update_device_offsets = true;
+      }
+
       mesh->vert_offset = vert_size;
       mesh->prim_offset = tri_size;
 
@@ -1003,6 +1009,10 @@ void GeometryManager::mesh_calc_offset(Scene *scene, BVHLayout bvh_layout)
     else if (geom->is_hair()) {
       Hair *hair = static_cast<Hair *>(geom);
 
+      if (hair->curvekey_offset != curve_key_size || hair->prim_offset != curve_size) {
+        hair->need_update_device_offsets = true;
+      }
+
       hair->curvekey_offset = curve_key_size;
       hair->prim_offset = curve_size;
 
@@ -1083,43 +1093,73 @@ void GeometryManager::device_update_mesh(
     /* normals */
     progress.set_status("Updating Mesh", "Computing normals");
 
+    /* Arrays that keep their size still hold the packed data of the previous update, so only
+     * geometry that changed or moved in the arrays has to be packed again. */
+    const bool copy_all_data = dscene->tri_shader.need_realloc() ||
+                               dscene->tri_vindex.need_realloc() ||
+                               dscene->tri_vnormal.need_realloc() ||
+                               dscene->tri_patch.need_realloc() ||
+                               dscene->tri_patch_uv.need_realloc() ||
+                               dscene->tri_shader.size() != tri_size ||
+                               dscene->tri_vnormal.size() != vert_size;
+
+    /* Triangle vertex indices refer to the primitive arrays, which are laid out again
+     * whenever the BVH is rebuilt. */
+    const bool copy_all_verts = copy_all_data || dscene->prim_tri_index.need_realloc();
+
     uint *tri_shader = dscene->tri_shader.alloc(tri_size);
     float4 *vnormal = dscene->tri_vnormal.alloc(vert_size);
     uint4 *tri_vindex = dscene->tri_vindex.alloc(tri_size);
     uint *tri_patch = dscene->tri_patch.alloc(tri_size);
     float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
 
-    const bool copy_all_data = dscene->tri_shader.need_realloc() ||
-                               dscene->tri_vindex.need_realloc() ||
-                               dscene->tri_vnormal.need_realloc() ||
-                               dscene->tri_patch.need_realloc() ||
-                               dscene->tri_patch_uv.need_realloc();
+    /* Meshes write to disjoint ranges of the arrays, so they can be packed in parallel. */
+    static const int GEOMETRY_PER_TASK = 8;
+    parallel_for(
+        blocked_range<size_t>(0, scene->geometry.size(), GEOMETRY_PER_TASK),
+        [&](const blocked_range<size_t> &r) {
+          for (size_t i = r.begin(); i != r.end(); i++) {
+            Geometry *geom = scene->geometry[i];
+            if (geom->geometry_type != Geometry::MESH &&
+                geom->geometry_type != Geometry::VOLUME) {
+              continue;
+            }
 
-    foreach (Geometry *geom, scene->geometry) {
-      if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
+            Mesh *mesh = static_cast<Mesh *>(geom);
+            const bool moved = copy_all_data || mesh->need_update_device_offsets;
 
-        if (mesh->shader_is_modified() || mesh->smooth_is_modified() ||
-            mesh->triangles_is_modified() || copy_all_data) {
-          mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
-        }
+            if (mesh->shader_is_modified() || mesh->smooth_is_modified() ||
+                mesh->triangles_is_modified() || moved) {
+              mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
+            }
 
-        if (mesh->verts_is_modified() || copy_all_data) {
-          mesh->pack_normals(&vnormal[mesh->vert_offset]);
-        }
+            if (mesh->verts_is_modified() || moved) {
+              mesh->pack_normals(&vnormal[mesh->vert_offset]);
+            }
 
-        if (mesh->triangles_is_modified() || mesh->vert_patch_uv_is_modified() || copy_all_data) {
-          mesh->pack_verts(tri_prim_index,
-                           &tri_vindex[mesh->prim_offset],
-                           &tri_patch[mesh->prim_offset],
-                           &tri_patch_uv[mesh->vert_offset],
-                           mesh->vert_offset,
-                           mesh->prim_offset);
-        }
+            if (mesh->triangles_is_modified() || mesh->vert_patch_uv_is_modified() || moved ||
+                copy_all_verts) {
+              mesh->pack_verts(tri_prim_index,
+                               &tri_vindex[mesh->prim_offset],
+                               &tri_patch[mesh->prim_offset],
+                               &tri_patch_uv[mesh->vert_offset],
+                               mesh->vert_offset,
+                               mesh->prim_offset);
+            }
+          }
 
-        if (progress.get_cancel())
-          return;
-      }
+          if (progress.get_cancel()) {
+            parallel_for_cancel();
+          }
+        });
+
+    if (progress.get_cancel())
+      return;
+
+    if (copy_all_verts) {
+      dscene->tri_vindex.tag_modified();
+      dscene->tri_patch.tag_modified();
+      dscene->tri_patch_uv.tag_modified();
     }
 
     /* vertex coordinates */
@@ -1135,32 +1175,48 @@ void GeometryManager::device_update_mesh(
   if (curve_size != 0) {
     progress.set_status("Updating Mesh", "Copying Strands to device");
 
+    const bool copy_all_data = dscene->curve_keys.need_realloc() ||
+                               dscene->curves.need_realloc() ||
+                               dscene->curve_keys.size() != curve_key_size ||
+                               dscene->curves.size() != curve_size;
+
     float4 *curve_keys = dscene->curve_keys.alloc(curve_key_size);
     float4 *curves = dscene->curves.alloc(curve_size);
 
-    const bool copy_all_data = dscene->curve_keys.need_realloc() || dscene->curves.need_realloc();
-
-    foreach (Geometry *geom, scene->geometry) {
-      if (geom->is_hair()) {
-        Hair *hair = static_cast<Hair *>(geom);
-
-        bool curve_keys_co_modified = hair->curve_radius_is_modified() ||
-                                      hair->curve_keys_is_modified();
-        bool curve_data_modified = hair->curve_shader_is_modified() ||
-                                   hair->curve_first_key_is_modified();
-
-        if (!curve_keys_co_modified && !curve_data_modified && !copy_all_data) {
-          continue;
-        }
-
-        hair->pack_curves(scene,
-                          &curve_keys[hair->curvekey_offset],
-                          &curves[hair->prim_offset],
-                          hair->curvekey_offset);
-        if (progress.get_cancel())
-          return;
-      }
-    }
+    static const int GEOMETRY_PER_TASK = 8;
+    parallel_for(blocked_range<size_t>(0, scene->geometry.size(), GEOMETRY_PER_TASK),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     Geometry *geom = scene->geometry[i];
+                     if (!geom->is_hair()) {
+                       continue;
+                     }
+
+                     Hair *hair = static_cast<Hair *>(geom);
+
+                     bool curve_keys_co_modified = hair->curve_radius_is_modified() ||
+                                                   hair->curve_keys_is_modified();
+                     bool curve_data_modified = hair->curve_shader_is_modified() ||
+                                                hair->curve_first_key_is_modified();
+
+                     if (!curve_keys_co_modified && !curve_data_modified && !copy_all_data &&
+                         !hair->need_update_device_offsets) {
+                       continue;
+                     }
+
+                     hair->pack_curves(scene,
+                                       &curve_keys[hair->curvekey_offset],
+                                       &curves[hair->prim_offset],
+                                       hair->curvekey_offset);
+                   }
+
+                   if (progress.get_cancel()) {
+                     parallel_for_cancel();
+                   }
+                 });
+
+    if (progress.get_cancel())
+      return;
 
     dscene->curve_keys.copy_to_device_if_modified();
     dscene->curves.copy_to_device_if_modified();
@@ -1580,11 +1636,13 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
     dscene->prim_time.tag_realloc();
 
     if (device_update_flags & DEVICE_MESH_DATA_NEEDS_REALLOC) {
-      dscene->tri_vnormal.tag_realloc();
-      dscene->tri_vindex.tag_realloc();
-      dscene->tri_patch.tag_realloc();
-      dscene->tri_vnormal.tag_realloc();
-      dscene->tri_patch_uv.tag_realloc();
+      /* Triangle arrays are packed in place when their size stays the same, only geometry that
+       * changed or moved to a different offset is packed again, see device_update_mesh(). */
+      dscene->tri_shader.tag_modified();
+      dscene->tri_vnormal.tag_modified();
+      dscene->tri_vindex.tag_modified();
+      dscene->tri_patch.tag_modified();
+      dscene->tri_patch_uv.tag_modified();
       dscene->patches.tag_realloc();
     }
 
@@ -1801,8 +1859,11 @@ void GeometryManager::device_update(Device *device,
         progress.set_status("Updating Mesh", msg);
 
         mesh->subd_params->camera = dicing_camera;
-        DiagSplit dsplit(*mesh->subd_params);
-        mesh->tessellate(&dsplit);
+        {
+          scoped_timer timer(&mesh->tessellation_time);
+          DiagSplit dsplit(*mesh->subd_params);
+          mesh->tessellate(&dsplit);
+        }
 
         i++;
 
@@ -1917,7 +1978,8 @@ void GeometryManager::device_update(Device *device,
 
   /* update the bvh even when there is no geometry so the kernel bvh data is still valid,
    * especially when removing all of the objects during interactive renders */
-  bool need_update_scene_bvh = (scene->bvh == nullptr);
+  bool need_update_scene_bvh = (scene->bvh == nullptr) ||
+                               (update_flags & TRANSFORM_MODIFIED) != 0;
   {
     scoped_callback_timer timer([scene](double time) {
       if (scene->update_stats) {
@@ -2009,6 +2071,7 @@ void GeometryManager::device_update(Device *device,
   foreach (Geometry *geom, scene->geometry) {
     geom->clear_modified();
     geom->attributes.clear_modified();
+    geom->need_update_device_offsets = false;
 
     if (geom->is_mesh()) {
       Mesh *mesh = static_cast<Mesh *>(geom);
@@ -2105,6 +2168,14 @@ void GeometryManager::collect_statistics(const Scene *scene, RenderStats *stats)
   foreach (Geometry *geometry, scene->geometry) {
     stats->mesh.geometry.add_entry(
         NamedSizeEntry(string(geometry->name.c_str()), geometry->get_total_size_in_bytes()));
+
+    if (geometry->is_mesh()) {
+      const Mesh *mesh = static_cast<const Mesh *>(geometry);
+      if (mesh->subd_params) {
+        stats->mesh.tessellation.add_entry(
+            NamedTimeEntry(string(mesh->name.c_str()), mesh->tessellation_time));
+      }
+    }
   }
 }
 
@@ -91,6 +91,9 @@ class Geometry : public Node {
   /* Update Flags */
   bool need_update_rebuild;
   bool need_update_bvh_for_offset;
+  /* Offsets into the packed device arrays changed, so the geometry must be packed again even
+   * if its own data is unmodified. */
+  bool need_update_device_offsets;
 
   /* Index into scene->geometry (only valid during update) */
   size_t index;
@@ -185,6 +188,7 @@ class GeometryManager {
 
     SHADER_ATTRIBUTE_MODIFIED = (1 << 8),
     SHADER_DISPLACEMENT_MODIFIED = (1 << 9),
+    TRANSFORM_MODIFIED = (1 << 10),
 
     GEOMETRY_ADDED = MESH_ADDED | HAIR_ADDED,
     GEOMETRY_REMOVED = MESH_REMOVED | HAIR_REMOVED,
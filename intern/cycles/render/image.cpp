@@ -30,6 +30,7 @@
 #include "util/util_progress.h"
 #include "util/util_task.h"
 #include "util/util_texture.h"
+#include "util/util_texture_cache.h"
 #include "util/util_unique_ptr.h"
 
 #ifdef WITH_OSL
@@ -300,6 +301,7 @@ ImageManager::ImageManager(const DeviceInfo &info)
 {
   need_update_ = true;
   osl_texture_system = NULL;
+  texture_cache = NULL;
   animation_frame = 0;
 
   /* Set image limits */
@@ -310,6 +312,8 @@ ImageManager::~ImageManager()
 {
   for (size_t slot = 0; slot < images.size(); slot++)
     assert(!images[slot]);
+
+  delete texture_cache;
 }
 
 void ImageManager::set_osl_texture_system(void *texture_system)
@@ -448,6 +452,7 @@ int ImageManager::add_image_slot(ImageLoader *loader,
   img->builtin = builtin;
   img->users = 1;
   img->mem = NULL;
+  img->cache_image = NULL;
 
   images[slot] = img;
 
@@ -481,7 +486,7 @@ void ImageManager::remove_image_user(int slot)
     need_update_ = true;
 }
 
-static bool image_associate_alpha(ImageManager::Image *img)
+static bool image_associate_alpha(const ImageManager::Image *img)
 {
   /* For typical RGBA images we let OIIO convert to associated alpha,
    * but some types we want to leave the RGB channels untouched. */
@@ -490,6 +495,25 @@ static bool image_associate_alpha(ImageManager::Image *img)
            img->params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED);
 }
 
+bool ImageManager::use_texture_cache(const Image *img) const
+{
+  /* Only 2D image files that don't need any processing of the pixels when loading, so
+   * sampling the file directly gives the same result. Alpha is associated by OpenImageIO
+   * for all images with an alpha channel. */
+  if (texture_cache == NULL || img->builtin || img->loader->osl_filepath().empty()) {
+    return false;
+  }
+  if (img->metadata.depth > 1) {
+    return false;
+  }
+  if (img->metadata.colorspace != u_colorspace_raw &&
+      img->metadata.colorspace != u_colorspace_srgb) {
+    return false;
+  }
+  const bool has_alpha = (img->metadata.channels == 2 || img->metadata.channels >= 4);
+  return !has_alpha || image_associate_alpha(img);
+}
+
 template<TypeDesc::BASETYPE FileFormat, typename StorageType>
 bool ImageManager::file_load_image(Image *img, int texture_limit)
 {
@@ -670,14 +694,33 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     delete img->mem;
     img->mem = NULL;
   }
+  if (img->cache_image) {
+    texture_cache->remove_image(img->cache_image);
+    img->cache_image = NULL;
+  }
 
   img->mem = new device_texture(
       device, img->mem_name.c_str(), slot, type, img->params.interpolation, img->params.extension);
   img->mem->info.use_transform_3d = img->metadata.use_transform_3d;
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
+  /* Sample image files on demand, instead of loading all pixels. */
+  if (use_texture_cache(img)) {
+    img->cache_image = texture_cache->add_image(img->loader->osl_filepath().string(),
+                                                img->params.interpolation,
+                                                img->params.extension,
+                                                texture_limit);
+  }
+
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (img->cache_image) {
+    /* Allocate a single pixel so the slot is valid, the kernel only uses the cache handle. */
+    thread_scoped_lock device_lock(device_mutex);
+    void *pixels = img->mem->alloc(1, 1);
+    memset(pixels, 0, img->mem->memory_size());
+    img->mem->info.cache = (uint64_t)img->cache_image;
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -803,6 +846,10 @@ void ImageManager::device_free_image(Device *, int slot)
     delete img->mem;
   }
 
+  if (img->cache_image) {
+    texture_cache->remove_image(img->cache_image);
+  }
+
   delete img->loader;
   delete img;
   images[slot] = NULL;
@@ -820,6 +867,14 @@ void ImageManager::device_update(Device *device, Scene *scene, Progress &progres
     }
   });
 
+  /* Only the CPU device can sample images through the texture cache while rendering. */
+  if (scene->params.use_texture_cache && device->info.type == DEVICE_CPU) {
+    if (texture_cache == NULL) {
+      texture_cache = new TextureCache();
+    }
+    texture_cache->set_memory_limit(scene->params.texture_cache_size);
+  }
+
   TaskPool pool;
   for (size_t slot = 0; slot < images.size(); slot++) {
     Image *img = images[slot];
@@ -886,6 +941,9 @@ void ImageManager::device_free(Device *device)
     device_free_image(device, slot);
   }
   images.clear();
+
+  delete texture_cache;
+  texture_cache = NULL;
 }
 
 void ImageManager::collect_statistics(RenderStats *stats)
@@ -894,6 +952,11 @@ void ImageManager::collect_statistics(RenderStats *stats)
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
   }
+
+  if (texture_cache) {
+    stats->image.use_texture_cache = true;
+    stats->image.texture_cache = texture_cache->get_stats();
+  }
 }
 
 void ImageManager::tag_update()
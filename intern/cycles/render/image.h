@@ -37,6 +37,8 @@ class ImageMetaData;
 class ImageManager;
 class Progress;
 class RenderStats;
+class TextureCache;
+struct TextureCacheImage;
 class Scene;
 class ColorSpaceProcessor;
 class VDBImageLoader;
@@ -205,6 +207,7 @@ class ImageManager {
 
     string mem_name;
     device_texture *mem;
+    TextureCacheImage *cache_image;
 
     int users;
     thread_mutex mutex;
@@ -220,12 +223,14 @@ class ImageManager {
 
   vector<Image *> images;
   void *osl_texture_system;
+  TextureCache *texture_cache;
 
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
   void remove_image_user(int slot);
 
   void load_image_metadata(Image *img);
+  bool use_texture_cache(const Image *img) const;
 
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/integrator.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -282,13 +283,96 @@ bool LightManager::object_usable_as_light(Object *object)
   return false;
 }
 
-void LightManager::device_update_distribution(Device *,
+bool LightManager::use_light_tree(Device *device, Scene *scene)
+{
+  Integrator *integrator = scene->integrator;
+  if (!integrator->get_use_light_tree()) {
+    return false;
+  }
+
+  /* Sampling all lights with branched path tracing loops over the lamps and uses the
+   * distribution to pick triangles only, which the light tree can't do. */
+  const bool branched = (integrator->get_method() == Integrator::BRANCHED_PATH) &&
+                        device->info.has_branched_path;
+  if (branched && (integrator->get_sample_all_lights_direct() ||
+                   integrator->get_sample_all_lights_indirect())) {
+    VLOG(1) << "Light tree is not used when sampling all lights.";
+    return false;
+  }
+
+  return true;
+}
+
+static LightTreePrimitive light_tree_lamp_primitive(const Light *light,
+                                                    const int distribution_index)
+{
+  LightTreePrimitive prim;
+  prim.distribution_index = distribution_index;
+  /* Emitted power, comparable with the energy of emissive triangles. Point and spot lights emit
+   * their strength, area lights have a radiance of a quarter of their strength per area. */
+  prim.energy = average(fabs(light->get_strength()));
+  if (light->get_light_type() == LIGHT_AREA) {
+    prim.energy *= 0.25f * M_PI_F;
+  }
+
+  const float3 co = light->get_co();
+  const float3 dir = safe_normalize(light->get_dir());
+
+  if (light->get_light_type() == LIGHT_AREA) {
+    const float size = light->get_size();
+    const float3 axisu = light->get_axisu() * (light->get_sizeu() * size * 0.5f);
+    const float3 axisv = light->get_axisv() * (light->get_sizev() * size * 0.5f);
+    prim.bounds = BoundBox::empty;
+    prim.bounds.grow(co - axisu - axisv);
+    prim.bounds.grow(co - axisu + axisv);
+    prim.bounds.grow(co + axisu - axisv);
+    prim.bounds.grow(co + axisu + axisv);
+    /* One sided. */
+    prim.cone = LightTreeCone(dir, 0.0f, M_PI_2_F);
+  }
+  else {
+    const float radius = light->get_size();
+    prim.bounds = BoundBox(co - make_float3(radius, radius, radius),
+                           co + make_float3(radius, radius, radius));
+    if (light->get_light_type() == LIGHT_SPOT) {
+      prim.cone = LightTreeCone(dir, 0.0f, min(light->get_spot_angle() * 0.5f, M_PI_2_F));
+    }
+    else {
+      prim.cone = LightTreeCone::sphere();
+    }
+  }
+
+  return prim;
+}
+
+/* Irradiance of a distant or background light, to compare it with the emitters of the light
+ * tree. Textured backgrounds are assumed to have unit radiance. */
+static float light_tree_distant_irradiance(Scene *scene, const Light *light)
+{
+  float irradiance = average(fabs(light->get_strength()));
+
+  if (light->get_light_type() == LIGHT_BACKGROUND) {
+    float3 emission = one_float3();
+    Shader *shader = scene->background->get_shader(scene);
+    if (shader == NULL || !shader->is_constant_emission(&emission)) {
+      emission = one_float3();
+    }
+    /* Irradiance from uniform radiance over the hemisphere. */
+    irradiance *= M_PI_F * average(fabs(emission));
+  }
+
+  return irradiance;
+}
+
+void LightManager::device_update_distribution(Device *device,
                                               DeviceScene *dscene,
                                               Scene *scene,
                                               Progress &progress)
 {
   progress.set_status("Updating Lights", "Computing distribution");
 
+  const bool use_tree = use_light_tree(device, scene);
+
   /* count */
   size_t num_lights = 0;
   size_t num_portals = 0;
@@ -336,6 +420,17 @@ void LightManager::device_update_distribution(Device *,
   KernelLightDistribution *distribution = dscene->light_distribution.alloc(num_distribution + 1);
   float totarea = 0.0f;
 
+  /* Emitters of the light tree, and the range of emissive triangles of each object in the
+   * distribution to find them from the kernel. */
+  vector<LightTreePrimitive> tree_primitives;
+  vector<int> tree_distant_lights;
+  float tree_distant_irradiance = 0.0f;
+  uint *object_offset = NULL;
+  if (use_tree) {
+    tree_primitives.reserve(num_distribution);
+    object_offset = dscene->light_tree_object_offset.alloc(scene->objects.size() + 1);
+  }
+
   /* triangles */
   size_t offset = 0;
   int j = 0;
@@ -344,6 +439,10 @@ void LightManager::device_update_distribution(Device *,
     if (progress.get_cancel())
       return;
 
+    if (use_tree) {
+      object_offset[j] = offset;
+    }
+
     if (!object_usable_as_light(object)) {
       j++;
       continue;
@@ -372,6 +471,18 @@ void LightManager::device_update_distribution(Device *,
       use_light_visibility = true;
     }
 
+    /* Estimate of the emitted radiance of each shader, for the light tree. Textured emission
+     * is assumed to have unit strength. */
+    vector<float> shader_emission;
+    if (use_tree) {
+      foreach (Node *node, mesh->get_used_shaders()) {
+        Shader *shader = static_cast<Shader *>(node);
+        float3 emission;
+        shader_emission.push_back(
+            (shader->is_constant_emission(&emission)) ? average(fabs(emission)) : 1.0f);
+      }
+    }
+
     size_t mesh_num_triangles = mesh->num_triangles();
     for (size_t i = 0; i < mesh_num_triangles; i++) {
       int shader_index = mesh->get_shader()[i];
@@ -386,8 +497,18 @@ void LightManager::device_update_distribution(Device *,
         distribution[offset].mesh_light.object_id = object_id;
         offset++;
 
+        LightTreePrimitive tree_prim;
+        tree_prim.distribution_index = offset - 1;
+        tree_prim.energy = 0.0f;
+        /* Emitting from both sides. */
+        tree_prim.cone = LightTreeCone::sphere();
+
         Mesh::Triangle t = mesh->get_triangle(i);
         if (!t.valid(&mesh->get_verts()[0])) {
+          if (use_tree) {
+            tree_prim.bounds = BoundBox(object->bounds.center());
+            tree_primitives.push_back(tree_prim);
+          }
           continue;
         }
         float3 p1 = mesh->get_verts()[t.v[0]];
@@ -400,13 +521,30 @@ void LightManager::device_update_distribution(Device *,
           p3 = transform_point(&tfm, p3);
         }
 
-        totarea += triangle_area(p1, p2, p3);
+        const float area = triangle_area(p1, p2, p3);
+        totarea += area;
+
+        if (use_tree) {
+          tree_prim.bounds = BoundBox(p1);
+          tree_prim.bounds.grow(p2);
+          tree_prim.bounds.grow(p3);
+          /* Power emitted from both sides of the triangle. */
+          tree_prim.energy = M_2PI_F * area *
+                             ((shader_index < shader_emission.size()) ?
+                                  shader_emission[shader_index] :
+                                  1.0f);
+          tree_primitives.push_back(tree_prim);
+        }
       }
     }
 
     j++;
   }
 
+  if (use_tree) {
+    object_offset[scene->objects.size()] = offset;
+  }
+
   float trianglearea = totarea;
 
   /* point lights */
@@ -424,6 +562,16 @@ void LightManager::device_update_distribution(Device *,
     distribution[offset].lamp.size = light->size;
     totarea += lightarea;
 
+    if (use_tree) {
+      if (light->light_type == LIGHT_DISTANT || light->light_type == LIGHT_BACKGROUND) {
+        tree_distant_lights.push_back(offset);
+        tree_distant_irradiance += light_tree_distant_irradiance(scene, light);
+      }
+      else {
+        tree_primitives.push_back(light_tree_lamp_primitive(light, offset));
+      }
+    }
+
     if (light->light_type == LIGHT_DISTANT) {
       use_lamp_mis |= (light->angle > 0.0f && light->use_mis);
     }
@@ -501,6 +649,17 @@ void LightManager::device_update_distribution(Device *,
     /* CDF */
     dscene->light_distribution.copy_to_device();
 
+    /* Light tree */
+    kintegrator->use_light_tree = use_tree;
+    if (use_tree) {
+      device_update_light_tree(dscene,
+                               tree_primitives,
+                               tree_distant_lights,
+                               tree_distant_irradiance,
+                               num_distribution);
+      dscene->light_tree_object_offset.copy_to_device();
+    }
+
     /* Portals */
     if (num_portals > 0) {
       kbackground->portal_offset = light_index;
@@ -524,6 +683,7 @@ void LightManager::device_update_distribution(Device *,
     kintegrator->pdf_triangles = 0.0f;
     kintegrator->pdf_lights = 0.0f;
     kintegrator->use_lamp_mis = false;
+    kintegrator->use_light_tree = false;
 
     kbackground->num_portals = 0;
     kbackground->portal_offset = 0;
@@ -535,6 +695,35 @@ void LightManager::device_update_distribution(Device *,
   }
 }
 
+void LightManager::device_update_light_tree(DeviceScene *dscene,
+                                            vector<LightTreePrimitive> &primitives,
+                                            const vector<int> &distant_lights,
+                                            const float distant_irradiance,
+                                            const size_t num_distribution)
+{
+  /* Reorders the primitives, so leaves reference a range of emitters. */
+  LightTree tree(primitives);
+
+  VLOG(1) << "Light tree with " << tree.nodes.size() << " nodes, " << primitives.size()
+          << " emitters and " << distant_lights.size() << " distant lights.";
+
+  KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(tree.nodes.size());
+  KernelLightTreeEmitter *kemitters = dscene->light_tree_emitters.alloc(primitives.size() +
+                                                                        distant_lights.size());
+  uint *light_to_tree = dscene->light_to_tree.alloc(num_distribution);
+  tree.pack(knodes, kemitters, light_to_tree, distant_lights);
+
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  kintegrator->num_light_tree_emitters = primitives.size();
+  kintegrator->num_light_tree_distant = distant_lights.size();
+  kintegrator->pdf_light_tree_distant = tree.distant_probability(distant_lights.size(),
+                                                                 distant_irradiance);
+
+  dscene->light_tree_nodes.copy_to_device();
+  dscene->light_tree_emitters.copy_to_device();
+  dscene->light_to_tree.copy_to_device();
+}
+
 static void background_cdf(
     int start, int end, int res_x, int res_y, const vector<float3> *pixels, float2 *cond_cdf)
 {
@@ -1013,6 +1202,10 @@ void LightManager::device_update(Device *device,
 void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_background)
 {
   dscene->light_distribution.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitters.free();
+  dscene->light_to_tree.free();
+  dscene->light_tree_object_offset.free();
   dscene->lights.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
@@ -38,6 +38,7 @@ class Object;
 class Progress;
 class Scene;
 class Shader;
+struct LightTreePrimitive;
 
 class Light : public Node {
  public:
@@ -100,6 +101,7 @@ class LightManager {
     OBJECT_MANAGER = (1 << 5),
     SHADER_COMPILED = (1 << 6),
     SHADER_MODIFIED = (1 << 7),
+    INTEGRATOR_MODIFIED = (1 << 8),
 
     /* tag everything in the manager for an update */
     UPDATE_ALL = ~0u,
@@ -142,12 +144,20 @@ class LightManager {
                                   DeviceScene *dscene,
                                   Scene *scene,
                                   Progress &progress);
+  void device_update_light_tree(DeviceScene *dscene,
+                                vector<LightTreePrimitive> &primitives,
+                                const vector<int> &distant_lights,
+                                const float distant_irradiance,
+                                const size_t num_distribution);
   void device_update_background(Device *device,
                                 DeviceScene *dscene,
                                 Scene *scene,
                                 Progress &progress);
   void device_update_ies(DeviceScene *dscene);
 
+  /* Whether lights are picked by traversing a light tree instead of the distribution. */
+  bool use_light_tree(Device *device, Scene *scene);
+
   /* Check whether light manager can use the object as a light-emissive. */
   bool object_usable_as_light(Object *object);
 
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+
+CCL_NAMESPACE_BEGIN
+
+LightTreeCone merge(const LightTreeCone &cone_a, const LightTreeCone &cone_b)
+{
+  /* Smallest cone containing both, see "Importance Sampling of Many Lights with Adaptive Tree
+   * Splitting" by Estevez and Kulla. */
+  const bool a_is_wider = (cone_a.theta_o >= cone_b.theta_o);
+  const LightTreeCone &a = (a_is_wider) ? cone_a : cone_b;
+  const LightTreeCone &b = (a_is_wider) ? cone_b : cone_a;
+
+  const float theta_e = max(a.theta_e, b.theta_e);
+  const float cos_theta_d = dot(a.axis, b.axis);
+  const float theta_d = safe_acosf(cos_theta_d);
+
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    return LightTreeCone(a.axis, a.theta_o, theta_e);
+  }
+
+  const float theta_o = 0.5f * (a.theta_o + theta_d + b.theta_o);
+  if (theta_o >= M_PI_F) {
+    return LightTreeCone(a.axis, M_PI_F, theta_e);
+  }
+
+  /* Rotate the axis of the wider cone towards the other one. */
+  float ortho_len;
+  const float3 ortho = safe_normalize_len(b.axis - a.axis * cos_theta_d, &ortho_len);
+  if (ortho_len == 0.0f) {
+    return LightTreeCone(a.axis, M_PI_F, theta_e);
+  }
+
+  const float theta_r = theta_o - a.theta_o;
+  const float3 axis = normalize(a.axis * cosf(theta_r) + ortho * sinf(theta_r));
+  return LightTreeCone(axis, theta_o, theta_e);
+}
+
+/* Measure of the solid angle of directions in which the cone emits. */
+static float cone_measure(const LightTreeCone &cone)
+{
+  const float theta_w = min(cone.theta_o + cone.theta_e, M_PI_F);
+  const float cos_theta_o = cosf(cone.theta_o);
+  const float sin_theta_o = sinf(cone.theta_o);
+  return M_2PI_F * (1.0f - cos_theta_o) +
+         M_PI_2_F * (2.0f * theta_w * sin_theta_o - cosf(cone.theta_o - 2.0f * theta_w) -
+                     2.0f * cone.theta_o * sin_theta_o + cos_theta_o);
+}
+
+LightTree::LightTree(vector<LightTreePrimitive> &primitives, const int max_primitives_in_leaf)
+    : primitives(primitives), max_primitives_in_leaf(max_primitives_in_leaf)
+{
+  if (primitives.empty()) {
+    return;
+  }
+
+  nodes.reserve(2 * primitives.size() - 1);
+  recursive_build(0, primitives.size(), -1);
+}
+
+void LightTree::pack(KernelLightTreeNode *knodes,
+                     KernelLightTreeEmitter *kemitters,
+                     uint *light_to_tree,
+                     const vector<int> &distant_lights) const
+{
+  for (size_t i = 0; i < nodes.size(); i++) {
+    const LightTreeNode &node = nodes[i];
+    KernelLightTreeNode &knode = knodes[i];
+    knode.bounds_min[0] = node.bounds.min.x;
+    knode.bounds_min[1] = node.bounds.min.y;
+    knode.bounds_min[2] = node.bounds.min.z;
+    knode.energy = node.energy;
+    knode.bounds_max[0] = node.bounds.max.x;
+    knode.bounds_max[1] = node.bounds.max.y;
+    knode.bounds_max[2] = node.bounds.max.z;
+    knode.theta_o = node.cone.theta_o;
+    knode.axis[0] = node.cone.axis.x;
+    knode.axis[1] = node.cone.axis.y;
+    knode.axis[2] = node.cone.axis.z;
+    knode.theta_e = node.cone.theta_e;
+    knode.child_index = node.child_index;
+    knode.num_emitters = node.num_primitives;
+    knode.parent_index = node.parent_index;
+    knode.pad = 0;
+
+    for (int j = 0; j < node.num_primitives; j++) {
+      kemitters[node.child_index + j].leaf_index = i;
+    }
+  }
+
+  for (size_t i = 0; i < primitives.size(); i++) {
+    kemitters[i].energy = primitives[i].energy;
+    kemitters[i].distribution_index = primitives[i].distribution_index;
+    kemitters[i].pad = 0;
+    light_to_tree[primitives[i].distribution_index] = i;
+  }
+
+  for (size_t i = 0; i < distant_lights.size(); i++) {
+    const size_t index = primitives.size() + i;
+    kemitters[index].energy = 0.0f;
+    kemitters[index].distribution_index = distant_lights[i];
+    kemitters[index].leaf_index = -1;
+    kemitters[index].pad = 0;
+    light_to_tree[distant_lights[i]] = index;
+  }
+}
+
+float LightTree::distant_probability(const int num_distant, const float distant_irradiance) const
+{
+  if (num_distant == 0) {
+    return 0.0f;
+  }
+  if (nodes.empty()) {
+    return 1.0f;
+  }
+
+  /* Split by the power arriving at the bounding sphere of the emitters, which is what the
+   * emitter energies are compared with. */
+  const LightTreeNode &root = nodes[0];
+  const float radius = 0.5f * len(root.bounds.size());
+  const float distant_energy = distant_irradiance * M_PI_F * radius * radius;
+  const float total_energy = distant_energy + root.energy;
+  if (!(total_energy > 0.0f)) {
+    return 0.5f;
+  }
+
+  /* Both groups keep a minimum probability. The estimate ignores distance and orientation at
+   * the shading point, and lights that are never picked would bias the result. */
+  return clamp(distant_energy / total_energy, 0.05f, 0.95f);
+}
+
+int LightTree::recursive_build(const int begin, const int end, const int parent_index)
+{
+  const int node_index = nodes.size();
+
+  LightTreeNode node;
+  node.bounds = BoundBox::empty;
+  node.cone = primitives[begin].cone;
+  node.energy = 0.0f;
+  node.child_index = begin;
+  node.num_primitives = end - begin;
+  node.parent_index = parent_index;
+
+  BoundBox centroid_bounds = BoundBox::empty;
+  for (int i = begin; i < end; i++) {
+    const LightTreePrimitive &prim = primitives[i];
+    node.bounds.grow(prim.bounds);
+    centroid_bounds.grow(prim.bounds.center());
+    if (i != begin) {
+      node.cone = merge(node.cone, prim.cone);
+    }
+    node.energy += prim.energy;
+  }
+
+  nodes.push_back(node);
+
+  const int num_primitives = end - begin;
+  if (num_primitives == 1) {
+    return node_index;
+  }
+
+  /* Find the bucket split with the lowest cost along each axis. */
+  const int num_buckets = 12;
+  const float3 extent = centroid_bounds.size();
+  const float max_extent = max3(extent);
+
+  int split_axis = -1;
+  int split_bucket = 0;
+  float split_cost = FLT_MAX;
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (extent[axis] <= 0.0f) {
+      continue;
+    }
+
+    struct Bucket {
+      int count = 0;
+      float energy = 0.0f;
+      BoundBox bounds = BoundBox::empty;
+      LightTreeCone cone;
+    } buckets[num_buckets];
+
+    const float inv_extent = 1.0f / extent[axis];
+    for (int i = begin; i < end; i++) {
+      const LightTreePrimitive &prim = primitives[i];
+      const float centroid = prim.bounds.center()[axis];
+      const int b = min((int)(num_buckets * (centroid - centroid_bounds.min[axis]) * inv_extent),
+                        num_buckets - 1);
+      Bucket &bucket = buckets[b];
+      bucket.cone = (bucket.count == 0) ? prim.cone : merge(bucket.cone, prim.cone);
+      bucket.bounds.grow(prim.bounds);
+      bucket.energy += prim.energy;
+      bucket.count++;
+    }
+
+    /* Favor splitting along the longest axis, to avoid thin nodes. */
+    const float regularization = max_extent * inv_extent;
+
+    for (int split = 1; split < num_buckets; split++) {
+      Bucket left, right;
+      for (int b = 0; b < num_buckets; b++) {
+        const Bucket &bucket = buckets[b];
+        if (bucket.count == 0) {
+          continue;
+        }
+        Bucket &side = (b < split) ? left : right;
+        side.cone = (side.count == 0) ? bucket.cone : merge(side.cone, bucket.cone);
+        side.bounds.grow(bucket.bounds);
+        side.energy += bucket.energy;
+        side.count += bucket.count;
+      }
+
+      if (left.count == 0 || right.count == 0) {
+        continue;
+      }
+
+      const float cost = regularization *
+                         (left.energy * left.bounds.area() * cone_measure(left.cone) +
+                          right.energy * right.bounds.area() * cone_measure(right.cone));
+      if (cost < split_cost) {
+        split_axis = axis;
+        split_bucket = split;
+        split_cost = cost;
+      }
+    }
+  }
+
+  if (num_primitives <= max_primitives_in_leaf) {
+    const float leaf_cost = node.energy * node.bounds.area() * cone_measure(node.cone);
+    if (split_axis == -1 || leaf_cost <= split_cost) {
+      return node_index;
+    }
+  }
+
+  int middle;
+  if (split_axis == -1) {
+    /* All centroids are in the same place, split in the middle. */
+    middle = (begin + end) / 2;
+  }
+  else {
+    const float centroid_min = centroid_bounds.min[split_axis];
+    const float inv_extent = 1.0f / extent[split_axis];
+    LightTreePrimitive *split_point = std::partition(
+        &primitives[begin], &primitives[end - 1] + 1, [&](const LightTreePrimitive &prim) {
+          const float centroid = prim.bounds.center()[split_axis];
+          const int b = min((int)(num_buckets * (centroid - centroid_min) * inv_extent),
+                            num_buckets - 1);
+          return b < split_bucket;
+        });
+    middle = split_point - &primitives[0];
+  }
+
+  recursive_build(begin, middle, node_index);
+  const int right_index = recursive_build(middle, end, node_index);
+
+  nodes[node_index].child_index = right_index;
+  nodes[node_index].num_primitives = 0;
+
+  return node_index;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_math.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Cone bounding the normals of emitters, with theta_o the spread of the normals around the axis
+ * and theta_e the angle beyond the normals in which light is emitted. */
+struct LightTreeCone {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+
+  LightTreeCone() : axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(0.0f), theta_e(0.0f)
+  {
+  }
+
+  LightTreeCone(const float3 &axis, const float theta_o, const float theta_e)
+      : axis(axis), theta_o(theta_o), theta_e(theta_e)
+  {
+  }
+
+  /* Cone emitting in all directions, for point lights and two sided emitters. */
+  static LightTreeCone sphere()
+  {
+    return LightTreeCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+  }
+};
+
+LightTreeCone merge(const LightTreeCone &a, const LightTreeCone &b);
+
+struct LightTreePrimitive {
+  BoundBox bounds;
+  LightTreeCone cone;
+  float energy;
+  /* Index in the light distribution. */
+  int distribution_index;
+};
+
+struct LightTreeNode {
+  BoundBox bounds;
+  LightTreeCone cone;
+  float energy;
+  /* Index of the second child for inner nodes, the first child directly follows the node. For
+   * leaves the index of the first primitive. */
+  int child_index;
+  int num_primitives;
+  int parent_index;
+};
+
+/* Light Tree
+ *
+ * Bounding volume hierarchy over emitters, split by a cost taking into account the energy, the
+ * surface area and the orientation bounds of the children. Primitives are reordered so that
+ * leaves reference a contiguous range. */
+class LightTree {
+ public:
+  LightTree(vector<LightTreePrimitive> &primitives, const int max_primitives_in_leaf = 8);
+
+  /* Fill the kernel arrays, the distant lights are stored after the emitters of the tree. The
+   * arrays must have room for all nodes, emitters and distant lights, and for every index of
+   * the light distribution that is used. */
+  void pack(KernelLightTreeNode *knodes,
+            KernelLightTreeEmitter *kemitters,
+            uint *light_to_tree,
+            const vector<int> &distant_lights) const;
+
+  /* Probability of picking one of the distant lights instead of an emitter of the tree, given
+   * the total irradiance of the distant lights. */
+  float distant_probability(const int num_distant, const float distant_irradiance) const;
+
+  vector<LightTreeNode> nodes;
+
+ protected:
+  int recursive_build(const int begin, const int end, const int parent_index);
+
+  vector<LightTreePrimitive> &primitives;
+  const int max_primitives_in_leaf;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
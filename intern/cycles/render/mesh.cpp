@@ -194,6 +194,8 @@ Mesh::Mesh(const NodeType *node_type, Type geom_type_)
   num_subd_verts = 0;
   num_subd_faces = 0;
 
+  tessellation_time = 0.0;
+
   num_ngons = 0;
 
   subdivision_type = SUBDIVISION_NONE;
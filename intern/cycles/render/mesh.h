@@ -180,6 +180,9 @@ class Mesh : public Geometry {
   size_t num_subd_verts;
   size_t num_subd_faces;
 
+  /* Time spent in the last tessellation, for render statistics. */
+  double tessellation_time;
+
   unordered_map<int, int> vert_to_stitching_key_map; /* real vert index -> stitching index */
   unordered_multimap<int, int>
       vert_stitching_map; /* stitching index -> multiple real vert indices */
@@ -154,12 +154,7 @@ bool TextureMapping::skip()
 
 void TextureMapping::compile(SVMCompiler &compiler, int offset_in, int offset_out)
 {
-  compiler.add_node(NODE_TEXTURE_MAPPING, offset_in, offset_out);
-
-  Transform tfm = compute_transform();
-  compiler.add_node(tfm.x);
-  compiler.add_node(tfm.y);
-  compiler.add_node(tfm.z);
+  compiler.add_texture_mapping(offset_in, offset_out, compute_transform());
 
   if (use_minmax) {
     compiler.add_node(NODE_MIN_MAX, offset_out, offset_out);
@@ -360,6 +355,79 @@ void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attribute
   ShaderNode::attributes(shader, attributes);
 }
 
+static Transform mapping_node_transform(NodeMappingType type,
+                                        float3 location,
+                                        float3 rotation,
+                                        float3 scale);
+
+/* Find the attribute the texture coordinates are read from, so the kernel can compute their
+ * derivatives for the texture cache. Mapping nodes with constant inputs are followed, and their
+ * transforms are accumulated in \a tfm. Returns false when the coordinates are not a linear
+ * function of an attribute. */
+static bool image_texture_coordinate_attribute(SVMCompiler &compiler,
+                                               ShaderInput *vector_in,
+                                               uint *r_attr,
+                                               Transform *tfm)
+{
+  ShaderOutput *link = vector_in->link;
+
+  while (link != NULL) {
+    ShaderNode *node = link->parent;
+
+    if (node->type == MappingNode::node_type) {
+      MappingNode *mapping = (MappingNode *)node;
+      if (mapping->input("Location")->link || mapping->input("Rotation")->link ||
+          mapping->input("Scale")->link ||
+          mapping->get_mapping_type() == NODE_MAPPING_TYPE_NORMAL) {
+        return false;
+      }
+      *tfm = *tfm * mapping_node_transform(mapping->get_mapping_type(),
+                                           mapping->get_location(),
+                                           mapping->get_rotation(),
+                                           mapping->get_scale());
+      link = mapping->input("Vector")->link;
+    }
+    else if (node->type == UVMapNode::node_type) {
+      UVMapNode *uvmap = (UVMapNode *)node;
+      if (uvmap->get_from_dupli()) {
+        return false;
+      }
+      *r_attr = (uvmap->get_attribute() != "") ? compiler.attribute(uvmap->get_attribute()) :
+                                                 compiler.attribute(ATTR_STD_UV);
+      return true;
+    }
+    else if (node->type == TextureCoordinateNode::node_type) {
+      TextureCoordinateNode *texco = (TextureCoordinateNode *)node;
+      if (texco->get_from_dupli()) {
+        return false;
+      }
+      if (link == texco->output("UV")) {
+        *r_attr = compiler.attribute(ATTR_STD_UV);
+        return true;
+      }
+      if (link == texco->output("Generated") && !compiler.background &&
+          compiler.output_type() != SHADER_TYPE_VOLUME) {
+        *r_attr = compiler.attribute(ATTR_STD_GENERATED);
+        return true;
+      }
+      return false;
+    }
+    else if (node->type == AttributeNode::node_type) {
+      AttributeNode *attr = (AttributeNode *)node;
+      if (link == attr->output("Vector") || link == attr->output("Color")) {
+        *r_attr = compiler.attribute_standard(attr->get_attribute());
+        return true;
+      }
+      return false;
+    }
+    else {
+      return false;
+    }
+  }
+
+  return false;
+}
+
 void ImageTextureNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *vector_in = input("Vector");
@@ -394,6 +462,26 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
   }
 
   if (projection != NODE_IMAGE_PROJ_BOX) {
+    /* Apply the texture mapping added right before in the image node. */
+    int co_offset = vector_offset;
+    Transform tfm;
+    const bool transform = compiler.fuse_texture_mapping(
+        vector_in, vector_offset, &co_offset, &tfm);
+    if (transform) {
+      flags |= NODE_IMAGE_TRANSFORM;
+    }
+
+    /* Only the CPU device samples images through the texture cache, see ImageManager. */
+    uint derivatives_attr = ATTR_STD_NOT_FOUND;
+    Transform derivatives_tfm = (tex_mapping.skip()) ? transform_identity() :
+                                                       tex_mapping.compute_transform();
+    if (projection == NODE_IMAGE_PROJ_FLAT && compiler.scene->params.use_texture_cache &&
+        compiler.scene->device->info.type == DEVICE_CPU &&
+        image_texture_coordinate_attribute(
+            compiler, vector_in, &derivatives_attr, &derivatives_tfm)) {
+      flags |= NODE_IMAGE_DERIVATIVES;
+    }
+
     /* If there only is one image (a very common case), we encode it as a negative value. */
     int num_nodes;
     if (handle.num_tiles() == 1) {
@@ -405,12 +493,24 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
 
     compiler.add_node(NODE_TEX_IMAGE,
                       num_nodes,
-                      compiler.encode_uchar4(vector_offset,
+                      compiler.encode_uchar4(co_offset,
                                              compiler.stack_assign_if_linked(color_out),
                                              compiler.stack_assign_if_linked(alpha_out),
                                              flags),
                       projection);
 
+    if (transform) {
+      compiler.add_node(tfm.x);
+      compiler.add_node(tfm.y);
+      compiler.add_node(tfm.z);
+    }
+
+    if (flags & NODE_IMAGE_DERIVATIVES) {
+      compiler.add_node(derivatives_attr, 0, 0, 0);
+      compiler.add_node(derivatives_tfm.x);
+      compiler.add_node(derivatives_tfm.y);
+    }
+
     if (num_nodes > 0) {
       for (int i = 0; i < num_nodes; i++) {
         int4 node;
@@ -1949,6 +2049,43 @@ void MappingNode::constant_fold(const ConstantFolder &folder)
   }
 }
 
+/* Same as svm_mapping() in the kernel, for constant location, rotation and scale. */
+static Transform mapping_node_transform(NodeMappingType type,
+                                        float3 location,
+                                        float3 rotation,
+                                        float3 scale)
+{
+  const Transform rotation_tfm = euler_to_transform(rotation);
+  const Transform inverse_scale_tfm = transform_scale(
+      safe_divide_float3_float3(one_float3(), scale));
+
+  switch (type) {
+    case NODE_MAPPING_TYPE_POINT:
+      return transform_translate(location) * rotation_tfm * transform_scale(scale);
+    case NODE_MAPPING_TYPE_TEXTURE: {
+      const Transform rotation_transposed_tfm = make_transform(rotation_tfm.x.x,
+                                                               rotation_tfm.y.x,
+                                                               rotation_tfm.z.x,
+                                                               0.0f,
+                                                               rotation_tfm.x.y,
+                                                               rotation_tfm.y.y,
+                                                               rotation_tfm.z.y,
+                                                               0.0f,
+                                                               rotation_tfm.x.z,
+                                                               rotation_tfm.y.z,
+                                                               rotation_tfm.z.z,
+                                                               0.0f);
+      return inverse_scale_tfm * rotation_transposed_tfm * transform_translate(-location);
+    }
+    case NODE_MAPPING_TYPE_VECTOR:
+      return rotation_tfm * transform_scale(scale);
+    case NODE_MAPPING_TYPE_NORMAL:
+      return rotation_tfm * inverse_scale_tfm;
+    default:
+      return transform_scale(zero_float3());
+  }
+}
+
 void MappingNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *vector_in = input("Vector");
@@ -1958,6 +2095,28 @@ void MappingNode::compile(SVMCompiler &compiler)
   ShaderOutput *vector_out = output("Vector");
 
   int vector_stack_offset = compiler.stack_assign(vector_in);
+
+  if (!location_in->link && !rotation_in->link && !scale_in->link) {
+    /* Compute the transform once instead of for every shading point. */
+    int result_stack_offset = compiler.stack_assign(vector_out);
+    compiler.add_texture_mapping(
+        vector_stack_offset,
+        result_stack_offset,
+        mapping_node_transform(mapping_type, location, rotation, scale));
+
+    if (mapping_type == NODE_MAPPING_TYPE_NORMAL) {
+      compiler.add_node(
+          NODE_VECTOR_MATH,
+          NODE_VECTOR_MATH_NORMALIZE,
+          compiler.encode_uchar4(result_stack_offset, result_stack_offset, result_stack_offset),
+          compiler.encode_uchar4(SVM_STACK_INVALID, result_stack_offset));
+    }
+
+    /* Location, rotation and scale would take two nodes each to be loaded on the stack. */
+    compiler.add_num_svm_nodes_saved((mapping_type == NODE_MAPPING_TYPE_NORMAL) ? 2 : 3);
+    return;
+  }
+
   int location_stack_offset = compiler.stack_assign(location_in);
   int rotation_stack_offset = compiler.stack_assign(rotation_in);
   int scale_stack_offset = compiler.stack_assign(scale_in);
@@ -6058,16 +6217,7 @@ void MathNode::compile(SVMCompiler &compiler)
   ShaderInput *value3_in = input("Value3");
   ShaderOutput *value_out = output("Value");
 
-  int value1_stack_offset = compiler.stack_assign(value1_in);
-  int value2_stack_offset = compiler.stack_assign(value2_in);
-  int value3_stack_offset = compiler.stack_assign(value3_in);
-  int value_stack_offset = compiler.stack_assign(value_out);
-
-  compiler.add_node(
-      NODE_MATH,
-      math_type,
-      compiler.encode_uchar4(value1_stack_offset, value2_stack_offset, value3_stack_offset),
-      value_stack_offset);
+  compiler.add_math_node(math_type, value1_in, value2_in, value3_in, value_out);
 }
 
 void MathNode::compile(OSLCompiler &compiler)
@@ -221,15 +221,20 @@ void Object::tag_update(Scene *scene)
 
   if (geometry) {
     if (tfm_is_modified()) {
-      /* tag the geometry as modified so the BVH is updated, but do not tag everything as modified
-       */
-      if (geometry->is_mesh() || geometry->is_volume()) {
-        Mesh *mesh = static_cast<Mesh *>(geometry);
-        mesh->tag_verts_modified();
-      }
-      else if (geometry->is_hair()) {
-        Hair *hair = static_cast<Hair *>(geometry);
-        hair->tag_curve_keys_modified();
+      flag |= ObjectManager::TRANSFORM_MODIFIED;
+
+      /* Geometry with the object transform baked into its vertices needs to be updated, but do
+       * not tag everything as modified. Instanced geometry keeps its own BVH, only the top level
+       * BVH over the objects is rebuilt. */
+      if (geometry->transform_applied) {
+        if (geometry->is_mesh() || geometry->is_volume()) {
+          Mesh *mesh = static_cast<Mesh *>(geometry);
+          mesh->tag_verts_modified();
+        }
+        else if (geometry->is_hair()) {
+          Hair *hair = static_cast<Hair *>(geometry);
+          hair->tag_curve_keys_modified();
+        }
       }
     }
 
@@ -923,6 +928,10 @@ void ObjectManager::tag_update(Scene *scene, uint32_t flag)
       geometry_flag |= (GeometryManager::GEOMETRY_ADDED | GeometryManager::GEOMETRY_REMOVED);
     }
 
+    if ((flag & TRANSFORM_MODIFIED) != 0) {
+      geometry_flag |= GeometryManager::TRANSFORM_MODIFIED;
+    }
+
     scene->geometry_manager->tag_update(scene, geometry_flag);
   }
 
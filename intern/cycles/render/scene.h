@@ -116,6 +116,10 @@ class DeviceScene {
   device_vector<KernelLight> lights;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<KernelLightTreeEmitter> light_tree_emitters;
+  device_vector<uint> light_to_tree;
+  device_vector<uint> light_tree_object_offset;
 
   /* particles */
   device_vector<KernelParticle> particles;
@@ -180,6 +184,8 @@ class SceneParams {
   CurveShapeType hair_shape;
   bool persistent_data;
   int texture_limit;
+  bool use_texture_cache;
+  int texture_cache_size;
 
   bool background;
 
@@ -195,6 +201,8 @@ class SceneParams {
     hair_shape = CURVE_RIBBON;
     persistent_data = false;
     texture_limit = 0;
+    use_texture_cache = false;
+    texture_cache_size = 1024;
     background = true;
   }
 
@@ -206,7 +214,9 @@ class SceneParams {
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             use_texture_cache == params.use_texture_cache &&
+             texture_cache_size == params.texture_cache_size);
   }
 
   int curve_subdivisions()
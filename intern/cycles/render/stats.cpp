@@ -235,12 +235,15 @@ string MeshStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Geometry:\n" + geometry.full_report(indent_level + 1);
+  if (!tessellation.entries.empty()) {
+    result += indent + "Tessellation:\n" + tessellation.full_report(indent_level + 1);
+  }
   return result;
 }
 
 /* Image statistics. */
 
-ImageStats::ImageStats()
+ImageStats::ImageStats() : use_texture_cache(false)
 {
 }
 
@@ -249,6 +252,24 @@ string ImageStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  if (use_texture_cache) {
+    const string double_indent = indent + indent;
+    const size_t lookups = texture_cache.lookups;
+    const size_t misses = min(texture_cache.misses, texture_cache.lookups);
+    result += indent + "Texture Cache:\n";
+    result += string_printf("%sMemory: %s (limit %s)\n",
+                            double_indent.c_str(),
+                            string_human_readable_size(texture_cache.memory_used).c_str(),
+                            string_human_readable_size(texture_cache.memory_limit).c_str());
+    result += string_printf("%sRead from files: %s\n",
+                            double_indent.c_str(),
+                            string_human_readable_size(texture_cache.file_size).c_str());
+    result += string_printf("%sTile lookups: %s, hits: %s, misses: %s\n",
+                            double_indent.c_str(),
+                            string_human_readable_number(lookups).c_str(),
+                            string_human_readable_number(lookups - misses).c_str(),
+                            string_human_readable_number(misses).c_str());
+  }
   return result;
 }
 
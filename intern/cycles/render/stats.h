@@ -21,6 +21,7 @@
 
 #include "util/util_stats.h"
 #include "util/util_string.h"
+#include "util/util_texture_cache.h"
 #include "util/util_vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -160,6 +161,9 @@ class MeshStats {
    * memory like BVH.
    */
   NamedSizeStats geometry;
+
+  /* Time spent on adaptive subdivision of each mesh. */
+  NamedTimeStats tessellation;
 };
 
 /* Statistics about images held in memory. */
@@ -171,6 +175,10 @@ class ImageStats {
   string full_report(int indent_level = 0);
 
   NamedSizeStats textures;
+
+  /* Tiles read on demand, when images are sampled through the texture cache. */
+  bool use_texture_cache;
+  TextureCacheStats texture_cache;
 };
 
 /* Render process statistics. */
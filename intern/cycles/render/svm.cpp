@@ -183,6 +183,8 @@ SVMCompiler::SVMCompiler(Scene *scene) : scene(scene)
   background = false;
   mix_weight_offset = SVM_STACK_INVALID;
   compile_failed = false;
+  num_svm_nodes_saved = 0;
+  fuse_barrier();
 }
 
 int SVMCompiler::stack_size(SocketType::Type type)
@@ -406,6 +408,182 @@ void SVMCompiler::add_node(const float4 &f)
       __float_as_int(f.x), __float_as_int(f.y), __float_as_int(f.z), __float_as_int(f.w)));
 }
 
+bool SVMCompiler::can_fuse(ShaderNodeType type)
+{
+  return fusable_node.type == type && fusable_node.end == (int)current_svm_nodes.size();
+}
+
+void SVMCompiler::fuse_barrier()
+{
+  fusable_node.type = NODE_END;
+  fusable_node.index = -1;
+  fusable_node.end = -1;
+}
+
+void SVMCompiler::add_math_node(NodeMathType type,
+                                ShaderInput *value1_in,
+                                ShaderInput *value2_in,
+                                ShaderInput *value3_in,
+                                ShaderOutput *value_out)
+{
+  ShaderInput *inputs[3] = {value1_in, value2_in, value3_in};
+  int stack_offsets[3];
+  int defaults[3] = {0, 0, 0};
+  int num_defaults = 0;
+
+  /* Find the input reading the result of the math node added right before, if any. */
+  int chain_result_offset = SVM_STACK_INVALID;
+  if (can_fuse(NODE_MATH)) {
+    chain_result_offset = current_svm_nodes[fusable_node.index].w;
+  }
+  else if (can_fuse(NODE_MATH_CHAIN)) {
+    chain_result_offset = current_svm_nodes[fusable_node.index].z;
+  }
+
+  int chain_input = SVM_STACK_INVALID;
+  for (int i = 0; i < 3; i++) {
+    ShaderInput *input = inputs[i];
+    stack_offsets[i] = stack_assign_if_linked(input);
+
+    if (input->link) {
+      if (chain_input == SVM_STACK_INVALID && stack_offsets[i] == chain_result_offset &&
+          input->link->links.size() == 1) {
+        chain_input = i;
+      }
+    }
+    else {
+      defaults[num_defaults++] = __float_as_int(input->parent->get_float(input->socket_type));
+    }
+  }
+
+  const int value_stack_offset = stack_assign(value_out);
+  const int start_num_svm_nodes = current_svm_nodes.size();
+
+  if (chain_input != SVM_STACK_INVALID &&
+      (fusable_node.type == NODE_MATH_CHAIN || convert_math_to_chain())) {
+    /* Append the operation to the chain, the values of the unlinked inputs fit in the node
+     * since one input is the chained one. */
+    int4 &chain_node = current_svm_nodes[fusable_node.index];
+    chain_node.y++;
+    chain_node.z = value_stack_offset;
+    add_node(type,
+             encode_uchar4(stack_offsets[0], stack_offsets[1], stack_offsets[2], chain_input),
+             defaults[0],
+             defaults[1]);
+  }
+  else {
+    add_node(NODE_MATH,
+             type,
+             encode_uchar4(stack_offsets[0], stack_offsets[1], stack_offsets[2]),
+             value_stack_offset);
+
+    if (num_defaults > 0) {
+      int values[3];
+      for (int i = 0, j = 0; i < 3; i++) {
+        values[i] = (inputs[i]->link) ? 0 : defaults[j++];
+      }
+      add_node(values[0], values[1], values[2], 0);
+    }
+
+    fusable_node.type = NODE_MATH;
+    fusable_node.index = start_num_svm_nodes;
+  }
+
+  fusable_node.end = current_svm_nodes.size();
+
+  /* Without optimization, every unlinked input takes a node to be loaded on the stack. */
+  add_num_svm_nodes_saved(1 + num_defaults + start_num_svm_nodes -
+                          (int)current_svm_nodes.size());
+}
+
+bool SVMCompiler::convert_math_to_chain()
+{
+  const int4 math_node = current_svm_nodes[fusable_node.index];
+
+  uint stack_offsets[3] = {(uint)math_node.z & 0xFF,
+                           ((uint)math_node.z >> 8) & 0xFF,
+                           ((uint)math_node.z >> 16) & 0xFF};
+  int defaults[3] = {0, 0, 0};
+  int num_defaults = 0;
+
+  for (int i = 0; i < 3; i++) {
+    if (stack_offsets[i] == SVM_STACK_INVALID) {
+      defaults[num_defaults++] = current_svm_nodes[fusable_node.index + 1][i];
+    }
+  }
+
+  /* Operations in a chain only have room for two unlinked inputs. */
+  if (num_defaults > 2) {
+    return false;
+  }
+
+  current_svm_nodes.resize(fusable_node.index);
+  add_node(NODE_MATH_CHAIN, 1, math_node.w);
+  add_node(math_node.y,
+           encode_uchar4(stack_offsets[0], stack_offsets[1], stack_offsets[2], SVM_STACK_INVALID),
+           defaults[0],
+           defaults[1]);
+
+  fusable_node.type = NODE_MATH_CHAIN;
+  return true;
+}
+
+void SVMCompiler::add_texture_mapping(int offset_in, int offset_out, const Transform &tfm)
+{
+  fusable_node.type = NODE_TEXTURE_MAPPING;
+  fusable_node.index = current_svm_nodes.size();
+
+  add_node(NODE_TEXTURE_MAPPING, offset_in, offset_out);
+  add_node(tfm.x);
+  add_node(tfm.y);
+  add_node(tfm.z);
+
+  fusable_node.end = current_svm_nodes.size();
+}
+
+bool SVMCompiler::fuse_texture_mapping(ShaderInput *vector_in,
+                                       int vector_offset,
+                                       int *offset_in,
+                                       Transform *tfm)
+{
+  if (!can_fuse(NODE_TEXTURE_MAPPING)) {
+    return false;
+  }
+
+  const int4 *nodes = &current_svm_nodes[fusable_node.index];
+  if (nodes[0].z != vector_offset) {
+    return false;
+  }
+
+  /* The transformed vector must not be used by other nodes, unless it's a temporary allocated
+   * for the texture node itself. */
+  if (vector_in->link && vector_in->link->stack_offset == vector_offset &&
+      vector_in->link->links.size() != 1) {
+    return false;
+  }
+
+  *offset_in = nodes[0].y;
+  tfm->x = make_float4(__int_as_float(nodes[1].x),
+                       __int_as_float(nodes[1].y),
+                       __int_as_float(nodes[1].z),
+                       __int_as_float(nodes[1].w));
+  tfm->y = make_float4(__int_as_float(nodes[2].x),
+                       __int_as_float(nodes[2].y),
+                       __int_as_float(nodes[2].z),
+                       __int_as_float(nodes[2].w));
+  tfm->z = make_float4(__int_as_float(nodes[3].x),
+                       __int_as_float(nodes[3].y),
+                       __int_as_float(nodes[3].z),
+                       __int_as_float(nodes[3].w));
+
+  current_svm_nodes.resize(fusable_node.index);
+  fuse_barrier();
+
+  /* The texture node stores the transform without the header node. */
+  add_num_svm_nodes_saved(1);
+  return true;
+}
+
 uint SVMCompiler::attribute(ustring name)
 {
   return scene->shader_manager->get_attribute_id(name);
@@ -675,6 +853,7 @@ void SVMCompiler::generate_multi_closure(ShaderNode *root_node,
         /* Fill in jump instruction location to be after closure. */
         current_svm_nodes[node_jump_skip_index].y = current_svm_nodes.size() -
                                                     node_jump_skip_index - 1;
+        fuse_barrier();
       }
 
       /* generate instructions for input closure 2 */
@@ -690,6 +869,7 @@ void SVMCompiler::generate_multi_closure(ShaderNode *root_node,
         /* Fill in jump instruction location to be after closure. */
         current_svm_nodes[node_jump_skip_index].y = current_svm_nodes.size() -
                                                     node_jump_skip_index - 1;
+        fuse_barrier();
       }
 
       /* unassign */
@@ -759,6 +939,7 @@ void SVMCompiler::compile_type(Shader *shader, ShaderGraph *graph, ShaderType ty
   /* clear all compiler state */
   memset((void *)&active_stack, 0, sizeof(active_stack));
   current_svm_nodes.clear();
+  fuse_barrier();
 
   foreach (ShaderNode *node, graph->nodes) {
     foreach (ShaderInput *input, node->inputs)
@@ -847,6 +1028,7 @@ void SVMCompiler::compile(Shader *shader, array<int4> &svm_nodes, int index, Sum
   /* copy graph for shader with bump mapping */
   ShaderNode *output = shader->graph->output();
   int start_num_svm_nodes = svm_nodes.size();
+  num_svm_nodes_saved = 0;
 
   const double time_start = time_dt();
 
@@ -918,6 +1100,7 @@ void SVMCompiler::compile(Shader *shader, array<int4> &svm_nodes, int index, Sum
     summary->time_total = time_dt() - time_start;
     summary->peak_stack_usage = max_stack_use;
     summary->num_svm_nodes = svm_nodes.size() - start_num_svm_nodes;
+    summary->num_svm_nodes_unoptimized = summary->num_svm_nodes + num_svm_nodes_saved;
   }
 }
 
@@ -925,6 +1108,7 @@ void SVMCompiler::compile(Shader *shader, array<int4> &svm_nodes, int index, Sum
 
 SVMCompiler::Summary::Summary()
     : num_svm_nodes(0),
+      num_svm_nodes_unoptimized(0),
       peak_stack_usage(0),
       time_finalize(0.0),
       time_generate_surface(0.0),
@@ -939,6 +1123,7 @@ string SVMCompiler::Summary::full_report() const
 {
   string report = "";
   report += string_printf("Number of SVM nodes: %d\n", num_svm_nodes);
+  report += string_printf("  Unoptimized:       %d\n", num_svm_nodes_unoptimized);
   report += string_printf("Peak stack usage:    %d\n", peak_stack_usage);
 
   report += string_printf("Time (in seconds):\n");
@@ -66,6 +66,10 @@ class SVMCompiler {
     /* Number of SVM nodes shader was compiled into. */
     int num_svm_nodes;
 
+    /* Number of SVM nodes shader would be compiled into without fusing nodes and storing
+     * constant inputs in the nodes. */
+    int num_svm_nodes_unoptimized;
+
     /* Peak stack usage during shader evaluation. */
     int peak_stack_usage;
 
@@ -111,6 +115,29 @@ class SVMCompiler {
   uint attribute(AttributeStandard std);
   uint attribute_standard(ustring name);
   uint encode_uchar4(uint x, uint y = 0, uint z = 0, uint w = 0);
+
+  /* Math operation with unlinked inputs stored in the SVM nodes instead of the stack. It is
+   * fused with the math operation added right before when that is the only user of its result,
+   * so the intermediate result is not written to the stack. */
+  void add_math_node(NodeMathType type,
+                     ShaderInput *value1_in,
+                     ShaderInput *value2_in,
+                     ShaderInput *value3_in,
+                     ShaderOutput *value_out);
+
+  /* Transform of a vector, which a texture node added right after can take over with
+   * fuse_texture_mapping to transform its coordinates itself. */
+  void add_texture_mapping(int offset_in, int offset_out, const Transform &tfm);
+  bool fuse_texture_mapping(ShaderInput *vector_in,
+                            int vector_offset,
+                            int *offset_in,
+                            Transform *tfm);
+
+  /* Count SVM nodes avoided by optimizations done while compiling nodes, for the summary. */
+  void add_num_svm_nodes_saved(int num_nodes)
+  {
+    num_svm_nodes_saved += num_nodes;
+  }
   uint closure_mix_weight_offset()
   {
     return mix_weight_offset;
@@ -218,6 +245,19 @@ class SVMCompiler {
   /* compile */
   void compile_type(Shader *shader, ShaderGraph *graph, ShaderType type);
 
+  /* node fusion */
+  bool can_fuse(ShaderNodeType type);
+  void fuse_barrier();
+  bool convert_math_to_chain();
+
+  /* Last added SVM node which may be fused with the next one, as long as no other nodes were
+   * added after it. Jump targets are barriers, nodes must not be moved across them. */
+  struct FusableNode {
+    ShaderNodeType type;
+    int index;
+    int end;
+  } fusable_node;
+
   array<int4> current_svm_nodes;
   ShaderType current_type;
   Shader *current_shader;
@@ -225,6 +265,7 @@ class SVMCompiler {
   int max_stack_use;
   uint mix_weight_offset;
   bool compile_failed;
+  int num_svm_nodes_saved;
 };
 
 CCL_NAMESPACE_END
@@ -20,6 +20,9 @@
 #include "subd/subd_dice.h"
 #include "subd/subd_patch.h"
 
+#include "util/util_foreach.h"
+#include "util/util_tbb.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* EdgeDice Base */
@@ -45,8 +48,13 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   vert_offset = mesh->get_verts().size();
   tri_offset = mesh->num_triangles();
 
-  mesh->resize_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles());
-  mesh->reserve_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles() + num_triangles);
+  /* Triangles are written in place rather than appended, so subpatches can be diced in
+   * parallel. */
+  mesh->resize_mesh(vert_offset + num_verts, tri_offset + num_triangles);
+  mesh->tag_triangles_modified();
+  mesh->tag_shader_modified();
+  mesh->tag_smooth_modified();
+  mesh->tag_triangle_patch_modified();
 
   Attribute *attr_vN = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -69,17 +77,22 @@ void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
   params.mesh->vert_patch_uv[index + vert_offset] = make_float2(uv.x, uv.y);
 }
 
-void EdgeDice::add_triangle(Patch *patch, int v0, int v1, int v2)
+void EdgeDice::set_triangle(Patch *patch, int index, int v0, int v1, int v2)
 {
   Mesh *mesh = params.mesh;
+  const size_t t = tri_offset + index;
 
-  mesh->add_triangle(v0 + vert_offset, v1 + vert_offset, v2 + vert_offset, patch->shader, true);
-  params.mesh->triangle_patch[params.mesh->num_triangles() - 1] = patch->patch_index;
+  assert(t < mesh->num_triangles());
 
-  tri_offset++;
+  mesh->triangles[t * 3 + 0] = v0 + vert_offset;
+  mesh->triangles[t * 3 + 1] = v1 + vert_offset;
+  mesh->triangles[t * 3 + 2] = v2 + vert_offset;
+  mesh->shader[t] = patch->shader;
+  mesh->smooth[t] = true;
+  mesh->triangle_patch[t] = patch->patch_index;
 }
 
-void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
+void EdgeDice::stitch_triangles(Subpatch &sub, int edge, int &triangle_index)
 {
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
   int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
@@ -122,7 +135,7 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
         v2 = sub.get_vert_along_grid_edge(edge, ++i);
     }
 
-    add_triangle(sub.patch, v1, v0, v2);
+    set_triangle(sub.patch, triangle_index++, v1, v0, v2);
   }
 }
 
@@ -224,7 +237,7 @@ float QuadDice::scale_factor(Subpatch &sub, int Mu, int Mv)
   return S;
 }
 
-void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
+void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset, int &triangle_index)
 {
   /* create inner grid */
   float du = 1.0f / (float)Mu;
@@ -243,18 +256,18 @@ void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
         int i3 = offset + i + j * (Mu - 1);
         int i4 = offset + (i - 1) + j * (Mu - 1);
 
-        add_triangle(sub.patch, i1, i2, i3);
-        add_triangle(sub.patch, i1, i3, i4);
+        set_triangle(sub.patch, triangle_index++, i1, i2, i3);
+        set_triangle(sub.patch, triangle_index++, i1, i3, i4);
       }
     }
   }
 }
 
-void QuadDice::dice(Subpatch &sub)
+void QuadDice::calc_grid_size(const Subpatch &sub, int &Mu, int &Mv)
 {
   /* compute inner grid size with scale factor */
-  int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
-  int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
+  Mu = max(sub.edge_u0.T, sub.edge_u1.T);
+  Mv = max(sub.edge_v0.T, sub.edge_v1.T);
 
 #if 0 /* Doesn't work very well, especially at grazing angles. */
   float S = scale_factor(sub, ef, Mu, Mv);
@@ -264,20 +277,50 @@ void QuadDice::dice(Subpatch &sub)
 
   Mu = max((int)ceilf(S * Mu), 2);  // XXX handle 0 & 1?
   Mv = max((int)ceilf(S * Mv), 2);  // XXX handle 0 & 1?
+}
 
-  /* inner grid */
-  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
-
-  /* sides */
-  set_side(sub, 0);
-  set_side(sub, 1);
-  set_side(sub, 2);
-  set_side(sub, 3);
+void QuadDice::dice(vector<Subpatch> &subpatches)
+{
+  /* Grain size to avoid too much threading overhead for small subpatches. */
+  static const int SUBPATCHES_PER_TASK = 64;
+
+  /* Inner grids don't share vertices or triangles with other subpatches. */
+  parallel_for(blocked_range<size_t>(0, subpatches.size(), SUBPATCHES_PER_TASK),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   Subpatch &sub = subpatches[i];
+                   int Mu, Mv;
+                   calc_grid_size(sub, Mu, Mv);
+
+                   int triangle_index = sub.triangle_offset;
+                   add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset, triangle_index);
+                 }
+               });
+
+  /* Vertices along the sides are shared with neighboring subpatches, set them in order so the
+   * result is the same as when dicing one subpatch after the other. */
+  foreach (Subpatch &sub, subpatches) {
+    set_side(sub, 0);
+    set_side(sub, 1);
+    set_side(sub, 2);
+    set_side(sub, 3);
+  }
 
-  stitch_triangles(sub, 0);
-  stitch_triangles(sub, 1);
-  stitch_triangles(sub, 2);
-  stitch_triangles(sub, 3);
+  /* Stitching only reads the shared vertices, and writes its own range of triangles. */
+  parallel_for(blocked_range<size_t>(0, subpatches.size(), SUBPATCHES_PER_TASK),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   Subpatch &sub = subpatches[i];
+                   int Mu, Mv;
+                   calc_grid_size(sub, Mu, Mv);
+
+                   int triangle_index = sub.triangle_offset + (Mu - 2) * (Mv - 2) * 2;
+                   stitch_triangles(sub, 0, triangle_index);
+                   stitch_triangles(sub, 1, triangle_index);
+                   stitch_triangles(sub, 2, triangle_index);
+                   stitch_triangles(sub, 3, triangle_index);
+                 }
+               });
 }
 
 CCL_NAMESPACE_END
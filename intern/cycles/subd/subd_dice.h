@@ -72,9 +72,9 @@ class EdgeDice {
   void reserve(int num_verts, int num_triangles);
 
   void set_vert(Patch *patch, int index, float2 uv);
-  void add_triangle(Patch *patch, int v0, int v1, int v2);
+  void set_triangle(Patch *patch, int index, int v0, int v1, int v2);
 
-  void stitch_triangles(Subpatch &sub, int edge);
+  void stitch_triangles(Subpatch &sub, int edge, int &triangle_index);
 };
 
 /* Quad EdgeDice */
@@ -88,14 +88,17 @@ class QuadDice : public EdgeDice {
   float2 map_uv(Subpatch &sub, float u, float v);
   void set_vert(Subpatch &sub, int index, float u, float v);
 
-  void add_grid(Subpatch &sub, int Mu, int Mv, int offset);
+  void add_grid(Subpatch &sub, int Mu, int Mv, int offset, int &triangle_index);
 
   void set_side(Subpatch &sub, int edge);
 
   float quad_area(const float3 &a, const float3 &b, const float3 &c, const float3 &d);
   float scale_factor(Subpatch &sub, int Mu, int Mv);
 
-  void dice(Subpatch &sub);
+  void calc_grid_size(const Subpatch &sub, int &Mu, int &Mv);
+
+  /* Dice all subpatches, with vertex and triangle offsets already assigned. */
+  void dice(vector<Subpatch> &subpatches);
 };
 
 CCL_NAMESPACE_END
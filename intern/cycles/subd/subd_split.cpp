@@ -25,6 +25,7 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_math.h"
+#include "util/util_tbb.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -338,10 +339,68 @@ Edge *DiagSplit::alloc_edge()
 }
 
 void DiagSplit::split_patches(Patch *patches, size_t patches_byte_stride)
+{
+  const int num_faces = params.mesh->get_num_subd_faces();
+
+  /* Faces are split independently of each other, so ranges of faces are split in parallel into
+   * their own subpatches and edges. Patch and vertex offsets of the ranges are known up front,
+   * which gives the same result as splitting all faces in order. */
+  static const int FACES_PER_TASK = 64;
+  const int num_ranges = divide_up(num_faces, FACES_PER_TASK);
+
+  vector<int> range_patch_index(num_ranges);
+  int num_patches = 0;
+
+  for (int f = 0; f < num_faces; f++) {
+    if (f % FACES_PER_TASK == 0) {
+      range_patch_index[f / FACES_PER_TASK] = num_patches;
+    }
+
+    Mesh::SubdFace face = params.mesh->get_subd_face(f);
+    num_patches += (face.is_quad()) ? 1 : face.num_corners;
+  }
+
+  /* `deque` is used so that the splits are never moved. */
+  deque<DiagSplit> ranges;
+  for (int i = 0; i < num_ranges; i++) {
+    ranges.emplace_back(params);
+    /* Splitting allocates the four corner vertices of every patch. */
+    ranges.back().num_alloced_verts = num_alloced_verts + range_patch_index[i] * 4;
+  }
+
+  parallel_for(blocked_range<int>(0, num_ranges), [&](const blocked_range<int> &r) {
+    for (int i = r.begin(); i != r.end(); i++) {
+      Patch *range_patches = (Patch *)(((char *)patches) +
+                                       range_patch_index[i] * patches_byte_stride);
+      ranges[i].split_faces(range_patches,
+                            patches_byte_stride,
+                            i * FACES_PER_TASK,
+                            min((i + 1) * FACES_PER_TASK, num_faces));
+    }
+  });
+
+  /* Merge in face order. Edges are moved as a whole, so pointers to them remain valid. */
+  range_edges.reserve(range_edges.size() + num_ranges);
+  foreach (DiagSplit &range, ranges) {
+    subpatches.insert(subpatches.end(), range.subpatches.begin(), range.subpatches.end());
+    range_edges.push_back(std::move(range.edges));
+  }
+  num_alloced_verts += num_patches * 4;
+
+  params.mesh->vert_to_stitching_key_map.clear();
+  params.mesh->vert_stitching_map.clear();
+
+  post_split();
+}
+
+void DiagSplit::split_faces(Patch *patches,
+                            size_t patches_byte_stride,
+                            int face_begin,
+                            int face_end)
 {
   int patch_index = 0;
 
-  for (int f = 0; f < params.mesh->get_num_subd_faces(); f++) {
+  for (int f = face_begin; f < face_end; f++) {
     Mesh::SubdFace face = params.mesh->get_subd_face(f);
 
     Patch *patch = (Patch *)(((char *)patches) + patch_index * patches_byte_stride);
@@ -357,11 +416,6 @@ void DiagSplit::split_patches(Patch *patches, size_t patches_byte_stride)
       split_ngon(face, patch, patches_byte_stride);
     }
   }
-
-  params.mesh->vert_to_stitching_key_map.clear();
-  params.mesh->vert_stitching_map.clear();
-
-  post_split();
 }
 
 static Edge *create_edge_from_corner(DiagSplit *split,
@@ -607,7 +661,19 @@ void DiagSplit::post_split()
 
   /* All patches are now split, and all T values known. */
 
+  /* Edges of all faces, in the order they were created. */
+  vector<Edge *> all_edges;
+  foreach (deque<Edge> &range, range_edges) {
+    foreach (Edge &edge, range) {
+      all_edges.push_back(&edge);
+    }
+  }
   foreach (Edge &edge, edges) {
+    all_edges.push_back(&edge);
+  }
+
+  foreach (Edge *edge_ptr, all_edges) {
+    Edge &edge = *edge_ptr;
     if (edge.second_vert_index < 0) {
       edge.second_vert_index = alloc_verts(edge.T - 1);
     }
@@ -630,7 +696,8 @@ void DiagSplit::post_split()
   typedef unordered_map<pair<int, int>, int, pair_hasher> edge_stitch_verts_map_t;
   edge_stitch_verts_map_t edge_stitch_verts_map;
 
-  foreach (Edge &edge, edges) {
+  foreach (Edge *edge_ptr, all_edges) {
+    Edge &edge = *edge_ptr;
     if (edge.is_stitch_edge) {
       if (edge.stitch_edge_T == 0) {
         edge.stitch_edge_T = edge.T;
@@ -644,7 +711,8 @@ void DiagSplit::post_split()
   }
 
   /* Set start and end indices for edges generated from a split. */
-  foreach (Edge &edge, edges) {
+  foreach (Edge *edge_ptr, all_edges) {
+    Edge &edge = *edge_ptr;
     if (edge.start_vert_index < 0) {
       /* Fix up offsets. */
       if (edge.top_indices_decrease) {
@@ -666,7 +734,8 @@ void DiagSplit::post_split()
   int vert_offset = params.mesh->verts.size();
 
   /* Add verts to stitching map. */
-  foreach (const Edge &edge, edges) {
+  foreach (const Edge *edge_ptr, all_edges) {
+    const Edge &edge = *edge_ptr;
     if (edge.is_stitch_edge) {
       int second_stitch_vert_index = edge_stitch_verts_map[edge.stitch_edge_key];
 
@@ -721,14 +790,6 @@ void DiagSplit::post_split()
   int num_verts = num_alloced_verts;
   int num_triangles = 0;
 
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    subpatches[i].inner_grid_vert_offset = num_verts;
-    num_verts += subpatches[i].calc_num_inner_verts();
-    num_triangles += subpatches[i].calc_num_triangles();
-  }
-
-  dice.reserve(num_verts, num_triangles);
-
   for (size_t i = 0; i < subpatches.size(); i++) {
     Subpatch &sub = subpatches[i];
 
@@ -737,12 +798,20 @@ void DiagSplit::post_split()
     sub.edge_v0.T = max(sub.edge_v0.T, 1);
     sub.edge_v1.T = max(sub.edge_v1.T, 1);
 
-    dice.dice(sub);
+    /* Offsets are assigned in order, so the diced mesh doesn't depend on threading. */
+    sub.inner_grid_vert_offset = num_verts;
+    sub.triangle_offset = num_triangles;
+    num_verts += sub.calc_num_inner_verts();
+    num_triangles += sub.calc_num_triangles();
   }
 
+  dice.reserve(num_verts, num_triangles);
+  dice.dice(subpatches);
+
   /* Cleanup */
   subpatches.clear();
   edges.clear();
+  range_edges.clear();
 }
 
 CCL_NAMESPACE_END
@@ -42,6 +42,8 @@ class DiagSplit {
   vector<Subpatch> subpatches;
   /* `deque` is used so that element pointers remain valid when size is changed. */
   deque<Edge> edges;
+  /* Edges of ranges of faces that were split in parallel, in face order. */
+  vector<deque<Edge>> range_edges;
 
   float3 to_world(Patch *patch, float2 uv);
   int T(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolve = false);
@@ -63,6 +65,7 @@ class DiagSplit {
   explicit DiagSplit(const SubdParams &params);
 
   void split_patches(Patch *patches, size_t patches_byte_stride);
+  void split_faces(Patch *patches, size_t patches_byte_stride, int face_begin, int face_end);
 
   void split_quad(const Mesh::SubdFace &face, Patch *patch);
   void split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t patches_byte_stride);
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/alembic.h"
+
+#include "util/util_array.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+void add_data(DataStore<int> &store, int value, double time)
+{
+  store.add_data(value, time);
+}
+
+int data_for_time(DataStore<int> &store, double time)
+{
+  const int *data = store.data_for_time_no_check(time);
+  return (data) ? *data : -1;
+}
+
+}  // namespace
+
+TEST(render_alembic_datastore, nearest_index)
+{
+  DataStore<int> store;
+  EXPECT_EQ(store.data_for_time_no_check(1.0), nullptr);
+
+  add_data(store, 10, 1.0);
+  add_data(store, 20, 2.0);
+  add_data(store, 30, 3.0);
+
+  /* Times outside of the loaded ones use the first or last data. */
+  EXPECT_EQ(data_for_time(store, 0.0), 10);
+  EXPECT_EQ(data_for_time(store, 5.0), 30);
+
+  /* Exact times. */
+  EXPECT_EQ(data_for_time(store, 1.0), 10);
+  EXPECT_EQ(data_for_time(store, 2.0), 20);
+  EXPECT_EQ(data_for_time(store, 3.0), 30);
+
+  /* Times in between use the nearest data. */
+  EXPECT_EQ(data_for_time(store, 1.4), 10);
+  EXPECT_EQ(data_for_time(store, 1.6), 20);
+  EXPECT_EQ(data_for_time(store, 2.9), 30);
+}
+
+TEST(render_alembic_datastore, add_data_out_of_order)
+{
+  DataStore<int> store;
+  add_data(store, 30, 3.0);
+  add_data(store, 10, 1.0);
+  add_data(store, 40, 4.0);
+  add_data(store, 20, 2.0);
+
+  EXPECT_EQ(store.size(), 4);
+  EXPECT_TRUE(store.has_data_for_time(1.0));
+  EXPECT_TRUE(store.has_data_for_time(2.0));
+  EXPECT_TRUE(store.has_data_for_time(3.0));
+  EXPECT_TRUE(store.has_data_for_time(4.0));
+  EXPECT_FALSE(store.has_data_for_time(2.5));
+
+  EXPECT_EQ(data_for_time(store, 1.0), 10);
+  EXPECT_EQ(data_for_time(store, 2.0), 20);
+  EXPECT_EQ(data_for_time(store, 3.0), 30);
+  EXPECT_EQ(data_for_time(store, 4.0), 40);
+
+  /* Data for an existing time is replaced. */
+  add_data(store, 25, 2.0);
+  EXPECT_EQ(store.size(), 4);
+  EXPECT_EQ(data_for_time(store, 2.0), 25);
+}
+
+TEST(render_alembic_datastore, add_data_arrays)
+{
+  DataStore<array<int>> store;
+
+  for (int i : {2, 0, 1}) {
+    array<int> values;
+    values.push_back_slow(i);
+    values.push_back_slow(i * 10);
+    store.add_data(values, (double)i);
+
+    /* The array is stolen instead of copied. */
+    EXPECT_EQ(values.size(), 0);
+  }
+
+  EXPECT_EQ(store.size(), 3);
+
+  for (int i = 0; i < 3; i++) {
+    const array<int> *values = store.data_for_time_no_check((double)i);
+    ASSERT_NE(values, nullptr);
+    ASSERT_EQ(values->size(), 2);
+    EXPECT_EQ((*values)[0], i);
+    EXPECT_EQ((*values)[1], i * 10);
+  }
+}
+
+TEST(render_alembic_datastore, remove_data_outside)
+{
+  DataStore<int> store;
+
+  for (int i = 0; i < 6; i++) {
+    add_data(store, i * 10, (double)i);
+  }
+
+  /* The time point right before the start of the range is kept, the end is exclusive. */
+  store.remove_data_outside({2.5, 4.0});
+  EXPECT_EQ(store.size(), 2);
+  EXPECT_TRUE(store.has_data_for_time(2.0));
+  EXPECT_TRUE(store.has_data_for_time(3.0));
+  EXPECT_EQ(data_for_time(store, 2.0), 20);
+  EXPECT_EQ(data_for_time(store, 3.0), 30);
+
+  /* A range starting at a time point does not keep the previous one. */
+  add_data(store, 40, 4.0);
+  store.remove_data_outside({3.0, 5.0});
+  EXPECT_EQ(store.size(), 2);
+  EXPECT_TRUE(store.has_data_for_time(3.0));
+  EXPECT_TRUE(store.has_data_for_time(4.0));
+}
+
+TEST(render_alembic_datastore, remove_data_outside_keep_all)
+{
+  /* Constant data. */
+  DataStore<int> constant_store;
+  add_data(constant_store, 10, 0.0);
+  constant_store.remove_data_outside({10.0, 11.0});
+  EXPECT_EQ(constant_store.size(), 1);
+  EXPECT_EQ(data_for_time(constant_store, 10.0), 10);
+
+  /* No time point overlapping with the range. */
+  DataStore<int> store;
+  add_data(store, 50, 5.0);
+  add_data(store, 60, 6.0);
+  store.remove_data_outside({1.0, 2.0});
+  EXPECT_EQ(store.size(), 2);
+
+  /* All the time points are in the range. */
+  store.remove_data_outside({5.0, 7.0});
+  EXPECT_EQ(store.size(), 2);
+}
+
+CCL_NAMESPACE_END
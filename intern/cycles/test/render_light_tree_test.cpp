@@ -0,0 +1,171 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/light_tree.h"
+
+#include "kernel/kernel_compat_cpu.h"
+#include "kernel/kernel_math.h"
+#include "kernel/kernel_types.h"
+#include "kernel/split/kernel_split_data.h"
+#include "kernel/kernel_globals.h"
+#include "kernel/kernel_light_tree.h"
+
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Light tree with emitters of different energies and orientations, spread over clusters, and
+ * distant lights stored after them in the light distribution. */
+class LightTreeTest : public testing::Test {
+ protected:
+  static const int num_emitters = 40;
+  static const int num_distant = 2;
+
+  vector<LightTreePrimitive> primitives;
+  vector<int> distant_lights;
+  vector<KernelLightTreeNode> knodes;
+  vector<KernelLightTreeEmitter> kemitters;
+  vector<uint> light_to_tree;
+  KernelGlobals *kg = nullptr;
+
+  void SetUp() override
+  {
+    for (int i = 0; i < num_emitters; i++) {
+      LightTreePrimitive prim;
+      const float3 co = make_float3(
+          (i % 5) * 3.0f, (i / 5 % 3) * 2.0f + 0.1f * i, (i % 7) * 0.5f);
+      const float3 radius = make_float3(0.1f, 0.1f, 0.1f);
+      prim.bounds = BoundBox(co - radius, co + radius);
+      if (i % 3 == 0) {
+        prim.cone = LightTreeCone::sphere();
+      }
+      else {
+        const float3 axis = normalize(make_float3((i % 2) ? 1.0f : -1.0f, 0.3f, 0.5f));
+        prim.cone = LightTreeCone(axis, 0.0f, M_PI_2_F);
+      }
+      prim.energy = 1.0f + (i % 4);
+      prim.distribution_index = i;
+      primitives.push_back(prim);
+    }
+    for (int i = 0; i < num_distant; i++) {
+      distant_lights.push_back(num_emitters + i);
+    }
+  }
+
+  void TearDown() override
+  {
+    delete kg;
+  }
+
+  void build(const float distant_irradiance)
+  {
+    LightTree tree(primitives);
+
+    knodes.resize(tree.nodes.size());
+    kemitters.resize(primitives.size() + distant_lights.size());
+    light_to_tree.resize(primitives.size() + distant_lights.size());
+    tree.pack(knodes.data(), kemitters.data(), light_to_tree.data(), distant_lights);
+
+    kg = new KernelGlobals();
+    kg->__light_tree_nodes.data = knodes.data();
+    kg->__light_tree_nodes.width = knodes.size();
+    kg->__light_tree_emitters.data = kemitters.data();
+    kg->__light_tree_emitters.width = kemitters.size();
+    kg->__light_to_tree.data = light_to_tree.data();
+    kg->__light_to_tree.width = light_to_tree.size();
+    kg->__data.integrator.num_light_tree_emitters = primitives.size();
+    kg->__data.integrator.num_light_tree_distant = distant_lights.size();
+    kg->__data.integrator.pdf_light_tree_distant = tree.distant_probability(
+        distant_lights.size(), distant_irradiance);
+  }
+
+  /* Sample the tree with stratified random numbers, and compare the probabilities returned by
+   * sampling and the frequency of each light with the probability computed for MIS. */
+  void validate_sampling(const float3 P)
+  {
+    const int num_samples = 100000;
+    const int num_lights = num_emitters + (int)distant_lights.size();
+    vector<int> counts(num_lights, 0);
+    float max_pdf_error = 0.0f;
+
+    for (int i = 0; i < num_samples; i++) {
+      float randu = (i + 0.5f) / num_samples;
+      float pdf;
+      const int index = light_tree_sample(kg, &randu, P, &pdf);
+      if (index < 0) {
+        continue;
+      }
+      ASSERT_LT(index, num_lights);
+      counts[index]++;
+      EXPECT_GE(randu, 0.0f);
+      EXPECT_LE(randu, 1.0f);
+      max_pdf_error = max(max_pdf_error, fabsf(pdf - light_tree_pdf(kg, P, index)) / pdf);
+    }
+
+    EXPECT_LT(max_pdf_error, 1e-4f);
+
+    for (int index = 0; index < num_lights; index++) {
+      EXPECT_NEAR((float)counts[index] / num_samples, light_tree_pdf(kg, P, index), 1e-3f);
+    }
+  }
+};
+
+}  // namespace
+
+TEST_F(LightTreeTest, pdf_matches_sampling)
+{
+  build(0.5f);
+  validate_sampling(make_float3(6.0f, 3.0f, 1.0f));
+  validate_sampling(make_float3(-10.0f, 0.0f, 0.0f));
+  validate_sampling(make_float3(1.0f, 20.0f, -5.0f));
+}
+
+TEST_F(LightTreeTest, pdf_matches_sampling_without_distant)
+{
+  distant_lights.clear();
+  build(0.0f);
+  validate_sampling(make_float3(6.0f, 3.0f, 1.0f));
+}
+
+TEST_F(LightTreeTest, distant_probability)
+{
+  LightTree tree(primitives);
+  const LightTreeNode &root = tree.nodes[0];
+  const float radius = 0.5f * len(root.bounds.size());
+  const float cross_section = M_PI_F * radius * radius;
+
+  EXPECT_EQ(tree.distant_probability(0, 1.0f), 0.0f);
+
+  /* Split by energy. */
+  const float irradiance = root.energy / cross_section;
+  EXPECT_NEAR(tree.distant_probability(num_distant, irradiance), 0.5f, 1e-5f);
+  EXPECT_NEAR(tree.distant_probability(num_distant, 3.0f * irradiance), 0.75f, 1e-5f);
+
+  /* Lights of both groups can always be picked. */
+  EXPECT_EQ(tree.distant_probability(num_distant, 0.0f), 0.05f);
+  EXPECT_EQ(tree.distant_probability(num_distant, 1e10f), 0.95f);
+
+  /* Only distant lights. */
+  vector<LightTreePrimitive> no_primitives;
+  LightTree empty_tree(no_primitives);
+  EXPECT_EQ(empty_tree.distant_probability(num_distant, 0.0f), 1.0f);
+}
+
+CCL_NAMESPACE_END
@@ -95,6 +95,8 @@ typedef enum ExtensionType {
 typedef struct TextureInfo {
   /* Pointer, offset or texture depending on device. */
   uint64_t data;
+  /* Handle for images sampled on demand through the texture cache, CPU only. */
+  uint64_t cache;
   /* Data Type */
   uint data_type;
   /* Buffer number for OpenCL. */
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <OpenImageIO/texture.h>
+
+#include "util/util_algorithm.h"
+#include "util/util_logging.h"
+#include "util/util_math.h"
+#include "util/util_param.h"
+#include "util/util_texture_cache.h"
+
+CCL_NAMESPACE_BEGIN
+
+OIIO_NAMESPACE_USING
+
+struct TextureCacheImage {
+  TextureSystem *texture_system;
+  TextureSystem::TextureHandle *handle;
+  ustring filepath;
+  int channels;
+  InterpolationType interpolation;
+  ExtensionType extension;
+  /* Minimum filter width in texture coordinates, to emulate the texture size limit. */
+  float min_filter_width;
+};
+
+TextureCache::TextureCache() : memory_limit_mb(0)
+{
+  /* Private texture system, so the memory limit is independent of the one used for OSL. */
+  TextureSystem *ts = TextureSystem::create(false);
+
+  /* Generate MIP levels and tiles on the fly for files that don't have them, so large
+   * scanline images don't need to be read fully for every lookup. */
+  ts->attribute("automip", 1);
+  ts->attribute("autotile", 64);
+  ts->attribute("accept_untiled", 1);
+
+  texture_system = ts;
+}
+
+TextureCache::~TextureCache()
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  ts->invalidate_all(true);
+  TextureSystem::destroy(ts);
+}
+
+void TextureCache::set_memory_limit(const size_t memory_limit_mb)
+{
+  if (this->memory_limit_mb == memory_limit_mb) {
+    return;
+  }
+
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  ts->attribute("max_memory_MB", (float)memory_limit_mb);
+  this->memory_limit_mb = memory_limit_mb;
+}
+
+TextureCacheImage *TextureCache::add_image(const string &filepath,
+                                           const InterpolationType interpolation,
+                                           const ExtensionType extension,
+                                           const int texture_limit)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  const ustring ufilepath(filepath);
+
+  TextureSystem::TextureHandle *handle = ts->get_texture_handle(ufilepath);
+  int channels = 0;
+  if (handle == NULL || !ts->good(handle) ||
+      !ts->get_texture_info(handle, NULL, 0, ustring("channels"), TypeDesc::INT, &channels) ||
+      channels < 1) {
+    VLOG(1) << "Texture cache can't read " << filepath << ", loading full image instead: "
+            << ts->geterror();
+    return NULL;
+  }
+
+  /* Same scale factor as used for images loaded into device memory. */
+  float min_filter_width = 0.0f;
+  int resolution[2] = {0, 0};
+  if (texture_limit > 0 &&
+      ts->get_texture_info(
+          handle, NULL, 0, ustring("resolution"), TypeDesc(TypeDesc::INT, 2), resolution)) {
+    const int max_size = max(resolution[0], resolution[1]);
+    if (max_size > texture_limit) {
+      float scale_factor = 1.0f;
+      while (max_size * scale_factor > texture_limit) {
+        scale_factor *= 0.5f;
+      }
+      VLOG(1) << "Limiting texture cache lookups of " << filepath << " to a factor of "
+              << scale_factor << ".";
+      min_filter_width = 1.0f / (max_size * scale_factor);
+    }
+  }
+
+  TextureCacheImage *image = new TextureCacheImage();
+  image->texture_system = ts;
+  image->handle = handle;
+  image->filepath = ufilepath;
+  image->channels = min(channels, 4);
+  image->interpolation = interpolation;
+  image->extension = extension;
+  image->min_filter_width = min_filter_width;
+  return image;
+}
+
+void TextureCache::remove_image(TextureCacheImage *image)
+{
+  /* Force reading the file again when it's used next, it may have changed on disk. */
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  ts->invalidate(image->filepath);
+  delete image;
+}
+
+TextureCacheStats TextureCache::get_stats() const
+{
+  const TextureSystem *ts = (const TextureSystem *)texture_system;
+
+  long long memory_used = 0, file_size = 0, find_tile_calls = 0;
+  int find_tile_cache_misses = 0;
+  ts->getattribute("stat:cache_memory_used", TypeDesc::INT64, &memory_used);
+  ts->getattribute("stat:file_size", TypeDesc::INT64, &file_size);
+  ts->getattribute("stat:find_tile_calls", TypeDesc::INT64, &find_tile_calls);
+  ts->getattribute("stat:find_tile_cache_misses", TypeDesc::INT, &find_tile_cache_misses);
+
+  TextureCacheStats stats;
+  stats.memory_used = (size_t)memory_used;
+  stats.memory_limit = memory_limit_mb * 1024 * 1024;
+  stats.file_size = (size_t)file_size;
+  stats.lookups = (uint64_t)find_tile_calls;
+  stats.misses = (uint64_t)find_tile_cache_misses;
+  return stats;
+}
+
+static TextureOpt::Wrap texture_cache_wrap(const ExtensionType extension)
+{
+  switch (extension) {
+    case EXTENSION_EXTEND:
+      return TextureOpt::WrapClamp;
+    case EXTENSION_CLIP:
+      return TextureOpt::WrapBlack;
+    case EXTENSION_REPEAT:
+    default:
+      return TextureOpt::WrapPeriodic;
+  }
+}
+
+static TextureOpt::InterpMode texture_cache_interp(const InterpolationType interpolation)
+{
+  switch (interpolation) {
+    case INTERPOLATION_CLOSEST:
+      return TextureOpt::InterpClosest;
+    case INTERPOLATION_CUBIC:
+      return TextureOpt::InterpBicubic;
+    case INTERPOLATION_SMART:
+      return TextureOpt::InterpSmartBicubic;
+    case INTERPOLATION_LINEAR:
+    default:
+      return TextureOpt::InterpBilinear;
+  }
+}
+
+void texture_cache_lookup(const uint64_t image_handle,
+                          const float x,
+                          const float y,
+                          const float dxdx,
+                          const float dydx,
+                          const float dxdy,
+                          const float dydy,
+                          float result[4])
+{
+  const TextureCacheImage *image = (const TextureCacheImage *)image_handle;
+
+  TextureOpt options;
+  options.swrap = options.twrap = texture_cache_wrap(image->extension);
+  options.interpmode = texture_cache_interp(image->interpolation);
+  if (image->min_filter_width > 0.0f) {
+    /* Blur by at least one pixel of the scaled down image, so no finer MIP level is used. */
+    options.sblur = options.tblur = image->min_filter_width;
+  }
+  else if (image->interpolation == INTERPOLATION_CLOSEST) {
+    /* Keep pixels sharp, closest is typically used for pixel art. */
+    options.mipmode = TextureOpt::MipModeNoMIP;
+  }
+
+  /* OpenImageIO has the origin at the top left, Cycles images are stored bottom-up. */
+  float values[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  if (!image->texture_system->texture(image->handle,
+                                      NULL,
+                                      options,
+                                      x,
+                                      1.0f - y,
+                                      dxdx,
+                                      -dydx,
+                                      dxdy,
+                                      -dydy,
+                                      image->channels,
+                                      values)) {
+    result[0] = TEX_IMAGE_MISSING_R;
+    result[1] = TEX_IMAGE_MISSING_G;
+    result[2] = TEX_IMAGE_MISSING_B;
+    result[3] = TEX_IMAGE_MISSING_A;
+    return;
+  }
+
+  /* Make sure we don't have buggy values. Like for images loaded into device memory, all
+   * channels are set to 0 if either of them is not finite, to avoid artifacts caused by fully
+   * changed hue. */
+  for (int i = 0; i < image->channels; i++) {
+    if (!isfinite_safe(values[i])) {
+      values[0] = values[1] = values[2] = values[3] = 0.0f;
+      break;
+    }
+  }
+
+  const bool outside = (image->extension == EXTENSION_CLIP) &&
+                       (x < 0.0f || x > 1.0f || y < 0.0f || y > 1.0f);
+
+  switch (image->channels) {
+    case 1:
+      result[0] = result[1] = result[2] = values[0];
+      result[3] = (outside) ? 0.0f : 1.0f;
+      break;
+    case 2:
+      result[0] = result[1] = result[2] = values[0];
+      result[3] = values[1];
+      break;
+    case 3:
+      result[0] = values[0];
+      result[1] = values[1];
+      result[2] = values[2];
+      result[3] = (outside) ? 0.0f : 1.0f;
+      break;
+    default:
+      result[0] = values[0];
+      result[1] = values[1];
+      result[2] = values[2];
+      result[3] = values[3];
+      break;
+  }
+}
+
+CCL_NAMESPACE_END
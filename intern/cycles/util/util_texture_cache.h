@@ -0,0 +1,83 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+#include "util/util_string.h"
+#include "util/util_texture.h"
+#include "util/util_types.h"
+
+CCL_NAMESPACE_BEGIN
+
+struct TextureCacheImage;
+
+/* Statistics about tiles read from image files. */
+struct TextureCacheStats {
+  TextureCacheStats() : memory_used(0), memory_limit(0), file_size(0), lookups(0), misses(0)
+  {
+  }
+
+  size_t memory_used;
+  size_t memory_limit;
+  size_t file_size;
+  uint64_t lookups;
+  uint64_t misses;
+};
+
+/* Texture Cache
+ *
+ * Samples 2D image files on demand through the OpenImageIO texture system, instead of
+ * loading the full resolution images into memory. Tiles are read lazily from the MIP level
+ * matching the texture coordinate derivatives, and evicted when the memory limit is reached.
+ * Only used by the CPU device, which can call back into the host while rendering. */
+class TextureCache {
+ public:
+  TextureCache();
+  ~TextureCache();
+
+  void set_memory_limit(const size_t memory_limit_mb);
+
+  /* Returns NULL if the file can't be opened, in which case the image must be loaded into
+   * device memory instead. Lookups are limited to a resolution of \a texture_limit pixels,
+   * like images scaled down when loading, zero means no limit. */
+  TextureCacheImage *add_image(const string &filepath,
+                               const InterpolationType interpolation,
+                               const ExtensionType extension,
+                               const int texture_limit);
+  void remove_image(TextureCacheImage *image);
+
+  TextureCacheStats get_stats() const;
+
+ protected:
+  void *texture_system;
+  size_t memory_limit_mb;
+};
+
+/* Filtered lookup for the CPU kernel, with derivatives of the texture coordinates in image
+ * space convention (Y pointing up). The image is the handle stored in TextureInfo.cache. */
+void texture_cache_lookup(const uint64_t image,
+                          const float x,
+                          const float y,
+                          const float dxdx,
+                          const float dydx,
+                          const float dxdy,
+                          const float dydy,
+                          float result[4]);
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
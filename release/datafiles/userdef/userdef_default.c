@@ -132,6 +132,8 @@ const UserDef U_default = {
 
     .prefetchframes = 0,
     .pad_rot_angle = 15,
+    .geometry_cache_limit = 0,
+    .modifier_cache_limit = 0,
     .rvisize = 25,
     .rvibright = 8,
     .recent_files = 10,
@@ -635,6 +635,12 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
         col.prop(system, "vbo_time_out", text="Vbo Time Out")
         col.prop(system, "vbo_collection_rate", text="Garbage Collection Rate")
 
+        layout.separator()
+
+        col = layout.column()
+        col.prop(system, "geometry_cache_limit", text="Geometry Cache Limit")
+        col.prop(system, "modifier_cache_limit", text="Modifier Cache Limit")
+
 
 class USERPREF_PT_system_video_sequencer(SystemPanel, CenterAlignMixIn, Panel):
     bl_label = "Video Sequencer"
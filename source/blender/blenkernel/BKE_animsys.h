@@ -288,6 +288,11 @@ void BKE_animsys_eval_driver(struct Depsgraph *depsgraph,
 
 void BKE_animsys_update_driver_array(struct ID *id);
 
+/* Resolved RNA path cache of evaluated animation data. */
+void BKE_animsys_path_cache_free(struct AnimData *adt);
+void BKE_animsys_path_cache_invalidate_all(void);
+void BKE_animsys_path_cache_stats_print_and_reset(void);
+
 /* ************************************* */
 
 #ifdef __cplusplus
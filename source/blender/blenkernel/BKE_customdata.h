@@ -417,6 +417,7 @@ void CustomData_from_bmesh_block(const struct CustomData *source,
 /* query info over types */
 void CustomData_file_write_info(int type, const char **r_struct_name, int *r_struct_num);
 int CustomData_sizeof(int type);
+size_t CustomData_memory_size(const struct CustomData *data, int totelem);
 
 /* get the name of a layer type */
 const char *CustomData_layertype_name(int type);
@@ -27,6 +27,7 @@ extern "C" {
 #endif
 
 struct Depsgraph;
+struct ID;
 struct ListBase;
 struct Object;
 struct ParticleSystem;
@@ -38,11 +39,17 @@ struct Scene;
 struct ListBase *object_duplilist(struct Depsgraph *depsgraph,
                                   struct Scene *sce,
                                   struct Object *ob);
+struct ListBase *object_duplilist_ex(struct Depsgraph *depsgraph,
+                                     struct Scene *sce,
+                                     struct Object *ob,
+                                     const bool use_instanced_geometry);
 void free_object_duplilist(struct ListBase *lb);
 
 typedef struct DupliObject {
   struct DupliObject *next, *prev;
   struct Object *ob;
+  /* Data that replaces the data of #ob, for geometry instanced by geometry nodes. */
+  struct ID *ob_data;
   float mat[4][4];
   float orco[3], uv[2];
 
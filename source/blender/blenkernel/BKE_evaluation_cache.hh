@@ -0,0 +1,192 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Storage shared by the in-memory caches of evaluated object data, see
+ * #BKE_geometry_playback_cache.h and #BKE_modifier_result_cache.h.
+ *
+ * Entries are stored per dependency graph and per object. Total memory usage is bounded by a
+ * limit, oldest entries are evicted first.
+ */
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+#include "BLI_map.hh"
+#include "BLI_vector.hh"
+
+struct Depsgraph;
+
+namespace blender::bke {
+
+/**
+ * \a Entry is the type of the cached items, it must have `uint64_t stamp` and
+ * `size_t memory_size` members, the stamp is set by the cache. \a ObjectState and \a GraphState
+ * are additional data stored per object and per dependency graph, they are not freed with the
+ * entries.
+ *
+ * None of the methods lock #mutex, callers have to hold it for every access.
+ */
+template<typename Entry, typename ObjectState = bool, typename GraphState = bool>
+class EvaluationCache {
+ public:
+  struct ObjectCache {
+    ObjectState state{};
+    Vector<Entry> entries;
+  };
+
+  struct GraphCache {
+    GraphState state{};
+    /** Objects are identified by the session UUID of their original datablock. */
+    Map<uint, ObjectCache> objects;
+  };
+
+  /* Mutex for multithreaded access, objects are evaluated in parallel. */
+  std::mutex mutex;
+
+  /* Statistics since the last invalidation. */
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+
+ private:
+  struct EvictionItem {
+    const Depsgraph *depsgraph;
+    uint object_uuid;
+    uint64_t stamp;
+  };
+
+  Map<const Depsgraph *, GraphCache> graphs_;
+  std::deque<EvictionItem> eviction_queue_;
+  uint64_t next_stamp_ = 0;
+  size_t memory_used_ = 0;
+
+ public:
+  ~EvaluationCache()
+  {
+    BLI_assert(graphs_.is_empty());
+  }
+
+  GraphCache *lookup_graph(const Depsgraph *depsgraph)
+  {
+    return graphs_.lookup_ptr(depsgraph);
+  }
+
+  GraphCache &ensure_graph(const Depsgraph *depsgraph)
+  {
+    return graphs_.lookup_or_add_default(depsgraph);
+  }
+
+  /** Add an entry and evict the oldest entries until the memory usage is within \a limit. */
+  void add_entry(const Depsgraph *depsgraph,
+                 const uint object_uuid,
+                 Entry entry,
+                 const size_t limit)
+  {
+    ObjectCache &object_cache = this->ensure_graph(depsgraph).objects.lookup_or_add_default(
+        object_uuid);
+    entry.stamp = next_stamp_++;
+    eviction_queue_.push_back({depsgraph, object_uuid, entry.stamp});
+    memory_used_ += entry.memory_size;
+    object_cache.entries.append(std::move(entry));
+
+    this->evict(limit);
+  }
+
+  void remove_entry(ObjectCache &object_cache, const int64_t index)
+  {
+    memory_used_ -= object_cache.entries[index].memory_size;
+    object_cache.entries.remove_and_reorder(index);
+  }
+
+  /** Free all entries of the dependency graph, when they became invalid. */
+  void clear_graph(GraphCache &graph_cache)
+  {
+    for (ObjectCache &object_cache : graph_cache.objects.values()) {
+      for (const Entry &entry : object_cache.entries) {
+        memory_used_ -= entry.memory_size;
+      }
+      object_cache.entries.clear();
+    }
+    hits = 0;
+    misses = 0;
+  }
+
+  /** Free all data of the dependency graph, when the graph itself is freed. */
+  void free_graph(const Depsgraph *depsgraph)
+  {
+    GraphCache *graph_cache = graphs_.lookup_ptr(depsgraph);
+    if (graph_cache == nullptr) {
+      return;
+    }
+    this->clear_graph(*graph_cache);
+    graphs_.remove(depsgraph);
+    if (graphs_.is_empty()) {
+      graphs_.clear();
+      eviction_queue_.clear();
+    }
+  }
+
+  void evict(const size_t limit)
+  {
+    while (memory_used_ > limit && !eviction_queue_.empty()) {
+      const EvictionItem item = eviction_queue_.front();
+      eviction_queue_.pop_front();
+
+      /* The entry might have been freed already by an invalidation. */
+      GraphCache *graph_cache = graphs_.lookup_ptr(item.depsgraph);
+      if (graph_cache == nullptr) {
+        continue;
+      }
+      ObjectCache *object_cache = graph_cache->objects.lookup_ptr(item.object_uuid);
+      if (object_cache == nullptr) {
+        continue;
+      }
+      for (const int64_t i : object_cache->entries.index_range()) {
+        if (object_cache->entries[i].stamp == item.stamp) {
+          this->remove_entry(*object_cache, i);
+          break;
+        }
+      }
+    }
+    if (memory_used_ == 0) {
+      /* Avoid unbounded growth of the queue when entries are invalidated faster than evicted. */
+      eviction_queue_.clear();
+    }
+  }
+
+  size_t memory_used() const
+  {
+    return memory_used_;
+  }
+
+  int64_t entries_num() const
+  {
+    int64_t entries_num = 0;
+    for (const GraphCache &graph_cache : graphs_.values()) {
+      for (const ObjectCache &object_cache : graph_cache.objects.values()) {
+        entries_num += object_cache.entries.size();
+      }
+    }
+    return entries_num;
+  }
+};
+
+}  // namespace blender::bke
@@ -296,6 +296,10 @@ void BKE_fcurve_correct_bezpart(const float v1[2], float v2[2], float v3[2], con
 /* evaluate fcurve */
 float evaluate_fcurve(struct FCurve *fcu, float evaltime);
 float evaluate_fcurve_only_curve(struct FCurve *fcu, float evaltime);
+void BKE_fcurves_evaluate_batch(struct FCurve **fcurves,
+                                const int fcurves_num,
+                                const float evaltime,
+                                float *r_values);
 float evaluate_fcurve_driver(struct PathResolvedRNA *anim_rna,
                              struct FCurve *fcu,
                              struct ChannelDriver *driver_orig,
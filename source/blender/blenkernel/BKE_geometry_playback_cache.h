@@ -0,0 +1,96 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * In-memory cache of evaluated object geometry, used to avoid re-running modifier stacks when
+ * the same frame is evaluated again without any edits in between (e.g. looping playback or
+ * scrubbing the timeline).
+ *
+ * Entries are keyed by the scene time and the update counter of the dependency graph, so any
+ * user edit tagged with #DEG_id_tag_update invalidates all entries of that dependency graph.
+ * Total memory usage is bounded by #UserDef.geometry_cache_limit, oldest entries are evicted
+ * first.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct CustomData_MeshMasks;
+struct Depsgraph;
+struct GeometrySet;
+struct Mesh;
+struct Object;
+
+typedef struct GeometryPlaybackCacheStats {
+  /** Number of lookups which were satisfied from the cache, since it was last invalidated. */
+  uint64_t hits;
+  /** Number of lookups which required the modifier stack to be evaluated. */
+  uint64_t misses;
+  /** Memory used by the cached geometry, in bytes. */
+  size_t memory_used;
+  /** Memory limit of the cache, in bytes. */
+  size_t memory_limit;
+  /** Number of cached frames, for all objects. */
+  int entries_num;
+} GeometryPlaybackCacheStats;
+
+bool BKE_geometry_playback_cache_is_enabled(void);
+
+/**
+ * Look up evaluated geometry of the object for the current time of the dependency graph.
+ * On success, newly allocated copies of the cached data are returned and are owned by the caller.
+ */
+bool BKE_geometry_playback_cache_lookup(const struct Depsgraph *depsgraph,
+                                        const struct Object *ob,
+                                        const struct CustomData_MeshMasks *dataMask,
+                                        const bool need_mapping,
+                                        struct Mesh **r_mesh_eval,
+                                        struct Mesh **r_mesh_deform_eval,
+                                        struct GeometrySet **r_geometry_set);
+
+/**
+ * Store evaluated geometry of the object for the current time of the dependency graph.
+ * The data is copied, the caller keeps ownership of the passed in data.
+ *
+ * Nothing is stored on the first evaluation after an update tag, so that interactive edits do
+ * not pay the cost of copying the result.
+ */
+void BKE_geometry_playback_cache_store(const struct Depsgraph *depsgraph,
+                                       const struct Object *ob,
+                                       const struct CustomData_MeshMasks *dataMask,
+                                       const bool need_mapping,
+                                       struct Mesh *mesh_eval,
+                                       struct Mesh *mesh_deform_eval,
+                                       const struct GeometrySet *geometry_set);
+
+/** Free all entries which were created for the given dependency graph. */
+void BKE_geometry_playback_cache_free_depsgraph(const struct Depsgraph *depsgraph);
+
+/** Evict entries until the memory usage is within the limit from the user preferences. */
+void BKE_geometry_playback_cache_limit_update(void);
+
+void BKE_geometry_playback_cache_stats_get(GeometryPlaybackCacheStats *r_stats);
+
+#ifdef __cplusplus
+}
+#endif
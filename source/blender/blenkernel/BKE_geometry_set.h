@@ -26,6 +26,7 @@ extern "C" {
 
 struct Collection;
 struct GeometrySet;
+struct ID;
 struct Object;
 
 void BKE_geometry_set_free(struct GeometrySet *geometry_set);
@@ -35,6 +36,7 @@ bool BKE_geometry_set_has_instances(const struct GeometrySet *geometry_set);
 typedef enum InstancedDataType {
   INSTANCE_DATA_TYPE_OBJECT = 0,
   INSTANCE_DATA_TYPE_COLLECTION = 1,
+  INSTANCE_DATA_TYPE_GEOMETRY_SET = 2,
 } InstancedDataType;
 
 typedef struct InstancedData {
@@ -42,6 +44,8 @@ typedef struct InstancedData {
   union {
     struct Object *object;
     struct Collection *collection;
+    /* Owned by the instances component that references it. */
+    const struct GeometrySet *geometry_set;
   } data;
 } InstancedData;
 
@@ -50,6 +54,8 @@ int BKE_geometry_set_instances(const struct GeometrySet *geometry_set,
                                const int **r_almost_unique_ids,
                                struct InstancedData **r_instanced_data);
 
+int BKE_geometry_set_drawable_data(const struct GeometrySet *geometry_set, struct ID *r_data[3]);
+
 #ifdef __cplusplus
 }
 #endif
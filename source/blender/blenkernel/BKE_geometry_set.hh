@@ -22,6 +22,7 @@
 
 #include <atomic>
 #include <iostream>
+#include <memory>
 
 #include "BLI_float3.hh"
 #include "BLI_float4x4.hh"
@@ -101,6 +102,9 @@ class OutputAttributePtr {
 
   ~OutputAttributePtr();
 
+  OutputAttributePtr(OutputAttributePtr &&other) = default;
+  OutputAttributePtr &operator=(OutputAttributePtr &&other) = default;
+
   /* Returns false, when this wrapper is empty. */
   operator bool() const
   {
@@ -316,6 +320,8 @@ struct GeometrySet {
   friend bool operator==(const GeometrySet &a, const GeometrySet &b);
   uint64_t hash() const;
 
+  size_t memory_size() const;
+
   /* Utility methods for creation. */
   static GeometrySet create_with_mesh(
       Mesh *mesh, GeometryOwnershipType ownership = GeometryOwnershipType::Owned);
@@ -418,6 +424,10 @@ class InstancesComponent : public GeometryComponent {
   blender::Vector<int> ids_;
   blender::Vector<InstancedData> instanced_data_;
 
+  /* Geometry sets referenced by instances of type #INSTANCE_DATA_TYPE_GEOMETRY_SET. They are
+   * immutable, so they can be shared with copies of this component instead of being copied. */
+  blender::Vector<std::shared_ptr<const GeometrySet>> instanced_geometry_sets_;
+
   /* These almost unique ids are generated based on `ids_`, which might not contain unique ids at
    * all. They are *almost* unique, because under certain very unlikely circumstances, they are not
    * unique. Code using these ids should not crash when they are not unique but can generally
@@ -434,6 +444,13 @@ class InstancesComponent : public GeometryComponent {
   void add_instance(Object *object, blender::float4x4 transform, const int id = -1);
   void add_instance(Collection *collection, blender::float4x4 transform, const int id = -1);
   void add_instance(InstancedData data, blender::float4x4 transform, const int id = -1);
+  void add_instances(const InstancesComponent &other);
+
+  /**
+   * Store a geometry set so that it can be instanced without realizing it. The returned data
+   * can be passed to #add_instance any number of times.
+   */
+  InstancedData add_instanced_geometry_set(GeometrySet geometry_set);
 
   blender::Span<InstancedData> instanced_data() const;
   blender::Span<blender::float4x4> transforms() const;
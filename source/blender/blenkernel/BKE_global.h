@@ -154,6 +154,8 @@ enum {
   G_DEBUG_XR_TIME = (1 << 20),               /* XR/OpenXR timing messages */
 
   G_DEBUG_GHOST = (1 << 21), /* Debug GHOST module. */
+
+  G_DEBUG_DEPSGRAPH_VALIDATE = (1 << 22), /* compare partial depsgraph updates with full build */
 };
 
 #define G_DEBUG_ALL \
@@ -123,6 +123,7 @@ void BKE_mesh_eval_delete(struct Mesh *mesh_eval);
 /* Performs copy for use during evaluation,
  * optional referencing original arrays to reduce memory. */
 struct Mesh *BKE_mesh_copy_for_eval(struct Mesh *source, bool reference);
+size_t BKE_mesh_memory_size(const struct Mesh *mesh);
 
 /* These functions construct a new Mesh,
  * contrary to BKE_mesh_from_nurbs which modifies ob itself. */
@@ -303,6 +304,21 @@ void BKE_mesh_calc_normals_poly(struct MVert *mverts,
                                 int numPolys,
                                 float (*r_polyNors)[3],
                                 const bool only_face_normals);
+void BKE_mesh_calc_normals_poly_and_vertex(const struct MVert *mvert,
+                                           const int mvert_len,
+                                           const struct MLoop *mloop,
+                                           const int mloop_len,
+                                           const struct MPoly *mpoly,
+                                           const int mpoly_len,
+                                           float (*r_poly_normals)[3],
+                                           float (*r_vert_normals)[3]);
+const float (*BKE_mesh_vertex_normals_ensure(const struct Mesh *mesh))[3];
+const float (*BKE_mesh_poly_normals_ensure(const struct Mesh *mesh))[3];
+void BKE_mesh_normals_tag_dirty(struct Mesh *mesh);
+void BKE_mesh_normals_cache_tag_dirty(struct Mesh *mesh);
+void BKE_mesh_normals_cache_ensure_len(float (**r_normals)[3],
+                                       int *r_normals_len,
+                                       const int len);
 void BKE_mesh_calc_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals_for_display(struct Mesh *mesh);
@@ -688,6 +704,8 @@ void BKE_mesh_eval_geometry(struct Depsgraph *depsgraph, struct Mesh *mesh);
 /* Draw Cache */
 void BKE_mesh_batch_cache_dirty_tag(struct Mesh *me, eMeshBatchDirtyMode mode);
 void BKE_mesh_batch_cache_free(struct Mesh *me);
+bool BKE_mesh_batch_cache_can_transfer_deform(const struct Mesh *me_src);
+bool BKE_mesh_batch_cache_transfer_deform(struct Mesh *me_src, struct Mesh *me_dst);
 
 extern void (*BKE_mesh_batch_cache_dirty_tag_cb)(struct Mesh *me, eMeshBatchDirtyMode mode);
 extern void (*BKE_mesh_batch_cache_free_cb)(struct Mesh *me);
@@ -0,0 +1,110 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * In-memory cache of intermediate results of the modifier stack of mesh objects.
+ *
+ * The mesh is stored after modifiers which took a long time to evaluate, so that changing the
+ * settings of a later modifier only re-evaluates the modifiers after the cached result.
+ *
+ * Every modifier in the stack gets a key, which combines the key of the previous modifier with
+ * the settings of the modifier, the data masks used for its evaluation and the time when the
+ * modifier depends on it. When the input mesh or any data-block used by a modifier is tagged for
+ * update, the keys of the following modifiers are zero and their cached results are discarded.
+ * For collections, this includes the objects in them and changes of their members.
+ *
+ * Total memory usage is bounded by #UserDef.modifier_cache_limit, oldest entries are evicted
+ * first.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct CDMaskLink;
+struct CustomData_MeshMasks;
+struct Depsgraph;
+struct GeometrySet;
+struct Mesh;
+struct ModifierData;
+struct Object;
+struct Scene;
+
+bool BKE_modifier_result_cache_is_enabled(void);
+
+/**
+ * Compute the cache key of the result of every modifier in the list starting at \a firstmd
+ * (including virtual modifiers), \a datamasks is the list of masks of the same modifiers.
+ * Keys are zero for modifiers which can not be cached, and for all modifiers after them.
+ */
+void BKE_modifier_result_cache_keys_calc(const struct Depsgraph *depsgraph,
+                                         const struct Scene *scene,
+                                         struct Object *ob,
+                                         struct ModifierData *firstmd,
+                                         const struct CDMaskLink *datamasks,
+                                         const struct CustomData_MeshMasks *final_datamask,
+                                         const int required_mode,
+                                         const bool need_mapping,
+                                         uint64_t *r_keys,
+                                         const int keys_num);
+
+/**
+ * Find the cached result of the last possible modifier. Results for modifiers with a zero key
+ * are discarded.
+ *
+ * \return The index of the modifier in the list, or -1 when there is no cached result.
+ * On success, newly allocated copies of the cached data are returned and are owned by the caller,
+ * and the errors of the modifiers up to the cached one are reported again.
+ */
+int BKE_modifier_result_cache_lookup(const struct Depsgraph *depsgraph,
+                                     struct Object *ob,
+                                     struct ModifierData *firstmd,
+                                     const uint64_t *keys,
+                                     const int keys_num,
+                                     struct Mesh **r_mesh,
+                                     struct GeometrySet **r_geometry_set);
+
+/**
+ * Store the result of a modifier if it took long enough to evaluate to be worth it.
+ * The data is copied, the caller keeps ownership of the passed in data.
+ *
+ * \param firstmd: First modifier of the list, used to store errors reported by the modifiers up
+ * to the cached one, so that they can be reported again on a cache hit.
+ */
+void BKE_modifier_result_cache_store(const struct Depsgraph *depsgraph,
+                                     const struct Object *ob,
+                                     const struct ModifierData *firstmd,
+                                     const int modifier_index,
+                                     const uint64_t key,
+                                     const double eval_time,
+                                     struct Mesh *mesh,
+                                     const struct GeometrySet *geometry_set);
+
+/** Free all entries which were created for the given dependency graph. */
+void BKE_modifier_result_cache_free_depsgraph(const struct Depsgraph *depsgraph);
+
+/** Evict entries until the memory usage is within the limit from the user preferences. */
+void BKE_modifier_result_cache_limit_update(void);
+
+#ifdef __cplusplus
+}
+#endif
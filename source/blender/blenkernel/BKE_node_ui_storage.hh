@@ -89,3 +89,7 @@ void BKE_nodetree_error_message_add(bNodeTree &ntree,
                                     const bNode &node,
                                     const NodeWarningType type,
                                     std::string message);
+
+bool BKE_nodetree_ui_storage_node_has_warnings(const bNodeTree &ntree,
+                                               const NodeTreeEvaluationContext &context,
+                                               const bNode &node);
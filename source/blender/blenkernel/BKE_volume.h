@@ -20,6 +20,9 @@
  * \ingroup bke
  * \brief Volume datablock.
  */
+
+#include "BLI_sys_types.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -43,6 +46,7 @@ void BKE_volume_init_grids(struct Volume *volume);
 void *BKE_volume_add(struct Main *bmain, const char *name);
 
 struct BoundBox *BKE_volume_boundbox_get(struct Object *ob);
+bool BKE_volume_min_max(const struct Volume *volume, float r_min[3], float r_max[3]);
 
 bool BKE_volume_is_y_up(const struct Volume *volume);
 bool BKE_volume_is_points_only(const struct Volume *volume);
@@ -85,6 +89,7 @@ bool BKE_volume_is_loaded(const struct Volume *volume);
 int BKE_volume_num_grids(const struct Volume *volume);
 const char *BKE_volume_grids_error_msg(const struct Volume *volume);
 const char *BKE_volume_grids_frame_filepath(const struct Volume *volume);
+size_t BKE_volume_memory_size(const struct Volume *volume);
 VolumeGrid *BKE_volume_grid_get(const struct Volume *volume, int grid_index);
 VolumeGrid *BKE_volume_grid_active_get(const struct Volume *volume);
 VolumeGrid *BKE_volume_grid_find(const struct Volume *volume, const char *name);
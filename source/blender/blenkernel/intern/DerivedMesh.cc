@@ -45,11 +45,14 @@
 #include "BLI_utildefines.h"
 #include "BLI_vector.hh"
 
+#include "PIL_time.h"
+
 #include "BKE_DerivedMesh.h"
 #include "BKE_bvhutils.h"
 #include "BKE_colorband.h"
 #include "BKE_deform.h"
 #include "BKE_editmesh.h"
+#include "BKE_geometry_playback_cache.h"
 #include "BKE_geometry_set.hh"
 #include "BKE_geometry_set_instances.hh"
 #include "BKE_key.h"
@@ -63,10 +66,12 @@
 #include "BKE_mesh_tangent.h"
 #include "BKE_mesh_wrapper.h"
 #include "BKE_modifier.h"
+#include "BKE_modifier_result_cache.h"
 #include "BKE_multires.h"
 #include "BKE_object.h"
 #include "BKE_object_deform.h"
 #include "BKE_paint.h"
+#include "BKE_pointcache.h"
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
@@ -811,17 +816,9 @@ static void mesh_calc_modifier_final_normals(const Mesh *mesh_input,
    * (BKE_mesh_calc_normals_split() assumes that if that data exists, it is always valid). */
   if (do_poly_normals) {
     if (!CustomData_has_layer(&mesh_final->pdata, CD_NORMAL)) {
-      float(*polynors)[3] = (float(*)[3])CustomData_add_layer(
-          &mesh_final->pdata, CD_NORMAL, CD_CALLOC, nullptr, mesh_final->totpoly);
-      BKE_mesh_calc_normals_poly(mesh_final->mvert,
-                                 nullptr,
-                                 mesh_final->totvert,
-                                 mesh_final->mloop,
-                                 mesh_final->mpoly,
-                                 mesh_final->totloop,
-                                 mesh_final->totpoly,
-                                 polynors,
-                                 false);
+      const float(*polynors)[3] = BKE_mesh_poly_normals_ensure(mesh_final);
+      CustomData_add_layer(
+          &mesh_final->pdata, CD_NORMAL, CD_DUPLICATE, (void *)polynors, mesh_final->totpoly);
     }
   }
 
@@ -1064,6 +1061,40 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   /* Clear errors before evaluation. */
   BKE_modifiers_clear_errors(ob);
 
+  /* Intermediate results of slow modifiers are cached for interactive updates in object mode,
+   * the result of the last modifier which is still valid is used instead of evaluating the
+   * modifiers before it. */
+  const bool use_result_cache = use_cache && index == -1 && useDeform == 1 && !use_render &&
+                                DEG_is_active(depsgraph) && ob->sculpt == nullptr &&
+                                (ob->mode & OB_MODE_ALL_PAINT) == 0 &&
+                                BKE_modifier_result_cache_is_enabled();
+  blender::Vector<uint64_t> result_keys;
+  int cached_md_index = -1;
+  Mesh *cached_mesh = nullptr;
+  GeometrySet *cached_geometry_set = nullptr;
+  if (use_result_cache) {
+    for (ModifierData *md_iter = firstmd; md_iter; md_iter = md_iter->next) {
+      result_keys.append(0);
+    }
+    BKE_modifier_result_cache_keys_calc(depsgraph,
+                                        scene,
+                                        ob,
+                                        firstmd,
+                                        datamasks,
+                                        &final_datamask,
+                                        required_mode,
+                                        need_mapping,
+                                        result_keys.data(),
+                                        result_keys.size());
+    cached_md_index = BKE_modifier_result_cache_lookup(depsgraph,
+                                                       ob,
+                                                       firstmd,
+                                                       result_keys.data(),
+                                                       result_keys.size(),
+                                                       &cached_mesh,
+                                                       &cached_geometry_set);
+  }
+
   /* Apply all leading deform modifiers. */
   if (useDeform) {
     for (; md; md = md->next, md_datamask = md_datamask->next) {
@@ -1118,7 +1149,37 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
 
   /* Apply all remaining constructive and deforming modifiers. */
   bool have_non_onlydeform_modifiers_appled = false;
-  for (; md; md = md->next, md_datamask = md_datamask->next) {
+  int md_index = 0;
+  for (ModifierData *md_iter = firstmd; md_iter != md; md_iter = md_iter->next) {
+    md_index++;
+  }
+
+  if (cached_md_index != -1) {
+    /* Continue the evaluation after the cached modifier. The leading deform modifiers are
+     * evaluated anyway, they are used for the deformed mesh. */
+    BLI_assert(cached_md_index >= md_index);
+    if (deformed_verts) {
+      MEM_freeN(deformed_verts);
+      deformed_verts = nullptr;
+    }
+    if (mesh_final) {
+      BLI_assert(mesh_final != mesh_input);
+      BKE_id_free(nullptr, mesh_final);
+    }
+    mesh_final = cached_mesh;
+    mesh_final->runtime.deformed_only = false;
+    geometry_set_final = std::move(*cached_geometry_set);
+    delete cached_geometry_set;
+    have_non_onlydeform_modifiers_appled = true;
+    isPrevDeform = false;
+
+    for (; md_index <= cached_md_index; md_index++) {
+      md = md->next;
+      md_datamask = md_datamask->next;
+    }
+  }
+
+  for (; md; md = md->next, md_datamask = md_datamask->next, md_index++) {
     const ModifierTypeInfo *mti = BKE_modifier_get_info((ModifierType)md->type);
 
     if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
@@ -1301,8 +1362,11 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
         }
       }
 
+      const double eval_start_time = use_result_cache ? PIL_check_seconds_timer() : 0.0;
       Mesh *mesh_next = modifier_modify_mesh_and_geometry_set(
           md, mectx, mesh_final, geometry_set_final);
+      const double eval_time = use_result_cache ? PIL_check_seconds_timer() - eval_start_time :
+                                                  0.0;
       ASSERT_IS_VALID_MESH(mesh_next);
 
       if (mesh_next) {
@@ -1385,6 +1449,17 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       }
 
       mesh_final->runtime.deformed_only = false;
+
+      if (use_result_cache && mesh_next) {
+        BKE_modifier_result_cache_store(depsgraph,
+                                        ob,
+                                        firstmd,
+                                        md_index,
+                                        result_keys[md_index],
+                                        eval_time,
+                                        mesh_final,
+                                        &geometry_set_final);
+      }
     }
 
     isPrevDeform = (mti->type == eModifierTypeType_OnlyDeform);
@@ -1542,17 +1617,9 @@ static void editbmesh_calc_modifier_final_normals(Mesh *mesh_final,
    * (BKE_mesh_calc_normals_split() assumes that if that data exists, it is always valid). */
   if (do_poly_normals) {
     if (!CustomData_has_layer(&mesh_final->pdata, CD_NORMAL)) {
-      float(*polynors)[3] = (float(*)[3])CustomData_add_layer(
-          &mesh_final->pdata, CD_NORMAL, CD_CALLOC, nullptr, mesh_final->totpoly);
-      BKE_mesh_calc_normals_poly(mesh_final->mvert,
-                                 nullptr,
-                                 mesh_final->totvert,
-                                 mesh_final->mloop,
-                                 mesh_final->mpoly,
-                                 mesh_final->totloop,
-                                 mesh_final->totpoly,
-                                 polynors,
-                                 false);
+      const float(*polynors)[3] = BKE_mesh_poly_normals_ensure(mesh_final);
+      CustomData_add_layer(
+          &mesh_final->pdata, CD_NORMAL, CD_DUPLICATE, (void *)polynors, mesh_final->totpoly);
     }
   }
 
@@ -1891,6 +1958,60 @@ static void mesh_runtime_check_normals_valid(const Mesh *mesh)
   BLI_assert(!(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL));
 }
 
+/**
+ * Check whether the evaluated geometry of the object only depends on the state of the scene at
+ * the current frame, so that it can be stored in the playback cache and used again when the same
+ * frame is evaluated.
+ */
+static bool mesh_build_data_use_playback_cache(struct Depsgraph *depsgraph,
+                                               Scene *scene,
+                                               Object *ob)
+{
+  if (!BKE_geometry_playback_cache_is_enabled()) {
+    return false;
+  }
+  if (DEG_get_mode(depsgraph) != DAG_EVAL_VIEWPORT) {
+    return false;
+  }
+  if (ob->sculpt != nullptr || (ob->mode & OB_MODE_ALL_PAINT)) {
+    return false;
+  }
+  bool has_modifiers = false;
+  LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+    if (!BKE_modifier_is_enabled(scene, md, eModifierMode_Realtime)) {
+      continue;
+    }
+    /* These modifiers store state which is used by simulations of the following frames. */
+    if (ELEM(md->type, eModifierType_Collision, eModifierType_Surface)) {
+      return false;
+    }
+    has_modifiers = true;
+  }
+  if (!has_modifiers) {
+    /* Nothing to be saved, the result is the original mesh. */
+    return false;
+  }
+  /* Simulations depend on the previous frame. */
+  if (BKE_ptcache_object_has(scene, ob, 0)) {
+    return false;
+  }
+  return true;
+}
+
+static Mesh *mesh_build_data_detach_previous(Object *ob)
+{
+  ID *data_eval = ob->runtime.data_eval;
+  if (data_eval == nullptr || !ob->runtime.is_data_eval_owned || GS(data_eval->name) != ID_ME) {
+    return nullptr;
+  }
+  Mesh *mesh_eval_prev = (Mesh *)data_eval;
+  if (!BKE_mesh_batch_cache_can_transfer_deform(mesh_eval_prev)) {
+    return nullptr;
+  }
+  ob->runtime.data_eval = nullptr;
+  return mesh_eval_prev;
+}
+
 static void mesh_build_data(struct Depsgraph *depsgraph,
                             Scene *scene,
                             Object *ob,
@@ -1903,6 +2024,10 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * they aren't cleaned up properly on mode switch, causing crashes, e.g T58150. */
   BLI_assert(ob->id.tag & LIB_TAG_COPIED_ON_WRITE);
 
+  /* Keep the previous result around until the new one is evaluated, its draw cache can be reused
+   * when only vertex positions change (e.g. during armature playback). */
+  Mesh *mesh_eval_prev = mesh_build_data_detach_previous(ob);
+
   BKE_object_free_derived_caches(ob);
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
@@ -1919,18 +2044,27 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
 
   Mesh *mesh_eval = nullptr, *mesh_deform_eval = nullptr;
   GeometrySet *geometry_set_eval = nullptr;
-  mesh_calc_modifiers(depsgraph,
-                      scene,
-                      ob,
-                      1,
-                      need_mapping,
-                      dataMask,
-                      -1,
-                      true,
-                      true,
-                      &mesh_deform_eval,
-                      &mesh_eval,
-                      &geometry_set_eval);
+  const bool use_playback_cache = mesh_build_data_use_playback_cache(depsgraph, scene, ob);
+  if (!use_playback_cache ||
+      !BKE_geometry_playback_cache_lookup(
+          depsgraph, ob, dataMask, need_mapping, &mesh_eval, &mesh_deform_eval, &geometry_set_eval)) {
+    mesh_calc_modifiers(depsgraph,
+                        scene,
+                        ob,
+                        1,
+                        need_mapping,
+                        dataMask,
+                        -1,
+                        true,
+                        true,
+                        &mesh_deform_eval,
+                        &mesh_eval,
+                        &geometry_set_eval);
+    if (use_playback_cache && mesh_eval != ((Mesh *)ob->data)->runtime.mesh_eval) {
+      BKE_geometry_playback_cache_store(
+          depsgraph, ob, dataMask, need_mapping, mesh_eval, mesh_deform_eval, geometry_set_eval);
+    }
+  }
 
   /* The modifier stack evaluation is storing result in mesh->runtime.mesh_eval, but this result
    * is not guaranteed to be owned by object.
@@ -1968,6 +2102,14 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
 
   mesh_runtime_check_normals_valid(mesh_eval);
   mesh_build_extra_data(depsgraph, ob, mesh_eval);
+
+  if (mesh_eval_prev != nullptr) {
+    /* Data referenced from the input mesh is only known to be unchanged when it was not tagged. */
+    if (is_mesh_eval_owned && mesh->id.recalc == 0) {
+      BKE_mesh_batch_cache_transfer_deform(mesh_eval_prev, mesh_eval);
+    }
+    BKE_mesh_eval_delete(mesh_eval_prev);
+  }
 }
 
 static void editbmesh_build_data(struct Depsgraph *depsgraph,
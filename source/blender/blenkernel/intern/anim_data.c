@@ -258,6 +258,9 @@ void BKE_animdata_free(ID *id, const bool do_id_user)
       /* free driver array cache */
       MEM_SAFE_FREE(adt->driver_array);
 
+      /* free resolved path cache */
+      BKE_animsys_path_cache_free(adt);
+
       /* free overrides */
       /* TODO... */
 
@@ -357,6 +360,7 @@ AnimData *BKE_animdata_copy(Main *bmain, AnimData *adt, const int flag)
   /* duplicate drivers (F-Curves) */
   BKE_fcurves_copy(&dadt->drivers, &adt->drivers);
   dadt->driver_array = NULL;
+  dadt->path_cache = NULL;
 
   /* don't copy overrides */
   BLI_listbase_clear(&dadt->overrides);
@@ -1578,6 +1582,7 @@ void BKE_animdata_blend_read_data(BlendDataReader *reader, AnimData *adt)
   BLO_read_list(reader, &adt->drivers);
   BKE_fcurve_blend_read_data(reader, &adt->drivers);
   adt->driver_array = NULL;
+  adt->path_cache = NULL;
 
   /* link overrides */
   /* TODO... */
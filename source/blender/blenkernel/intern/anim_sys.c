@@ -73,6 +73,8 @@
 
 #include "nla_private.h"
 
+#include "PIL_time.h"
+
 #include "atomic_ops.h"
 
 #include "CLG_log.h"
@@ -425,6 +427,9 @@ bool BKE_animsys_store_rna_setting(PointerRNA *ptr,
   return success;
 }
 
+/* Number of F-Curves of an action which are evaluated together. */
+#define ANIMSYS_FCURVE_BATCH_SIZE 256
+
 /* less than 1.0 evaluates to false, use epsilon to avoid float error */
 #define ANIMSYS_FLOAT_AS_BOOL(value) ((value) > ((1.0f - FLT_EPSILON)))
 
@@ -590,38 +595,295 @@ static void animsys_write_orig_anim_rna(PointerRNA *ptr,
     return;
   }
   PathResolvedRNA orig_anim_rna;
-  /* TODO(sergey): Should be possible to cache resolved path in dependency graph somehow. */
   if (BKE_animsys_store_rna_setting(&ptr_orig, rna_path, array_index, &orig_anim_rna)) {
     BKE_animsys_write_rna_setting(&orig_anim_rna, value);
   }
 }
 
+/* ***************************************** */
+/* Resolved Path Cache */
+
+/* Resolving RNA paths involves string parsing and looking up structs by name, which takes a
+ * considerable part of the evaluation time of heavily animated data. Evaluated animation data
+ * stores the resolved paths of the F-Curves of its action and of its drivers, for both the
+ * evaluated and the original data-block.
+ *
+ * All entries are invalidated at once by bumping a global generation number whenever data-blocks
+ * are copied for evaluation or relations of a dependency graph are updated. Editing, renaming or
+ * removing anything an RNA path can point to goes through one of these. */
+
+typedef struct AnimPathCacheEntry {
+  /** Value of #animsys_path_cache_generation when the entry was filled, zero when unused. */
+  uint generation;
+  int array_index;
+  /** What the path was resolved for. */
+  const FCurve *fcu;
+  const char *rna_path;
+  const void *owner_data;
+
+  bool is_valid;
+  /** The original data-block is only resolved when writing to it is requested. */
+  bool is_orig_resolved;
+  bool is_orig_valid;
+
+  PathResolvedRNA anim_rna;
+  PathResolvedRNA orig_anim_rna;
+} AnimPathCacheEntry;
+
+typedef struct AnimDataPathCache {
+  /** One entry per F-Curve of the active action, allocated on first evaluation. */
+  AnimPathCacheEntry *action_entries;
+  int action_entries_num;
+  /** One entry per driver, so that drivers evaluated in parallel never share an entry. */
+  AnimPathCacheEntry *driver_entries;
+  int driver_entries_num;
+} AnimDataPathCache;
+
+static uint animsys_path_cache_generation = 1;
+
+/* Statistics, only gathered when dependency graph timing is enabled. */
+static struct {
+  uint64_t hits;
+  uint64_t misses;
+  /* In nanoseconds. */
+  uint64_t resolve_time;
+} animsys_path_cache_stats = {0};
+
+void BKE_animsys_path_cache_invalidate_all(void)
+{
+  uint generation = atomic_add_and_fetch_uint32(&animsys_path_cache_generation, 1);
+  if (UNLIKELY(generation == 0)) {
+    /* Zero is reserved for unused entries. */
+    atomic_add_and_fetch_uint32(&animsys_path_cache_generation, 1);
+  }
+}
+
+void BKE_animsys_path_cache_free(AnimData *adt)
+{
+  AnimDataPathCache *cache = adt->path_cache;
+  if (cache == NULL) {
+    return;
+  }
+  MEM_SAFE_FREE(cache->action_entries);
+  MEM_SAFE_FREE(cache->driver_entries);
+  MEM_freeN(cache);
+  adt->path_cache = NULL;
+}
+
+void BKE_animsys_path_cache_stats_print_and_reset(void)
+{
+  const uint64_t hits = animsys_path_cache_stats.hits;
+  const uint64_t misses = animsys_path_cache_stats.misses;
+  const uint64_t resolve_time = animsys_path_cache_stats.resolve_time;
+  if (hits + misses == 0) {
+    return;
+  }
+  /* Time which would have been spent on resolving the paths of the cache hits. */
+  const double resolve_avg = (misses != 0) ? (double)resolve_time / (double)misses : 0.0;
+  printf("Animation path cache: %llu hits, %llu misses, %.3f ms resolving, ~%.3f ms saved\n",
+         (unsigned long long)hits,
+         (unsigned long long)misses,
+         (double)resolve_time * 1e-6,
+         (double)hits * resolve_avg * 1e-6);
+
+  animsys_path_cache_stats.hits = 0;
+  animsys_path_cache_stats.misses = 0;
+  animsys_path_cache_stats.resolve_time = 0;
+}
+
+/* Get the cache entries of the F-Curves of the action, (re)allocating them when needed. */
+static AnimPathCacheEntry *animsys_path_cache_action_entries(AnimData *adt, bAction *act)
+{
+  AnimDataPathCache *cache = adt->path_cache;
+  if (cache == NULL || act == NULL) {
+    return NULL;
+  }
+  const int curves_num = BLI_listbase_count(&act->curves);
+  if (cache->action_entries_num != curves_num) {
+    MEM_SAFE_FREE(cache->action_entries);
+    cache->action_entries = (curves_num != 0) ? MEM_calloc_arrayN(curves_num,
+                                                                  sizeof(AnimPathCacheEntry),
+                                                                  "AnimPathCacheEntry action") :
+                                                NULL;
+    cache->action_entries_num = curves_num;
+  }
+  return cache->action_entries;
+}
+
+static AnimPathCacheEntry *animsys_path_cache_driver_entry(const AnimData *adt,
+                                                           const int driver_index)
+{
+  const AnimDataPathCache *cache = adt->path_cache;
+  if (cache == NULL || driver_index >= cache->driver_entries_num) {
+    return NULL;
+  }
+  return &cache->driver_entries[driver_index];
+}
+
+/**
+ * Same as #BKE_animsys_store_rna_setting for the path of the F-Curve, using the cache entry when
+ * it is still valid. The entry is optional.
+ */
+static bool animsys_path_cache_resolve(AnimPathCacheEntry *entry,
+                                       PointerRNA *ptr,
+                                       const FCurve *fcu,
+                                       PathResolvedRNA *r_anim_rna)
+{
+  if (entry == NULL) {
+    return BKE_animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, r_anim_rna);
+  }
+
+  const bool use_stats = (G.debug & G_DEBUG_DEPSGRAPH_TIME) != 0;
+  if (entry->generation == animsys_path_cache_generation && entry->fcu == fcu &&
+      entry->rna_path == fcu->rna_path && entry->array_index == fcu->array_index &&
+      entry->owner_data == ptr->data) {
+    if (use_stats) {
+      atomic_add_and_fetch_uint64(&animsys_path_cache_stats.hits, 1);
+    }
+    *r_anim_rna = entry->anim_rna;
+    return entry->is_valid;
+  }
+
+  const double start_time = use_stats ? PIL_check_seconds_timer() : 0.0;
+
+  entry->is_valid = BKE_animsys_store_rna_setting(
+      ptr, fcu->rna_path, fcu->array_index, &entry->anim_rna);
+  entry->is_orig_resolved = false;
+  entry->generation = animsys_path_cache_generation;
+  entry->fcu = fcu;
+  entry->rna_path = fcu->rna_path;
+  entry->array_index = fcu->array_index;
+  entry->owner_data = ptr->data;
+
+  if (use_stats) {
+    const double elapsed = PIL_check_seconds_timer() - start_time;
+    atomic_add_and_fetch_uint64(&animsys_path_cache_stats.misses, 1);
+    atomic_add_and_fetch_uint64(&animsys_path_cache_stats.resolve_time,
+                                (uint64_t)(elapsed * 1e9));
+  }
+
+  *r_anim_rna = entry->anim_rna;
+  return entry->is_valid;
+}
+
+/**
+ * Write the value to the original data-block, using the resolved path of the entry when the
+ * entry was resolved by #animsys_path_cache_resolve during this evaluation.
+ */
+static void animsys_write_orig_anim_rna_cached(AnimPathCacheEntry *entry,
+                                               PointerRNA *ptr,
+                                               const FCurve *fcu,
+                                               float value)
+{
+  if (entry == NULL) {
+    animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, value);
+    return;
+  }
+
+  if (!entry->is_orig_resolved) {
+    PointerRNA ptr_orig;
+    entry->is_orig_valid = animsys_construct_orig_pointer_rna(ptr, &ptr_orig) &&
+                           BKE_animsys_store_rna_setting(
+                               &ptr_orig, fcu->rna_path, fcu->array_index, &entry->orig_anim_rna);
+    /* ID properties of original data-blocks can be added and removed from Python without tagging
+     * anything for update, so they are resolved again every time. */
+    entry->is_orig_resolved = !entry->is_orig_valid ||
+                              !RNA_property_is_idprop(entry->orig_anim_rna.prop);
+    if (!entry->is_orig_resolved) {
+      BKE_animsys_write_rna_setting(&entry->orig_anim_rna, value);
+      return;
+    }
+  }
+
+  if (entry->is_orig_valid) {
+    BKE_animsys_write_rna_setting(&entry->orig_anim_rna, value);
+  }
+}
+
+/* Evaluate a batch of F-Curves and write their values. */
+static void animsys_evaluate_fcurves_batch(PointerRNA *ptr,
+                                           FCurve **fcurves,
+                                           PathResolvedRNA *anim_rnas,
+                                           AnimPathCacheEntry **cache_entries,
+                                           const int fcurves_num,
+                                           const AnimationEvalContext *anim_eval_context,
+                                           bool flush_to_original)
+{
+  float values[ANIMSYS_FCURVE_BATCH_SIZE];
+  BKE_fcurves_evaluate_batch(fcurves, fcurves_num, anim_eval_context->eval_time, values);
+
+  for (int i = 0; i < fcurves_num; i++) {
+    FCurve *fcu = fcurves[i];
+    /* Same as #calculate_fcurve(), curves without any data which warrants it write zero. */
+    if (BKE_fcurve_is_empty(fcu)) {
+      values[i] = 0.0f;
+    }
+    else {
+      fcu->curval = values[i]; /* Debug display only, not thread safe! */
+    }
+    BKE_animsys_write_rna_setting(&anim_rnas[i], values[i]);
+    if (flush_to_original) {
+      animsys_write_orig_anim_rna_cached(cache_entries[i], ptr, fcu, values[i]);
+    }
+  }
+}
+
 /**
  * Evaluate all the F-Curves in the given list
  * This performs a set of standard checks. If extra checks are required,
  * separate code should be used.
+ *
+ * \param cache_entries: Optional resolved path cache, with one entry per F-Curve in the list.
  */
 static void animsys_evaluate_fcurves(PointerRNA *ptr,
                                      ListBase *list,
+                                     AnimPathCacheEntry *cache_entries,
                                      const AnimationEvalContext *anim_eval_context,
                                      bool flush_to_original)
 {
-  /* Calculate then execute each curve. */
-  LISTBASE_FOREACH (FCurve *, fcu, list) {
+  /* Curves are evaluated in batches, which is faster than evaluating them one by one. */
+  FCurve *fcurves[ANIMSYS_FCURVE_BATCH_SIZE];
+  PathResolvedRNA anim_rnas[ANIMSYS_FCURVE_BATCH_SIZE];
+  AnimPathCacheEntry *batch_cache_entries[ANIMSYS_FCURVE_BATCH_SIZE];
+  int batch_len = 0;
+  int fcu_index = -1;
 
+  LISTBASE_FOREACH (FCurve *, fcu, list) {
+    fcu_index++;
     if (!is_fcurve_evaluatable(fcu)) {
       continue;
     }
+    /* Drivers are not stored in actions. */
+    BLI_assert(fcu->driver == NULL);
 
-    PathResolvedRNA anim_rna;
-    if (BKE_animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
-      const float curval = calculate_fcurve(&anim_rna, fcu, anim_eval_context);
-      BKE_animsys_write_rna_setting(&anim_rna, curval);
-      if (flush_to_original) {
-        animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
-      }
+    AnimPathCacheEntry *cache_entry = cache_entries ? &cache_entries[fcu_index] : NULL;
+    if (!animsys_path_cache_resolve(cache_entry, ptr, fcu, &anim_rnas[batch_len])) {
+      continue;
+    }
+    batch_cache_entries[batch_len] = cache_entry;
+    fcurves[batch_len++] = fcu;
+
+    if (batch_len == ANIMSYS_FCURVE_BATCH_SIZE) {
+      animsys_evaluate_fcurves_batch(ptr,
+                                     fcurves,
+                                     anim_rnas,
+                                     batch_cache_entries,
+                                     batch_len,
+                                     anim_eval_context,
+                                     flush_to_original);
+      batch_len = 0;
     }
   }
+
+  if (batch_len > 0) {
+    animsys_evaluate_fcurves_batch(ptr,
+                                   fcurves,
+                                   anim_rnas,
+                                   batch_cache_entries,
+                                   batch_len,
+                                   anim_eval_context,
+                                   flush_to_original);
+  }
 }
 
 /* ***************************************** */
@@ -758,6 +1020,7 @@ void animsys_evaluate_action_group(PointerRNA *ptr,
 /* Evaluate Action (F-Curve Bag) */
 static void animsys_evaluate_action_ex(PointerRNA *ptr,
                                        bAction *act,
+                                       AnimPathCacheEntry *cache_entries,
                                        const AnimationEvalContext *anim_eval_context,
                                        const bool flush_to_original)
 {
@@ -769,7 +1032,7 @@ static void animsys_evaluate_action_ex(PointerRNA *ptr,
   action_idcode_patch_check(ptr->owner_id, act);
 
   /* calculate then execute each curve */
-  animsys_evaluate_fcurves(ptr, &act->curves, anim_eval_context, flush_to_original);
+  animsys_evaluate_fcurves(ptr, &act->curves, cache_entries, anim_eval_context, flush_to_original);
 }
 
 void animsys_evaluate_action(PointerRNA *ptr,
@@ -777,7 +1040,7 @@ void animsys_evaluate_action(PointerRNA *ptr,
                              const AnimationEvalContext *anim_eval_context,
                              const bool flush_to_original)
 {
-  animsys_evaluate_action_ex(ptr, act, anim_eval_context, flush_to_original);
+  animsys_evaluate_action_ex(ptr, act, NULL, anim_eval_context, flush_to_original);
 }
 
 /* ***************************************** */
@@ -817,7 +1080,8 @@ static void nlastrip_evaluate_controls(NlaStrip *strip,
     RNA_pointer_create(NULL, &RNA_NlaStrip, strip, &strip_ptr);
 
     /* execute these settings as per normal */
-    animsys_evaluate_fcurves(&strip_ptr, &strip->fcurves, anim_eval_context, flush_to_original);
+    animsys_evaluate_fcurves(
+        &strip_ptr, &strip->fcurves, NULL, anim_eval_context, flush_to_original);
   }
 
   /* analytically generate values for influence and time (if applicable)
@@ -1720,6 +1984,36 @@ static void nlaeval_fmodifiers_split_stacks(ListBase *list1, ListBase *list2)
 
 /* ---------------------- */
 
+static void nlasnapshot_from_action_batch(ListBase *modifiers,
+                                          FModifiersStackStorage *storage,
+                                          FCurve **fcurves,
+                                          NlaEvalChannel **channels,
+                                          const int fcurves_num,
+                                          const float evaltime,
+                                          const float modified_evaltime,
+                                          NlaEvalSnapshot *r_snapshot)
+{
+  float values[ANIMSYS_FCURVE_BATCH_SIZE];
+  BKE_fcurves_evaluate_batch(fcurves, fcurves_num, modified_evaltime, values);
+
+  for (int i = 0; i < fcurves_num; i++) {
+    FCurve *fcu = fcurves[i];
+    NlaEvalChannel *nec = channels[i];
+    NlaEvalChannelSnapshot *necs = nlaeval_snapshot_ensure_channel(r_snapshot, nec);
+
+    float value = values[i];
+    evaluate_value_fmodifiers(storage, modifiers, fcu, &value, evaltime);
+    necs->values[fcu->array_index] = value;
+
+    if (nec->mix_mode == NEC_MIX_QUATERNION) {
+      BLI_bitmap_set_all(necs->blend_domain.ptr, true, 4);
+    }
+    else {
+      BLI_BITMAP_ENABLE(necs->blend_domain.ptr, fcu->array_index);
+    }
+  }
+}
+
 /** Fills \a r_snapshot with the \a action's evaluated fcurve values with modifiers applied. */
 static void nlasnapshot_from_action(PointerRNA *ptr,
                                     NlaEvalData *channels,
@@ -1741,6 +2035,11 @@ static void nlasnapshot_from_action(PointerRNA *ptr,
   const float modified_evaltime = evaluate_time_fmodifiers(
       &storage, modifiers, NULL, 0.0f, evaltime);
 
+  /* Curves are evaluated in batches, which is faster than evaluating them one by one. */
+  FCurve *fcurves[ANIMSYS_FCURVE_BATCH_SIZE];
+  NlaEvalChannel *fcurve_channels[ANIMSYS_FCURVE_BATCH_SIZE];
+  int batch_len = 0;
+
   for (fcu = action->curves.first; fcu; fcu = fcu->next) {
     if (!is_fcurve_evaluatable(fcu)) {
       continue;
@@ -1757,19 +2056,33 @@ static void nlasnapshot_from_action(PointerRNA *ptr,
       continue;
     }
 
-    NlaEvalChannelSnapshot *necs = nlaeval_snapshot_ensure_channel(r_snapshot, nec);
+    fcurves[batch_len] = fcu;
+    fcurve_channels[batch_len] = nec;
+    batch_len++;
 
-    float value = evaluate_fcurve(fcu, modified_evaltime);
-    evaluate_value_fmodifiers(&storage, modifiers, fcu, &value, evaltime);
-    necs->values[fcu->array_index] = value;
-
-    if (nec->mix_mode == NEC_MIX_QUATERNION) {
-      BLI_bitmap_set_all(necs->blend_domain.ptr, true, 4);
-    }
-    else {
-      BLI_BITMAP_ENABLE(necs->blend_domain.ptr, fcu->array_index);
+    if (batch_len == ANIMSYS_FCURVE_BATCH_SIZE) {
+      nlasnapshot_from_action_batch(modifiers,
+                                    &storage,
+                                    fcurves,
+                                    fcurve_channels,
+                                    batch_len,
+                                    evaltime,
+                                    modified_evaltime,
+                                    r_snapshot);
+      batch_len = 0;
     }
   }
+
+  if (batch_len > 0) {
+    nlasnapshot_from_action_batch(modifiers,
+                                  &storage,
+                                  fcurves,
+                                  fcurve_channels,
+                                  batch_len,
+                                  evaltime,
+                                  modified_evaltime,
+                                  r_snapshot);
+  }
 }
 
 /* evaluate action-clip strip */
@@ -2850,7 +3163,9 @@ void BKE_animsys_evaluate_animdata(ID *id,
     }
     /* evaluate Active Action only */
     else if (adt->action) {
-      animsys_evaluate_action_ex(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      AnimPathCacheEntry *cache_entries = animsys_path_cache_action_entries(adt, adt->action);
+      animsys_evaluate_action_ex(
+          &id_ptr, adt->action, cache_entries, anim_eval_context, flush_to_original);
     }
   }
 
@@ -3062,6 +3377,20 @@ void BKE_animsys_update_driver_array(ID *id)
       adt->driver_array[driver_index++] = fcu;
     }
   }
+
+  /* Only evaluated copies cache resolved paths, since nothing guarantees that the pointers into
+   * original data stay valid when it is evaluated outside of a dependency graph. */
+  if (adt) {
+    BLI_assert(!adt->path_cache);
+
+    AnimDataPathCache *cache = MEM_callocN(sizeof(AnimDataPathCache), "AnimDataPathCache");
+    cache->driver_entries_num = BLI_listbase_count(&adt->drivers);
+    if (cache->driver_entries_num != 0) {
+      cache->driver_entries = MEM_calloc_arrayN(
+          cache->driver_entries_num, sizeof(AnimPathCacheEntry), "AnimPathCacheEntry driver");
+    }
+    adt->path_cache = cache;
+  }
 }
 
 void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCurve *fcu_orig)
@@ -3082,6 +3411,7 @@ void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCu
   else {
     fcu = BLI_findlink(&adt->drivers, driver_index);
   }
+  AnimPathCacheEntry *cache_entry = animsys_path_cache_driver_entry(adt, driver_index);
 
   DEG_debug_print_eval_subdata_index(
       depsgraph, __func__, id->name, id, "fcu", fcu->rna_path, fcu, fcu->array_index);
@@ -3100,7 +3430,7 @@ void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCu
       // printf("\told val = %f\n", fcu->curval);
 
       PathResolvedRNA anim_rna;
-      if (BKE_animsys_store_rna_setting(&id_ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
+      if (animsys_path_cache_resolve(cache_entry, &id_ptr, fcu, &anim_rna)) {
         /* Evaluate driver, and write results to COW-domain destination */
         const float ctime = DEG_get_ctime(depsgraph);
         const AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(
@@ -3110,7 +3440,7 @@ void BKE_animsys_eval_driver(Depsgraph *depsgraph, ID *id, int driver_index, FCu
 
         /* Flush results & status codes to original data for UI (T59984) */
         if (ok && DEG_is_active(depsgraph)) {
-          animsys_write_orig_anim_rna(&id_ptr, fcu->rna_path, fcu->array_index, curval);
+          animsys_write_orig_anim_rna_cached(cache_entry, &id_ptr, fcu, curval);
 
           /* curval is displayed in the UI, and flag contains error-status codes */
           fcu_orig->curval = fcu->curval;
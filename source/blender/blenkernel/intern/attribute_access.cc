@@ -219,6 +219,17 @@ class VertexWeightReadAttribute final : public ReadAttribute {
   {
     VertexWeightWriteAttribute::get_internal(dverts_, dvert_index_, index, r_value);
   }
+
+  void initialize_span() const override
+  {
+    /* Avoid a virtual call per vertex. */
+    float *weights = (float *)MEM_mallocN_aligned(size_ * sizeof(float), alignof(float), __func__);
+    for (const int64_t i : IndexRange(size_)) {
+      VertexWeightWriteAttribute::get_internal(dverts_, dvert_index_, i, weights + i);
+    }
+    array_buffer_ = weights;
+    array_is_temporary_ = true;
+  }
 };
 
 template<typename T> class ArrayWriteAttribute final : public WriteAttribute {
@@ -374,6 +385,32 @@ class DerivedArrayWriteAttribute final : public WriteAttribute {
     const ElemT &typed_value = *reinterpret_cast<const ElemT *>(value);
     SetFunc(struct_value, typed_value);
   }
+
+  /* Copy between the structs and the temporary array directly, without a virtual call per
+   * element. */
+  void initialize_span(const bool write_only) override
+  {
+    ElemT *array = (ElemT *)MEM_mallocN_aligned(size_ * sizeof(ElemT), alignof(ElemT), __func__);
+    if (write_only) {
+      cpp_type_.construct_default_n(array, size_);
+    }
+    else {
+      for (const int64_t i : data_.index_range()) {
+        new (array + i) ElemT(GetFunc(data_[i]));
+      }
+    }
+    array_buffer_ = array;
+    array_is_temporary_ = true;
+  }
+
+  void apply_span_if_necessary() override
+  {
+    BLI_assert(array_buffer_ != nullptr);
+    const ElemT *array = static_cast<const ElemT *>(array_buffer_);
+    for (const int64_t i : data_.index_range()) {
+      SetFunc(data_[i], array[i]);
+    }
+  }
 };
 
 template<typename StructT, typename ElemT, ElemT (*GetFunc)(const StructT &)>
@@ -393,6 +430,17 @@ class DerivedArrayReadAttribute final : public ReadAttribute {
     const ElemT value = GetFunc(struct_value);
     new (r_value) ElemT(value);
   }
+
+  void initialize_span() const override
+  {
+    /* Avoid a virtual call per element. */
+    ElemT *array = (ElemT *)MEM_mallocN_aligned(size_ * sizeof(ElemT), alignof(ElemT), __func__);
+    for (const int64_t i : data_.index_range()) {
+      new (array + i) ElemT(GetFunc(data_[i]));
+    }
+    array_buffer_ = array;
+    array_is_temporary_ = true;
+  }
 };
 
 class ConstantReadAttribute final : public ReadAttribute {
@@ -460,6 +508,16 @@ class ConvertedReadAttribute final : public ReadAttribute {
     base_attribute_->get(index, buffer.ptr());
     conversions_.convert(from_type_, to_type_, buffer.ptr(), r_value);
   }
+
+  void initialize_span() const override
+  {
+    /* Convert all values at once, which is much faster than converting them one by one. The span
+     * of the base attribute is usually the attribute array itself. */
+    const fn::GSpan base_span = base_attribute_->get_span();
+    array_buffer_ = MEM_mallocN_aligned(size_ * to_type_.size(), to_type_.alignment(), __func__);
+    array_is_temporary_ = true;
+    conversions_.convert(base_span, fn::GMutableSpan(to_type_, array_buffer_, size_));
+  }
 };
 
 /** \} */
@@ -4273,6 +4273,21 @@ int CustomData_sizeof(int type)
   return typeInfo->size;
 }
 
+/**
+ * Approximate memory used by the allocated layers, in bytes.
+ */
+size_t CustomData_memory_size(const CustomData *data, int totelem)
+{
+  size_t size = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    if (layer->data != NULL) {
+      size += (size_t)CustomData_sizeof(layer->type) * (size_t)totelem;
+    }
+  }
+  return size;
+}
+
 const char *CustomData_layertype_name(int type)
 {
   return layerType_getName(type);
@@ -1760,115 +1760,51 @@ static float fcurve_eval_keyframes_extrapolate(
   return endpoint_bezt->vec[1][1] - (fac * dx);
 }
 
-static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, float evaltime)
-{
-  const float eps = 1.e-8f;
-  BezTriple *bezt, *prevbezt;
-  unsigned int a;
-
-  /* Evaltime occurs somewhere in the middle of the curve. */
-  bool exact = false;
-
-  /* Use binary search to find appropriate keyframes...
-   *
-   * The threshold here has the following constraints:
-   * - 0.001 is too coarse:
-   *   We get artifacts with 2cm driver movements at 1BU = 1m (see T40332).
-   *
-   * - 0.00001 is too fine:
-   *   Weird errors, like selecting the wrong keyframe range (see T39207), occur.
-   *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
-   */
-  a = BKE_fcurve_bezt_binarysearch_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
-  bezt = bezts + a;
-
-  if (exact) {
-    /* Index returned must be interpreted differently when it sits on top of an existing keyframe
-     * - That keyframe is the start of the segment we need (see action_bug_2.blend in T39207).
-     */
-    return bezt->vec[1][1];
-  }
-
-  /* Index returned refers to the keyframe that the eval-time occurs *before*
-   * - hence, that keyframe marks the start of the segment we're dealing with.
-   */
-  prevbezt = (a > 0) ? (bezt - 1) : bezt;
+/**
+ * Threshold used to find the keyframe segment containing the evaluation time.
+ *
+ * The threshold here has the following constraints:
+ * - 0.001 is too coarse:
+ *   We get artifacts with 2cm driver movements at 1BU = 1m (see T40332).
+ *
+ * - 0.00001 is too fine:
+ *   Weird errors, like selecting the wrong keyframe range (see T39207), occur.
+ *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
+ */
+#define FCURVE_EVAL_SEGMENT_THRESH 0.0001f
 
-  /* Use if the key is directly on the frame, in rare cases this is needed else we get 0.0 instead.
-   * XXX: consult T39207 for examples of files where failure of these checks can cause issues. */
-  if (fabsf(bezt->vec[1][0] - evaltime) < eps) {
-    return bezt->vec[1][1];
-  }
+/* Solve the Bezier segment defined by the control points `v` for the value at `evaltime`. */
+static float fcurve_eval_bezier_segment(const float v[4][2], const float evaltime)
+{
+  float opl[32];
 
-  if (evaltime < prevbezt->vec[1][0] || bezt->vec[1][0] < evaltime) {
+  /* Try to get a value for this position - if failure, try another set of points. */
+  if (!findzero(evaltime, v[0][0], v[1][0], v[2][0], v[3][0], opl)) {
     if (G.debug & G_DEBUG) {
-      printf("   ERROR: failed eval - p=%f b=%f, t=%f (%f)\n",
-             prevbezt->vec[1][0],
-             bezt->vec[1][0],
+      printf("    ERROR: findzero() failed at %f with %f %f %f %f\n",
              evaltime,
-             fabsf(bezt->vec[1][0] - evaltime));
+             v[0][0],
+             v[1][0],
+             v[2][0],
+             v[3][0]);
     }
-    return 0.0f;
+    return 0.0;
   }
 
-  /* Evaltime occurs within the interval defined by these two keyframes. */
-  const float begin = prevbezt->vec[1][1];
-  const float change = bezt->vec[1][1] - prevbezt->vec[1][1];
-  const float duration = bezt->vec[1][0] - prevbezt->vec[1][0];
-  const float time = evaltime - prevbezt->vec[1][0];
+  berekeny(v[0][1], v[1][1], v[2][1], v[3][1], opl, 1);
+  return opl[0];
+}
+
+static float fcurve_eval_keyframes_easing(const BezTriple *prevbezt,
+                                          const float time,
+                                          const float begin,
+                                          const float change,
+                                          const float duration)
+{
   const float amplitude = prevbezt->amplitude;
   const float period = prevbezt->period;
 
-  /* Value depends on interpolation mode. */
-  if ((prevbezt->ipo == BEZT_IPO_CONST) || (fcu->flag & FCURVE_DISCRETE_VALUES) ||
-      (duration == 0)) {
-    /* Constant (evaltime not relevant, so no interpolation needed). */
-    return prevbezt->vec[1][1];
-  }
-
   switch (prevbezt->ipo) {
-    /* Interpolation ...................................... */
-    case BEZT_IPO_BEZ: {
-      float v1[2], v2[2], v3[2], v4[2], opl[32];
-
-      /* Bezier interpolation. */
-      /* (v1, v2) are the first keyframe and its 2nd handle. */
-      v1[0] = prevbezt->vec[1][0];
-      v1[1] = prevbezt->vec[1][1];
-      v2[0] = prevbezt->vec[2][0];
-      v2[1] = prevbezt->vec[2][1];
-      /* (v3, v4) are the last keyframe's 1st handle + the last keyframe. */
-      v3[0] = bezt->vec[0][0];
-      v3[1] = bezt->vec[0][1];
-      v4[0] = bezt->vec[1][0];
-      v4[1] = bezt->vec[1][1];
-
-      if (fabsf(v1[1] - v4[1]) < FLT_EPSILON && fabsf(v2[1] - v3[1]) < FLT_EPSILON &&
-          fabsf(v3[1] - v4[1]) < FLT_EPSILON) {
-        /* Optimization: If all the handles are flat/at the same values,
-         * the value is simply the shared value (see T40372 -> F91346).
-         */
-        return v1[1];
-      }
-      /* Adjust handles so that they don't overlap (forming a loop). */
-      BKE_fcurve_correct_bezpart(v1, v2, v3, v4);
-
-      /* Try to get a value for this position - if failure, try another set of points. */
-      if (!findzero(evaltime, v1[0], v2[0], v3[0], v4[0], opl)) {
-        if (G.debug & G_DEBUG) {
-          printf("    ERROR: findzero() failed at %f with %f %f %f %f\n",
-                 evaltime,
-                 v1[0],
-                 v2[0],
-                 v3[0],
-                 v4[0]);
-        }
-        return 0.0;
-      }
-
-      berekeny(v1[1], v2[1], v3[1], v4[1], opl, 1);
-      return opl[0];
-    }
     case BEZT_IPO_LIN:
       /* Linear - simply linearly interpolate between values of the two keyframes. */
       return BLI_easing_linear_ease(time, begin, change, duration);
@@ -2021,6 +1957,115 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
   return 0.0f;
 }
 
+/**
+ * Evaluate the segment between two keyframes, `evaltime` is expected to be between them.
+ *
+ * When `r_bezier` is given, Bezier segments are not solved. The control points of the segment are
+ * returned instead and the function returns false, see #BKE_fcurves_evaluate_batch().
+ */
+static bool fcurve_eval_keyframes_segment(const FCurve *fcu,
+                                          const BezTriple *prevbezt,
+                                          const BezTriple *bezt,
+                                          const float evaltime,
+                                          float r_bezier[4][2],
+                                          float *r_value)
+{
+  const float eps = 1.e-8f;
+
+  /* Use if the key is directly on the frame, in rare cases this is needed else we get 0.0 instead.
+   * XXX: consult T39207 for examples of files where failure of these checks can cause issues. */
+  if (fabsf(bezt->vec[1][0] - evaltime) < eps) {
+    *r_value = bezt->vec[1][1];
+    return true;
+  }
+
+  if (evaltime < prevbezt->vec[1][0] || bezt->vec[1][0] < evaltime) {
+    if (G.debug & G_DEBUG) {
+      printf("   ERROR: failed eval - p=%f b=%f, t=%f (%f)\n",
+             prevbezt->vec[1][0],
+             bezt->vec[1][0],
+             evaltime,
+             fabsf(bezt->vec[1][0] - evaltime));
+    }
+    *r_value = 0.0f;
+    return true;
+  }
+
+  /* Evaltime occurs within the interval defined by these two keyframes. */
+  const float begin = prevbezt->vec[1][1];
+  const float change = bezt->vec[1][1] - prevbezt->vec[1][1];
+  const float duration = bezt->vec[1][0] - prevbezt->vec[1][0];
+  const float time = evaltime - prevbezt->vec[1][0];
+
+  /* Value depends on interpolation mode. */
+  if ((prevbezt->ipo == BEZT_IPO_CONST) || (fcu->flag & FCURVE_DISCRETE_VALUES) ||
+      (duration == 0)) {
+    /* Constant (evaltime not relevant, so no interpolation needed). */
+    *r_value = prevbezt->vec[1][1];
+    return true;
+  }
+
+  if (prevbezt->ipo == BEZT_IPO_BEZ) {
+    float v[4][2];
+
+    /* Bezier interpolation. */
+    /* (v1, v2) are the first keyframe and its 2nd handle. */
+    copy_v2_v2(v[0], prevbezt->vec[1]);
+    copy_v2_v2(v[1], prevbezt->vec[2]);
+    /* (v3, v4) are the last keyframe's 1st handle + the last keyframe. */
+    copy_v2_v2(v[2], bezt->vec[0]);
+    copy_v2_v2(v[3], bezt->vec[1]);
+
+    if (fabsf(v[0][1] - v[3][1]) < FLT_EPSILON && fabsf(v[1][1] - v[2][1]) < FLT_EPSILON &&
+        fabsf(v[2][1] - v[3][1]) < FLT_EPSILON) {
+      /* Optimization: If all the handles are flat/at the same values,
+       * the value is simply the shared value (see T40372 -> F91346).
+       */
+      *r_value = v[0][1];
+      return true;
+    }
+    /* Adjust handles so that they don't overlap (forming a loop). */
+    BKE_fcurve_correct_bezpart(v[0], v[1], v[2], v[3]);
+
+    if (r_bezier != NULL) {
+      memcpy(r_bezier, v, sizeof(v));
+      return false;
+    }
+    *r_value = fcurve_eval_bezier_segment(v, evaltime);
+    return true;
+  }
+
+  *r_value = fcurve_eval_keyframes_easing(prevbezt, time, begin, change, duration);
+  return true;
+}
+
+static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, float evaltime)
+{
+  /* Evaltime occurs somewhere in the middle of the curve. */
+  bool exact = false;
+
+  /* Use binary search to find appropriate keyframes. */
+  const int a = BKE_fcurve_bezt_binarysearch_index_ex(
+      bezts, evaltime, fcu->totvert, FCURVE_EVAL_SEGMENT_THRESH, &exact);
+  BezTriple *bezt = bezts + a;
+
+  if (exact) {
+    /* Index returned must be interpreted differently when it sits on top of an existing keyframe
+     * - That keyframe is the start of the segment we need (see action_bug_2.blend in T39207).
+     */
+    return bezt->vec[1][1];
+  }
+
+  /* Index returned refers to the keyframe that the eval-time occurs *before*
+   * - hence, that keyframe marks the start of the segment we're dealing with.
+   */
+  BezTriple *prevbezt = (a > 0) ? (bezt - 1) : bezt;
+
+  float value;
+  fcurve_eval_keyframes_segment(fcu, prevbezt, bezt, evaltime, NULL, &value);
+  return value;
+}
+
 /* Calculate F-Curve value for 'evaltime' using #BezTriple keyframes. */
 static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime)
 {
@@ -2214,6 +2259,206 @@ float calculate_fcurve(PathResolvedRNA *anim_rna,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name F-Curve - Batch Evaluation
+ *
+ * Evaluating many F-Curves one by one is dominated by finding the keyframe segment and solving the
+ * Bezier segment for the time parameter. The batch evaluation reuses the segment of the previous
+ * curve when its keyframes are on the same frames (as is typical for baked or crowd animation), and
+ * solves all Bezier segments of a chunk together, in loops which the compiler can vectorize.
+ * \{ */
+
+/** Number of curves evaluated together, so that the temporary data fits on the stack. */
+#define FCURVE_BATCH_CHUNK_SIZE 64
+/** Newton iterations to find the time parameter of Bezier segments. */
+#define FCURVE_BATCH_NEWTON_STEPS 8
+/** Maximum error of the solution (relative to the segment duration) before falling back to the
+ * analytic solution. */
+#define FCURVE_BATCH_NEWTON_TOLERANCE 1e-9
+
+typedef struct FCurveBezierBatch {
+  int len;
+  /** Index of the curve in the chunk. */
+  int curve_index[FCURVE_BATCH_CHUNK_SIZE];
+  /** Coordinates of the control points of the segments, after handle correction. */
+  float x[4][FCURVE_BATCH_CHUNK_SIZE];
+  float y[4][FCURVE_BATCH_CHUNK_SIZE];
+} FCurveBezierBatch;
+
+/**
+ * The curve is monotonic in X when the derivative (a quadratic Bezier with these coefficients)
+ * is not negative, there is a single solution then.
+ */
+static bool fcurve_bezier_is_monotonic(const float v[4][2])
+{
+  const float a = v[1][0] - v[0][0];
+  const float b = v[2][0] - v[1][0];
+  const float c = v[3][0] - v[2][0];
+  return (a >= 0.0f) && (c >= 0.0f) && ((b >= 0.0f) || (b * b <= a * c));
+}
+
+static void fcurve_bezier_batch_solve(const FCurveBezierBatch *batch,
+                                      const float evaltime,
+                                      float *r_values)
+{
+  const int len = batch->len;
+  double c0[FCURVE_BATCH_CHUNK_SIZE], c1[FCURVE_BATCH_CHUNK_SIZE], c2[FCURVE_BATCH_CHUNK_SIZE],
+      c3[FCURVE_BATCH_CHUNK_SIZE], t[FCURVE_BATCH_CHUNK_SIZE];
+
+  /* Same polynomial as #findzero(), the evaluation time is in the segment. */
+  for (int i = 0; i < len; i++) {
+    const float x0 = batch->x[0][i], x1 = batch->x[1][i], x2 = batch->x[2][i],
+                x3 = batch->x[3][i];
+    c0[i] = x0 - evaltime;
+    c1[i] = 3.0f * (x1 - x0);
+    c2[i] = 3.0f * (x0 - 2.0f * x1 + x2);
+    c3[i] = x3 - x0 + 3.0f * (x1 - x2);
+    t[i] = (double)(evaltime - x0) / (double)(x3 - x0);
+  }
+
+  for (int step = 0; step < FCURVE_BATCH_NEWTON_STEPS; step++) {
+    for (int i = 0; i < len; i++) {
+      const double f = c0[i] + t[i] * (c1[i] + t[i] * (c2[i] + t[i] * c3[i]));
+      const double df = c1[i] + t[i] * (2.0 * c2[i] + t[i] * 3.0 * c3[i]);
+      const double t_next = (df != 0.0) ? t[i] - f / df : t[i];
+      t[i] = min_dd(max_dd(t_next, 0.0), 1.0);
+    }
+  }
+
+  for (int i = 0; i < len; i++) {
+    const double f = c0[i] + t[i] * (c1[i] + t[i] * (c2[i] + t[i] * c3[i]));
+    const double tolerance = FCURVE_BATCH_NEWTON_TOLERANCE * (batch->x[3][i] - batch->x[0][i]);
+    float value;
+
+    if (fabs(f) <= tolerance) {
+      float o = (float)t[i];
+      berekeny(batch->y[0][i], batch->y[1][i], batch->y[2][i], batch->y[3][i], &o, 1);
+      value = o;
+    }
+    else {
+      /* Not converged (e.g. zero length handles), use the analytic solution. */
+      const float v[4][2] = {
+          {batch->x[0][i], batch->y[0][i]},
+          {batch->x[1][i], batch->y[1][i]},
+          {batch->x[2][i], batch->y[2][i]},
+          {batch->x[3][i], batch->y[3][i]},
+      };
+      value = fcurve_eval_bezier_segment(v, evaltime);
+    }
+    r_values[batch->curve_index[i]] = value;
+  }
+}
+
+/**
+ * Same as #fcurve_eval_keyframes(), except that Bezier segments are added to the batch instead of
+ * being solved. \a r_segment is the index of the segment that was used, and can be reused.
+ */
+static void fcurve_eval_keyframes_batched(FCurve *fcu,
+                                          const float evaltime,
+                                          const int curve_index,
+                                          int *r_segment,
+                                          FCurveBezierBatch *batch,
+                                          float *r_values)
+{
+  BezTriple *bezts = fcu->bezt;
+  float *r_value = &r_values[curve_index];
+
+  if (evaltime <= bezts->vec[1][0]) {
+    *r_value = fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, 0, +1);
+    return;
+  }
+  BezTriple *lastbezt = bezts + fcu->totvert - 1;
+  if (lastbezt->vec[1][0] <= evaltime) {
+    *r_value = fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, fcu->totvert - 1, -1);
+    return;
+  }
+
+  /* The segment of the previous curve is valid when no keyframe is within the search threshold
+   * of the evaluation time, which is what the binary search would find as well. */
+  int a = *r_segment;
+  if (!(a > 0 && a < fcu->totvert &&
+        evaltime - bezts[a - 1].vec[1][0] > FCURVE_EVAL_SEGMENT_THRESH &&
+        bezts[a].vec[1][0] - evaltime > FCURVE_EVAL_SEGMENT_THRESH)) {
+    bool exact = false;
+    a = BKE_fcurve_bezt_binarysearch_index_ex(
+        bezts, evaltime, fcu->totvert, FCURVE_EVAL_SEGMENT_THRESH, &exact);
+    *r_segment = a;
+    if (exact) {
+      *r_value = bezts[a].vec[1][1];
+      return;
+    }
+  }
+
+  BezTriple *bezt = bezts + a;
+  BezTriple *prevbezt = (a > 0) ? (bezt - 1) : bezt;
+
+  float v[4][2];
+  if (fcurve_eval_keyframes_segment(fcu, prevbezt, bezt, evaltime, v, r_value)) {
+    return;
+  }
+  if (!fcurve_bezier_is_monotonic(v)) {
+    /* Several solutions are possible, use the same one as the regular evaluation. */
+    *r_value = fcurve_eval_bezier_segment(v, evaltime);
+    return;
+  }
+
+  const int i = batch->len++;
+  batch->curve_index[i] = curve_index;
+  for (int j = 0; j < 4; j++) {
+    batch->x[j][i] = v[j][0];
+    batch->y[j][i] = v[j][1];
+  }
+}
+
+static void fcurves_evaluate_chunk(FCurve **fcurves,
+                                   const int fcurves_num,
+                                   const float evaltime,
+                                   float *r_values)
+{
+  FCurveBezierBatch batch;
+  batch.len = 0;
+  int segment = -1;
+
+  for (int i = 0; i < fcurves_num; i++) {
+    FCurve *fcu = fcurves[i];
+    BLI_assert(fcu->driver == NULL);
+
+    if (fcu->bezt == NULL || fcu->totvert == 0 || !BLI_listbase_is_empty(&fcu->modifiers)) {
+      r_values[i] = evaluate_fcurve(fcu, evaltime);
+      continue;
+    }
+    fcurve_eval_keyframes_batched(fcu, evaltime, i, &segment, &batch, r_values);
+  }
+
+  fcurve_bezier_batch_solve(&batch, evaltime, r_values);
+
+  for (int i = 0; i < fcurves_num; i++) {
+    /* Same as #evaluate_fcurve_ex(), rounding again is harmless for the other curves. */
+    if (fcurves[i]->flag & FCURVE_INT_VALUES) {
+      r_values[i] = floorf(r_values[i] + 0.5f);
+    }
+  }
+}
+
+/**
+ * Evaluate multiple F-Curves without drivers at the same time, giving the same result as
+ * #evaluate_fcurve() for each of them, except for Bezier segments. Those are solved iteratively
+ * instead of analytically, the values differ by rounding errors, in the order of 1e-6 relative to
+ * the largest value of the keyframes and handles of the segment.
+ */
+void BKE_fcurves_evaluate_batch(FCurve **fcurves,
+                                const int fcurves_num,
+                                const float evaltime,
+                                float *r_values)
+{
+  for (int start = 0; start < fcurves_num; start += FCURVE_BATCH_CHUNK_SIZE) {
+    const int chunk_len = min_ii(FCURVE_BATCH_CHUNK_SIZE, fcurves_num - start);
+    fcurves_evaluate_chunk(fcurves + start, chunk_len, evaltime, r_values + start);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name F-Curve - .blend file API
  * \{ */
@@ -26,6 +26,11 @@
 
 #include "DNA_anim_types.h"
 
+#include "BLI_math_base.h"
+#include "BLI_rand.h"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
 namespace blender::bke::tests {
 
 /* Epsilon for floating point comparisons. */
@@ -362,4 +367,113 @@ TEST(BKE_fcurve, BKE_fcurve_keyframe_move_value_with_handles)
   BKE_fcurve_free(fcu);
 }
 
+/* Curves with keyframes on the same frames, but different values and handles. */
+static Vector<FCurve *> test_fcurves_create(const int fcurves_num, const int keys_num)
+{
+  RNG *rng = BLI_rng_new(47);
+  Vector<FCurve *> fcurves;
+  for (int i = 0; i < fcurves_num; i++) {
+    FCurve *fcu = BKE_fcurve_create();
+    for (int key = 0; key < keys_num; key++) {
+      insert_vert_fcurve(fcu,
+                         (float)(key * 5),
+                         BLI_rng_get_float(rng) * 10.0f,
+                         BEZT_KEYTYPE_KEYFRAME,
+                         INSERTKEY_NO_USERPREF);
+    }
+    for (int key = 0; key < keys_num; key++) {
+      BezTriple *bezt = &fcu->bezt[key];
+      /* Free handles, including ones which are longer than the segment or cross each other. */
+      bezt->vec[0][0] += (BLI_rng_get_float(rng) - 0.5f) * 6.0f;
+      bezt->vec[0][1] += (BLI_rng_get_float(rng) - 0.5f) * 6.0f;
+      bezt->vec[2][0] += (BLI_rng_get_float(rng) - 0.5f) * 6.0f;
+      bezt->vec[2][1] += (BLI_rng_get_float(rng) - 0.5f) * 6.0f;
+      if (i % 7 == 3) {
+        bezt->ipo = BEZT_IPO_LIN;
+      }
+    }
+    if (i % 5 == 1) {
+      fcu->extend = FCURVE_EXTRAPOLATE_LINEAR;
+    }
+    if (i % 11 == 2) {
+      fcu->flag |= FCURVE_INT_VALUES;
+    }
+    if (i % 13 == 4) {
+      add_fmodifier(&fcu->modifiers, FMODIFIER_TYPE_CYCLES, fcu);
+    }
+    fcurves.append(fcu);
+  }
+  BLI_rng_free(rng);
+  return fcurves;
+}
+
+TEST(evaluate_fcurve, BatchMatchesSingle)
+{
+  const int keys_num = 6;
+  Vector<FCurve *> fcurves = test_fcurves_create(200, keys_num);
+  Vector<float> values(fcurves.size());
+
+  /* Bezier segments are solved differently, which gives different rounding errors. Those are
+   * relative to the magnitude of the values of the curve. */
+  Vector<float> tolerances;
+  for (const FCurve *fcu : fcurves) {
+    float max_value = 1.0f;
+    for (int key = 0; key < fcu->totvert; key++) {
+      for (int j = 0; j < 3; j++) {
+        max_value = max_ff(max_value, fabsf(fcu->bezt[key].vec[j][1]));
+      }
+    }
+    tolerances.append(1e-6f * max_value);
+  }
+
+  /* Before, on and between the keyframes, and after the last one. */
+  for (float frame = -3.0f; frame < (keys_num * 5) + 3.0f; frame += 0.37f) {
+    BKE_fcurves_evaluate_batch(fcurves.data(), fcurves.size(), frame, values.data());
+    for (const int i : fcurves.index_range()) {
+      EXPECT_NEAR(values[i], evaluate_fcurve(fcurves[i], frame), tolerances[i]);
+    }
+  }
+  for (int key = 0; key < keys_num; key++) {
+    const float frame = (float)(key * 5);
+    BKE_fcurves_evaluate_batch(fcurves.data(), fcurves.size(), frame, values.data());
+    for (const int i : fcurves.index_range()) {
+      EXPECT_EQ(values[i], evaluate_fcurve(fcurves[i], frame));
+    }
+  }
+
+  for (FCurve *fcu : fcurves) {
+    BKE_fcurve_free(fcu);
+  }
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it is slow.
+ */
+#if 0
+TEST(fcurve_performance, evaluate_batch_100k)
+{
+  Vector<FCurve *> fcurves = test_fcurves_create(100000, 20);
+  Vector<float> values(fcurves.size());
+
+  {
+    SCOPED_TIMER("evaluate_single_100k");
+    for (float frame = 0.0f; frame < 100.0f; frame += 1.1f) {
+      for (const int i : fcurves.index_range()) {
+        values[i] = evaluate_fcurve(fcurves[i], frame);
+      }
+    }
+  }
+  {
+    SCOPED_TIMER("evaluate_batch_100k");
+    for (float frame = 0.0f; frame < 100.0f; frame += 1.1f) {
+      BKE_fcurves_evaluate_batch(fcurves.data(), fcurves.size(), frame, values.data());
+    }
+  }
+
+  for (FCurve *fcu : fcurves) {
+    BKE_fcurve_free(fcu);
+  }
+}
+#endif /* Benchmark */
+
 }  // namespace blender::bke::tests
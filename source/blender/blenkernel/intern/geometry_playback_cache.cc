@@ -0,0 +1,276 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <memory>
+#include <mutex>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_math_base.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_evaluation_cache.hh"
+#include "BKE_geometry_playback_cache.h"
+#include "BKE_geometry_set.hh"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DEG_depsgraph_query.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Cached Data
+ * \{ */
+
+/**
+ * Evaluated geometry of a single object at a single frame. Owns copies of the data, which are
+ * copied again when the cache is hit, so that the object never references memory owned by the
+ * cache. Shared pointers keep the data alive while it is being copied, even if the entry is
+ * evicted by another thread at the same time.
+ */
+struct CachedGeometry {
+  Mesh *mesh_eval = nullptr;
+  Mesh *mesh_deform_eval = nullptr;
+  GeometrySet geometry_set;
+
+  ~CachedGeometry()
+  {
+    if (mesh_eval != nullptr) {
+      BKE_id_free(nullptr, mesh_eval);
+    }
+    if (mesh_deform_eval != nullptr) {
+      BKE_id_free(nullptr, mesh_deform_eval);
+    }
+  }
+};
+
+struct CacheEntry {
+  float ctime;
+  CustomData_MeshMasks data_mask;
+  bool need_mapping;
+  uint64_t stamp;
+  size_t memory_size;
+  std::shared_ptr<CachedGeometry> data;
+};
+
+struct ObjectState {
+  /** Update counter of the dependency graph at the last evaluation of this object. */
+  uint64_t last_update_count = UINT64_MAX;
+};
+
+struct DepsgraphState {
+  /** Update counter of the dependency graph which all entries are valid for. */
+  uint64_t update_count = 0;
+};
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Global Cache
+ * \{ */
+
+using GeometryPlaybackCache =
+    blender::bke::EvaluationCache<CacheEntry, ObjectState, DepsgraphState>;
+
+static GeometryPlaybackCache GLOBAL_CACHE;
+
+/* Get cache of the dependency graph, invalidating it when there were updates since the last
+ * access. */
+static GeometryPlaybackCache::GraphCache &playback_cache_ensure_graph(const Depsgraph *depsgraph)
+{
+  const uint64_t update_count = DEG_get_update_count(depsgraph);
+  GeometryPlaybackCache::GraphCache &graph_cache = GLOBAL_CACHE.ensure_graph(depsgraph);
+  if (graph_cache.state.update_count != update_count) {
+    GLOBAL_CACHE.clear_graph(graph_cache);
+    graph_cache.state.update_count = update_count;
+  }
+  return graph_cache;
+}
+
+static size_t playback_cache_limit_get(void)
+{
+  return ((size_t)max_ii(U.geometry_cache_limit, 0)) * 1024 * 1024;
+}
+
+static uint object_cache_key(const Object *ob)
+{
+  const Object *ob_orig = DEG_get_original_object(const_cast<Object *>(ob));
+  return ob_orig->id.session_uuid;
+}
+
+static bool cache_entry_matches(const CacheEntry &entry,
+                                const float ctime,
+                                const CustomData_MeshMasks *dataMask,
+                                const bool need_mapping)
+{
+  return entry.ctime == ctime && (entry.need_mapping || !need_mapping) &&
+         CustomData_MeshMasks_are_matching(&entry.data_mask, dataMask);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+bool BKE_geometry_playback_cache_is_enabled(void)
+{
+  return U.geometry_cache_limit > 0;
+}
+
+bool BKE_geometry_playback_cache_lookup(const Depsgraph *depsgraph,
+                                        const Object *ob,
+                                        const CustomData_MeshMasks *dataMask,
+                                        const bool need_mapping,
+                                        Mesh **r_mesh_eval,
+                                        Mesh **r_mesh_deform_eval,
+                                        GeometrySet **r_geometry_set)
+{
+  const float ctime = DEG_get_ctime(depsgraph);
+  const uint object_uuid = object_cache_key(ob);
+
+  std::shared_ptr<CachedGeometry> data;
+  {
+    std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+    GeometryPlaybackCache::GraphCache &graph_cache = playback_cache_ensure_graph(depsgraph);
+    const GeometryPlaybackCache::ObjectCache *object_cache = graph_cache.objects.lookup_ptr(
+        object_uuid);
+    if (object_cache != nullptr) {
+      for (const CacheEntry &entry : object_cache->entries) {
+        if (cache_entry_matches(entry, ctime, dataMask, need_mapping)) {
+          data = entry.data;
+          break;
+        }
+      }
+    }
+  }
+
+  if (!data) {
+    GLOBAL_CACHE.misses++;
+    return false;
+  }
+  GLOBAL_CACHE.hits++;
+
+  *r_mesh_eval = BKE_mesh_copy_for_eval(data->mesh_eval, false);
+  *r_mesh_deform_eval = (data->mesh_deform_eval != nullptr) ?
+                            BKE_mesh_copy_for_eval(data->mesh_deform_eval, false) :
+                            nullptr;
+  /* Components are shared, they are copied when they are accessed for write. */
+  *r_geometry_set = new GeometrySet(data->geometry_set);
+  return true;
+}
+
+void BKE_geometry_playback_cache_store(const Depsgraph *depsgraph,
+                                       const Object *ob,
+                                       const CustomData_MeshMasks *dataMask,
+                                       const bool need_mapping,
+                                       Mesh *mesh_eval,
+                                       Mesh *mesh_deform_eval,
+                                       const GeometrySet *geometry_set)
+{
+  const size_t limit = playback_cache_limit_get();
+  const float ctime = DEG_get_ctime(depsgraph);
+  const uint object_uuid = object_cache_key(ob);
+  const uint64_t update_count = DEG_get_update_count(depsgraph);
+
+  {
+    std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+    GeometryPlaybackCache::GraphCache &graph_cache = playback_cache_ensure_graph(depsgraph);
+    GeometryPlaybackCache::ObjectCache &object_cache = graph_cache.objects.lookup_or_add_default(
+        object_uuid);
+    if (object_cache.state.last_update_count != update_count) {
+      /* First evaluation after an edit, most likely the next one will be an edit as well. */
+      object_cache.state.last_update_count = update_count;
+      return;
+    }
+  }
+
+  /* Check the size before copying, entries larger than the limit would be evicted immediately. */
+  size_t memory_size = BKE_mesh_memory_size(mesh_eval);
+  if (mesh_deform_eval != nullptr) {
+    memory_size += BKE_mesh_memory_size(mesh_deform_eval);
+  }
+  if (geometry_set != nullptr) {
+    memory_size += geometry_set->memory_size();
+  }
+  if (memory_size > limit) {
+    return;
+  }
+
+  /* Copy outside of the lock, this is the expensive part. The copies do not reference any data of
+   * the original mesh, so they stay valid when the original is changed. */
+  std::shared_ptr<CachedGeometry> data = std::make_shared<CachedGeometry>();
+  data->mesh_eval = BKE_mesh_copy_for_eval(mesh_eval, false);
+  if (mesh_deform_eval != nullptr) {
+    data->mesh_deform_eval = BKE_mesh_copy_for_eval(mesh_deform_eval, false);
+  }
+  if (geometry_set != nullptr) {
+    data->geometry_set = *geometry_set;
+  }
+
+  std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+  GeometryPlaybackCache::GraphCache &graph_cache = playback_cache_ensure_graph(depsgraph);
+  GeometryPlaybackCache::ObjectCache &object_cache = graph_cache.objects.lookup_or_add_default(
+      object_uuid);
+  for (const CacheEntry &entry : object_cache.entries) {
+    if (cache_entry_matches(entry, ctime, dataMask, need_mapping)) {
+      /* Another evaluation of the same object stored the result already. */
+      return;
+    }
+  }
+
+  CacheEntry entry;
+  entry.ctime = ctime;
+  entry.data_mask = *dataMask;
+  entry.need_mapping = need_mapping;
+  entry.memory_size = memory_size;
+  entry.data = std::move(data);
+  GLOBAL_CACHE.add_entry(depsgraph, object_uuid, std::move(entry), limit);
+}
+
+void BKE_geometry_playback_cache_free_depsgraph(const Depsgraph *depsgraph)
+{
+  std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+  GLOBAL_CACHE.free_graph(depsgraph);
+}
+
+void BKE_geometry_playback_cache_limit_update(void)
+{
+  const size_t limit = playback_cache_limit_get();
+  std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+  GLOBAL_CACHE.evict(limit);
+}
+
+void BKE_geometry_playback_cache_stats_get(GeometryPlaybackCacheStats *r_stats)
+{
+  std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+  r_stats->hits = GLOBAL_CACHE.hits;
+  r_stats->misses = GLOBAL_CACHE.misses;
+  r_stats->memory_used = GLOBAL_CACHE.memory_used();
+  r_stats->memory_limit = playback_cache_limit_get();
+  r_stats->entries_num = (int)GLOBAL_CACHE.entries_num();
+}
+
+/** \} */
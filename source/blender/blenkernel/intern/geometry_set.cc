@@ -15,9 +15,11 @@
  */
 
 #include "BLI_map.hh"
+#include "BLI_set.hh"
 
 #include "BKE_attribute.h"
 #include "BKE_attribute_access.hh"
+#include "BKE_customdata.h"
 #include "BKE_geometry_set.hh"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
@@ -27,7 +29,10 @@
 #include "BKE_volume.h"
 
 #include "DNA_collection_types.h"
+#include "DNA_mesh_types.h"
 #include "DNA_object_types.h"
+#include "DNA_pointcloud_types.h"
+#include "DNA_volume_types.h"
 
 #include "BLI_rand.hh"
 
@@ -37,6 +42,7 @@ using blender::float3;
 using blender::float4x4;
 using blender::Map;
 using blender::MutableSpan;
+using blender::Set;
 using blender::Span;
 using blender::StringRef;
 using blender::Vector;
@@ -205,6 +211,47 @@ uint64_t GeometrySet::hash() const
   return reinterpret_cast<uint64_t>(this);
 }
 
+static size_t geometry_set_memory_size(const GeometrySet &geometry_set,
+                                       Set<const GeometrySet *> &counted_geometry_sets)
+{
+  size_t size = sizeof(GeometrySet);
+  const Mesh *mesh = geometry_set.get_mesh_for_read();
+  if (mesh != nullptr) {
+    size += BKE_mesh_memory_size(mesh);
+  }
+  const PointCloud *pointcloud = geometry_set.get_pointcloud_for_read();
+  if (pointcloud != nullptr) {
+    size += sizeof(PointCloud) + CustomData_memory_size(&pointcloud->pdata, pointcloud->totpoint);
+  }
+  const Volume *volume = geometry_set.get_volume_for_read();
+  if (volume != nullptr) {
+    size += BKE_volume_memory_size(volume);
+  }
+  const InstancesComponent *instances = geometry_set.get_component_for_read<InstancesComponent>();
+  if (instances != nullptr) {
+    size += (size_t)instances->instances_amount() *
+            (sizeof(float4x4) + sizeof(InstancedData) + sizeof(int) * 2);
+    for (const InstancedData &data : instances->instanced_data()) {
+      /* Instanced geometry sets are shared by all instances referencing them. */
+      if (data.type == INSTANCE_DATA_TYPE_GEOMETRY_SET &&
+          counted_geometry_sets.add(data.data.geometry_set)) {
+        size += geometry_set_memory_size(*data.data.geometry_set, counted_geometry_sets);
+      }
+    }
+  }
+  return size;
+}
+
+/**
+ * Approximate memory used by the data of all components, in bytes. Instanced objects and
+ * collections are not owned by the geometry set, they are not taken into account.
+ */
+size_t GeometrySet::memory_size() const
+{
+  Set<const GeometrySet *> counted_geometry_sets;
+  return geometry_set_memory_size(*this, counted_geometry_sets);
+}
+
 /* Returns a read-only mesh or null. */
 const Mesh *GeometrySet::get_mesh_for_read() const
 {
@@ -533,7 +580,9 @@ GeometryComponent *InstancesComponent::copy() const
 {
   InstancesComponent *new_component = new InstancesComponent();
   new_component->transforms_ = transforms_;
+  new_component->ids_ = ids_;
   new_component->instanced_data_ = instanced_data_;
+  new_component->instanced_geometry_sets_ = instanced_geometry_sets_;
   return new_component;
 }
 
@@ -541,6 +590,8 @@ void InstancesComponent::clear()
 {
   instanced_data_.clear();
   transforms_.clear();
+  ids_.clear();
+  instanced_geometry_sets_.clear();
 }
 
 void InstancesComponent::add_instance(Object *object, float4x4 transform, const int id)
@@ -566,6 +617,26 @@ void InstancesComponent::add_instance(InstancedData data, float4x4 transform, co
   ids_.append(id);
 }
 
+void InstancesComponent::add_instances(const InstancesComponent &other)
+{
+  instanced_data_.extend(other.instanced_data_);
+  transforms_.extend(other.transforms_);
+  ids_.extend(other.ids_);
+  /* The instanced data of the other component may point to geometry sets owned by it. */
+  instanced_geometry_sets_.extend(other.instanced_geometry_sets_);
+}
+
+InstancedData InstancesComponent::add_instanced_geometry_set(GeometrySet geometry_set)
+{
+  std::shared_ptr<const GeometrySet> stored_geometry_set = std::make_shared<const GeometrySet>(
+      std::move(geometry_set));
+  InstancedData data;
+  data.type = INSTANCE_DATA_TYPE_GEOMETRY_SET;
+  data.data.geometry_set = stored_geometry_set.get();
+  instanced_geometry_sets_.append(std::move(stored_geometry_set));
+  return data;
+}
+
 Span<InstancedData> InstancesComponent::instanced_data() const
 {
   return instanced_data_;
@@ -770,4 +841,28 @@ int BKE_geometry_set_instances(const GeometrySet *geometry_set,
   return component->instances_amount();
 }
 
+/**
+ * Get the data-blocks of the components that can be drawn and rendered directly, which is
+ * used to create duplis for instanced geometry sets.
+ *
+ * \return The number of data-blocks written to \a r_data.
+ */
+int BKE_geometry_set_drawable_data(const GeometrySet *geometry_set, ID *r_data[3])
+{
+  int data_len = 0;
+  const Mesh *mesh = geometry_set->get_mesh_for_read();
+  if (mesh != nullptr) {
+    r_data[data_len++] = (ID *)&mesh->id;
+  }
+  const PointCloud *pointcloud = geometry_set->get_pointcloud_for_read();
+  if (pointcloud != nullptr) {
+    r_data[data_len++] = (ID *)&pointcloud->id;
+  }
+  const Volume *volume = geometry_set->get_volume_for_read();
+  if (volume != nullptr) {
+    r_data[data_len++] = (ID *)&volume->id;
+  }
+  return data_len;
+}
+
 /** \} */
@@ -139,6 +139,10 @@ static void geometry_set_collect_recursive(const GeometrySet &geometry_set,
         const Collection &collection = *data.data.collection;
         geometry_set_collect_recursive_collection_instance(collection, instance_transform, r_sets);
       }
+      else if (data.type == INSTANCE_DATA_TYPE_GEOMETRY_SET) {
+        BLI_assert(data.data.geometry_set != nullptr);
+        geometry_set_collect_recursive(*data.data.geometry_set, instance_transform, r_sets);
+      }
     }
   }
 }
@@ -155,7 +155,7 @@ static void mesh_free_data(ID *id)
 {
   Mesh *mesh = (Mesh *)id;
 
-  BKE_mesh_runtime_clear_cache(mesh);
+  BKE_mesh_runtime_free_data(mesh);
   mesh_clear_geometry(mesh);
   MEM_SAFE_FREE(mesh->mat);
 }
@@ -1003,6 +1003,19 @@ Mesh *BKE_mesh_copy_for_eval(struct Mesh *source, bool reference)
   return result;
 }
 
+/**
+ * Approximate memory used by the mesh and its custom data layers, in bytes.
+ * Runtime data (e.g. tessellation and draw caches) is not taken into account.
+ */
+size_t BKE_mesh_memory_size(const Mesh *mesh)
+{
+  return sizeof(Mesh) + CustomData_memory_size(&mesh->vdata, mesh->totvert) +
+         CustomData_memory_size(&mesh->edata, mesh->totedge) +
+         CustomData_memory_size(&mesh->fdata, mesh->totface) +
+         CustomData_memory_size(&mesh->ldata, mesh->totloop) +
+         CustomData_memory_size(&mesh->pdata, mesh->totpoly);
+}
+
 BMesh *BKE_mesh_to_bmesh_ex(const Mesh *me,
                             const struct BMeshCreateParams *create_params,
                             const struct BMeshFromMeshParams *convert_params)
@@ -1759,7 +1772,7 @@ void BKE_mesh_vert_coords_apply(Mesh *mesh, const float (*vert_coords)[3])
   for (int i = 0; i < mesh->totvert; i++, mv++) {
     copy_v3_v3(mv->co, vert_coords[i]);
   }
-  mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  BKE_mesh_normals_tag_dirty(mesh);
 }
 
 void BKE_mesh_vert_coords_apply_with_mat4(Mesh *mesh,
@@ -1772,7 +1785,7 @@ void BKE_mesh_vert_coords_apply_with_mat4(Mesh *mesh,
   for (int i = 0; i < mesh->totvert; i++, mv++) {
     mul_v3_m4v3(mv->co, mat, vert_coords[i]);
   }
-  mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  BKE_mesh_normals_tag_dirty(mesh);
 }
 
 void BKE_mesh_vert_normals_apply(Mesh *mesh, const short (*vert_normals)[3])
@@ -1783,7 +1796,19 @@ void BKE_mesh_vert_normals_apply(Mesh *mesh, const short (*vert_normals)[3])
   for (int i = 0; i < mesh->totvert; i++, mv++) {
     copy_v3_v3_short(mv->no, vert_normals[i]);
   }
-  mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
+
+  /* Keep the float normals in sync with the custom vertex normals. */
+  Mesh_Runtime *runtime = &mesh->runtime;
+  if (runtime->cd_dirty_vert & CD_MASK_NORMAL) {
+    runtime->poly_normals_dirty = true;
+  }
+  BKE_mesh_normals_cache_ensure_len(
+      &runtime->vert_normals, &runtime->vert_normals_len, mesh->totvert);
+  for (int i = 0; i < mesh->totvert; i++) {
+    normal_short_to_float_v3(runtime->vert_normals[i], vert_normals[i]);
+  }
+  runtime->vert_normals_dirty = false;
+  runtime->cd_dirty_vert &= ~CD_MASK_NORMAL;
 }
 
 /**
@@ -1796,9 +1821,8 @@ void BKE_mesh_vert_normals_apply(Mesh *mesh, const short (*vert_normals)[3])
 void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spacearr)
 {
   float(*r_loopnors)[3];
-  float(*polynors)[3];
+  const float(*polynors)[3];
   short(*clnors)[2] = NULL;
-  bool free_polynors = false;
 
   /* Note that we enforce computing clnors when the clnor space array is requested by caller here.
    * However, we obviously only use the autosmooth angle threshold
@@ -1822,20 +1846,17 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
     /* This assume that layer is always up to date, not sure this is the case
      * (esp. in Edit mode?)... */
     polynors = CustomData_get_layer(&mesh->pdata, CD_NORMAL);
-    free_polynors = false;
+    /* Vertex normals are not recalculated here, the dirty tag is cleared below though,
+     * make sure the normals cache does not get used. */
+    if (mesh->runtime.cd_dirty_vert & CD_MASK_NORMAL) {
+      mesh->runtime.vert_normals_dirty = true;
+      mesh->runtime.poly_normals_dirty = true;
+    }
   }
   else {
-    polynors = MEM_malloc_arrayN(mesh->totpoly, sizeof(float[3]), __func__);
-    BKE_mesh_calc_normals_poly(mesh->mvert,
-                               NULL,
-                               mesh->totvert,
-                               mesh->mloop,
-                               mesh->mpoly,
-                               mesh->totloop,
-                               mesh->totpoly,
-                               polynors,
-                               false);
-    free_polynors = true;
+    /* Also updates the cached polygon normals. */
+    BKE_mesh_calc_normals(mesh);
+    polynors = mesh->runtime.poly_normals;
   }
 
   BKE_mesh_normals_loop_split(mesh->mvert,
@@ -1846,7 +1867,7 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
                               r_loopnors,
                               mesh->totloop,
                               mesh->mpoly,
-                              (const float(*)[3])polynors,
+                              polynors,
                               mesh->totpoly,
                               use_split_normals,
                               split_angle,
@@ -1854,10 +1875,6 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
                               clnors,
                               NULL);
 
-  if (free_polynors) {
-    MEM_freeN(polynors);
-  }
-
   mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
 }
 
@@ -43,6 +43,7 @@
 #include "BLI_polyfill_2d.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_customdata.h"
@@ -209,10 +210,12 @@ void BKE_mesh_calc_normals_mapping_ex(MVert *mverts,
 typedef struct MeshCalcNormalsData {
   const MPoly *mpolys;
   const MLoop *mloop;
-  MVert *mverts;
+  const MVert *mverts;
   float (*pnors)[3];
   float (*lnors_weighted)[3];
   float (*vnors)[3];
+  /** When not NULL, the vertex normals are stored in #MVert.no as well. */
+  MVert *mverts_no;
 } MeshCalcNormalsData;
 
 static void mesh_calc_normals_poly_cb(void *__restrict userdata,
@@ -225,9 +228,8 @@ static void mesh_calc_normals_poly_cb(void *__restrict userdata,
   BKE_mesh_calc_poly_normal(mp, data->mloop + mp->loopstart, data->mverts, data->pnors[pidx]);
 }
 
-static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
-                                              const int pidx,
-                                              const TaskParallelTLS *__restrict UNUSED(tls))
+static void mesh_calc_normals_poly_and_vertex_prepare_cb(
+    void *__restrict userdata, const int pidx, const TaskParallelTLS *__restrict UNUSED(tls))
 {
   MeshCalcNormalsData *data = userdata;
   const MPoly *mp = &data->mpolys[pidx];
@@ -268,7 +270,8 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
 
   /* accumulate angle weighted face normal */
   /* inline version of #accumulate_vertex_normals_poly_v3,
-   * split between this threaded callback and #mesh_calc_normals_poly_accum_cb. */
+   * split between this threaded callback and the accumulation loop in
+   * #mesh_calc_normals_poly_and_vertex_ex. */
   {
     const float *prev_edge = edgevecbuf[nverts - 1];
 
@@ -288,13 +291,12 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
   }
 }
 
-static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
-                                               const int vidx,
-                                               const TaskParallelTLS *__restrict UNUSED(tls))
+static void mesh_calc_normals_poly_and_vertex_finalize_cb(
+    void *__restrict userdata, const int vidx, const TaskParallelTLS *__restrict UNUSED(tls))
 {
   MeshCalcNormalsData *data = userdata;
 
-  MVert *mv = &data->mverts[vidx];
+  const MVert *mv = &data->mverts[vidx];
   float *no = data->vnors[vidx];
 
   if (UNLIKELY(normalize_v3(no) == 0.0f)) {
@@ -302,7 +304,82 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
     normalize_v3_v3(no, mv->co);
   }
 
-  normal_float_to_short_v3(mv->no, no);
+  if (data->mverts_no != NULL) {
+    normal_float_to_short_v3(data->mverts_no[vidx].no, no);
+  }
+}
+
+static void mesh_calc_normals_poly_and_vertex_ex(const MVert *mvert,
+                                                 const int mvert_len,
+                                                 const MLoop *mloop,
+                                                 const int mloop_len,
+                                                 const MPoly *mpoly,
+                                                 const int mpoly_len,
+                                                 float (*r_poly_normals)[3],
+                                                 float (*r_vert_normals)[3],
+                                                 MVert *r_mverts_no)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  float(*lnors_weighted)[3] = MEM_malloc_arrayN(
+      (size_t)mloop_len, sizeof(*lnors_weighted), __func__);
+
+  memset(r_vert_normals, 0, sizeof(*r_vert_normals) * (size_t)mvert_len);
+
+  MeshCalcNormalsData data = {
+      .mpolys = mpoly,
+      .mloop = mloop,
+      .mverts = mvert,
+      .pnors = r_poly_normals,
+      .lnors_weighted = lnors_weighted,
+      .vnors = r_vert_normals,
+      .mverts_no = r_mverts_no,
+  };
+
+  /* Compute poly normals, and prepare weighted loop normals. */
+  BLI_task_parallel_range(
+      0, mpoly_len, &data, mesh_calc_normals_poly_and_vertex_prepare_cb, &settings);
+
+  /* Actually accumulate weighted loop normals into vertex ones. */
+  /* Unfortunately, not possible to thread that
+   * (not in a reasonable, totally lock- and barrier-free fashion),
+   * since several loops will point to the same vertex.
+   * Accumulating in loop order also keeps the result deterministic. */
+  for (int lidx = 0; lidx < mloop_len; lidx++) {
+    add_v3_v3(r_vert_normals[mloop[lidx].v], lnors_weighted[lidx]);
+  }
+  MEM_freeN(lnors_weighted);
+
+  /* Normalize and validate computed vertex normals. */
+  BLI_task_parallel_range(
+      0, mvert_len, &data, mesh_calc_normals_poly_and_vertex_finalize_cb, &settings);
+}
+
+/**
+ * Calculate float polygon and vertex normals without modifying the mesh.
+ *
+ * \param r_poly_normals: May be NULL when only vertex normals are needed.
+ */
+void BKE_mesh_calc_normals_poly_and_vertex(const MVert *mvert,
+                                           const int mvert_len,
+                                           const MLoop *mloop,
+                                           const int mloop_len,
+                                           const MPoly *mpoly,
+                                           const int mpoly_len,
+                                           float (*r_poly_normals)[3],
+                                           float (*r_vert_normals)[3])
+{
+  mesh_calc_normals_poly_and_vertex_ex(mvert,
+                                       mvert_len,
+                                       mloop,
+                                       mloop_len,
+                                       mpoly,
+                                       mpoly_len,
+                                       r_poly_normals,
+                                       r_vert_normals,
+                                       NULL);
 }
 
 void BKE_mesh_calc_normals_poly(MVert *mverts,
@@ -317,14 +394,14 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
 {
   float(*pnors)[3] = r_polynors;
 
-  TaskParallelSettings settings;
-  BLI_parallel_range_settings_defaults(&settings);
-  settings.min_iter_per_thread = 1024;
-
   if (only_face_normals) {
     BLI_assert((pnors != NULL) || (numPolys == 0));
     BLI_assert(r_vertnors == NULL);
 
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+
     MeshCalcNormalsData data = {
         .mpolys = mpolys,
         .mloop = mloop,
@@ -337,46 +414,151 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
   }
 
   float(*vnors)[3] = r_vertnors;
-  float(*lnors_weighted)[3] = MEM_malloc_arrayN(
-      (size_t)numLoops, sizeof(*lnors_weighted), __func__);
   bool free_vnors = false;
 
-  /* first go through and calculate normals for all the polys */
   if (vnors == NULL) {
-    vnors = MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
+    vnors = MEM_malloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
     free_vnors = true;
   }
-  else {
-    memset(vnors, 0, sizeof(*vnors) * (size_t)numVerts);
+
+  mesh_calc_normals_poly_and_vertex_ex(
+      mverts, numVerts, mloop, numLoops, mpolys, numPolys, pnors, vnors, mverts);
+
+  if (free_vnors) {
+    MEM_freeN(vnors);
   }
+}
 
-  MeshCalcNormalsData data = {
-      .mpolys = mpolys,
-      .mloop = mloop,
-      .mverts = mverts,
-      .pnors = pnors,
-      .lnors_weighted = lnors_weighted,
-      .vnors = vnors,
-  };
+/* Float vertex and polygon normals stored in #Mesh_Runtime, computed on demand.
+ *
+ * The cached normals are only used while the #MVert.no normals are up to date as well
+ * (#CD_MASK_NORMAL not set in `cd_dirty_vert`), code which changes #MVert.no directly
+ * must tag the cache as dirty or fill it. */
+
+static bool mesh_normals_cache_is_valid(const Mesh *mesh,
+                                        const void *normals,
+                                        const int normals_len,
+                                        const int len,
+                                        const char dirty)
+{
+  return (normals != NULL) && (normals_len == len) && !dirty &&
+         !(mesh->runtime.cd_dirty_vert & CD_MASK_NORMAL);
+}
 
-  /* Compute poly normals, and prepare weighted loop normals. */
-  BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_prepare_cb, &settings);
+/**
+ * Make sure a cached normals array has room for \a len normals, reallocating it when the
+ * geometry was resized since it was allocated (e.g. vertices added with #mesh_add_verts).
+ */
+void BKE_mesh_normals_cache_ensure_len(float (**r_normals)[3], int *r_normals_len, const int len)
+{
+  if (*r_normals != NULL && *r_normals_len == len) {
+    return;
+  }
+  MEM_SAFE_FREE(*r_normals);
+  *r_normals = MEM_malloc_arrayN((size_t)len, sizeof(**r_normals), __func__);
+  *r_normals_len = len;
+}
 
-  /* Actually accumulate weighted loop normals into vertex ones. */
-  /* Unfortunately, not possible to thread that
-   * (not in a reasonable, totally lock- and barrier-free fashion),
-   * since several loops will point to the same vertex... */
-  for (int lidx = 0; lidx < numLoops; lidx++) {
-    add_v3_v3(vnors[mloop[lidx].v], data.lnors_weighted[lidx]);
+static void mesh_normals_cache_calc(Mesh *mesh, const bool do_vert_normals, MVert *r_mverts_no)
+{
+  Mesh_Runtime *runtime = &mesh->runtime;
+
+  BKE_mesh_normals_cache_ensure_len(
+      &runtime->poly_normals, &runtime->poly_normals_len, mesh->totpoly);
+
+  if (do_vert_normals) {
+    BKE_mesh_normals_cache_ensure_len(
+        &runtime->vert_normals, &runtime->vert_normals_len, mesh->totvert);
+    mesh_calc_normals_poly_and_vertex_ex(mesh->mvert,
+                                         mesh->totvert,
+                                         mesh->mloop,
+                                         mesh->totloop,
+                                         mesh->mpoly,
+                                         mesh->totpoly,
+                                         runtime->poly_normals,
+                                         runtime->vert_normals,
+                                         r_mverts_no);
+    runtime->vert_normals_dirty = false;
   }
+  else {
+    BKE_mesh_calc_normals_poly(mesh->mvert,
+                               NULL,
+                               mesh->totvert,
+                               mesh->mloop,
+                               mesh->mpoly,
+                               mesh->totloop,
+                               mesh->totpoly,
+                               runtime->poly_normals,
+                               true);
+  }
+  runtime->poly_normals_dirty = false;
+}
 
-  /* Normalize and validate computed vertex normals. */
-  BLI_task_parallel_range(0, numVerts, &data, mesh_calc_normals_poly_finalize_cb, &settings);
+/**
+ * Return float vertex normals of the mesh, calculating them if necessary.
+ * The array is owned by the mesh and stays valid until its geometry changes.
+ */
+const float (*BKE_mesh_vertex_normals_ensure(const Mesh *mesh))[3]
+{
+  /* The cache is runtime data, filling it does not change the mesh itself. */
+  Mesh *mesh_mutable = (Mesh *)mesh;
+  Mesh_Runtime *runtime = &mesh_mutable->runtime;
+
+  ThreadMutex *normals_mutex = (ThreadMutex *)runtime->normals_mutex;
+  BLI_mutex_lock(normals_mutex);
+  if (!mesh_normals_cache_is_valid(mesh,
+                                   runtime->vert_normals,
+                                   runtime->vert_normals_len,
+                                   mesh->totvert,
+                                   runtime->vert_normals_dirty)) {
+    mesh_normals_cache_calc(mesh_mutable, true, NULL);
+  }
+  BLI_mutex_unlock(normals_mutex);
 
-  if (free_vnors) {
-    MEM_freeN(vnors);
+  return (const float(*)[3])runtime->vert_normals;
+}
+
+/**
+ * Return float polygon normals of the mesh, calculating them if necessary.
+ * The array is owned by the mesh and stays valid until its geometry changes.
+ */
+const float (*BKE_mesh_poly_normals_ensure(const Mesh *mesh))[3]
+{
+  Mesh *mesh_mutable = (Mesh *)mesh;
+  Mesh_Runtime *runtime = &mesh_mutable->runtime;
+
+  ThreadMutex *normals_mutex = (ThreadMutex *)runtime->normals_mutex;
+  BLI_mutex_lock(normals_mutex);
+  if (!mesh_normals_cache_is_valid(mesh,
+                                   runtime->poly_normals,
+                                   runtime->poly_normals_len,
+                                   mesh->totpoly,
+                                   runtime->poly_normals_dirty)) {
+    mesh_normals_cache_calc(mesh_mutable, false, NULL);
   }
-  MEM_freeN(lnors_weighted);
+  BLI_mutex_unlock(normals_mutex);
+
+  return (const float(*)[3])runtime->poly_normals;
+}
+
+/**
+ * Tag vertex and polygon normals as out of date, call after changing vertex positions.
+ * The allocated arrays are kept, so recalculating them does not have to allocate again.
+ */
+void BKE_mesh_normals_tag_dirty(Mesh *mesh)
+{
+  mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  BKE_mesh_normals_cache_tag_dirty(mesh);
+}
+
+/**
+ * Only tag the cached float normals as out of date, for code which moves vertices and updates
+ * #MVert.no itself (e.g. sculpt mode, which only updates normals of the changed PBVH nodes).
+ */
+void BKE_mesh_normals_cache_tag_dirty(Mesh *mesh)
+{
+  mesh->runtime.vert_normals_dirty = true;
+  mesh->runtime.poly_normals_dirty = true;
 }
 
 void BKE_mesh_ensure_normals(Mesh *mesh)
@@ -412,47 +594,32 @@ void BKE_mesh_ensure_normals_for_display(Mesh *mesh)
   const bool do_poly_normals = (mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL || poly_nors == NULL);
 
   if (do_vert_normals || do_poly_normals) {
-    const bool do_add_poly_nors_cddata = (poly_nors == NULL);
-    if (do_add_poly_nors_cddata) {
-      poly_nors = MEM_malloc_arrayN((size_t)mesh->totpoly, sizeof(*poly_nors), __func__);
+    /* Calculate vertex normals first, so the polygon normals come from the cache for free. */
+    if (do_vert_normals) {
+      BKE_mesh_calc_normals(mesh);
     }
+    const float(*poly_normals)[3] = BKE_mesh_poly_normals_ensure(mesh);
 
-    /* calculate poly/vert normals */
-    BKE_mesh_calc_normals_poly(mesh->mvert,
-                               NULL,
-                               mesh->totvert,
-                               mesh->mloop,
-                               mesh->mpoly,
-                               mesh->totloop,
-                               mesh->totpoly,
-                               poly_nors,
-                               !do_vert_normals);
-
-    if (do_add_poly_nors_cddata) {
-      CustomData_add_layer(&mesh->pdata, CD_NORMAL, CD_ASSIGN, poly_nors, mesh->totpoly);
+    if (poly_nors == NULL) {
+      CustomData_add_layer(
+          &mesh->pdata, CD_NORMAL, CD_DUPLICATE, (void *)poly_normals, mesh->totpoly);
+    }
+    else {
+      memcpy(poly_nors, poly_normals, sizeof(*poly_nors) * (size_t)mesh->totpoly);
     }
 
-    mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
     mesh->runtime.cd_dirty_poly &= ~CD_MASK_NORMAL;
   }
 }
 
 /* Note that this does not update the CD_NORMAL layer,
- * but does update the normals in the CD_MVERT layer. */
+ * but does update the normals in the CD_MVERT layer and the normals cache. */
 void BKE_mesh_calc_normals(Mesh *mesh)
 {
 #ifdef DEBUG_TIME
   TIMEIT_START_AVERAGED(BKE_mesh_calc_normals);
 #endif
-  BKE_mesh_calc_normals_poly(mesh->mvert,
-                             NULL,
-                             mesh->totvert,
-                             mesh->mloop,
-                             mesh->mpoly,
-                             mesh->totloop,
-                             mesh->totpoly,
-                             NULL,
-                             false);
+  mesh_normals_cache_calc(mesh, true, mesh->mvert);
 #ifdef DEBUG_TIME
   TIMEIT_END_AVERAGED(BKE_mesh_calc_normals);
 #endif
@@ -813,6 +980,22 @@ typedef struct LoopSplitTaskDataCommon {
   int numEdges;
   int numLoops;
   int numPolys;
+
+  /* Used by the threaded passes of #BKE_mesh_normals_loop_split. */
+  bool check_angle;
+  float split_angle_cos;
+  /** Number of loops using each edge. */
+  int *edge_users;
+  /** Loops which are known not to be the entry point of a cyclic smooth fan. */
+  BLI_bitmap *skip_loops;
+  /** Loops of smooth fans delimited by sharp edges, a subset of #skip_loops. */
+  BLI_bitmap *open_fan_loops;
+  /** Type of loop normal computation started from each loop (#LOOP_SPLIT_ENTRY_NONE etc). */
+  char *loop_entry_types;
+  /** Index of the lnor space of the first entry of each poly. */
+  int *poly_entry_offsets;
+  /** All lnor spaces, allocated at once since memarena is not threadsafe. */
+  MLoopNorSpace *lnor_spaces;
 } LoopSplitTaskDataCommon;
 
 #define INDEX_UNSET INT_MIN
@@ -820,12 +1003,12 @@ typedef struct LoopSplitTaskDataCommon {
 /* See comment about edge_to_loops below. */
 #define IS_EDGE_SHARP(_e2l) (ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID))
 
+/* See #loop_split_edge_sharp_cb for the threaded version used when computing loop normals. */
 static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
                                  const bool check_angle,
                                  const float split_angle,
                                  const bool do_sharp_edges_tag)
 {
-  const MVert *mverts = data->mverts;
   const MEdge *medges = data->medges;
   const MLoop *mloops = data->mloops;
 
@@ -834,7 +1017,6 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
   const int numEdges = data->numEdges;
   const int numPolys = data->numPolys;
 
-  float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
   const float(*polynors)[3] = data->polynors;
 
   int(*edge_to_loops)[2] = data->edge_to_loops;
@@ -860,13 +1042,6 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
 
       loop_to_poly[ml_curr_index] = mp_index;
 
-      /* Pre-populate all loop normals as if their verts were all-smooth,
-       * this way we don't have to compute those later!
-       */
-      if (loopnors) {
-        normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
-      }
-
       /* Check whether current edge might be smooth or sharp */
       if ((e2l[0] | e2l[1]) == 0) {
         /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
@@ -1312,66 +1487,117 @@ static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
   }
 }
 
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
+/**
+ * Whether loop \a ml_index_a comes before loop \a ml_index_b when iterating over polygons
+ * (loops of a polygon are not required to be stored after those of the previous polygons).
+ */
+BLI_INLINE bool loop_split_loop_is_before(const int *loop_to_poly,
+                                          const int ml_index_a,
+                                          const int ml_index_b)
 {
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
+  const int mp_index_a = loop_to_poly[ml_index_a];
+  const int mp_index_b = loop_to_poly[ml_index_b];
+  return (mp_index_a < mp_index_b) || (mp_index_a == mp_index_b && ml_index_a < ml_index_b);
+}
 
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
+/**
+ * Thread-safe version of #BLI_BITMAP_ENABLE. Bits are never cleared while the bitmap is shared
+ * between threads, so reading them with #BLI_BITMAP_TEST is fine.
+ */
+BLI_INLINE void loop_split_bitmap_enable_atomic(BLI_bitmap *bitmap, const int index)
+{
+  atomic_fetch_and_or_uint32((uint32_t *)&bitmap[index >> _BITMAP_POWER],
+                             1u << (index & _BITMAP_MASK));
+}
 
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
+/**
+ * Tag the loops of the smooth fan walked from \a ml_curr_index, up to the sharp edge ending it or
+ * up to a loop which was already tagged.
+ */
+static void loop_split_open_fan_tag(const MLoop *mloops,
+                                    const MPoly *mpolys,
+                                    const int (*edge_to_loops)[2],
+                                    const int *loop_to_poly,
+                                    const int *e2l_prev,
+                                    BLI_bitmap *skip_loops,
+                                    BLI_bitmap *open_fan_loops,
+                                    const MLoop *ml_curr,
+                                    const MLoop *ml_prev,
+                                    const int ml_curr_index,
+                                    const int ml_prev_index,
+                                    const int mp_curr_index,
+                                    const int steps_num)
+{
+  const unsigned int mv_pivot_index = ml_curr->v;
+  const int *e2lfan_curr = e2l_prev;
+  const MLoop *mlfan_curr = ml_prev;
+  int mlfan_curr_index = ml_prev_index;
+  int mlfan_vert_index = ml_curr_index;
+  int mpfan_curr_index = mp_curr_index;
+
+  for (int step = 0; step <= steps_num; step++) {
+    loop_split_bitmap_enable_atomic(skip_loops, mlfan_vert_index);
+    loop_split_bitmap_enable_atomic(open_fan_loops, mlfan_vert_index);
+    if (step == steps_num) {
       break;
     }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
-  }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
+    BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
+                                                mpolys,
+                                                loop_to_poly,
+                                                e2lfan_curr,
+                                                mv_pivot_index,
+                                                &mlfan_curr,
+                                                &mlfan_curr_index,
+                                                &mlfan_vert_index,
+                                                &mpfan_curr_index);
+    e2lfan_curr = edge_to_loops[mlfan_curr->e];
   }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
 }
 
 /**
- * Check whether given loop is part of an unknown-so-far cyclic smooth fan, or not.
+ * Check whether given loop is the entry point of a cyclic smooth fan.
  * Needed because cyclic smooth fans have no obvious 'entry point',
  * and yet we need to walk them once, and only once.
+ *
+ * The first loop of the fan in polygon order is used as entry point. This does not depend on
+ * which loops were checked before, so all loops can be checked in parallel, and the result is
+ * the same as when iterating over the polygons in order.
+ *
+ * The other loops met while walking around the fan are tagged in \a skip_loops, so that most
+ * of them do not walk around the same fan again. Loops of fans ending at a sharp edge are also
+ * tagged in \a open_fan_loops, a walk reaching such a loop stops there.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
+static bool loop_split_check_cyclic_smooth_fan(const MLoop *mloops,
+                                               const MPoly *mpolys,
+                                               const int (*edge_to_loops)[2],
+                                               const int *loop_to_poly,
+                                               const int *e2l_prev,
+                                               BLI_bitmap *skip_loops,
+                                               BLI_bitmap *open_fan_loops,
+                                               const MLoop *ml_curr,
+                                               const MLoop *ml_prev,
+                                               const int ml_curr_index,
+                                               const int ml_prev_index,
+                                               const int mp_curr_index,
+                                               const int numLoops)
 {
   const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
   const int *e2lfan_curr;
   const MLoop *mlfan_curr;
   /* mlfan_vert_index: the loop of our current edge might not be the loop of our current vertex! */
   int mlfan_curr_index, mlfan_vert_index, mpfan_curr_index;
+  /* First loop of the fan in polygon order met so far. */
+  int ml_first_index = ml_curr_index;
 
   e2lfan_curr = e2l_prev;
   if (IS_EDGE_SHARP(e2lfan_curr)) {
     /* Sharp loop, so not a cyclic smooth fan... */
     return false;
   }
+  if (BLI_BITMAP_TEST(skip_loops, ml_curr_index)) {
+    /* ... already found not to be an entry point when walking from another loop. */
+    return false;
+  }
 
   mlfan_curr = ml_prev;
   mlfan_curr_index = ml_prev_index;
@@ -1382,10 +1608,8 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  BLI_assert(!BLI_BITMAP_TEST(skip_loops, mlfan_vert_index));
-  BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
-
-  while (true) {
+  /* The step limit only guards against endless walking on invalid geometry. */
+  for (int step = 0; step < numLoops; step++) {
     /* Find next loop of the smooth fan. */
     BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
                                                 mpolys,
@@ -1399,201 +1623,258 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
 
     e2lfan_curr = edge_to_loops[mlfan_curr->e];
 
-    if (IS_EDGE_SHARP(e2lfan_curr)) {
+    if (IS_EDGE_SHARP(e2lfan_curr) || BLI_BITMAP_TEST(open_fan_loops, mlfan_vert_index)) {
       /* Sharp loop/edge, so not a cyclic smooth fan... */
+      loop_split_open_fan_tag(mloops,
+                              mpolys,
+                              edge_to_loops,
+                              loop_to_poly,
+                              e2l_prev,
+                              skip_loops,
+                              open_fan_loops,
+                              ml_curr,
+                              ml_prev,
+                              ml_curr_index,
+                              ml_prev_index,
+                              mp_curr_index,
+                              step + 1);
       return false;
     }
-    /* Smooth loop/edge... */
-    if (BLI_BITMAP_TEST(skip_loops, mlfan_vert_index)) {
-      if (mlfan_vert_index == ml_curr_index) {
-        /* We walked around a whole cyclic smooth fan without finding any already-processed loop,
-         * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
-        return true;
-      }
-      /* ... already checked in some previous looping, we can abort. */
-      return false;
+    if (mlfan_vert_index == ml_curr_index) {
+      /* We walked around a whole cyclic smooth fan, the initial ml_curr/ml_prev edge is the
+       * start of this smooth fan if no loop before it was found. */
+      return ml_first_index == ml_curr_index;
+    }
+    /* ... all loops of the fan except the first one can be skipped in future. */
+    if (loop_split_loop_is_before(loop_to_poly, mlfan_vert_index, ml_first_index)) {
+      loop_split_bitmap_enable_atomic(skip_loops, ml_first_index);
+      ml_first_index = mlfan_vert_index;
+    }
+    else {
+      loop_split_bitmap_enable_atomic(skip_loops, mlfan_vert_index);
     }
-
-    /* ... we can skip it in future, and keep checking the smooth fan. */
-    BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
   }
+  return false;
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
+BLI_INLINE void loop_split_atomic_min_int32(int32_t *p, const int32_t value)
 {
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
-  float(*loopnors)[3] = common_data->loopnors;
-
-  const MLoop *mloops = common_data->mloops;
-  const MPoly *mpolys = common_data->mpolys;
-  const int *loop_to_poly = common_data->loop_to_poly;
-  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
-  const int numLoops = common_data->numLoops;
-  const int numPolys = common_data->numPolys;
-
-  const MPoly *mp;
-  int mp_index;
-
-  const MLoop *ml_curr;
-  const MLoop *ml_prev;
-  int ml_curr_index;
-  int ml_prev_index;
-
-  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
-
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
+  int32_t prev = *p;
+  while (value < prev) {
+    const int32_t orig = atomic_cas_int32(p, prev, value);
+    if (orig == prev) {
+      break;
+    }
+    prev = orig;
+  }
+}
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
+/**
+ * Fill loop_to_poly, pre-populate all loop normals as if their verts were all-smooth
+ * (this way we don't have to compute those later!), and gather the loops using each edge.
+ */
+static void loop_split_edge_users_cb(void *__restrict userdata,
+                                     const int mp_index,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *data = userdata;
+  const MPoly *mp = &data->mpolys[mp_index];
+  const int ml_index_end = mp->loopstart + mp->totloop;
+
+  for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+    const MLoop *ml = &data->mloops[ml_index];
+
+    data->loop_to_poly[ml_index] = mp_index;
+    normal_short_to_float_v3(data->loopnors[ml_index], data->mverts[ml->v].no);
+
+    /* Only the first two users are needed, edges with more users are always sharp. The second
+     * one is stored as is, the lowest index of the others is kept, so that the result does not
+     * depend on the order in which threads reach the edge. */
+    const int user_index = atomic_fetch_and_add_int32(&data->edge_users[ml->e], 1);
+    if (user_index == 1) {
+      data->edge_to_loops[ml->e][1] = ml_index;
+    }
+    else {
+      loop_split_atomic_min_int32(&data->edge_to_loops[ml->e][0], ml_index);
+    }
+  }
+}
 
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_generator);
-#endif
+/**
+ * Threaded equivalent of #mesh_edges_sharp_tag, checks which edges are actually smooth.
+ * Both give the same edge_to_loops result, except for edges used by more than two loops when
+ * loops are not stored in polygon order: the first loop is the one with the lowest index here.
+ */
+static void loop_split_edge_sharp_cb(void *__restrict userdata,
+                                     const int me_index,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *data = userdata;
+  const MPoly *mpolys = data->mpolys;
+  const MLoop *mloops = data->mloops;
+  const int *loop_to_poly = data->loop_to_poly;
+  int *e2l = data->edge_to_loops[me_index];
 
-  if (!pool) {
-    if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+  switch (data->edge_users[me_index]) {
+    case 0:
+      /* Loose edge. */
+      e2l[0] = e2l[1] = 0;
+      break;
+    case 1:
+      e2l[1] = (mpolys[loop_to_poly[e2l[0]]].flag & ME_SMOOTH) ? INDEX_UNSET : INDEX_INVALID;
+      break;
+    case 2: {
+      if (loop_split_loop_is_before(loop_to_poly, e2l[1], e2l[0])) {
+        SWAP(int, e2l[0], e2l[1]);
+      }
+      const int mp_first_index = loop_to_poly[e2l[0]];
+      const int mp_second_index = loop_to_poly[e2l[1]];
+
+      /* An edge is sharp if it is tagged as such, or one of its faces is not smooth,
+       * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
+       * same vertex, or angle between both its polys' normals is above split_angle value. */
+      if (!(mpolys[mp_first_index].flag & ME_SMOOTH) ||
+          !(mpolys[mp_second_index].flag & ME_SMOOTH) ||
+          (data->medges[me_index].flag & ME_SHARP) || mloops[e2l[0]].v == mloops[e2l[1]].v ||
+          (data->check_angle && dot_v3v3(data->polynors[mp_first_index],
+                                         data->polynors[mp_second_index]) <
+                                    data->split_angle_cos)) {
+        e2l[1] = INDEX_INVALID;
+      }
+      break;
     }
+    default:
+      /* More than two loops using this edge, keep the one with the lowest index. */
+      e2l[0] = min_ii(e2l[0], e2l[1]);
+      e2l[1] = INDEX_INVALID;
+      break;
   }
+}
 
-  /* We now know edges that can be smoothed (with their vector, and their two loops),
-   * and edges that will be hard! Now, time to generate the normals.
-   */
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    float(*lnors)[3];
-    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
-    ml_curr_index = mp->loopstart;
-    ml_prev_index = ml_last_index;
-
-    ml_curr = &mloops[ml_curr_index];
-    ml_prev = &mloops[ml_prev_index];
-    lnors = &loopnors[ml_curr_index];
+enum {
+  LOOP_SPLIT_ENTRY_NONE = 0,
+  LOOP_SPLIT_ENTRY_SINGLE = 1,
+  LOOP_SPLIT_ENTRY_FAN = 2,
+};
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++, lnors++) {
-      const int *e2l_curr = edge_to_loops[ml_curr->e];
-      const int *e2l_prev = edge_to_loops[ml_prev->e];
+/**
+ * Find the loops from which normals are computed: one per smooth fan, or per loop with two
+ * sharp edges. Only the number of entries per poly is stored, so that lnor spaces can be
+ * allocated in one block before the actual computation.
+ */
+static void loop_split_entries_find_cb(void *__restrict userdata,
+                                       const int mp_index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *data = userdata;
+  const MLoop *mloops = data->mloops;
+  const int(*edge_to_loops)[2] = data->edge_to_loops;
+  const MPoly *mp = &data->mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int entries_num = 0;
+
+  for (int ml_curr_index = mp->loopstart, ml_prev_index = ml_last_index;
+       ml_curr_index <= ml_last_index;
+       ml_prev_index = ml_curr_index++) {
+    const MLoop *ml_curr = &mloops[ml_curr_index];
+    const MLoop *ml_prev = &mloops[ml_prev_index];
+    const int *e2l_curr = edge_to_loops[ml_curr->e];
+    const int *e2l_prev = edge_to_loops[ml_prev->e];
+    char entry_type = LOOP_SPLIT_ENTRY_NONE;
+
+    /* We *do not need* to check/tag loops as already computed!
+     * Due to the fact a loop only links to one of its two edges,
+     * a same fan *will never be walked more than once!*
+     * Since we consider edges having neighbor polys with inverted
+     * (flipped) normals as sharp, we are sure that no fan will be skipped,
+     * even only considering the case (sharp curr_edge, smooth prev_edge),
+     * and not the alternative (smooth curr_edge, sharp prev_edge).
+     * All this due/thanks to link between normals and loop ordering (i.e. winding).
+     */
+    if (IS_EDGE_SHARP(e2l_curr)) {
+      entry_type = IS_EDGE_SHARP(e2l_prev) ? LOOP_SPLIT_ENTRY_SINGLE : LOOP_SPLIT_ENTRY_FAN;
+    }
+    /* A smooth edge, we have to check for cyclic smooth fan case. */
+    else if (loop_split_check_cyclic_smooth_fan(mloops,
+                                                data->mpolys,
+                                                edge_to_loops,
+                                                data->loop_to_poly,
+                                                e2l_prev,
+                                                data->skip_loops,
+                                                data->open_fan_loops,
+                                                ml_curr,
+                                                ml_prev,
+                                                ml_curr_index,
+                                                ml_prev_index,
+                                                mp_index,
+                                                data->numLoops)) {
+      entry_type = LOOP_SPLIT_ENTRY_FAN;
+    }
 
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
-#endif
+    data->loop_entry_types[ml_curr_index] = entry_type;
+    if (entry_type != LOOP_SPLIT_ENTRY_NONE) {
+      entries_num++;
+    }
+  }
 
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
-       * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
-      }
-      else {
-        LoopSplitTaskData *data, data_local;
+  data->poly_entry_offsets[mp_index] = entries_num;
+}
 
-        //              printf("PROCESSING!\n");
+typedef struct LoopSplitTLS {
+  /* Temp edge vectors stack, only used when computing lnor spacearr. */
+  BLI_Stack *edge_vectors;
+} LoopSplitTLS;
 
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
-          }
-          data = &data_buff[data_idx];
-        }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
-        }
+static void loop_split_entries_compute_cb(void *__restrict userdata,
+                                          const int mp_index,
+                                          const TaskParallelTLS *__restrict tls)
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+  LoopSplitTLS *tls_data = tls->userdata_chunk;
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int space_index = common_data->poly_entry_offsets[mp_index];
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
-#endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
+  if (common_data->lnors_spacearr && tls_data->edge_vectors == NULL) {
+    tls_data->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+  }
 
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
-        }
-      }
+  for (int ml_curr_index = mp->loopstart, ml_prev_index = ml_last_index;
+       ml_curr_index <= ml_last_index;
+       ml_prev_index = ml_curr_index++) {
+    const char entry_type = common_data->loop_entry_types[ml_curr_index];
+    if (entry_type == LOOP_SPLIT_ENTRY_NONE) {
+      continue;
+    }
 
-      ml_prev = ml_curr;
-      ml_prev_index = ml_curr_index;
+    LoopSplitTaskData data = {NULL};
+    data.ml_curr = &mloops[ml_curr_index];
+    data.ml_prev = &mloops[ml_prev_index];
+    data.ml_curr_index = ml_curr_index;
+    data.mp_index = mp_index;
+    if (entry_type == LOOP_SPLIT_ENTRY_SINGLE) {
+      data.lnor = &common_data->loopnors[ml_curr_index];
+    }
+    else {
+      data.ml_prev_index = ml_prev_index;
+      data.e2l_prev = common_data->edge_to_loops[data.ml_prev->e]; /* Also tag as 'fan' task. */
+    }
+    if (common_data->lnors_spacearr) {
+      data.lnor_space = &common_data->lnor_spaces[space_index++];
     }
-  }
 
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
+    loop_split_worker_do(common_data, &data, tls_data->edge_vectors);
   }
+}
 
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
+static void loop_split_entries_compute_free(const void *__restrict UNUSED(userdata),
+                                            void *__restrict chunk)
+{
+  LoopSplitTLS *tls_data = chunk;
+  if (tls_data->edge_vectors) {
+    BLI_stack_free(tls_data->edge_vectors);
   }
-  MEM_freeN(skip_loops);
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_generator);
-#endif
 }
 
 /**
@@ -1666,7 +1947,11 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
    * However, if needed, we can store the negated value of loop index instead of INDEX_INVALID
    * to retrieve the real value later in code).
    * Note also that loose edges always have both values set to 0! */
-  int(*edge_to_loops)[2] = MEM_calloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
+  int(*edge_to_loops)[2] = MEM_malloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
+  /* The first loop is the lowest index of the users, see #loop_split_edge_users_cb. */
+  for (int me_index = 0; me_index < numEdges; me_index++) {
+    edge_to_loops[me_index][0] = INT_MAX;
+  }
 
   /* Simple mapping from a loop to its polygon index. */
   int *loop_to_poly = r_loop_to_poly ?
@@ -1705,25 +1990,55 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
       .numEdges = numEdges,
       .numLoops = numLoops,
       .numPolys = numPolys,
+      .check_angle = check_angle,
+      .split_angle_cos = check_angle ? cosf(split_angle) : -1.0f,
+      .edge_users = MEM_calloc_arrayN((size_t)numEdges, sizeof(int), __func__),
+      .skip_loops = BLI_BITMAP_NEW((size_t)numLoops, __func__),
+      .open_fan_loops = BLI_BITMAP_NEW((size_t)numLoops, __func__),
+      .loop_entry_types = MEM_malloc_arrayN((size_t)numLoops, sizeof(char), __func__),
+      .poly_entry_offsets = MEM_malloc_arrayN((size_t)numPolys, sizeof(int), __func__),
   };
 
-  /* This first loop check which edges are actually smooth, and compute edge vectors. */
-  mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  /* Not enough loops to be worth the whole threading overhead otherwise... */
+  settings.use_threading = (numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  settings.min_iter_per_thread = 1024;
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
-  }
-  else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
+  /* These first loops check which edges are actually smooth. */
+  BLI_task_parallel_range(0, numPolys, &common_data, loop_split_edge_users_cb, &settings);
+  BLI_task_parallel_range(0, numEdges, &common_data, loop_split_edge_sharp_cb, &settings);
+  MEM_freeN(common_data.edge_users);
 
-    loop_split_generator(task_pool, &common_data);
+  /* We now know edges that can be smoothed (with their two loops), and edges that will be hard!
+   * Find where to start computing each normal, then allocate all lnor spaces at once so that
+   * they can be defined from the worker threads. */
+  BLI_task_parallel_range(0, numPolys, &common_data, loop_split_entries_find_cb, &settings);
+  MEM_freeN(common_data.skip_loops);
+  MEM_freeN(common_data.open_fan_loops);
 
-    BLI_task_pool_work_and_wait(task_pool);
+  int entries_num = 0;
+  for (int mp_index = 0; mp_index < numPolys; mp_index++) {
+    const int poly_entries_num = common_data.poly_entry_offsets[mp_index];
+    common_data.poly_entry_offsets[mp_index] = entries_num;
+    entries_num += poly_entries_num;
+  }
 
-    BLI_task_pool_free(task_pool);
+  if (r_lnors_spacearr && entries_num) {
+    common_data.lnor_spaces = BLI_memarena_calloc(r_lnors_spacearr->mem,
+                                                  sizeof(MLoopNorSpace) * (size_t)entries_num);
+    r_lnors_spacearr->num_spaces += entries_num;
   }
 
+  /* Time to generate the normals. */
+  LoopSplitTLS tls_data = {NULL};
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = loop_split_entries_compute_free;
+  BLI_task_parallel_range(0, numPolys, &common_data, loop_split_entries_compute_cb, &settings);
+
+  MEM_freeN(common_data.loop_entry_types);
+  MEM_freeN(common_data.poly_entry_offsets);
   MEM_freeN(edge_to_loops);
   if (!r_loop_to_poly) {
     MEM_freeN(loop_to_poly);
@@ -0,0 +1,393 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <array>
+
+#include "BKE_mesh.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "BLI_float3.hh"
+#include "BLI_map.hh"
+#include "BLI_math.h"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+namespace blender::bke::tests {
+
+struct MeshNormalsTestContext {
+  MVert *mverts;
+  MEdge *medges;
+  MLoop *mloops;
+  MPoly *mpolys;
+  float (*polynors)[3];
+  int verts_num;
+  int edges_num;
+  int loops_num;
+  int polys_num;
+};
+
+/**
+ * Wavy grid of `size * size` quads, with some sharp edges and flat faces so that all kinds of
+ * smooth fans are generated.
+ */
+static void test_mesh_normals_init(MeshNormalsTestContext *ctx, const int size)
+{
+  const int row_len = size + 1;
+  ctx->verts_num = row_len * row_len;
+  ctx->edges_num = 2 * size * row_len;
+  ctx->polys_num = size * size;
+  ctx->loops_num = ctx->polys_num * 4;
+
+  ctx->mverts = (MVert *)MEM_calloc_arrayN(ctx->verts_num, sizeof(MVert), __func__);
+  ctx->medges = (MEdge *)MEM_calloc_arrayN(ctx->edges_num, sizeof(MEdge), __func__);
+  ctx->mloops = (MLoop *)MEM_calloc_arrayN(ctx->loops_num, sizeof(MLoop), __func__);
+  ctx->mpolys = (MPoly *)MEM_calloc_arrayN(ctx->polys_num, sizeof(MPoly), __func__);
+  ctx->polynors = (float(*)[3])MEM_malloc_arrayN(ctx->polys_num, sizeof(float[3]), __func__);
+
+  for (int y = 0; y < row_len; y++) {
+    for (int x = 0; x < row_len; x++) {
+      MVert &mv = ctx->mverts[y * row_len + x];
+      mv.co[0] = (float)x;
+      mv.co[1] = (float)y;
+      mv.co[2] = sinf((float)x * 0.3f) * cosf((float)y * 0.2f);
+    }
+  }
+
+  /* Edges along X, then edges along Y. */
+  const int edges_y_start = size * row_len;
+  for (int y = 0; y < row_len; y++) {
+    for (int x = 0; x < size; x++) {
+      MEdge &me = ctx->medges[y * size + x];
+      me.v1 = y * row_len + x;
+      me.v2 = y * row_len + x + 1;
+      if (y % 7 == 0) {
+        me.flag |= ME_SHARP;
+      }
+    }
+  }
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < row_len; x++) {
+      MEdge &me = ctx->medges[edges_y_start + y * row_len + x];
+      me.v1 = y * row_len + x;
+      me.v2 = (y + 1) * row_len + x;
+    }
+  }
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int mp_index = y * size + x;
+      MPoly &mp = ctx->mpolys[mp_index];
+      mp.loopstart = mp_index * 4;
+      mp.totloop = 4;
+      mp.flag = (x % 11 == 5) ? 0 : ME_SMOOTH;
+
+      MLoop *ml = &ctx->mloops[mp.loopstart];
+      ml[0].v = y * row_len + x;
+      ml[0].e = y * size + x;
+      ml[1].v = y * row_len + x + 1;
+      ml[1].e = edges_y_start + y * row_len + x + 1;
+      ml[2].v = (y + 1) * row_len + x + 1;
+      ml[2].e = (y + 1) * size + x;
+      ml[3].v = (y + 1) * row_len + x;
+      ml[3].e = edges_y_start + y * row_len + x;
+    }
+  }
+
+  BKE_mesh_calc_normals_poly(ctx->mverts,
+                             nullptr,
+                             ctx->verts_num,
+                             ctx->mloops,
+                             ctx->mpolys,
+                             ctx->loops_num,
+                             ctx->polys_num,
+                             ctx->polynors,
+                             false);
+}
+
+static void test_mesh_normals_free(MeshNormalsTestContext *ctx)
+{
+  MEM_freeN(ctx->mverts);
+  MEM_freeN(ctx->medges);
+  MEM_freeN(ctx->mloops);
+  MEM_freeN(ctx->mpolys);
+  MEM_freeN(ctx->polynors);
+}
+
+static void test_mesh_normals_loop_split(MeshNormalsTestContext *ctx,
+                                         float (*r_loopnors)[3],
+                                         MLoopNorSpaceArray *r_lnors_spacearr,
+                                         short (*clnors)[2])
+{
+  BKE_mesh_normals_loop_split(ctx->mverts,
+                              ctx->verts_num,
+                              ctx->medges,
+                              ctx->edges_num,
+                              ctx->mloops,
+                              r_loopnors,
+                              ctx->loops_num,
+                              ctx->mpolys,
+                              ctx->polynors,
+                              ctx->polys_num,
+                              true,
+                              DEG2RADF(30.0f),
+                              r_lnors_spacearr,
+                              clnors,
+                              nullptr);
+}
+
+TEST(mesh_normals, loop_split_custom_normals_match)
+{
+  /* Large enough to use threading. */
+  MeshNormalsTestContext ctx;
+  test_mesh_normals_init(&ctx, 64);
+
+  float(*loopnors)[3] = (float(*)[3])MEM_malloc_arrayN(
+      ctx.loops_num, sizeof(float[3]), __func__);
+  float(*loopnors_custom)[3] = (float(*)[3])MEM_malloc_arrayN(
+      ctx.loops_num, sizeof(float[3]), __func__);
+  short(*clnors)[2] = (short(*)[2])MEM_calloc_arrayN(ctx.loops_num, sizeof(short[2]), __func__);
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+
+  /* Custom normal data set to zero gives the same result as automatic normals, except that the
+   * split angle is ignored, so only test sharp edges and flat faces. */
+  BKE_mesh_normals_loop_split(ctx.mverts,
+                              ctx.verts_num,
+                              ctx.medges,
+                              ctx.edges_num,
+                              ctx.mloops,
+                              loopnors,
+                              ctx.loops_num,
+                              ctx.mpolys,
+                              ctx.polynors,
+                              ctx.polys_num,
+                              true,
+                              (float)M_PI,
+                              &lnors_spacearr,
+                              nullptr,
+                              nullptr);
+  test_mesh_normals_loop_split(&ctx, loopnors_custom, nullptr, clnors);
+
+  EXPECT_GT(lnors_spacearr.num_spaces, 0);
+  for (int i = 0; i < ctx.loops_num; i++) {
+    EXPECT_NE(lnors_spacearr.lspacearr[i], nullptr);
+    EXPECT_V3_NEAR(loopnors[i], loopnors_custom[i], 1e-4f);
+  }
+
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+  MEM_freeN(loopnors);
+  MEM_freeN(loopnors_custom);
+  MEM_freeN(clnors);
+  test_mesh_normals_free(&ctx);
+}
+
+/**
+ * Two poles of high valence: one in a cyclic smooth fan, and one with non-manifold fins on some
+ * of its spokes, which split it in fans delimited by sharp edges. Polygons are in a shuffled
+ * order, and each one is followed by \a padding disconnected triangles. Loops of the poles get
+ * the same normals with and without padding, but only the padded mesh is large enough to be
+ * processed with threading.
+ */
+struct PoleMesh {
+  Vector<MVert> verts;
+  Vector<MEdge> edges;
+  Vector<MLoop> loops;
+  Vector<MPoly> polys;
+  Vector<float3> polynors;
+  /** Indices of the loops of the poles, in the order they are created. */
+  Vector<int> pole_loops;
+};
+
+static void test_pole_mesh_init(PoleMesh &mesh, const int valence, const int padding)
+{
+  Map<std::pair<int, int>, int> edge_map;
+  auto add_edge = [&](const int v1, const int v2) {
+    return edge_map.lookup_or_add_cb({min_ii(v1, v2), max_ii(v1, v2)}, [&]() {
+      MEdge me = {0};
+      me.v1 = v1;
+      me.v2 = v2;
+      mesh.edges.append(me);
+      return (int)mesh.edges.size() - 1;
+    });
+  };
+  auto add_vert = [&](const float x, const float y, const float z) {
+    MVert mv = {{0}};
+    mv.co[0] = x;
+    mv.co[1] = y;
+    mv.co[2] = z;
+    mesh.verts.append(mv);
+    return (int)mesh.verts.size() - 1;
+  };
+  auto add_tri = [&](const int v1, const int v2, const int v3, const bool is_pole) {
+    MPoly mp = {0};
+    mp.loopstart = mesh.loops.size();
+    mp.totloop = 3;
+    mp.flag = ME_SMOOTH;
+    const int verts[3] = {v1, v2, v3};
+    for (int i = 0; i < 3; i++) {
+      if (is_pole) {
+        mesh.pole_loops.append(mesh.loops.size());
+      }
+      MLoop ml = {0};
+      ml.v = verts[i];
+      ml.e = add_edge(verts[i], verts[(i + 1) % 3]);
+      mesh.loops.append(ml);
+    }
+    mesh.polys.append(mp);
+  };
+
+  /* Both poles, their rings and one fin vertex per spoke. */
+  Vector<std::array<int, 3>> tris;
+  for (int pole = 0; pole < 2; pole++) {
+    const float offset = pole * 10.0f;
+    const int center = add_vert(offset, 0.0f, 1.0f);
+    const int ring_start = mesh.verts.size();
+    for (int i = 0; i < valence; i++) {
+      const float angle = (float)i * 2.0f * (float)M_PI / (float)valence;
+      add_vert(offset + cosf(angle), sinf(angle), 0.2f * sinf(angle * 3.0f));
+    }
+    for (int i = 0; i < valence; i++) {
+      tris.append({center, ring_start + i, ring_start + (i + 1) % valence});
+    }
+    if (pole == 1) {
+      for (int i = 0; i < valence; i += 16) {
+        const int fin = add_vert(offset, 0.0f, 2.0f + (float)i);
+        tris.append({center, fin, ring_start + i});
+      }
+    }
+  }
+  const int pole_verts_num = mesh.verts.size();
+
+  for (int i = 0; i < tris.size(); i++) {
+    /* Shuffle, so that the walk around the poles goes back and forth in polygon order. */
+    const std::array<int, 3> &tri = tris[(i * 7919) % tris.size()];
+    add_tri(tri[0], tri[1], tri[2], true);
+    for (int j = 0; j < padding; j++) {
+      const float x = (float)(mesh.verts.size() - pole_verts_num);
+      const int v1 = add_vert(x, 5.0f, 0.0f);
+      const int v2 = add_vert(x + 1.0f, 5.0f, 0.0f);
+      const int v3 = add_vert(x, 6.0f, 0.0f);
+      add_tri(v1, v2, v3, false);
+    }
+  }
+
+  mesh.polynors.resize(mesh.polys.size());
+  BKE_mesh_calc_normals_poly(mesh.verts.data(),
+                             nullptr,
+                             mesh.verts.size(),
+                             mesh.loops.data(),
+                             mesh.polys.data(),
+                             mesh.loops.size(),
+                             mesh.polys.size(),
+                             (float(*)[3])mesh.polynors.data(),
+                             false);
+}
+
+/** Compute the normals of the loops of the poles, with custom normals. */
+static Vector<float3> test_pole_mesh_normals(PoleMesh &mesh)
+{
+  Vector<float3> loopnors(mesh.loops.size());
+  /* The same custom normal everywhere, so that the result depends on the lnor spaces, and so on
+   * the loop from which each smooth fan is walked. */
+  Vector<std::array<short, 2>> clnors(mesh.loops.size(), {300, -200});
+  BKE_mesh_normals_loop_split(mesh.verts.data(),
+                              mesh.verts.size(),
+                              mesh.edges.data(),
+                              mesh.edges.size(),
+                              mesh.loops.data(),
+                              (float(*)[3])loopnors.data(),
+                              mesh.loops.size(),
+                              mesh.polys.data(),
+                              (const float(*)[3])mesh.polynors.data(),
+                              mesh.polys.size(),
+                              true,
+                              (float)M_PI,
+                              nullptr,
+                              (short(*)[2])clnors.data(),
+                              nullptr);
+  Vector<float3> pole_loopnors;
+  for (const int ml_index : mesh.pole_loops) {
+    pole_loopnors.append(loopnors[ml_index]);
+  }
+  return pole_loopnors;
+}
+
+TEST(mesh_normals, loop_split_threaded_poles_match)
+{
+  const int valence = 256;
+  PoleMesh mesh_serial;
+  test_pole_mesh_init(mesh_serial, valence, 0);
+  PoleMesh mesh_threaded;
+  test_pole_mesh_init(mesh_threaded, valence, 16);
+  /* Below and above the threshold to use threading. */
+  EXPECT_LT(mesh_serial.loops.size(), 8 * 1024);
+  EXPECT_GE(mesh_threaded.loops.size(), 8 * 1024);
+
+  const Vector<float3> loopnors_serial = test_pole_mesh_normals(mesh_serial);
+  ASSERT_EQ(loopnors_serial.size(), mesh_threaded.pole_loops.size());
+  /* Repeat to give races a chance to show. */
+  for (int i = 0; i < 8; i++) {
+    const Vector<float3> loopnors_threaded = test_pole_mesh_normals(mesh_threaded);
+    for (const int j : loopnors_serial.index_range()) {
+      EXPECT_V3_NEAR(loopnors_serial[j], loopnors_threaded[j], 1e-6f);
+    }
+  }
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it is slow.
+ */
+#if 0
+/* Grid of 1582 * 1582 quads, a bit more than 10M loops. */
+static const int performance_grid_size = 1582;
+
+TEST(mesh_normals_performance, loop_split_10M)
+{
+  MeshNormalsTestContext ctx;
+  test_mesh_normals_init(&ctx, performance_grid_size);
+  float(*loopnors)[3] = (float(*)[3])MEM_malloc_arrayN(
+      ctx.loops_num, sizeof(float[3]), __func__);
+  {
+    SCOPED_TIMER("loop_split_10M");
+    test_mesh_normals_loop_split(&ctx, loopnors, nullptr, nullptr);
+  }
+  MEM_freeN(loopnors);
+  test_mesh_normals_free(&ctx);
+}
+
+TEST(mesh_normals_performance, loop_split_custom_normals_10M)
+{
+  MeshNormalsTestContext ctx;
+  test_mesh_normals_init(&ctx, performance_grid_size);
+  float(*loopnors)[3] = (float(*)[3])MEM_malloc_arrayN(
+      ctx.loops_num, sizeof(float[3]), __func__);
+  short(*clnors)[2] = (short(*)[2])MEM_calloc_arrayN(ctx.loops_num, sizeof(short[2]), __func__);
+  {
+    SCOPED_TIMER("loop_split_custom_normals_10M");
+    test_mesh_normals_loop_split(&ctx, loopnors, nullptr, clnors);
+  }
+  MEM_freeN(loopnors);
+  MEM_freeN(clnors);
+  test_mesh_normals_free(&ctx);
+}
+#endif /* Benchmark */
+
+}  // namespace blender::bke::tests
@@ -51,6 +51,8 @@ void BKE_mesh_runtime_reset(Mesh *mesh)
   memset(&mesh->runtime, 0, sizeof(mesh->runtime));
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
+  mesh->runtime.normals_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime normals_mutex");
+  BLI_mutex_init(mesh->runtime.normals_mutex);
 }
 
 /* Clear all pointers which we don't want to be shared on copying the datablock.
@@ -63,22 +65,43 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   runtime->mesh_eval = NULL;
   runtime->edit_data = NULL;
   runtime->batch_cache = NULL;
+  runtime->batch_cache_is_deformed = false;
   runtime->subdiv_ccg = NULL;
   memset(&runtime->looptris, 0, sizeof(runtime->looptris));
   runtime->bvh_cache = NULL;
   runtime->shrinkwrap_data = NULL;
+  runtime->vert_normals = NULL;
+  runtime->poly_normals = NULL;
+  runtime->vert_normals_len = 0;
+  runtime->poly_normals_len = 0;
 
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
+  mesh->runtime.normals_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime normals_mutex");
+  BLI_mutex_init(mesh->runtime.normals_mutex);
 }
 
-void BKE_mesh_runtime_clear_cache(Mesh *mesh)
+/**
+ * Free all runtime data, including the mutexes. Only to be used when the mesh itself is freed,
+ * use #BKE_mesh_runtime_clear_cache for meshes which stay in use.
+ */
+void BKE_mesh_runtime_free_data(Mesh *mesh)
 {
+  BKE_mesh_runtime_clear_cache(mesh);
   if (mesh->runtime.eval_mutex != NULL) {
     BLI_mutex_end(mesh->runtime.eval_mutex);
     MEM_freeN(mesh->runtime.eval_mutex);
     mesh->runtime.eval_mutex = NULL;
   }
+  if (mesh->runtime.normals_mutex != NULL) {
+    BLI_mutex_end(mesh->runtime.normals_mutex);
+    MEM_freeN(mesh->runtime.normals_mutex);
+    mesh->runtime.normals_mutex = NULL;
+  }
+}
+
+void BKE_mesh_runtime_clear_cache(Mesh *mesh)
+{
   if (mesh->runtime.mesh_eval != NULL) {
     mesh->runtime.mesh_eval->edit_mesh = NULL;
     BKE_id_free(NULL, mesh->runtime.mesh_eval);
@@ -230,6 +253,10 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
     mesh->runtime.bvh_cache = NULL;
   }
   MEM_SAFE_FREE(mesh->runtime.looptris.array);
+  MEM_SAFE_FREE(mesh->runtime.vert_normals);
+  MEM_SAFE_FREE(mesh->runtime.poly_normals);
+  mesh->runtime.vert_normals_len = 0;
+  mesh->runtime.poly_normals_len = 0;
   /* TODO(sergey): Does this really belong here? */
   if (mesh->runtime.subdiv_ccg != NULL) {
     BKE_subdiv_ccg_destroy(mesh->runtime.subdiv_ccg);
@@ -261,6 +288,74 @@ void BKE_mesh_batch_cache_free(Mesh *me)
   }
 }
 
+/* Check that all layers are shared between both meshes, except the ones which change along with
+ * vertex positions. Shared data is referenced from the input mesh of the modifier stack. */
+static bool mesh_batch_cache_customdata_is_shared(const CustomData *data_a,
+                                                  const CustomData *data_b)
+{
+  if (data_a->totlayer != data_b->totlayer) {
+    return false;
+  }
+  for (int i = 0; i < data_a->totlayer; i++) {
+    const CustomDataLayer *layer_a = &data_a->layers[i];
+    const CustomDataLayer *layer_b = &data_b->layers[i];
+    if (layer_a->type != layer_b->type) {
+      return false;
+    }
+    if (ELEM(layer_a->type, CD_MVERT, CD_NORMAL, CD_ORCO)) {
+      continue;
+    }
+    if ((layer_a->data != layer_b->data) || !(layer_a->flag & CD_FLAG_NOFREE) ||
+        !(layer_b->flag & CD_FLAG_NOFREE)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Check whether the draw cache of an evaluated mesh may be reused by the next evaluation result,
+ * see #BKE_mesh_batch_cache_transfer_deform.
+ */
+bool BKE_mesh_batch_cache_can_transfer_deform(const Mesh *me_src)
+{
+  return (me_src->runtime.batch_cache != NULL) && (me_src->edit_mesh == NULL) &&
+         (me_src->runtime.subdiv_ccg == NULL);
+}
+
+/**
+ * Move the draw cache of a previous evaluated mesh to \a me_dst when both only differ in vertex
+ * positions, which is the case when deform modifiers are evaluated again (e.g. armature
+ * playback). Only the GPU buffers depending on positions are extracted again then.
+ *
+ * \note The caller must make sure the input mesh of the modifier stack did not change since
+ * \a me_src was evaluated, as only pointers to the data referenced from it are compared.
+ */
+bool BKE_mesh_batch_cache_transfer_deform(Mesh *me_src, Mesh *me_dst)
+{
+  if (!BKE_mesh_batch_cache_can_transfer_deform(me_src) || (me_dst->runtime.batch_cache != NULL) ||
+      (me_dst->edit_mesh != NULL)) {
+    return false;
+  }
+  if ((me_src->totvert != me_dst->totvert) || (me_src->totedge != me_dst->totedge) ||
+      (me_src->totloop != me_dst->totloop) || (me_src->totpoly != me_dst->totpoly) ||
+      (me_src->totcol != me_dst->totcol)) {
+    return false;
+  }
+  if (!mesh_batch_cache_customdata_is_shared(&me_src->vdata, &me_dst->vdata) ||
+      !mesh_batch_cache_customdata_is_shared(&me_src->edata, &me_dst->edata) ||
+      !mesh_batch_cache_customdata_is_shared(&me_src->ldata, &me_dst->ldata) ||
+      !mesh_batch_cache_customdata_is_shared(&me_src->pdata, &me_dst->pdata)) {
+    return false;
+  }
+
+  me_dst->runtime.batch_cache = me_src->runtime.batch_cache;
+  me_src->runtime.batch_cache = NULL;
+  BKE_mesh_batch_cache_dirty_tag(me_dst, BKE_MESH_BATCH_DIRTY_DEFORM);
+  me_dst->runtime.batch_cache_is_deformed = true;
+  return true;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
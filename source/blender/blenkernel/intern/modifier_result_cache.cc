@@ -0,0 +1,521 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_collection_types.h"
+#include "DNA_color_types.h"
+#include "DNA_curveprofile_types.h"
+#include "DNA_key_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_hash.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "BKE_customdata.h"
+#include "BKE_evaluation_cache.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_modifier_result_cache.h"
+
+#include "DEG_depsgraph_query.h"
+
+using blender::Vector;
+using blender::bke::EvaluationCache;
+
+/**
+ * Results of modifiers which took less time to evaluate (in seconds) are not stored, copying
+ * them would take about as long as evaluating them again.
+ */
+#define MODIFIER_CACHE_MIN_EVAL_TIME 0.005
+
+/* -------------------------------------------------------------------- */
+/** \name Cache Keys
+ * \{ */
+
+static void key_add_bytes(uint64_t *key, const void *data, const size_t size)
+{
+  *key = BLI_hash_fnv1a_64(*key, data, size);
+}
+
+template<typename T> static void key_add(uint64_t *key, const T &value)
+{
+  key_add_bytes(key, &value, sizeof(value));
+}
+
+static void key_add_curve_mapping(uint64_t *key, const CurveMapping *cumap)
+{
+  if (cumap == nullptr) {
+    return;
+  }
+  key_add(key, cumap->flag);
+  key_add(key, cumap->preset);
+  key_add(key, cumap->clipr);
+  for (int i = 0; i < ARRAY_SIZE(cumap->cm); i++) {
+    const CurveMap *cuma = &cumap->cm[i];
+    key_add(key, cuma->totpoint);
+    if (cuma->curve != nullptr) {
+      key_add_bytes(key, cuma->curve, sizeof(*cuma->curve) * (size_t)cuma->totpoint);
+    }
+  }
+}
+
+static void key_add_curve_profile(uint64_t *key, const CurveProfile *profile)
+{
+  if (profile == nullptr) {
+    return;
+  }
+  key_add(key, profile->flag);
+  key_add(key, profile->preset);
+  key_add(key, profile->segments_len);
+  for (int i = 0; i < profile->path_len; i++) {
+    const CurveProfilePoint *point = &profile->path[i];
+    /* The other members are runtime data. */
+    key_add(key, point->x);
+    key_add(key, point->y);
+    key_add(key, point->flag);
+    key_add(key, point->h1);
+    key_add(key, point->h2);
+    key_add(key, point->h1_loc);
+    key_add(key, point->h2_loc);
+  }
+}
+
+/**
+ * Settings which are not stored in the modifier struct itself, but in data it points to.
+ * The pointers are cleared in \a md_settings, a copy of the modifier, because the data is
+ * reallocated by every copy-on-write update of the object.
+ *
+ * Other pointers reference data-blocks or bind data, they are included in the key as they are.
+ */
+static void key_add_modifier_indirect_settings(uint64_t *key,
+                                               const ModifierData *md,
+                                               ModifierData *md_settings)
+{
+  switch ((ModifierType)md->type) {
+    case eModifierType_Bevel:
+      key_add_curve_profile(key, ((const BevelModifierData *)md)->custom_profile);
+      ((BevelModifierData *)md_settings)->custom_profile = nullptr;
+      break;
+    case eModifierType_Hook: {
+      const HookModifierData *hmd = (const HookModifierData *)md;
+      key_add_curve_mapping(key, hmd->curfalloff);
+      if (hmd->indexar != nullptr) {
+        key_add_bytes(key, hmd->indexar, sizeof(*hmd->indexar) * (size_t)hmd->totindex);
+      }
+      ((HookModifierData *)md_settings)->curfalloff = nullptr;
+      ((HookModifierData *)md_settings)->indexar = nullptr;
+      break;
+    }
+    case eModifierType_Warp:
+      key_add_curve_mapping(key, ((const WarpModifierData *)md)->curfalloff);
+      ((WarpModifierData *)md_settings)->curfalloff = nullptr;
+      break;
+    case eModifierType_WeightVGEdit:
+      key_add_curve_mapping(key, ((const WeightVGEditModifierData *)md)->cmap_curve);
+      ((WeightVGEditModifierData *)md_settings)->cmap_curve = nullptr;
+      break;
+    case eModifierType_WeightVGProximity:
+      key_add_curve_mapping(key, ((const WeightVGProximityModifierData *)md)->cmap_curve);
+      ((WeightVGProximityModifierData *)md_settings)->cmap_curve = nullptr;
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * Whether the result of the modifier only depends on its settings, its input and the
+ * data-blocks it references.
+ */
+static bool modifier_result_is_cacheable(const ModifierData *md)
+{
+  switch ((ModifierType)md->type) {
+    /* Simulations, and modifiers storing state used by simulations of the following frames. */
+    case eModifierType_Cloth:
+    case eModifierType_Collision:
+    case eModifierType_DynamicPaint:
+    case eModifierType_Fluid:
+    case eModifierType_Fluidsim:
+    case eModifierType_ParticleSystem:
+    case eModifierType_Softbody:
+    case eModifierType_Surface:
+    /* Depends on the particle systems of the object. */
+    case eModifierType_Explode:
+    /* Node trees can reference data-blocks which are not known to the modifier, and the input
+     * values are stored in ID properties. */
+    case eModifierType_Nodes:
+      return false;
+    default:
+      return true;
+  }
+}
+
+/**
+ * Add the objects of the collection and its children to the key.
+ * \return False when the collection or any of its objects has been tagged for update.
+ */
+static bool key_add_collection(uint64_t *key, const Collection *collection)
+{
+  if (collection->id.recalc != 0) {
+    return false;
+  }
+  LISTBASE_FOREACH (const CollectionObject *, collection_object, &collection->gobject) {
+    const Object *object = collection_object->ob;
+    if (object->id.recalc != 0) {
+      return false;
+    }
+    key_add(key, object->id.session_uuid);
+  }
+  LISTBASE_FOREACH (const CollectionChild *, collection_child, &collection->children) {
+    if (!key_add_collection(key, collection_child->collection)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct ModifierIDKeyData {
+  uint64_t *key;
+  bool id_changed;
+};
+
+static void modifier_id_key_cb(void *user_data,
+                               Object *UNUSED(ob),
+                               ID **idpoin,
+                               int UNUSED(cb_flag))
+{
+  ModifierIDKeyData *data = (ModifierIDKeyData *)user_data;
+  const ID *id = *idpoin;
+  if (id == nullptr) {
+    return;
+  }
+  if (GS(id->name) == ID_GR) {
+    /* Modifiers using collections depend on the objects in it (e.g. Boolean), moving them does
+     * not tag the collection. Objects can also be added to collections without tagging them. */
+    if (!key_add_collection(data->key, (const Collection *)id)) {
+      data->id_changed = true;
+    }
+    return;
+  }
+  /* The recalc flags of evaluated data-blocks are set for the whole evaluation after an update
+   * of the data-block or of anything it depends on. */
+  if (id->recalc != 0) {
+    data->id_changed = true;
+  }
+}
+
+static bool modifier_key_update(uint64_t *key,
+                                const Scene *scene,
+                                Object *ob,
+                                ModifierData *md,
+                                const CustomData_MeshMasks *mask,
+                                const CustomData_MeshMasks *next_mask,
+                                const int required_mode,
+                                const float ctime)
+{
+  const ModifierTypeInfo *mti = BKE_modifier_get_info((ModifierType)md->type);
+  const bool is_enabled = BKE_modifier_is_enabled(scene, md, required_mode);
+
+  key_add(key, md->type);
+  key_add(key, md->mode);
+  key_add(key, is_enabled);
+  if (!is_enabled) {
+    return true;
+  }
+  if (!modifier_result_is_cacheable(md)) {
+    return false;
+  }
+
+  ModifierIDKeyData id_data = {key, false};
+  if (mti->foreachIDLink != nullptr) {
+    mti->foreachIDLink(md, ob, modifier_id_key_cb, &id_data);
+  }
+  if (id_data.id_changed) {
+    return false;
+  }
+
+  /* Type specific settings follow the common #ModifierData members. */
+  Vector<char, 1024> settings(mti->structSize);
+  memcpy(settings.data(), md, (size_t)mti->structSize);
+  key_add_modifier_indirect_settings(key, md, (ModifierData *)settings.data());
+  key_add_bytes(key,
+                settings.data() + sizeof(ModifierData),
+                (size_t)mti->structSize - sizeof(ModifierData));
+
+  if (mti->dependsOnTime && mti->dependsOnTime(md)) {
+    key_add(key, ctime);
+  }
+
+  /* Layers which are kept in the result, and which are created before the evaluation. */
+  key_add(key, *mask);
+  key_add(key, *next_mask);
+  if ((mask->vmask | next_mask->vmask) & (CD_MASK_ORCO | CD_MASK_CLOTH_ORCO)) {
+    /* Undeformed coordinates are evaluated in parallel to the stack, they are not cached. */
+    return false;
+  }
+  return true;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Cached Data
+ * \{ */
+
+/**
+ * Result of the modifier stack up to a modifier. Shared pointers keep the data alive while it is
+ * being copied, even if the entry is evicted by another thread at the same time.
+ */
+struct CachedResult {
+  Mesh *mesh = nullptr;
+  GeometrySet geometry_set;
+  /** Errors reported by the modifiers up to the cached one, with the index of the modifier. */
+  Vector<std::pair<int, std::string>> errors;
+
+  ~CachedResult()
+  {
+    if (mesh != nullptr) {
+      BKE_id_free(nullptr, mesh);
+    }
+  }
+};
+
+struct CacheEntry {
+  int modifier_index;
+  uint64_t key;
+  /** Insertion order, used to find the entry from the eviction queue. */
+  uint64_t stamp;
+  size_t memory_size;
+  std::shared_ptr<CachedResult> data;
+};
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Global Cache
+ * \{ */
+
+using ModifierResultCache = EvaluationCache<CacheEntry>;
+
+static ModifierResultCache GLOBAL_CACHE;
+
+static size_t modifier_cache_limit_get(void)
+{
+  return ((size_t)max_ii(U.modifier_cache_limit, 0)) * 1024 * 1024;
+}
+
+static uint object_cache_key(const Object *ob)
+{
+  const Object *ob_orig = DEG_get_original_object(const_cast<Object *>(ob));
+  return ob_orig->id.session_uuid;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+bool BKE_modifier_result_cache_is_enabled(void)
+{
+  return U.modifier_cache_limit > 0;
+}
+
+void BKE_modifier_result_cache_keys_calc(const Depsgraph *depsgraph,
+                                         const Scene *scene,
+                                         Object *ob,
+                                         ModifierData *firstmd,
+                                         const CDMaskLink *datamasks,
+                                         const CustomData_MeshMasks *final_datamask,
+                                         const int required_mode,
+                                         const bool need_mapping,
+                                         uint64_t *r_keys,
+                                         const int keys_num)
+{
+  const float ctime = DEG_get_ctime(depsgraph);
+  const Mesh *mesh = (const Mesh *)ob->data;
+
+  /* Any change of the input mesh invalidates all results. */
+  bool is_valid = (mesh->id.recalc == 0) && (mesh->key == nullptr || mesh->key->id.recalc == 0);
+
+  uint64_t key = BLI_HASH_FNV1A_64_INIT;
+  key_add(&key, need_mapping);
+  key_add(&key, ob->obmat);
+  LISTBASE_FOREACH (const bDeformGroup *, dg, &ob->defbase) {
+    key_add(&key, dg->name);
+  }
+
+  ModifierData *md = firstmd;
+  const CDMaskLink *md_datamask = datamasks;
+  for (int i = 0; i < keys_num; i++, md = md->next, md_datamask = md_datamask->next) {
+    const CustomData_MeshMasks *next_mask = md_datamask->next ? &md_datamask->next->mask :
+                                                                final_datamask;
+    is_valid = is_valid && modifier_key_update(&key,
+                                               scene,
+                                               ob,
+                                               md,
+                                               &md_datamask->mask,
+                                               next_mask,
+                                               required_mode,
+                                               ctime);
+    /* Zero is reserved for results which can not be cached. */
+    r_keys[i] = is_valid ? (key | 1) : 0;
+  }
+}
+
+int BKE_modifier_result_cache_lookup(const Depsgraph *depsgraph,
+                                     Object *ob,
+                                     ModifierData *firstmd,
+                                     const uint64_t *keys,
+                                     const int keys_num,
+                                     Mesh **r_mesh,
+                                     GeometrySet **r_geometry_set)
+{
+  const uint object_uuid = object_cache_key(ob);
+
+  int modifier_index = -1;
+  std::shared_ptr<CachedResult> data;
+  {
+    std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+    ModifierResultCache::GraphCache *graph_cache = GLOBAL_CACHE.lookup_graph(depsgraph);
+    if (graph_cache == nullptr) {
+      return -1;
+    }
+    ModifierResultCache::ObjectCache *object_cache = graph_cache->objects.lookup_ptr(
+        object_uuid);
+    if (object_cache == nullptr) {
+      return -1;
+    }
+    /* Results with a different key will not be used again, free them. */
+    for (int i = object_cache->entries.size() - 1; i >= 0; i--) {
+      const CacheEntry &entry = object_cache->entries[i];
+      if (entry.modifier_index >= keys_num || entry.key != keys[entry.modifier_index]) {
+        GLOBAL_CACHE.remove_entry(*object_cache, i);
+      }
+    }
+    for (const CacheEntry &entry : object_cache->entries) {
+      if (entry.modifier_index > modifier_index) {
+        modifier_index = entry.modifier_index;
+        data = entry.data;
+      }
+    }
+  }
+
+  if (!data) {
+    return -1;
+  }
+
+  *r_mesh = BKE_mesh_copy_for_eval(data->mesh, false);
+  /* Components are shared, they are copied when they are accessed for write. */
+  *r_geometry_set = new GeometrySet(data->geometry_set);
+
+  /* The evaluation of these modifiers is skipped, report their errors again. */
+  int i = 0;
+  for (ModifierData *md = firstmd; i <= modifier_index; md = md->next, i++) {
+    for (const std::pair<int, std::string> &error : data->errors) {
+      if (error.first == i) {
+        BKE_modifier_set_error(ob, md, "%s", error.second.c_str());
+      }
+    }
+  }
+
+  return modifier_index;
+}
+
+void BKE_modifier_result_cache_store(const Depsgraph *depsgraph,
+                                     const Object *ob,
+                                     const ModifierData *firstmd,
+                                     const int modifier_index,
+                                     const uint64_t key,
+                                     const double eval_time,
+                                     Mesh *mesh,
+                                     const GeometrySet *geometry_set)
+{
+  if (key == 0 || eval_time < MODIFIER_CACHE_MIN_EVAL_TIME) {
+    return;
+  }
+
+  const size_t limit = modifier_cache_limit_get();
+  /* The size of the copy, computed before copying to skip results which would not fit. */
+  const size_t memory_size = BKE_mesh_memory_size(mesh) + geometry_set->memory_size();
+  if (memory_size > limit) {
+    return;
+  }
+
+  /* Copy outside of the lock, this is the expensive part. The copy does not reference any data
+   * of the original mesh, so it stays valid when the original is changed. */
+  std::shared_ptr<CachedResult> data = std::make_shared<CachedResult>();
+  data->mesh = BKE_mesh_copy_for_eval(mesh, false);
+  data->geometry_set = *geometry_set;
+  int i = 0;
+  for (const ModifierData *md = firstmd; i <= modifier_index; md = md->next, i++) {
+    if (md->error != nullptr) {
+      data->errors.append({i, md->error});
+    }
+  }
+
+  const uint object_uuid = object_cache_key(ob);
+
+  CacheEntry entry;
+  entry.modifier_index = modifier_index;
+  entry.key = key;
+  entry.memory_size = memory_size;
+  entry.data = std::move(data);
+
+  std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+  ModifierResultCache::ObjectCache &object_cache =
+      GLOBAL_CACHE.ensure_graph(depsgraph).objects.lookup_or_add_default(object_uuid);
+  for (const int i : object_cache.entries.index_range()) {
+    if (object_cache.entries[i].modifier_index == modifier_index) {
+      GLOBAL_CACHE.remove_entry(object_cache, i);
+      break;
+    }
+  }
+  GLOBAL_CACHE.add_entry(depsgraph, object_uuid, std::move(entry), limit);
+}
+
+void BKE_modifier_result_cache_free_depsgraph(const Depsgraph *depsgraph)
+{
+  std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+  GLOBAL_CACHE.free_graph(depsgraph);
+}
+
+void BKE_modifier_result_cache_limit_update(void)
+{
+  const size_t limit = modifier_cache_limit_get();
+  std::lock_guard<std::mutex> lock(GLOBAL_CACHE.mutex);
+  GLOBAL_CACHE.evict(limit);
+}
+
+/** \} */
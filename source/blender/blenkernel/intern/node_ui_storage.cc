@@ -14,6 +14,8 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <mutex>
+
 #include "CLG_log.h"
 
 #include "BLI_map.hh"
@@ -27,6 +29,10 @@
 
 static CLG_LogRef LOG = {"bke.node_ui_storage"};
 
+/* Nodes of the same tree can be executed on multiple threads, and the same tree can be used by
+ * different modifiers which are evaluated in parallel. */
+static std::mutex ui_storage_mutex;
+
 using blender::Map;
 using blender::StringRef;
 using blender::Vector;
@@ -46,6 +52,7 @@ static void ui_storage_ensure(bNodeTree &ntree)
 void BKE_nodetree_ui_storage_free_for_context(bNodeTree &ntree,
                                               const NodeTreeEvaluationContext &context)
 {
+  std::lock_guard lock{ui_storage_mutex};
   NodeTreeUIStorage *ui_storage = ntree.ui_storage;
   if (ui_storage != nullptr) {
     ui_storage->context_map.remove(context);
@@ -107,6 +114,25 @@ void BKE_nodetree_error_message_add(bNodeTree &ntree,
 {
   node_error_message_log(ntree, node, message, type);
 
+  std::lock_guard lock{ui_storage_mutex};
   NodeUIStorage &node_ui_storage = find_node_ui_storage(ntree, context, node);
   node_ui_storage.warnings.append({type, std::move(message)});
 }
+
+bool BKE_nodetree_ui_storage_node_has_warnings(const bNodeTree &ntree,
+                                               const NodeTreeEvaluationContext &context,
+                                               const bNode &node)
+{
+  std::lock_guard lock{ui_storage_mutex};
+  const NodeTreeUIStorage *ui_storage = ntree.ui_storage;
+  if (ui_storage == nullptr) {
+    return false;
+  }
+  const Map<std::string, NodeUIStorage> *node_tree_ui_storage = ui_storage->context_map.lookup_ptr(
+      context);
+  if (node_tree_ui_storage == nullptr) {
+    return false;
+  }
+  const NodeUIStorage *node_ui_storage = node_tree_ui_storage->lookup_ptr_as(StringRef(node.name));
+  return node_ui_storage != nullptr && !node_ui_storage->warnings.is_empty();
+}
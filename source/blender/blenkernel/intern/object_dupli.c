@@ -86,6 +86,9 @@ typedef struct DupliContext {
 
   const struct DupliGenerator *gen;
 
+  /** Create duplis for geometry sets instanced by geometry nodes, see #DupliObject.ob_data. */
+  bool use_instanced_geometry;
+
   /** Result containers. */
   ListBase *duplilist; /* Legacy doubly-linked list. */
 } DupliContext;
@@ -104,7 +107,8 @@ static void init_context(DupliContext *r_ctx,
                          Depsgraph *depsgraph,
                          Scene *scene,
                          Object *ob,
-                         const float space_mat[4][4])
+                         const float space_mat[4][4],
+                         const bool use_instanced_geometry)
 {
   r_ctx->depsgraph = depsgraph;
   r_ctx->scene = scene;
@@ -122,6 +126,7 @@ static void init_context(DupliContext *r_ctx,
   r_ctx->level = 0;
 
   r_ctx->gen = get_dupli_generator(r_ctx);
+  r_ctx->use_instanced_geometry = use_instanced_geometry;
 
   r_ctx->duplilist = NULL;
 }
@@ -811,15 +816,60 @@ static const DupliGenerator gen_dupli_verts_pointcloud = {
 /** \name Instances Geometry Component Implementation
  * \{ */
 
-static void make_duplis_instances_component(const DupliContext *ctx)
+static void make_duplis_geometry_set_instances(const DupliContext *ctx,
+                                               const struct GeometrySet *geometry_set,
+                                               const float parent_matrix[4][4]);
+
+/**
+ * Geometry sets instanced by geometry nodes don't have an object. They are instanced as the
+ * object owning the geometry set, with its data replaced by the data of the geometry set. All
+ * instances of the same geometry set share the same data, so they can be drawn and rendered as
+ * real instances.
+ */
+static void make_duplis_instanced_geometry_set(const DupliContext *ctx,
+                                               const struct GeometrySet *geometry_set,
+                                               const float matrix[4][4],
+                                               const int id)
+{
+  /* Simple preventing of too deep nested instances with #MAX_DUPLI_RECUR. */
+  if (ctx->level >= MAX_DUPLI_RECUR) {
+    return;
+  }
+
+  DupliContext sub_ctx;
+  copy_dupli_context(&sub_ctx, ctx, ctx->object, NULL, id);
+  /* The object stays the same, only a level of persistent ids is added. */
+  sub_ctx.gen = ctx->gen;
+
+  /* Only users that replace the object data with #DupliObject.ob_data ask for these duplis,
+   * all others would see the owner object with its full evaluated geometry. */
+  if (ctx->use_instanced_geometry) {
+    ID *data[3];
+    const int data_len = BKE_geometry_set_drawable_data(geometry_set, data);
+    for (int i = 0; i < data_len; i++) {
+      DupliObject *dob = make_dupli(&sub_ctx, ctx->object, matrix, i);
+      if (dob != NULL) {
+        dob->ob_data = data[i];
+      }
+    }
+  }
+
+  make_duplis_geometry_set_instances(&sub_ctx, geometry_set, matrix);
+}
+
+/**
+ * \param parent_matrix: Transform of the geometry set containing the instances, relative to the
+ * current context.
+ */
+static void make_duplis_geometry_set_instances(const DupliContext *ctx,
+                                               const struct GeometrySet *geometry_set,
+                                               const float parent_matrix[4][4])
 {
   float(*instance_offset_matrices)[4][4];
   InstancedData *instanced_data;
   const int *almost_unique_ids;
-  const int amount = BKE_geometry_set_instances(ctx->object->runtime.geometry_set_eval,
-                                                &instance_offset_matrices,
-                                                &almost_unique_ids,
-                                                &instanced_data);
+  const int amount = BKE_geometry_set_instances(
+      geometry_set, &instance_offset_matrices, &almost_unique_ids, &instanced_data);
 
   for (int i = 0; i < amount; i++) {
     InstancedData *data = &instanced_data[i];
@@ -830,12 +880,12 @@ static void make_duplis_instances_component(const DupliContext *ctx)
       Object *object = data->data.object;
       if (object != NULL) {
         float matrix[4][4];
-        mul_m4_m4m4(matrix, ctx->object->obmat, instance_offset_matrices[i]);
+        mul_m4_m4m4(matrix, parent_matrix, instance_offset_matrices[i]);
         make_dupli(ctx, object, matrix, id);
 
         float space_matrix[4][4];
         mul_m4_m4m4(space_matrix, instance_offset_matrices[i], object->imat);
-        mul_m4_m4_pre(space_matrix, ctx->object->obmat);
+        mul_m4_m4_pre(space_matrix, parent_matrix);
         make_recursive_duplis(ctx, object, space_matrix, id);
       }
     }
@@ -846,7 +896,7 @@ static void make_duplis_instances_component(const DupliContext *ctx)
         unit_m4(collection_matrix);
         sub_v3_v3(collection_matrix[3], collection->instance_offset);
         mul_m4_m4_pre(collection_matrix, instance_offset_matrices[i]);
-        mul_m4_m4_pre(collection_matrix, ctx->object->obmat);
+        mul_m4_m4_pre(collection_matrix, parent_matrix);
 
         eEvaluationMode mode = DEG_get_mode(ctx->depsgraph);
         FOREACH_COLLECTION_VISIBLE_OBJECT_RECURSIVE_BEGIN (collection, object, mode) {
@@ -863,9 +913,23 @@ static void make_duplis_instances_component(const DupliContext *ctx)
         FOREACH_COLLECTION_VISIBLE_OBJECT_RECURSIVE_END;
       }
     }
+    else if (data->type == INSTANCE_DATA_TYPE_GEOMETRY_SET) {
+      const struct GeometrySet *instanced_geometry_set = data->data.geometry_set;
+      if (instanced_geometry_set != NULL) {
+        float matrix[4][4];
+        mul_m4_m4m4(matrix, parent_matrix, instance_offset_matrices[i]);
+        make_duplis_instanced_geometry_set(ctx, instanced_geometry_set, matrix, id);
+      }
+    }
   }
 }
 
+static void make_duplis_instances_component(const DupliContext *ctx)
+{
+  make_duplis_geometry_set_instances(
+      ctx, ctx->object->runtime.geometry_set_eval, ctx->object->obmat);
+}
+
 static const DupliGenerator gen_dupli_instances_component = {
     0,
     make_duplis_instances_component,
@@ -1589,13 +1653,19 @@ static const DupliGenerator *get_dupli_generator(const DupliContext *ctx)
  * \{ */
 
 /**
+ * \param use_instanced_geometry: Also create duplis for geometry sets instanced by geometry
+ * nodes. These keep the owner object in #DupliObject.ob, so only callers that use
+ * #DupliObject.ob_data in place of the object data should enable this.
  * \return a #ListBase of #DupliObject.
  */
-ListBase *object_duplilist(Depsgraph *depsgraph, Scene *sce, Object *ob)
+ListBase *object_duplilist_ex(Depsgraph *depsgraph,
+                              Scene *sce,
+                              Object *ob,
+                              const bool use_instanced_geometry)
 {
   ListBase *duplilist = MEM_callocN(sizeof(ListBase), "duplilist");
   DupliContext ctx;
-  init_context(&ctx, depsgraph, sce, ob, NULL);
+  init_context(&ctx, depsgraph, sce, ob, NULL, use_instanced_geometry);
   if (ctx.gen) {
     ctx.duplilist = duplilist;
     ctx.gen->make_duplis(&ctx);
@@ -1604,6 +1674,14 @@ ListBase *object_duplilist(Depsgraph *depsgraph, Scene *sce, Object *ob)
   return duplilist;
 }
 
+/**
+ * \return a #ListBase of #DupliObject.
+ */
+ListBase *object_duplilist(Depsgraph *depsgraph, Scene *sce, Object *ob)
+{
+  return object_duplilist_ex(depsgraph, sce, ob, false);
+}
+
 void free_object_duplilist(ListBase *lb)
 {
   BLI_freelistN(lb);
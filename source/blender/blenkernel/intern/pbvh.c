@@ -1126,6 +1126,11 @@ static void pbvh_faces_update_normals(PBVH *pbvh, PBVHNode **nodes, int totnode)
   BLI_task_parallel_range(0, totnode, &data, pbvh_update_normals_store_task_cb, &settings);
 
   MEM_freeN(vnors);
+
+  /* Vertices are moved without tagging the mesh, and only #MVert.no is updated above. */
+  if (pbvh->mesh != NULL) {
+    BKE_mesh_normals_cache_tag_dirty((Mesh *)pbvh->mesh);
+  }
 }
 
 static void pbvh_update_mask_redraw_task_cb(void *__restrict userdata,
@@ -902,19 +902,7 @@ BoundBox *BKE_volume_boundbox_get(Object *ob)
      * load it as part of dependency graph evaluation for better threading. We
      * could also share the bounding box computation in the global volume cache. */
     if (BKE_volume_load(volume, G.main)) {
-      const int num_grids = BKE_volume_num_grids(volume);
-
-      for (int i = 0; i < num_grids; i++) {
-        VolumeGrid *grid = BKE_volume_grid_get(volume, i);
-        float grid_min[3], grid_max[3];
-
-        BKE_volume_grid_load(volume, grid);
-        if (BKE_volume_grid_bounds(grid, grid_min, grid_max)) {
-          DO_MIN(grid_min, min);
-          DO_MAX(grid_max, max);
-          have_minmax = true;
-        }
-      }
+      have_minmax = BKE_volume_min_max(volume, min, max);
     }
 
     if (!have_minmax) {
@@ -928,6 +916,30 @@ BoundBox *BKE_volume_boundbox_get(Object *ob)
   return ob->runtime.bb;
 }
 
+/**
+ * Expand \a r_min and \a r_max by the bounds of all grids of a loaded volume.
+ * \return False when no grid has any bounds.
+ */
+bool BKE_volume_min_max(const Volume *volume, float r_min[3], float r_max[3])
+{
+  bool have_minmax = false;
+  const int num_grids = BKE_volume_num_grids(volume);
+
+  for (int i = 0; i < num_grids; i++) {
+    VolumeGrid *grid = BKE_volume_grid_get(volume, i);
+    float grid_min[3], grid_max[3];
+
+    BKE_volume_grid_load(volume, grid);
+    if (BKE_volume_grid_bounds(grid, grid_min, grid_max)) {
+      DO_MIN(grid_min, r_min);
+      DO_MAX(grid_max, r_max);
+      have_minmax = true;
+    }
+  }
+
+  return have_minmax;
+}
+
 bool BKE_volume_is_y_up(const Volume *volume)
 {
   /* Simple heuristic for common files to open the right way up. */
@@ -1143,6 +1155,22 @@ const char *BKE_volume_grids_frame_filepath(const Volume *volume)
 #endif
 }
 
+/**
+ * Approximate memory used by the volume and the trees of its loaded grids, in bytes.
+ */
+size_t BKE_volume_memory_size(const Volume *volume)
+{
+  size_t size = sizeof(Volume);
+#ifdef WITH_OPENVDB
+  for (const VolumeGrid &grid : *volume->runtime.grids) {
+    if (grid.grid_is_loaded()) {
+      size += (size_t)grid.grid()->memUsage();
+    }
+  }
+#endif
+  return size;
+}
+
 VolumeGrid *BKE_volume_grid_get(const Volume *volume, int grid_index)
 {
 #ifdef WITH_OPENVDB
@@ -110,6 +110,22 @@ BLI_INLINE float BLI_hash_int_01(unsigned int k)
   return (float)BLI_hash_int(k) * (1.0f / (float)0xFFFFFFFF);
 }
 
+/**
+ * 64 bit FNV-1a, for keys built incrementally from many values which are only compared for
+ * equality. Start with #BLI_HASH_FNV1A_64_INIT and pass the result of the previous call.
+ */
+#define BLI_HASH_FNV1A_64_INIT 14695981039346656037ULL
+
+BLI_INLINE uint64_t BLI_hash_fnv1a_64(uint64_t hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
 BLI_INLINE void BLI_hash_pointer_to_color(const void *ptr, int *r, int *g, int *b)
 {
   size_t val = (size_t)ptr;
@@ -29,14 +29,16 @@
  *  - Literals:
  *      floating point and decimal integer.
  *  - Constants:
- *      pi, True, False
+ *      pi, tau, e, inf, True, False
  *  - Operators:
- *      +, -, *, /, ==, !=, <, <=, >, >=, and, or, not, ternary if
+ *      +, -, *, /, //, %, **, ==, !=, <, <=, >, >=, and, or, not, ternary if
  *  - Functions:
  *      min, max, radians, degrees,
- *      abs, fabs, floor, ceil, trunc, int,
+ *      abs, fabs, floor, ceil, trunc, round, int, float, bool,
  *      sin, cos, tan, asin, acos, atan, atan2,
- *      exp, log, sqrt, pow, fmod
+ *      sinh, cosh, tanh, asinh, acosh, atanh,
+ *      exp, log, log2, log10, sqrt, pow, fmod, hypot, copysign,
+ *      lerp, clamp, smoothstep
  *
  * The implementation has no global state and can be used multi-threaded.
  */
@@ -315,6 +317,43 @@ static double op_div(double a, double b)
   return a / b;
 }
 
+/* Python floor division, consistent with #op_mod so that `a == (a // b) * b + a % b`.
+ * Same as `float_floor_div` in CPython, `floor(a / b)` is off by one for e.g. `1 // 0.1`. */
+static double op_floordiv(double a, double b)
+{
+  if (b == 0.0) {
+    /* Raise the division by zero error. */
+    return a / b;
+  }
+
+  const double mod = fmod(a, b);
+  double div = (a - mod) / b;
+  if (mod != 0.0 && ((mod < 0.0) != (b < 0.0))) {
+    div -= 1.0;
+  }
+
+  if (div == 0.0) {
+    return copysign(0.0, a / b);
+  }
+
+  /* Snap to the nearest integer, the division is exact up to rounding. */
+  double floordiv = floor(div);
+  if (div - floordiv > 0.5) {
+    floordiv += 1.0;
+  }
+  return floordiv;
+}
+
+/* Python modulo, the result has the same sign as the divisor. */
+static double op_mod(double a, double b)
+{
+  double result = fmod(a, b);
+  if (result != 0.0 && ((result < 0.0) != (b < 0.0))) {
+    result += b;
+  }
+  return result;
+}
+
 static double op_add(double a, double b)
 {
   return a + b;
@@ -364,6 +403,16 @@ static double op_smoothstep(double a, double b, double x)
   return t * t * (3.0 - 2.0 * t);
 }
 
+static double op_bool(double a)
+{
+  return a ? 1.0 : 0.0;
+}
+
+static double op_identity(double a)
+{
+  return a;
+}
+
 static double op_not(double a)
 {
   return a ? 0.0 : 1.0;
@@ -405,7 +454,14 @@ typedef struct BuiltinConstDef {
 } BuiltinConstDef;
 
 static BuiltinConstDef builtin_consts[] = {
-    {"pi", M_PI}, {"True", 1.0}, {"False", 0.0}, {NULL, 0.0}};
+    {"pi", M_PI},
+    {"tau", 2.0 * M_PI},
+    {"e", M_E},
+    {"inf", INFINITY},
+    {"True", 1.0},
+    {"False", 0.0},
+    {NULL, 0.0},
+};
 
 typedef struct BuiltinOpDef {
   const char *name;
@@ -430,6 +486,8 @@ static BuiltinOpDef builtin_ops[] = {
     {"trunc", OPCODE_FUNC1, trunc},
     {"round", OPCODE_FUNC1, round},
     {"int", OPCODE_FUNC1, trunc},
+    {"float", OPCODE_FUNC1, op_identity},
+    {"bool", OPCODE_FUNC1, op_bool},
     {"sin", OPCODE_FUNC1, sin},
     {"cos", OPCODE_FUNC1, cos},
     {"tan", OPCODE_FUNC1, tan},
@@ -437,12 +495,22 @@ static BuiltinOpDef builtin_ops[] = {
     {"acos", OPCODE_FUNC1, acos},
     {"atan", OPCODE_FUNC1, atan},
     {"atan2", OPCODE_FUNC2, atan2},
+    {"sinh", OPCODE_FUNC1, sinh},
+    {"cosh", OPCODE_FUNC1, cosh},
+    {"tanh", OPCODE_FUNC1, tanh},
+    {"asinh", OPCODE_FUNC1, asinh},
+    {"acosh", OPCODE_FUNC1, acosh},
+    {"atanh", OPCODE_FUNC1, atanh},
     {"exp", OPCODE_FUNC1, exp},
     {"log", OPCODE_FUNC1, log},
     {"log", OPCODE_FUNC2, op_log2},
+    {"log2", OPCODE_FUNC1, log2},
+    {"log10", OPCODE_FUNC1, log10},
     {"sqrt", OPCODE_FUNC1, sqrt},
     {"pow", OPCODE_FUNC2, pow},
     {"fmod", OPCODE_FUNC2, fmod},
+    {"hypot", OPCODE_FUNC2, hypot},
+    {"copysign", OPCODE_FUNC2, copysign},
     {"lerp", OPCODE_FUNC3, op_lerp},
     {"clamp", OPCODE_FUNC1, op_clamp},
     {"clamp", OPCODE_FUNC3, op_clamp3},
@@ -472,6 +540,8 @@ static BuiltinOpDef builtin_ops[] = {
 #define TOKEN_LE MAKE_CHAR2('<', '=')
 #define TOKEN_NE MAKE_CHAR2('!', '=')
 #define TOKEN_EQ MAKE_CHAR2('=', '=')
+#define TOKEN_POW MAKE_CHAR2('*', '*')
+#define TOKEN_FLOORDIV MAKE_CHAR2('/', '/')
 #define TOKEN_AND MAKE_CHAR2('A', 'N')
 #define TOKEN_OR MAKE_CHAR2('O', 'R')
 #define TOKEN_NOT MAKE_CHAR2('N', 'O')
@@ -720,6 +790,13 @@ static bool parse_next_token(ExprParseState *state)
     return true;
   }
 
+  /* ** and // tokens */
+  if (ELEM(state->cur[0], '*', '/') && state->cur[1] == state->cur[0]) {
+    state->token = MAKE_CHAR2(state->cur[0], state->cur[1]);
+    state->cur += 2;
+    return true;
+  }
+
   /* Special characters (single character tokens) */
   if (strchr(token_characters, *state->cur)) {
     state->token = *state->cur++;
@@ -792,19 +869,11 @@ static int parse_function_args(ExprParseState *state)
   }
 }
 
-static bool parse_unary(ExprParseState *state)
+static bool parse_primary(ExprParseState *state)
 {
   int i;
 
   switch (state->token) {
-    case '+':
-      return parse_next_token(state) && parse_unary(state);
-
-    case '-':
-      CHECK_ERROR(parse_next_token(state) && parse_unary(state));
-      parse_add_func(state, OPCODE_FUNC1, 1, op_negate);
-      return true;
-
     case '(':
       return parse_next_token(state) && parse_expr(state) && state->token == ')' &&
              parse_next_token(state);
@@ -875,6 +944,37 @@ static bool parse_unary(ExprParseState *state)
   }
 }
 
+static bool parse_unary(ExprParseState *state);
+
+/* The power operator binds tighter than unary operators on its left, but not on its right. */
+static bool parse_power(ExprParseState *state)
+{
+  CHECK_ERROR(parse_primary(state));
+
+  if (state->token == TOKEN_POW) {
+    CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+    parse_add_func(state, OPCODE_FUNC2, 2, pow);
+  }
+
+  return true;
+}
+
+static bool parse_unary(ExprParseState *state)
+{
+  switch (state->token) {
+    case '+':
+      return parse_next_token(state) && parse_unary(state);
+
+    case '-':
+      CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+      parse_add_func(state, OPCODE_FUNC1, 1, op_negate);
+      return true;
+
+    default:
+      return parse_power(state);
+  }
+}
+
 static bool parse_mul(ExprParseState *state)
 {
   CHECK_ERROR(parse_unary(state));
@@ -891,6 +991,16 @@ static bool parse_mul(ExprParseState *state)
         parse_add_func(state, OPCODE_FUNC2, 2, op_div);
         break;
 
+      case TOKEN_FLOORDIV:
+        CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+        parse_add_func(state, OPCODE_FUNC2, 2, op_floordiv);
+        break;
+
+      case '%':
+        CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+        parse_add_func(state, OPCODE_FUNC2, 2, op_mod);
+        break;
+
       default:
         return true;
     }
@@ -77,6 +77,14 @@ void DEG_graph_relations_update(struct Depsgraph *graph);
 /* Tag all relations in the database for update.*/
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of the given ID for update.
+ *
+ * Unlike #DEG_relations_tag_update only nodes and relations of this ID (and relations of IDs
+ * it is connected to) are re-built, which is much faster for big scenes. Graphs for which such
+ * partial update is not possible fall back to the full rebuild. */
+void DEG_graph_id_tag_relations_update(struct Depsgraph *graph, struct ID *id);
+void DEG_id_tag_relations_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /* Handle for components to define their dependencies from callbacks.
@@ -64,6 +64,10 @@ eEvaluationMode DEG_get_mode(const Depsgraph *graph);
 /* Get time that depsgraph is being evaluated or was last evaluated at. */
 float DEG_get_ctime(const Depsgraph *graph);
 
+/* Get counter which is incremented on every update of depsgraph which is not caused by a time
+ * change. Data evaluated at the same time and the same update count is the same. */
+uint64_t DEG_get_update_count(const Depsgraph *graph);
+
 /* ********************* DEG evaluated data ******************* */
 
 /* Check if given ID type was tagged for update. */
@@ -169,6 +173,8 @@ typedef struct DEGObjectIterData {
   /* Temporary storage to report fully populated DNA to the render engine or
    * other users of the iterator. */
   struct Object temp_dupli_object;
+  /* Bounds of #temp_dupli_object, when it uses data instanced by geometry nodes. */
+  struct BoundBox temp_dupli_object_bb;
 
   /* **** Iteration over ID nodes **** */
   size_t id_node_index;
@@ -360,6 +360,61 @@ void DepsgraphNodeBuilder::begin_build()
   graph_->entry_tags.clear();
 }
 
+void DepsgraphNodeBuilder::begin_partial_build(Span<IDNode *> id_nodes)
+{
+  Set<IDNode *> rebuild_id_nodes;
+  for (IDNode *id_node : id_nodes) {
+    rebuild_id_nodes.add(id_node);
+  }
+
+  /* All other IDs are kept as-is, they are not to be re-tagged for update by the finalization
+   * of the build unless something changes for them. */
+  for (IDNode *id_node : graph_->id_nodes) {
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    if (!rebuild_id_nodes.contains(id_node)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+
+  for (IDNode *id_node : id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        BLI_assert(op_node->inlinks.is_empty() && op_node->outlinks.is_empty());
+        if (!graph_->entry_tags.remove(op_node)) {
+          continue;
+        }
+        SavedEntryTag entry_tag;
+        entry_tag.id_orig = id_node->id_orig;
+        entry_tag.component_type = comp_node->type;
+        entry_tag.opcode = op_node->opcode;
+        entry_tag.name = op_node->name;
+        entry_tag.name_tag = op_node->name_tag;
+        saved_entry_tags_.append(entry_tag);
+      }
+    }
+  }
+
+  /* Remove operations of the IDs which are being re-built from the flat list. */
+  int64_t num_kept_operations = 0;
+  for (OperationNode *op_node : graph_->operations) {
+    if (!rebuild_id_nodes.contains(op_node->owner->owner)) {
+      graph_->operations[num_kept_operations++] = op_node;
+    }
+  }
+  graph_->operations.resize(num_kept_operations);
+
+  /* NOTE: The ID node itself and its copy-on-write datablock are preserved, components are
+   * re-created from scratch. */
+  for (IDNode *id_node : id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      delete comp_node;
+    }
+    id_node->components.clear();
+  }
+}
+
 void DepsgraphNodeBuilder::end_build()
 {
   for (const SavedEntryTag &entry_tag : saved_entry_tags_) {
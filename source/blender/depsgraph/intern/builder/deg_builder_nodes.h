@@ -101,6 +101,10 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void begin_build();
   virtual void end_build();
 
+  /* Prepare for re-building nodes of the given IDs, keeping the rest of the graph as-is.
+   * Relations of the operations of these IDs are expected to be removed already. */
+  virtual void begin_partial_build(Span<IDNode *> id_nodes);
+
   IDNode *add_id_node(ID *id);
   IDNode *find_id_node(ID *id);
   TimeSourceNode *add_time_source();
@@ -165,6 +169,9 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  virtual void build_view_layer_objects(Scene *scene,
+                                        ViewLayer *view_layer,
+                                        const Set<ID *> &objects);
   virtual void build_collection(LayerCollection *from_layer_collection, Collection *collection);
   virtual void build_object(int base_index,
                             Object *object,
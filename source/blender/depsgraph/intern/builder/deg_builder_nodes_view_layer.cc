@@ -176,4 +176,24 @@ void DepsgraphNodeBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphNodeBuilder::build_view_layer_objects(Scene *scene,
+                                                    ViewLayer *view_layer,
+                                                    const Set<ID *> &objects)
+{
+  /* Setup currently building context, matching the one of the view layer build. */
+  view_layer_index_ = 0;
+  scene_ = scene;
+  view_layer_ = view_layer;
+  /* NOTE: Base index is to match the one used by the full view layer build. */
+  int base_index = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+    if (need_pull_base_into_graph(base)) {
+      if (objects.contains(&base->object->id)) {
+        build_object(base_index, base->object, DEG_ID_LINKED_DIRECTLY, true);
+      }
+      base_index++;
+    }
+  }
+}
+
 }  // namespace blender::deg
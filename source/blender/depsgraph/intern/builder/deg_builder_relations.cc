@@ -486,6 +486,16 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_partial_build(const Set<IDNode *> &id_nodes)
+{
+  scene_ = graph_->scene;
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (!id_nodes.contains(id_node)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
@@ -2892,9 +2902,9 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
       rel->flag |= rel_flag;
     }
     /* All dangling operations should also be executed after copy-on-write. */
-    for (OperationNode *op_node : comp_node->operations_map->values()) {
+    auto add_dangling_operation_relation = [&](OperationNode *op_node) {
       if (op_node == op_entry) {
-        continue;
+        return;
       }
       if (op_node->inlinks.is_empty()) {
         Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
@@ -2917,6 +2927,17 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
           rel->flag |= rel_flag;
         }
       }
+    };
+    /* NOTE: Components which were kept by the partial relations update are finalized already. */
+    if (comp_node->operations_map != nullptr) {
+      for (OperationNode *op_node : comp_node->operations_map->values()) {
+        add_dangling_operation_relation(op_node);
+      }
+    }
+    else {
+      for (OperationNode *op_node : comp_node->operations) {
+        add_dangling_operation_relation(op_node);
+      }
     }
     /* NOTE: We currently ignore implicit relations to an external
      * data-blocks for copy-on-write operations. This means, for example,
@@ -164,6 +164,10 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   void begin_build();
 
+  /* Prepare for building relations of the given IDs only: all other IDs which are in the graph
+   * are considered to have their relations built already. */
+  void begin_partial_build(const Set<IDNode *> &id_nodes);
+
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
                          const KeyTo &key_to,
@@ -65,8 +65,8 @@ class AbstractBuilderPipeline {
   virtual unique_ptr<DepsgraphRelationBuilder> construct_relation_builder();
 
   virtual void build_step_sanity_check();
-  void build_step_nodes();
-  void build_step_relations();
+  virtual void build_step_nodes();
+  virtual void build_step_relations();
   void build_step_finalize();
 
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) = 0;
@@ -0,0 +1,366 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "pipeline_view_layer_partial.h"
+
+#include <cstdio>
+
+#include "BLI_string.h"
+
+#include "BKE_layer.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_object_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg {
+
+namespace {
+
+/* Invoke the function for all operations of the ID node, regardless of whether its components
+ * are finalized or not. */
+template<typename Func> void foreach_id_operation(IDNode *id_node, const Func &func)
+{
+  for (ComponentNode *comp_node : id_node->components.values()) {
+    if (comp_node->operations_map != nullptr) {
+      for (OperationNode *op_node : comp_node->operations_map->values()) {
+        func(op_node);
+      }
+    }
+    else {
+      for (OperationNode *op_node : comp_node->operations) {
+        func(op_node);
+      }
+    }
+  }
+}
+
+IDNode *get_relation_id_node(Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return nullptr;
+  }
+  return static_cast<OperationNode *>(node)->owner->owner;
+}
+
+/* Remove relations which connect the same nodes and have the same description.
+ * Relations are stored in both nodes, so only the incoming or outgoing side is to be checked. */
+void remove_duplicate_links(const Vector<Relation *> &links, const bool is_inlinks)
+{
+  if (links.size() < 2) {
+    return;
+  }
+  Map<std::pair<Node *, StringRef>, Relation *> unique_links;
+  /* NOTE: Iterate over a copy since unlinking modifies the original storage. */
+  for (Relation *rel : Vector<Relation *>(links)) {
+    Node *other_node = is_inlinks ? rel->from : rel->to;
+    Relation *existing_rel = unique_links.lookup_or_add(std::make_pair(other_node, rel->name),
+                                                        rel);
+    if (existing_rel != rel) {
+      existing_rel->flag |= rel->flag;
+      rel->unlink();
+      delete rel;
+    }
+  }
+}
+
+string operation_key(const OperationNode *op_node)
+{
+  const ComponentNode *comp_node = op_node->owner;
+  char id_ptr[24];
+  BLI_snprintf(id_ptr, sizeof(id_ptr), "%p", comp_node->owner->id_orig);
+  return string(id_ptr) + "/" + to_string(static_cast<int>(comp_node->type)) + "/" +
+         op_node->full_identifier() + "/" + to_string(op_node->name_tag);
+}
+
+struct GraphKeys {
+  Set<string> operations;
+  /* Relation key, and keys of the operations it connects. The key of the source operation is
+   * empty for relations from the time source. */
+  Map<string, std::pair<string, string>> relations;
+};
+
+void graph_keys_collect(const Depsgraph *graph, GraphKeys &r_keys)
+{
+  for (OperationNode *op_node : graph->operations) {
+    const string op_key = operation_key(op_node);
+    r_keys.operations.add(op_key);
+    for (Relation *rel : op_node->inlinks) {
+      const string from_key = (rel->from->type == NodeType::OPERATION) ?
+                                  operation_key(static_cast<OperationNode *>(rel->from)) :
+                                  "";
+      const string from_name = from_key.empty() ? rel->from->identifier() : from_key;
+      r_keys.relations.add(from_name + " -> " + op_key + " (" + rel->name + ")",
+                           std::make_pair(from_key, op_key));
+    }
+  }
+}
+
+}  // namespace
+
+PartialViewLayerBuilderPipeline::PartialViewLayerBuilderPipeline(::Depsgraph *graph)
+    : ViewLayerBuilderPipeline(graph)
+{
+  for (ID *id : deg_graph_->id_relations_update) {
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node != nullptr) {
+      rebuild_id_nodes_.append(id_node);
+    }
+  }
+}
+
+bool PartialViewLayerBuilderPipeline::is_partial_build_possible() const
+{
+  if (deg_graph_->is_render_pipeline_depsgraph) {
+    return false;
+  }
+  if (rebuild_id_nodes_.size() != deg_graph_->id_relations_update.size()) {
+    /* Some of the IDs are not in the graph yet. */
+    return false;
+  }
+  /* Colliders and effectors are cached for the whole graph, the cache is only valid for the
+   * relations it was created with. */
+  for (int i = 0; i < DEG_PHYSICS_RELATIONS_NUM; i++) {
+    if (deg_graph_->physics_relations[i] != nullptr) {
+      return false;
+    }
+  }
+  for (IDNode *id_node : rebuild_id_nodes_) {
+    if (id_node->id_type != ID_OB) {
+      return false;
+    }
+    if (!id_node->has_base || id_node->linked_state != DEG_ID_LINKED_DIRECTLY) {
+      return false;
+    }
+    Object *object = reinterpret_cast<Object *>(id_node->id_orig);
+    if (BKE_view_layer_base_find(view_layer_, object) == nullptr) {
+      return false;
+    }
+    if (object->proxy != nullptr || object->proxy_from != nullptr ||
+        object->proxy_group != nullptr) {
+      return false;
+    }
+    if (object->rigidbody_object != nullptr || object->rigidbody_constraint != nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PartialViewLayerBuilderPipeline::build_step_sanity_check()
+{
+  ViewLayerBuilderPipeline::build_step_sanity_check();
+  BLI_assert(!deg_graph_->need_update);
+  BLI_assert(is_partial_build_possible());
+}
+
+void PartialViewLayerBuilderPipeline::build_step_nodes()
+{
+  remove_rebuild_id_relations();
+
+  const int64_t num_id_nodes = deg_graph_->id_nodes.size();
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  node_builder->begin_partial_build(rebuild_id_nodes_);
+  build_nodes(*node_builder);
+  node_builder->end_build();
+
+  /* Relations of the re-built IDs and of the IDs they pulled into the graph are to be built. */
+  for (IDNode *id_node : rebuild_id_nodes_) {
+    affected_id_nodes_.add(id_node);
+  }
+  for (int64_t i = num_id_nodes; i < deg_graph_->id_nodes.size(); i++) {
+    affected_id_nodes_.add(deg_graph_->id_nodes[i]);
+  }
+}
+
+void PartialViewLayerBuilderPipeline::build_step_relations()
+{
+  Set<IDNode *> built_id_nodes;
+  Set<IDNode *> id_nodes = affected_id_nodes_;
+  bool is_first_pass = true;
+  while (!id_nodes.is_empty()) {
+    build_relations_for_ids(id_nodes, is_first_pass);
+    remove_duplicate_relations(id_nodes);
+    for (IDNode *id_node : id_nodes) {
+      built_id_nodes.add(id_node);
+    }
+    /* Relations coming to no-op operations which had no users are removed by the build
+     * finalization. If a re-built ID started to use such operation, relations of its owner are to
+     * be re-built as well. */
+    id_nodes = find_ids_with_pruned_relations(id_nodes);
+    for (IDNode *id_node : built_id_nodes) {
+      id_nodes.remove(id_node);
+    }
+    is_first_pass = false;
+  }
+}
+
+void PartialViewLayerBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
+{
+  Set<ID *> objects;
+  for (IDNode *id_node : rebuild_id_nodes_) {
+    objects.add(id_node->id_orig);
+  }
+  node_builder.build_view_layer_objects(scene_, view_layer_, objects);
+}
+
+void PartialViewLayerBuilderPipeline::remove_rebuild_id_relations()
+{
+  for (IDNode *id_node : rebuild_id_nodes_) {
+    foreach_id_operation(id_node, [&](OperationNode *op_node) {
+      while (!op_node->inlinks.is_empty()) {
+        Relation *rel = op_node->inlinks[0];
+        IDNode *from_id_node = get_relation_id_node(rel->from);
+        if (from_id_node != nullptr) {
+          affected_id_nodes_.add(from_id_node);
+        }
+        rel->unlink();
+        delete rel;
+      }
+      while (!op_node->outlinks.is_empty()) {
+        Relation *rel = op_node->outlinks[0];
+        IDNode *to_id_node = get_relation_id_node(rel->to);
+        if (to_id_node != nullptr) {
+          affected_id_nodes_.add(to_id_node);
+        }
+        rel->unlink();
+        delete rel;
+      }
+    });
+  }
+}
+
+void PartialViewLayerBuilderPipeline::build_relations_for_ids(const Set<IDNode *> &id_nodes,
+                                                              bool build_view_layer)
+{
+  unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+  relation_builder->begin_partial_build(id_nodes);
+  if (build_view_layer) {
+    /* Visit the IDs in the same context as the full build does. IDs which are not in the
+     * partial build are skipped by the builder. */
+    build_relations(*relation_builder);
+  }
+  for (IDNode *id_node : id_nodes) {
+    relation_builder->build_id(id_node->id_orig);
+  }
+  for (IDNode *id_node : id_nodes) {
+    relation_builder->build_copy_on_write_relations(id_node);
+    relation_builder->build_driver_relations(id_node);
+  }
+}
+
+void PartialViewLayerBuilderPipeline::remove_duplicate_relations(const Set<IDNode *> &id_nodes)
+{
+  /* Relations of the kept IDs were not removed, so the re-built relations of those IDs are added
+   * for the second time. */
+  for (IDNode *id_node : id_nodes) {
+    foreach_id_operation(id_node, [&](OperationNode *op_node) {
+      remove_duplicate_links(op_node->inlinks, true);
+      remove_duplicate_links(op_node->outlinks, false);
+    });
+  }
+}
+
+Set<IDNode *> PartialViewLayerBuilderPipeline::find_ids_with_pruned_relations(
+    const Set<IDNode *> &id_nodes) const
+{
+  Set<IDNode *> result;
+  for (IDNode *id_node : id_nodes) {
+    foreach_id_operation(id_node, [&](OperationNode *op_node) {
+      for (Relation *rel : op_node->inlinks) {
+        if (rel->from->type != NodeType::OPERATION) {
+          continue;
+        }
+        OperationNode *op_from = static_cast<OperationNode *>(rel->from);
+        if (op_from->is_noop() && op_from->inlinks.is_empty()) {
+          result.add(op_from->owner->owner);
+        }
+      }
+    });
+  }
+  return result;
+}
+
+bool PartialViewLayerBuilderPipeline::validate() const
+{
+  ::Depsgraph *reference_graph = DEG_graph_new(bmain_, scene_, view_layer_, deg_graph_->mode);
+  DEG_graph_build_from_view_layer(reference_graph);
+
+  GraphKeys keys, reference_keys;
+  graph_keys_collect(deg_graph_, keys);
+  graph_keys_collect(reinterpret_cast<const Depsgraph *>(reference_graph), reference_keys);
+
+  DEG_graph_free(reference_graph);
+
+  bool is_valid = true;
+  int num_stale_operations = 0, num_stale_relations = 0;
+  for (const string &op_key : reference_keys.operations) {
+    if (!keys.operations.contains(op_key)) {
+      fprintf(stderr, "Partial depsgraph update: missing operation %s\n", op_key.c_str());
+      is_valid = false;
+    }
+  }
+  for (const string &op_key : keys.operations) {
+    if (!reference_keys.operations.contains(op_key)) {
+      num_stale_operations++;
+    }
+  }
+  for (const string &rel_key : reference_keys.relations.keys()) {
+    if (!keys.relations.contains(rel_key)) {
+      fprintf(stderr, "Partial depsgraph update: missing relation %s\n", rel_key.c_str());
+      is_valid = false;
+    }
+  }
+  for (const auto item : keys.relations.items()) {
+    if (reference_keys.relations.contains(item.key)) {
+      continue;
+    }
+    /* Relations of operations which are no longer used are expected to be kept. */
+    const std::pair<string, string> &op_keys = item.value;
+    if ((!op_keys.first.empty() && !reference_keys.operations.contains(op_keys.first)) ||
+        !reference_keys.operations.contains(op_keys.second)) {
+      num_stale_relations++;
+      continue;
+    }
+    fprintf(stderr, "Partial depsgraph update: unexpected relation %s\n", item.key.c_str());
+    is_valid = false;
+  }
+  if (num_stale_operations != 0 || num_stale_relations != 0) {
+    printf("Partial depsgraph update: %d unused operations and %d unused relations are kept.\n",
+           num_stale_operations,
+           num_stale_relations);
+  }
+  return is_valid;
+}
+
+}  // namespace blender::deg
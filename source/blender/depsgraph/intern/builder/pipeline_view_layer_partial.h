@@ -0,0 +1,75 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "pipeline_view_layer.h"
+
+namespace blender {
+namespace deg {
+
+struct IDNode;
+
+/* Update of an existing view layer graph, which only re-builds nodes and relations of IDs tagged
+ * with #DEG_graph_id_tag_relations_update.
+ *
+ * - Relations of operations of the tagged IDs are removed, IDs on the other side of those
+ *   relations are considered affected.
+ * - Nodes of the tagged IDs are re-built. Nodes of IDs which were not in the graph yet are built
+ *   as well.
+ * - Relations of the tagged, affected and new IDs are re-built, relations which already exist
+ *   are de-duplicated.
+ *
+ * Nodes of IDs which are no longer used by the tagged IDs are kept in the graph until the next
+ * full rebuild. */
+class PartialViewLayerBuilderPipeline : public ViewLayerBuilderPipeline {
+ public:
+  PartialViewLayerBuilderPipeline(::Depsgraph *graph);
+
+  /* Check whether the graph can be updated partially. Only objects which are directly in the
+   * view layer and which do not take part in physics simulation are supported, the full rebuild
+   * is to be used otherwise. */
+  bool is_partial_build_possible() const;
+
+  /* Compare the graph with the result of a full rebuild, report differences.
+   * Returns true if the graph is equivalent. */
+  bool validate() const;
+
+ protected:
+  Vector<IDNode *> rebuild_id_nodes_;
+  Set<IDNode *> affected_id_nodes_;
+
+  virtual void build_step_sanity_check() override;
+  virtual void build_step_nodes() override;
+  virtual void build_step_relations() override;
+
+  virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
+
+  void remove_rebuild_id_relations();
+  void build_relations_for_ids(const Set<IDNode *> &id_nodes, bool build_view_layer);
+  void remove_duplicate_relations(const Set<IDNode *> &id_nodes);
+  Set<IDNode *> find_ids_with_pruned_relations(const Set<IDNode *> &id_nodes) const;
+};
+
+}  // namespace deg
+}  // namespace blender
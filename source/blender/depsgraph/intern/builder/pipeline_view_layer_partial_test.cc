@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/pipeline_view_layer_partial.h"
+
+#include "BKE_collection.h"
+#include "BKE_constraint.h"
+#include "BKE_idtype.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_constraint_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/depsgraph.h"
+#include "intern/eval/deg_eval_flush.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+#include "CLG_log.h"
+
+#include "testing/testing.h"
+
+namespace blender::deg::tests {
+
+class PartialViewLayerBuilderTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+  ::Depsgraph *depsgraph = nullptr;
+
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    BKE_modifier_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestCase()
+  {
+    DEG_free_node_types();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+  }
+
+  void TearDown() override
+  {
+    if (depsgraph != nullptr) {
+      DEG_graph_free(depsgraph);
+    }
+    BKE_main_free(bmain);
+  }
+
+  Object *add_object(const char *name)
+  {
+    Object *object = BKE_object_add_only_object(bmain, OB_EMPTY, name);
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+    return object;
+  }
+
+  void add_copy_location_constraint(Object *object, Object *target)
+  {
+    bConstraint *con = BKE_constraint_add_for_object(
+        object, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+    static_cast<bLocateLikeConstraint *>(con->data)->tar = target;
+  }
+
+  void build_depsgraph()
+  {
+    BKE_main_collection_sync(bmain);
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    /* Act as if the graph was evaluated, so that only tags of the relations update remain. */
+    deg_graph_clear_tags(reinterpret_cast<Depsgraph *>(depsgraph));
+  }
+
+  bool is_scene_tagged_for_update() const
+  {
+    const Depsgraph *deg_graph = reinterpret_cast<const Depsgraph *>(depsgraph);
+    const IDNode *id_node = deg_graph->find_id_node(&scene->id);
+    for (const ComponentNode *comp_node : id_node->components.values()) {
+      for (const OperationNode *op_node : comp_node->operations) {
+        if (op_node->flag & DEPSOP_FLAG_NEEDS_UPDATE) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /* Update relations of the object partially, and compare the result with a full rebuild. */
+  void update_and_validate(Object *object)
+  {
+    DEG_graph_id_tag_relations_update(depsgraph, &object->id);
+    EXPECT_TRUE(is_scene_tagged_for_update());
+
+    PartialViewLayerBuilderPipeline builder(depsgraph);
+    ASSERT_TRUE(builder.is_partial_build_possible());
+    builder.build();
+    EXPECT_TRUE(builder.validate());
+  }
+};
+
+TEST_F(PartialViewLayerBuilderTest, constraint_added)
+{
+  Object *object = add_object("Object");
+  Object *target = add_object("Target");
+  add_object("Unrelated");
+  build_depsgraph();
+
+  add_copy_location_constraint(object, target);
+  update_and_validate(object);
+}
+
+TEST_F(PartialViewLayerBuilderTest, constraint_removed)
+{
+  Object *object = add_object("Object");
+  Object *target = add_object("Target");
+  Object *other = add_object("Other");
+  add_copy_location_constraint(object, target);
+  add_copy_location_constraint(other, object);
+  build_depsgraph();
+
+  BKE_constraints_free_ex(&object->constraints, true);
+  update_and_validate(object);
+}
+
+}  // namespace blender::deg::tests
@@ -30,6 +30,7 @@
 
 #include "PIL_time_utildefines.h"
 
+#include "BKE_animsys.h"
 #include "BKE_global.h"
 
 namespace blender::deg {
@@ -68,6 +69,7 @@ void DepsgraphDebug::end_graph_evaluation()
   const double graph_eval_end_time = PIL_check_seconds_timer();
   printf("Depsgraph updated in %f seconds.\n", graph_eval_end_time - graph_evaluation_start_time_);
   printf("Depsgraph evaluation FPS: %f\n", 1.0f / fps_samples_.get_averaged());
+  BKE_animsys_path_cache_stats_print_and_reset();
 
   is_ever_evaluated = true;
 }
@@ -34,8 +34,10 @@
 #include "BLI_hash.h"
 #include "BLI_utildefines.h"
 
+#include "BKE_geometry_playback_cache.h"
 #include "BKE_global.h"
 #include "BKE_idtype.h"
+#include "BKE_modifier_result_cache.h"
 #include "BKE_scene.h"
 
 #include "DEG_depsgraph.h"
@@ -62,6 +64,7 @@ namespace blender::deg {
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      update_count(0),
       bmain(bmain),
       scene(scene),
       view_layer(view_layer),
@@ -316,6 +319,8 @@ void DEG_graph_free(Depsgraph *graph)
   using deg::Depsgraph;
   deg::Depsgraph *deg_depsgraph = reinterpret_cast<deg::Depsgraph *>(graph);
   deg::unregister_graph(deg_depsgraph);
+  BKE_geometry_playback_cache_free_depsgraph(graph);
+  BKE_modifier_result_cache_free_depsgraph(graph);
   delete deg_depsgraph;
 }
 
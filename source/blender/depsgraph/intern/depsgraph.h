@@ -110,6 +110,15 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* IDs whose relations are to be updated. Unless a full rebuild is requested via #need_update,
+   * only nodes and relations of these IDs are re-built. */
+  Set<ID *> id_relations_update;
+
+  /* Incremented every time the graph is tagged for an update which can change evaluation result,
+   * and when relations are rebuilt. Changes in time do not affect it, which allows to cache data
+   * evaluated for a specific frame for until the next edit. */
+  uint64_t update_count;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
 
@@ -37,6 +37,8 @@
 #include "DNA_scene_types.h"
 #include "DNA_simulation_types.h"
 
+#include "BKE_animsys.h"
+#include "BKE_global.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
 
@@ -50,6 +52,7 @@
 #include "builder/pipeline_from_ids.h"
 #include "builder/pipeline_render.h"
 #include "builder/pipeline_view_layer.h"
+#include "builder/pipeline_view_layer_partial.h"
 
 #include "intern/debug/deg_debug.h"
 
@@ -252,12 +255,8 @@ void DEG_graph_build_from_ids(Depsgraph *graph, ID **ids, const int num_ids)
   builder.build();
 }
 
-/* Tag graph relations for update. */
-void DEG_graph_tag_relations_update(Depsgraph *graph)
+static void deg_graph_tag_scene_for_relations_update(deg::Depsgraph *deg_graph)
 {
-  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
-  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
-  deg_graph->need_update = true;
   /* NOTE: When relations are updated, it's quite possible that
    * we've got new bases in the scene. This means, we need to
    * re-create flat array of bases in view layer.
@@ -270,13 +269,51 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   }
 }
 
+/* Tag graph relations for update. */
+void DEG_graph_tag_relations_update(Depsgraph *graph)
+{
+  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  deg_graph->need_update = true;
+  deg_graph->update_count++;
+  deg_graph_tag_scene_for_relations_update(deg_graph);
+}
+
+/* Update nodes and relations of IDs tagged with #DEG_graph_id_tag_relations_update.
+ * Returns false if the graph is to be fully rebuilt instead. */
+static bool deg_graph_relations_update_partial(Depsgraph *graph)
+{
+  deg::PartialViewLayerBuilderPipeline builder(graph);
+  if (!builder.is_partial_build_possible()) {
+    return false;
+  }
+  builder.build();
+  if (G.debug & G_DEBUG_DEPSGRAPH_VALIDATE) {
+    if (!builder.validate()) {
+      fprintf(stderr, "Partial depsgraph update differs from full rebuild, rebuilding.\n");
+      return false;
+    }
+  }
+  return true;
+}
+
 /* Create or update relations in the specified graph. */
 void DEG_graph_relations_update(Depsgraph *graph)
 {
   deg::Depsgraph *deg_graph = (deg::Depsgraph *)graph;
   if (!deg_graph->need_update) {
-    /* Graph is up to date, nothing to do. */
-    return;
+    if (deg_graph->id_relations_update.is_empty()) {
+      /* Graph is up to date, nothing to do. */
+      return;
+    }
+    /* Resolved paths of animation can point to data which is about to be remapped. */
+    BKE_animsys_path_cache_invalidate_all();
+    if (deg_graph_relations_update_partial(graph)) {
+      return;
+    }
+  }
+  else {
+    BKE_animsys_path_cache_invalidate_all();
   }
   DEG_graph_build_from_view_layer(graph);
 }
@@ -289,3 +326,26 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+/* Tag relations of the given ID for update. */
+void DEG_graph_id_tag_relations_update(Depsgraph *graph, ID *id)
+{
+  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  if (deg_graph->need_update) {
+    /* Full rebuild is pending already. */
+    return;
+  }
+  deg_graph->id_relations_update.add(id);
+  deg_graph->update_count++;
+  /* The partial update keeps the scene node, tag it the same way as for the full rebuild. */
+  deg_graph_tag_scene_for_relations_update(deg_graph);
+}
+
+void DEG_id_tag_relations_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    DEG_graph_id_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph), id);
+  }
+}
@@ -79,6 +79,12 @@ float DEG_get_ctime(const Depsgraph *graph)
   return deg_graph->ctime;
 }
 
+uint64_t DEG_get_update_count(const Depsgraph *graph)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  return deg_graph->update_count;
+}
+
 bool DEG_id_type_updated(const Depsgraph *graph, short id_type)
 {
   const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
@@ -319,7 +325,7 @@ bool DEG_is_fully_evaluated(const struct Depsgraph *depsgraph)
 {
   const deg::Depsgraph *deg_graph = (const deg::Depsgraph *)depsgraph;
   /* Check whether relations are up to date. */
-  if (deg_graph->need_update) {
+  if (deg_graph->need_update || !deg_graph->id_relations_update.is_empty()) {
     return false;
   }
   /* Check whether IDs are up to date. */
@@ -32,13 +32,18 @@
 #include "BKE_geometry_set.hh"
 #include "BKE_idprop.h"
 #include "BKE_layer.h"
+#include "BKE_mesh_wrapper.h"
 #include "BKE_node.h"
 #include "BKE_object.h"
+#include "BKE_pointcloud.h"
+#include "BKE_volume.h"
 
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 
+#include "DNA_mesh_types.h"
 #include "DNA_object_types.h"
+#include "DNA_pointcloud_types.h"
 #include "DNA_scene_types.h"
 
 #include "DEG_depsgraph.h"
@@ -223,12 +228,46 @@ bool deg_iterator_components_step(BLI_Iterator *iter)
   return false;
 }
 
+/* Bounds of data instanced by geometry nodes, see #DupliObject.ob_data. */
+void deg_instanced_data_boundbox(const ID *data, BoundBox *r_bb)
+{
+  float min[3], max[3];
+  bool have_minmax = false;
+  INIT_MINMAX(min, max);
+
+  switch (GS(data->name)) {
+    case ID_ME:
+      have_minmax = BKE_mesh_wrapper_minmax((const Mesh *)data, min, max);
+      break;
+    case ID_PT: {
+      const PointCloud *pointcloud = (const PointCloud *)data;
+      if (pointcloud->totpoint > 0) {
+        BKE_pointcloud_minmax(pointcloud, min, max);
+        have_minmax = true;
+      }
+      break;
+    }
+    case ID_VO:
+      have_minmax = BKE_volume_min_max((const Volume *)data, min, max);
+      break;
+    default:
+      break;
+  }
+
+  if (!have_minmax) {
+    min[0] = min[1] = min[2] = -1.0f;
+    max[0] = max[1] = max[2] = 1.0f;
+  }
+  BKE_boundbox_init_from_minmax(r_bb, min, max);
+  r_bb->flag = 0;
+}
+
 void deg_iterator_duplis_init(DEGObjectIterData *data, Object *object)
 {
   if ((data->flag & DEG_ITER_OBJECT_FLAG_DUPLI) &&
       ((object->transflag & OB_DUPLI) || object->runtime.geometry_set_eval != nullptr)) {
     data->dupli_parent = object;
-    data->dupli_list = object_duplilist(data->graph, data->scene, object);
+    data->dupli_list = object_duplilist_ex(data->graph, data->scene, object, true);
     data->dupli_object_next = (DupliObject *)data->dupli_list->first;
   }
 }
@@ -287,6 +326,19 @@ bool deg_iterator_duplis_step(DEGObjectIterData *data)
 
     copy_m4_m4(data->temp_dupli_object.obmat, dob->mat);
     invert_m4_m4(data->temp_dupli_object.imat, data->temp_dupli_object.obmat);
+
+    if (dob->ob_data != nullptr) {
+      /* Instanced geometry from geometry nodes, all its components are separate duplis. */
+      temp_dupli_object->type = BKE_object_obdata_to_type(dob->ob_data);
+      temp_dupli_object->data = dob->ob_data;
+      temp_dupli_object->runtime.geometry_set_eval = nullptr;
+      /* The evaluated data and the bounds of the instancing object describe its own geometry.
+       * The bounds are computed here, so that users of the iterator do not write to them. */
+      temp_dupli_object->runtime.data_eval = dob->ob_data;
+      temp_dupli_object->runtime.mesh_deform_eval = nullptr;
+      temp_dupli_object->runtime.bb = &data->temp_dupli_object_bb;
+      deg_instanced_data_boundbox(dob->ob_data, &data->temp_dupli_object_bb);
+    }
     deg_iterator_components_init(data, &data->temp_dupli_object);
     BLI_assert(deg::deg_validate_copy_on_write_datablock(&data->temp_dupli_object.id));
     return true;
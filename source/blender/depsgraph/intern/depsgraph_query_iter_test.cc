@@ -0,0 +1,152 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "blendfile_loading_base_test.h"
+
+#include "BLI_float4x4.hh"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
+
+#include "BKE_collection.h"
+#include "BKE_customdata.h"
+#include "BKE_geometry_set.hh"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+namespace blender::deg::tests {
+
+class DepsgraphObjectIteratorTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+  }
+
+  void TearDown() override
+  {
+    depsgraph_free();
+    BKE_main_free(bmain);
+  }
+
+  /* Fill the vertices of the mesh with the corners of the box from \a min to \a max. */
+  static void mesh_set_box_verts(Mesh *mesh, const float min, const float max)
+  {
+    for (int i = 0; i < 8; i++) {
+      const float co[3] = {(i & 1) ? max : min, (i & 2) ? max : min, (i & 4) ? max : min};
+      copy_v3_v3(mesh->mvert[i].co, co);
+    }
+  }
+
+  Object *add_mesh_object(const char *name)
+  {
+    Mesh *mesh = BKE_mesh_add(bmain, name);
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, 8);
+    mesh->totvert = 8;
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    mesh_set_box_verts(mesh, -1.0f, 1.0f);
+
+    Object *object = BKE_object_add_only_object(bmain, OB_MESH, name);
+    object->data = mesh;
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+    return object;
+  }
+
+  void build_and_evaluate_depsgraph()
+  {
+    BKE_main_collection_sync(bmain);
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+};
+
+TEST_F(DepsgraphObjectIteratorTest, instanced_geometry_bounds)
+{
+  Object *owner = add_mesh_object("Owner");
+  build_and_evaluate_depsgraph();
+
+  Object *owner_eval = DEG_get_evaluated_object(depsgraph, owner);
+  ASSERT_NE(owner_eval->runtime.geometry_set_eval, nullptr);
+  BoundBox *owner_bb = BKE_object_boundbox_get(owner_eval);
+  ASSERT_NE(owner_bb, nullptr);
+  const BoundBox owner_bb_orig = *owner_bb;
+
+  /* Instance geometry far away from the owner, as geometry nodes would. */
+  Mesh *instance_mesh = BKE_mesh_new_nomain(8, 0, 0, 0, 0);
+  mesh_set_box_verts(instance_mesh, 10.0f, 11.0f);
+  float identity[4][4];
+  unit_m4(identity);
+  InstancesComponent &instances =
+      owner_eval->runtime.geometry_set_eval->get_component_for_write<InstancesComponent>();
+  instances.add_instance(
+      instances.add_instanced_geometry_set(GeometrySet::create_with_mesh(instance_mesh)),
+      float4x4(identity));
+
+  int duplis_num = 0;
+  DEG_OBJECT_ITER_BEGIN (depsgraph,
+                         object,
+                         DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY | DEG_ITER_OBJECT_FLAG_VISIBLE |
+                             DEG_ITER_OBJECT_FLAG_DUPLI) {
+    if (data_.dupli_object_current == nullptr) {
+      continue;
+    }
+    duplis_num++;
+    EXPECT_EQ(object->data, instance_mesh);
+    EXPECT_EQ(object->runtime.data_eval, &instance_mesh->id);
+    EXPECT_EQ(object->runtime.mesh_deform_eval, nullptr);
+
+    const BoundBox *bb = BKE_object_boundbox_get(object);
+    ASSERT_NE(bb, nullptr);
+    EXPECT_NE(bb, owner_bb);
+    const float expected_min[3] = {10.0f, 10.0f, 10.0f};
+    const float expected_max[3] = {11.0f, 11.0f, 11.0f};
+    EXPECT_V3_NEAR(bb->vec[0], expected_min, 1e-6f);
+    EXPECT_V3_NEAR(bb->vec[6], expected_max, 1e-6f);
+  }
+  DEG_OBJECT_ITER_END;
+
+  EXPECT_EQ(duplis_num, 1);
+  /* The bounds of the owner are not affected by the instances. */
+  EXPECT_EQ(BKE_object_boundbox_get(owner_eval), owner_bb);
+  EXPECT_V3_NEAR(owner_bb->vec[0], owner_bb_orig.vec[0], 1e-6f);
+  EXPECT_V3_NEAR(owner_bb->vec[6], owner_bb_orig.vec[6], 1e-6f);
+}
+
+}  // namespace blender::deg::tests
@@ -474,6 +474,22 @@ int deg_recalc_flags_effective(Depsgraph *graph, int flags)
   return flags;
 }
 
+/* Check whether the update can change result of evaluation of the ID, as opposite to only
+ * affecting drawing, selection or playback of the scene. */
+bool deg_recalc_flags_affect_evaluation(int flags)
+{
+  if (flags == 0) {
+    return true;
+  }
+  const int non_evaluation_flags = ID_RECALC_SELECT | ID_RECALC_SHADING | ID_RECALC_BASE_FLAGS |
+                                   ID_RECALC_EDITORS | ID_RECALC_SEQUENCER_STRIPS |
+                                   ID_RECALC_AUDIO_SEEK | ID_RECALC_AUDIO_FPS |
+                                   ID_RECALC_AUDIO_VOLUME | ID_RECALC_AUDIO_MUTE |
+                                   ID_RECALC_AUDIO_LISTENER | ID_RECALC_AUDIO |
+                                   ID_RECALC_TAG_FOR_UNDO;
+  return (flags & ~non_evaluation_flags) != 0;
+}
+
 /* Special tag function which tags all components which needs to be tagged
  * for update flag=0.
  *
@@ -643,6 +659,9 @@ void graph_id_tag_update(
   IDNode *id_node = (graph != nullptr) ? graph->find_id_node(id) : nullptr;
   if (graph != nullptr) {
     DEG_graph_id_type_tag(reinterpret_cast<::Depsgraph *>(graph), GS(id->name));
+    if (id_node != nullptr && deg_recalc_flags_affect_evaluation(flag)) {
+      graph->update_count++;
+    }
   }
   if (flag == 0) {
     deg_graph_node_tag_zero(bmain, graph, id_node, update_source);
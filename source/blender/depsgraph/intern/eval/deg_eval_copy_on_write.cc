@@ -947,6 +947,8 @@ ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode
   if (!deg_copy_on_write_is_needed(id_orig)) {
     return id_cow;
   }
+  /* Resolved paths of animation of any data-block can point into the data which is freed. */
+  BKE_animsys_path_cache_invalidate_all();
   RuntimeBackup backup(depsgraph);
   backup.init_from_id(id_cow);
   deg_free_copy_on_write_datablock(id_cow);
@@ -178,8 +178,15 @@ OperationNode *ComponentNode::add_operation(const DepsEvalOperationCb &op,
     op_node = (OperationNode *)factory->create_node(this->owner->id_orig, "", name);
 
     /* register opnode in this component's operation set */
-    OperationIDKey key(opcode, name, name_tag);
-    operations_map->add(key, op_node);
+    if (operations_map != nullptr) {
+      OperationIDKey key(opcode, name, name_tag);
+      operations_map->add(key, op_node);
+    }
+    else {
+      /* Component has been finalized already, which happens when new operations are added by the
+       * partial relations update. */
+      operations.append(op_node);
+    }
 
     /* set backlink */
     op_node->owner = this;
@@ -289,6 +296,11 @@ OperationNode *ComponentNode::get_exit_operation()
 
 void ComponentNode::finalize_build(Depsgraph * /*graph*/)
 {
+  if (operations_map == nullptr) {
+    /* Already finalized, happens for components which were kept as-is by the partial relations
+     * update. */
+    return;
+  }
   operations.reserve(operations_map->size());
   for (OperationNode *op_node : operations_map->values()) {
     operations.append(op_node);
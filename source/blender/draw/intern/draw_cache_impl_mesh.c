@@ -622,6 +622,63 @@ static void mesh_batch_cache_discard_uvedit_select(MeshBatchCache *cache)
   cache->batch_ready &= ~MBC_EDITUV;
 }
 
+static bool mesh_has_ngons(const Mesh *me)
+{
+  const MPoly *mpoly = me->mpoly;
+  for (int i = 0; i < me->totpoly; i++) {
+    if (mpoly[i].totloop > 4) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Discard the buffers which depend on vertex positions, keeping index buffers and attributes
+ * like UVs or colors. Batches reference the buffers directly, so all of them are discarded,
+ * they are cheap to create again from the existing buffers.
+ *
+ * The triangulation of n-gons depends on vertex positions, so the index buffers built from
+ * the loop triangles are only kept for meshes made of triangles and quads. */
+static void mesh_batch_cache_discard_deform(MeshBatchCache *cache, const Mesh *me)
+{
+  if (mesh_has_ngons(me)) {
+    FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+      GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.tris);
+      GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.lines_adjacency);
+      GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.edituv_tris);
+    }
+    if (cache->final.tris_per_mat != NULL) {
+      for (int i = 0; i < cache->mat_len; i++) {
+        GPU_INDEXBUF_DISCARD_SAFE(cache->final.tris_per_mat[i]);
+      }
+    }
+  }
+
+  FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.pos_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.lnor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edge_fac);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.tan);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edituv_stretch_area);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edituv_stretch_angle);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.mesh_analysis);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_pos);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.skin_roots);
+  }
+
+  for (int i = 0; i < sizeof(cache->batch) / sizeof(void *); i++) {
+    GPUBatch **batch = (GPUBatch **)&cache->batch;
+    GPU_BATCH_DISCARD_SAFE(batch[i]);
+  }
+  for (int i = 0; i < cache->mat_len; i++) {
+    GPU_BATCH_DISCARD_SAFE(cache->surface_per_mat[i]);
+  }
+  cache->batch_ready = 0;
+  cache->tot_area = 0.0f;
+  cache->tot_uv_area = 0.0f;
+}
+
 void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
 {
   MeshBatchCache *cache = me->runtime.batch_cache;
@@ -687,6 +744,9 @@ void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
       GPU_BATCH_DISCARD_SAFE(cache->batch.edituv_fdots);
       cache->batch_ready &= ~MBC_EDITUV;
       break;
+    case BKE_MESH_BATCH_DIRTY_DEFORM:
+      mesh_batch_cache_discard_deform(cache, me);
+      break;
     default:
       BLI_assert(0);
   }
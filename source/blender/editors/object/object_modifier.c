@@ -245,7 +245,7 @@ ModifierData *ED_object_modifier_add(
   BKE_object_modifier_set_active(ob, new_md);
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  DEG_id_tag_relations_update(bmain, &ob->id);
 
   return new_md;
 }
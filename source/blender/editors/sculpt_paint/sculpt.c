@@ -73,6 +73,7 @@
 #include "BKE_subsurf.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
 
 #include "IMB_colormanagement.h"
 
@@ -7773,6 +7774,16 @@ void SCULPT_flush_update_step(bContext *C, SculptUpdateType update_flags)
 
   DEG_id_tag_update(&ob->id, ID_RECALC_SHADING);
 
+  if ((update_flags & SCULPT_UPDATE_COORDS) && BKE_pbvh_type(ss->pbvh) == PBVH_FACES) {
+    /* The evaluated mesh can share vertex positions with the original one, which are changed in
+     * place. The float normals it has cached are not updated by the PBVH. */
+    Object *ob_eval = DEG_get_evaluated_object(depsgraph, ob);
+    Mesh *me_eval = BKE_object_get_evaluated_mesh(ob_eval);
+    if (me_eval != NULL) {
+      BKE_mesh_normals_cache_tag_dirty(me_eval);
+    }
+  }
+
   /* Only current viewport matters, slower update for all viewports will
    * be done in sculpt_flush_update_done. */
   if (!BKE_sculptsession_use_pbvh_draw(ob, v3d)) {
@@ -48,6 +48,7 @@
 #include "BKE_curve.h"
 #include "BKE_displist.h"
 #include "BKE_editmesh.h"
+#include "BKE_geometry_playback_cache.h"
 #include "BKE_gpencil.h"
 #include "BKE_key.h"
 #include "BKE_layer.h"
@@ -618,6 +619,20 @@ static const char *info_statusbar_string(Main *bmain,
     uintptr_t mem_in_use = MEM_get_memory_in_use();
     BLI_str_format_byte_unit(formatted_mem, mem_in_use, false);
     ofs += BLI_snprintf(info + ofs, len, TIP_("Memory: %s"), formatted_mem);
+
+    /* Evaluated geometry playback cache. */
+    if (BKE_geometry_playback_cache_is_enabled()) {
+      GeometryPlaybackCacheStats cache_stats;
+      BKE_geometry_playback_cache_stats_get(&cache_stats);
+      const uint64_t lookups = cache_stats.hits + cache_stats.misses;
+      const int hit_percent = (lookups > 0) ? (int)(100 * cache_stats.hits / lookups) : 0;
+      BLI_str_format_byte_unit(formatted_mem, cache_stats.memory_used, false);
+      ofs += BLI_snprintf(info + ofs,
+                          len - ofs,
+                          TIP_(" | Geometry Cache: %s (%d%% hits)"),
+                          formatted_mem,
+                          hit_percent);
+    }
   }
 
   /* GPU VRAM status. */
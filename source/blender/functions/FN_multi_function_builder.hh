@@ -58,6 +58,15 @@ template<typename In1, typename Out1> class CustomMF_SI_SO : public MultiFunctio
   template<typename ElementFuncT> static FunctionT create_function(ElementFuncT element_fn)
   {
     return [=](IndexMask mask, VSpan<In1> in1, MutableSpan<Out1> out1) {
+      if (mask.is_range() && in1.is_full_array()) {
+        /* Fast path for contiguous arrays, which the compiler can vectorize. */
+        const In1 *in1_data = in1.as_full_array().data();
+        Out1 *out1_data = out1.data();
+        for (const int64_t i : mask.as_range()) {
+          new (static_cast<void *>(out1_data + i)) Out1(element_fn(in1_data[i]));
+        }
+        return;
+      }
       mask.foreach_index(
           [&](int i) { new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i])); });
     };
@@ -101,6 +110,16 @@ class CustomMF_SI_SI_SO : public MultiFunction {
   template<typename ElementFuncT> static FunctionT create_function(ElementFuncT element_fn)
   {
     return [=](IndexMask mask, VSpan<In1> in1, VSpan<In2> in2, MutableSpan<Out1> out1) {
+      if (mask.is_range() && in1.is_full_array() && in2.is_full_array()) {
+        /* Fast path for contiguous arrays, which the compiler can vectorize. */
+        const In1 *in1_data = in1.as_full_array().data();
+        const In2 *in2_data = in2.as_full_array().data();
+        Out1 *out1_data = out1.data();
+        for (const int64_t i : mask.as_range()) {
+          new (static_cast<void *>(out1_data + i)) Out1(element_fn(in1_data[i], in2_data[i]));
+        }
+        return;
+      }
       mask.foreach_index(
           [&](int i) { new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i], in2[i])); });
     };
@@ -152,6 +171,19 @@ class CustomMF_SI_SI_SI_SO : public MultiFunction {
                VSpan<In2> in2,
                VSpan<In3> in3,
                MutableSpan<Out1> out1) {
+      if (mask.is_range() && in1.is_full_array() && in2.is_full_array() &&
+          in3.is_full_array()) {
+        /* Fast path for contiguous arrays, which the compiler can vectorize. */
+        const In1 *in1_data = in1.as_full_array().data();
+        const In2 *in2_data = in2.as_full_array().data();
+        const In3 *in3_data = in3.as_full_array().data();
+        Out1 *out1_data = out1.data();
+        for (const int64_t i : mask.as_range()) {
+          new (static_cast<void *>(out1_data + i))
+              Out1(element_fn(in1_data[i], in2_data[i], in3_data[i]));
+        }
+        return;
+      }
       mask.foreach_index([&](int i) {
         new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i], in2[i], in3[i]));
       });
@@ -25,11 +25,14 @@
 namespace blender::fn {
 
 class MFNetworkEvaluationStorage;
+class MFNetworkEvaluationBufferCache;
 
 class MFNetworkEvaluator : public MultiFunction {
  private:
   Vector<const MFOutputSocket *> inputs_;
   Vector<const MFInputSocket *> outputs_;
+  /** True when all inputs and outputs are single values, so that they can be sliced. */
+  bool supports_chunked_evaluation_;
 
  public:
   MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs, Vector<const MFInputSocket *> outputs);
@@ -39,6 +42,12 @@ class MFNetworkEvaluator : public MultiFunction {
  private:
   using Storage = MFNetworkEvaluationStorage;
 
+  void call_in_chunks(IndexMask mask, MFParams params, MFContext context) const;
+  void call_with_buffer_cache(IndexMask mask,
+                              MFParams params,
+                              MFContext context,
+                              MFNetworkEvaluationBufferCache &buffer_cache) const;
+
   void copy_inputs_to_storage(MFParams params, Storage &storage) const;
   void copy_outputs_to_storage(
       MFParams params,
@@ -103,6 +103,14 @@ class GSpan {
     BLI_assert(type_->is<T>());
     return Span<T>(static_cast<const T *>(data_), size_);
   }
+
+  GSpan slice(const int64_t start, const int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= size_ || size == 0);
+    return GSpan(*type_, POINTER_OFFSET(data_, type_->size() * start), size);
+  }
 };
 
 /**
@@ -178,6 +186,14 @@ class GMutableSpan {
     BLI_assert(type_->is<T>());
     return MutableSpan<T>(static_cast<T *>(data_), size_);
   }
+
+  GMutableSpan slice(const int64_t start, const int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= size_ || size == 0);
+    return GMutableSpan(*type_, POINTER_OFFSET(data_, type_->size() * start), size);
+  }
 };
 
 enum class VSpanCategory {
@@ -443,6 +459,29 @@ class GVSpan : public VSpanBase<void> {
     return GSpan(*this->type_, data, this->virtual_size_);
   }
 
+  /**
+   * Get a virtual span that references the elements in the given range. A single value stays a
+   * single value, independent of the range.
+   */
+  GVSpan slice(const int64_t start, const int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= virtual_size_ || size == 0);
+    switch (this->category_) {
+      case VSpanCategory::Single:
+        return GVSpan::FromSingle(*type_, this->data_.single.data, size);
+      case VSpanCategory::FullArray:
+        return GVSpan(
+            GSpan(*type_, this->data_.full_array.data, virtual_size_).slice(start, size));
+      case VSpanCategory::FullPointerArray:
+        return GVSpan::FromFullPointerArray(
+            *type_, this->data_.full_pointer_array.data + start, size);
+    }
+    BLI_assert(false);
+    return GVSpan(*type_);
+  }
+
   void materialize_to_uninitialized(void *dst) const
   {
     this->materialize_to_uninitialized(IndexRange(virtual_size_), dst);
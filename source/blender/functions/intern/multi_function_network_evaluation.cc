@@ -28,9 +28,12 @@
  * - Avoids data copies in many cases.
  * - Every node is executed at most once.
  * - Can compute sub-functions on a single element, when the result is the same for all elements.
+ * - Large masks are split into chunks which are evaluated through the entire network at once, in
+ *   parallel. This keeps the intermediate buffers small enough to stay in the CPU cache.
+ * - Buffers of intermediate values are reused once all their users have been evaluated.
  *
  * Possible improvements:
- * - Cache and reuse buffers.
+ * - Support chunked evaluation when vector parameters are passed in by the caller.
  * - Use "deepest depth first" heuristic to decide which order the inputs of a node should be
  *   computed. This reduces the number of required temporary buffers when they are reused.
  */
@@ -38,11 +41,60 @@
 #include "FN_multi_function_network_evaluation.hh"
 
 #include "BLI_stack.hh"
+#include "BLI_task.hh"
 
 namespace blender::fn {
 
 struct Value;
 
+/**
+ * Number of elements that are evaluated through the entire network at once, when the mask is
+ * large. The intermediate buffers of a chunk are small enough to stay in the CPU cache, instead of
+ * every function streaming full size buffers through memory.
+ */
+static constexpr int64_t chunk_size = 4096;
+
+/**
+ * Keeps buffers which are not used anymore, so that they can be reused for other values in the
+ * same network evaluation and for the evaluation of later chunks.
+ */
+class MFNetworkEvaluationBufferCache : NonCopyable, NonMovable {
+ private:
+  struct Buffer {
+    void *data;
+    int64_t size;
+    int64_t alignment;
+  };
+  Vector<Buffer> free_buffers_;
+
+ public:
+  ~MFNetworkEvaluationBufferCache()
+  {
+    for (const Buffer &buffer : free_buffers_) {
+      MEM_freeN(buffer.data);
+    }
+  }
+
+  void *allocate(const int64_t size, const int64_t alignment)
+  {
+    for (const int64_t i : free_buffers_.index_range()) {
+      const Buffer &buffer = free_buffers_[i];
+      if (buffer.size >= size && buffer.alignment >= alignment) {
+        void *data = buffer.data;
+        free_buffers_.remove_and_reorder(i);
+        return data;
+      }
+    }
+    /* Use a common minimum alignment, so that buffers can be reused for most types. */
+    return MEM_mallocN_aligned(size, std::max<int64_t>(alignment, 16), __func__);
+  }
+
+  void free(void *data, const int64_t size, const int64_t alignment)
+  {
+    free_buffers_.append({data, size, std::max<int64_t>(alignment, 16)});
+  }
+};
+
 /**
  * This keeps track of all the values that flow through the multi-function network. Therefore it
  * maintains a mapping between output sockets and their corresponding values. Every `value`
@@ -56,9 +108,12 @@ class MFNetworkEvaluationStorage {
   IndexMask mask_;
   Array<Value *> value_per_output_id_;
   int64_t min_array_size_;
+  MFNetworkEvaluationBufferCache &buffer_cache_;
 
  public:
-  MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount);
+  MFNetworkEvaluationStorage(IndexMask mask,
+                             int socket_id_amount,
+                             MFNetworkEvaluationBufferCache &buffer_cache);
   ~MFNetworkEvaluationStorage();
 
   /* Add the values that have been provided by the caller of the multi-function network. */
@@ -97,11 +152,17 @@ class MFNetworkEvaluationStorage {
   bool socket_is_computed(const MFOutputSocket &socket);
   bool is_same_value_for_every_index(const MFOutputSocket &socket);
   bool socket_has_buffer_for_output(const MFOutputSocket &socket);
+
+ private:
+  void *allocate_full_buffer(const CPPType &type);
+  void free_full_buffer(GMutableSpan span);
 };
 
 MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
                                        Vector<const MFInputSocket *> outputs)
-    : inputs_(std::move(inputs)), outputs_(std::move(outputs))
+    : inputs_(std::move(inputs)),
+      outputs_(std::move(outputs)),
+      supports_chunked_evaluation_(true)
 {
   BLI_assert(outputs_.size() > 0);
   MFSignatureBuilder signature = this->get_builder("Function Tree");
@@ -116,6 +177,7 @@ MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
         break;
       case MFDataType::Vector:
         signature.vector_input(socket->name(), type.vector_base_type());
+        supports_chunked_evaluation_ = false;
         break;
     }
   }
@@ -130,6 +192,7 @@ MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
         break;
       case MFDataType::Vector:
         signature.vector_output(socket->name(), type.vector_base_type());
+        supports_chunked_evaluation_ = false;
         break;
     }
   }
@@ -141,8 +204,72 @@ void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context
     return;
   }
 
+  if (supports_chunked_evaluation_ && mask.size() > chunk_size) {
+    this->call_in_chunks(mask, params, context);
+    return;
+  }
+
+  MFNetworkEvaluationBufferCache buffer_cache;
+  this->call_with_buffer_cache(mask, params, context, buffer_cache);
+}
+
+/**
+ * Split the mask into chunks and evaluate the entire network for one chunk at a time. The indices
+ * of every chunk are shifted to start at zero, so that intermediate buffers only have to be as
+ * large as the chunk. Chunks are independent and are evaluated in parallel.
+ */
+BLI_NOINLINE void MFNetworkEvaluator::call_in_chunks(IndexMask mask,
+                                                     MFParams params,
+                                                     MFContext context) const
+{
+  const int64_t chunks_num = (mask.size() + chunk_size - 1) / chunk_size;
+
+  parallel_for(IndexRange(chunks_num), 1, [&](IndexRange chunk_range) {
+    /* Buffers are reused for all chunks that are evaluated by this task. */
+    MFNetworkEvaluationBufferCache buffer_cache;
+    Vector<int64_t> shifted_indices;
+
+    for (const int64_t chunk_index : chunk_range) {
+      const int64_t start = chunk_index * chunk_size;
+      const int64_t size = std::min(chunk_size, mask.size() - start);
+      const int64_t first_index = mask[start];
+      const int64_t array_size = mask[start + size - 1] - first_index + 1;
+
+      IndexMask chunk_mask;
+      if (array_size == size) {
+        chunk_mask = IndexRange(size);
+      }
+      else {
+        shifted_indices.clear();
+        for (const int64_t i : IndexRange(start, size)) {
+          shifted_indices.append(mask[i] - first_index);
+        }
+        chunk_mask = shifted_indices.as_span();
+      }
+
+      MFParamsBuilder chunk_params{*this, array_size};
+      for (const int input_index : inputs_.index_range()) {
+        const GVSpan values = params.readonly_single_input(input_index);
+        chunk_params.add_readonly_single_input(values.slice(first_index, array_size));
+      }
+      for (const int output_index : outputs_.index_range()) {
+        const GMutableSpan values = params.uninitialized_single_output(output_index +
+                                                                       inputs_.size());
+        chunk_params.add_uninitialized_single_output(values.slice(first_index, array_size));
+      }
+
+      this->call_with_buffer_cache(chunk_mask, chunk_params, context, buffer_cache);
+    }
+  });
+}
+
+void MFNetworkEvaluator::call_with_buffer_cache(IndexMask mask,
+                                                MFParams params,
+                                                MFContext context,
+                                                MFNetworkEvaluationBufferCache &buffer_cache) const
+{
   const MFNetwork &network = outputs_[0]->node().network();
-  Storage storage(mask, network.socket_id_amount());
+  Storage storage(mask, network.socket_id_amount(), buffer_cache);
 
   Vector<const MFInputSocket *> outputs_to_initialize_in_the_end;
 
@@ -506,10 +633,12 @@ struct OwnVectorValue : public Value {
 /** \name Storage methods
  * \{ */
 
-MFNetworkEvaluationStorage::MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount)
+MFNetworkEvaluationStorage::MFNetworkEvaluationStorage(
+    IndexMask mask, int socket_id_amount, MFNetworkEvaluationBufferCache &buffer_cache)
     : mask_(mask),
       value_per_output_id_(socket_id_amount, nullptr),
-      min_array_size_(mask.min_array_size())
+      min_array_size_(mask.min_array_size()),
+      buffer_cache_(buffer_cache)
 {
 }
 
@@ -528,7 +657,7 @@ MFNetworkEvaluationStorage::~MFNetworkEvaluationStorage()
       }
       else {
         type.destruct_indices(span.data(), mask_);
-        MEM_freeN(span.data());
+        this->free_full_buffer(span);
       }
     }
     else if (any_value->type == ValueType::OwnVector) {
@@ -543,6 +672,17 @@ IndexMask MFNetworkEvaluationStorage::mask() const
   return mask_;
 }
 
+void *MFNetworkEvaluationStorage::allocate_full_buffer(const CPPType &type)
+{
+  return buffer_cache_.allocate(min_array_size_ * type.size(), type.alignment());
+}
+
+void MFNetworkEvaluationStorage::free_full_buffer(GMutableSpan span)
+{
+  const CPPType &type = span.type();
+  buffer_cache_.free(span.data(), min_array_size_ * type.size(), type.alignment());
+}
+
 bool MFNetworkEvaluationStorage::socket_is_computed(const MFOutputSocket &socket)
 {
   Value *any_value = value_per_output_id_[socket.id()];
@@ -638,7 +778,7 @@ void MFNetworkEvaluationStorage::finish_input_socket(const MFInputSocket &socket
         }
         else {
           type.destruct_indices(span.data(), mask_);
-          MEM_freeN(span.data());
+          this->free_full_buffer(span);
         }
         value_per_output_id_[origin.id()] = nullptr;
       }
@@ -702,7 +842,7 @@ GMutableSpan MFNetworkEvaluationStorage::get_single_output__full(const MFOutputS
   Value *any_value = value_per_output_id_[socket.id()];
   if (any_value == nullptr) {
     const CPPType &type = socket.data_type().single_type();
-    void *buffer = MEM_mallocN_aligned(min_array_size_ * type.size(), type.alignment(), AT);
+    void *buffer = this->allocate_full_buffer(type);
     GMutableSpan span(type, buffer, min_array_size_);
 
     auto *value = allocator_.construct<OwnSingleValue>(span, socket.targets().size(), false);
@@ -802,7 +942,7 @@ GMutableSpan MFNetworkEvaluationStorage::get_mutable_single__full(const MFInputS
   }
 
   GVSpan virtual_span = this->get_single_input__full(input);
-  void *new_buffer = MEM_mallocN_aligned(min_array_size_ * type.size(), type.alignment(), AT);
+  void *new_buffer = this->allocate_full_buffer(type);
   GMutableSpan new_array_ref(type, new_buffer, min_array_size_);
   virtual_span.materialize_to_uninitialized(mask_, new_array_ref.data());
 
@@ -251,5 +251,64 @@ TEST(multi_function_network, Test2)
   }
 }
 
+TEST(multi_function_network, ChunkedEvaluation)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+  CustomMF_SI_SI_SO<int, int, int> add_fn("add", [](int a, int b) { return a + b; });
+
+  MFNetwork network;
+
+  MFNode &node1 = network.add_function(add_10_fn);
+  MFNode &node2 = network.add_function(add_fn);
+  MFOutputSocket &input1 = network.add_input("Input 1", MFDataType::ForSingle<int>());
+  MFOutputSocket &input2 = network.add_input("Input 2", MFDataType::ForSingle<int>());
+  MFInputSocket &output1 = network.add_output("Output 1", MFDataType::ForSingle<int>());
+  MFInputSocket &output2 = network.add_output("Output 2", MFDataType::ForSingle<int>());
+  network.add_link(input1, node1.input(0));
+  network.add_link(node1.output(0), node2.input(0));
+  network.add_link(input2, node2.input(1));
+  network.add_link(node2.output(0), output1);
+  network.add_link(input1, output2);
+
+  MFNetworkEvaluator network_fn{{&input1, &input2}, {&output1, &output2}};
+
+  /* Large enough to be split into multiple chunks. */
+  const int size = 100000;
+  Array<int> values(size);
+  for (const int i : values.index_range()) {
+    values[i] = i;
+  }
+  int offset = 5;
+
+  Vector<int64_t> indices;
+  for (int64_t i = 3; i < size; i += 3) {
+    indices.append(i);
+  }
+
+  for (const IndexMask mask : {IndexMask(IndexRange(7, size - 7)), IndexMask(indices)}) {
+    Array<int> results1(size, -1);
+    Array<int> results2(size, -1);
+
+    MFParamsBuilder params(network_fn, size);
+    params.add_readonly_single_input(values.as_span());
+    params.add_readonly_single_input(&offset);
+    params.add_uninitialized_single_output(results1.as_mutable_span());
+    params.add_uninitialized_single_output(results2.as_mutable_span());
+
+    MFContextBuilder context;
+
+    network_fn.call(mask, params, context);
+
+    Array<bool> is_in_mask(size, false);
+    for (const int64_t i : mask) {
+      is_in_mask[i] = true;
+    }
+    for (const int i : IndexRange(size)) {
+      EXPECT_EQ(results1[i], is_in_mask[i] ? i + 15 : -1);
+      EXPECT_EQ(results2[i], is_in_mask[i] ? i : -1);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace blender::fn::tests
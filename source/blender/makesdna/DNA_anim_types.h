@@ -1107,6 +1107,8 @@ typedef struct AnimData {
 
   /** Runtime data, for depsgraph evaluation. */
   FCurve **driver_array;
+  /** Runtime data, resolved RNA paths of evaluated animation data. */
+  struct AnimDataPathCache *path_cache;
 
   /* settings for animation evaluation */
   /** User-defined settings. */
@@ -103,6 +103,18 @@ typedef struct Mesh_Runtime {
   /** Non-manifold boundary data for Shrinkwrap Target Project. */
   struct ShrinkwrapBoundaryData *shrinkwrap_data;
 
+  /**
+   * Lazily computed float normals, see #BKE_mesh_vertex_normals_ensure.
+   * Only valid while the normals of the #MVert layer are not tagged dirty either.
+   */
+  float (*vert_normals)[3];
+  float (*poly_normals)[3];
+  /** Protects computing the normals above from multiple threads. */
+  void *normals_mutex;
+  /** Allocated length of the normal arrays, the geometry may be resized without freeing them. */
+  int vert_normals_len;
+  int poly_normals_len;
+
   /** Set by modifier stack if only deformed from original. */
   char deformed_only;
   /**
@@ -122,7 +134,17 @@ typedef struct Mesh_Runtime {
    */
   char wrapper_type_finalize;
 
-  char _pad[4];
+  /** Set when #vert_normals and #poly_normals need to be recomputed before use. */
+  char vert_normals_dirty;
+  char poly_normals_dirty;
+
+  /**
+   * Set when #batch_cache was moved over from the previous evaluated mesh, which only differed
+   * in vertex positions. The cache is already tagged for that, so the full reset is skipped.
+   */
+  char batch_cache_is_deformed;
+
+  char _pad[1];
 
   /** Needed in case we need to lazily initialize the mesh. */
   CustomData_MeshMasks cd_mask_extra;
@@ -774,7 +774,8 @@ typedef struct UserDef {
   short gp_manhattandist, gp_euclideandist, gp_eraser;
   /** #eGP_UserdefSettings. */
   short gp_settings;
-  char _pad13[4];
+  /** Memory limit of the modifier result cache (in megabytes), 0 disables it. */
+  int modifier_cache_limit;
   struct SolidLight light_param[4];
   float light_ambient[3];
   char gizmo_flag;
@@ -792,7 +793,8 @@ typedef struct UserDef {
   int prefetchframes;
   /** Control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use. */
   float pad_rot_angle;
-  char _pad12[4];
+  /** Memory limit of the evaluated geometry playback cache (in megabytes), 0 disables it. */
+  int geometry_cache_limit;
   /** Rotating view icon size. */
   short rvisize;
   /** Rotating view icon brightness. */
@@ -8679,6 +8679,11 @@ static void def_geo_point_instance(StructRNA *srna)
        ICON_NONE,
        "Collection",
        "Instance an entire collection on all points"},
+      {GEO_NODE_POINT_INSTANCE_TYPE_GEOMETRY,
+       "GEOMETRY",
+       ICON_NONE,
+       "Geometry",
+       "Instance the input geometry on all points, without making a copy of it for every point"},
       {0, NULL, 0, NULL, NULL},
   };
 
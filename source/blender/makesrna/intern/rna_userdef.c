@@ -177,11 +177,13 @@ static const EnumPropertyItem rna_enum_userdef_viewport_aa_items[] = {
 #  include "DNA_screen_types.h"
 
 #  include "BKE_blender.h"
+#  include "BKE_geometry_playback_cache.h"
 #  include "BKE_global.h"
 #  include "BKE_idprop.h"
 #  include "BKE_image.h"
 #  include "BKE_main.h"
 #  include "BKE_mesh_runtime.h"
+#  include "BKE_modifier_result_cache.h"
 #  include "BKE_paint.h"
 #  include "BKE_pbvh.h"
 #  include "BKE_preferences.h"
@@ -571,6 +573,22 @@ static void rna_Userdef_memcache_update(Main *UNUSED(bmain),
   USERDEF_TAG_DIRTY;
 }
 
+static void rna_Userdef_geometry_cache_update(Main *UNUSED(bmain),
+                                              Scene *UNUSED(scene),
+                                              PointerRNA *UNUSED(ptr))
+{
+  BKE_geometry_playback_cache_limit_update();
+  USERDEF_TAG_DIRTY;
+}
+
+static void rna_Userdef_modifier_cache_update(Main *UNUSED(bmain),
+                                              Scene *UNUSED(scene),
+                                              PointerRNA *UNUSED(ptr))
+{
+  BKE_modifier_result_cache_limit_update();
+  USERDEF_TAG_DIRTY;
+}
+
 static void rna_Userdef_disk_cache_dir_update(Main *UNUSED(bmain),
                                               Scene *UNUSED(scene),
                                               PointerRNA *UNUSED(ptr))
@@ -5389,6 +5407,25 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "geometry_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "geometry_cache_limit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Geometry Cache Limit",
+                           "Memory limit for caching evaluated object geometry for playback (in "
+                           "megabytes), zero disables the cache");
+  RNA_def_property_update(prop, 0, "rna_Userdef_geometry_cache_update");
+
+  prop = RNA_def_property(srna, "modifier_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "modifier_cache_limit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Modifier Cache Limit",
+                           "Memory limit for caching the results of slow modifiers, so that only "
+                           "the following modifiers are evaluated again when their settings "
+                           "change (in megabytes), zero disables the cache");
+  RNA_def_property_update(prop, 0, "rna_Userdef_modifier_cache_update");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
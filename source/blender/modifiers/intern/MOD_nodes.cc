@@ -21,16 +21,22 @@
  * \ingroup modifiers
  */
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "MEM_guardedalloc.h"
 
 #include "BLI_float3.hh"
+#include "BLI_hash.h"
 #include "BLI_listbase.h"
 #include "BLI_set.hh"
+#include "BLI_stack.hh"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_collection_types.h"
@@ -87,6 +93,7 @@ using blender::bke::PersistentCollectionHandle;
 using blender::bke::PersistentDataHandleMap;
 using blender::bke::PersistentObjectHandle;
 using blender::fn::GMutablePointer;
+using blender::fn::GPointer;
 using blender::fn::GValueMap;
 using blender::nodes::GeoNodeExecParams;
 using namespace blender::nodes::derived_node_tree_types;
@@ -236,10 +243,237 @@ static bool isDisabled(const struct Scene *UNUSED(scene),
   return false;
 }
 
+/**
+ * Copies of the outputs of a node, which are used instead of executing the node again when the
+ * node has the same key in a later evaluation.
+ */
+struct NodeOutputCacheEntry : blender::NonCopyable, blender::NonMovable {
+  /* One value per output socket of the node, empty for unavailable outputs. */
+  Vector<GMutablePointer> values;
+  /* True when the entry has been used by the last evaluation. */
+  bool used = true;
+
+  ~NodeOutputCacheEntry()
+  {
+    for (GMutablePointer value : values) {
+      if (value.get() != nullptr) {
+        value.destruct();
+        MEM_freeN(value.get());
+      }
+    }
+  }
+};
+
+/**
+ * Stored in #ModifierData.runtime of the evaluated modifier, which is kept when the evaluated
+ * object is updated from the original. Entries are keyed by #GeometryNodesEvaluator's node keys.
+ */
+struct NodesModifierRuntimeData {
+  /* Nodes are executed on multiple threads. */
+  std::mutex cache_mutex;
+  Map<uint64_t, std::unique_ptr<NodeOutputCacheEntry>> cache;
+
+  /* Free entries which have not been used by the last evaluation, their inputs have changed. */
+  void remove_unused_cache_entries()
+  {
+    Vector<uint64_t> unused_keys;
+    for (auto item : cache.items()) {
+      if (!item.value->used) {
+        unused_keys.append(item.key);
+      }
+      item.value->used = false;
+    }
+    for (const uint64_t key : unused_keys) {
+      cache.remove(key);
+    }
+  }
+};
+
+static void freeRuntimeData(void *runtime_data_v)
+{
+  if (runtime_data_v == nullptr) {
+    return;
+  }
+  NodesModifierRuntimeData *runtime_data = static_cast<NodesModifierRuntimeData *>(
+      runtime_data_v);
+  OBJECT_GUARDED_DELETE(runtime_data, NodesModifierRuntimeData);
+}
+
+static NodesModifierRuntimeData *nodes_modifier_ensure_runtime(NodesModifierData *nmd)
+{
+  if (nmd->modifier.runtime == nullptr) {
+    nmd->modifier.runtime = OBJECT_GUARDED_NEW(NodesModifierRuntimeData);
+  }
+  return static_cast<NodesModifierRuntimeData *>(nmd->modifier.runtime);
+}
+
+/* Start value of node cache keys, zero is used for outputs which can't be cached. */
+static constexpr uint64_t node_cache_key_init = BLI_HASH_FNV1A_64_INIT;
+
+template<typename T> static void node_cache_key_add(uint64_t *key, const T &value)
+{
+  *key = BLI_hash_fnv1a_64(*key, &value, sizeof(value));
+}
+
+static void node_cache_key_add_string(uint64_t *key, const StringRef str)
+{
+  *key = BLI_hash_fnv1a_64(*key, str.data(), (size_t)str.size());
+  node_cache_key_add(key, str.size());
+}
+
+static bool node_cache_key_add_collection(uint64_t *key, const Collection &collection)
+{
+  if (collection.id.recalc != 0) {
+    return false;
+  }
+  node_cache_key_add(key, collection.id.session_uuid);
+  LISTBASE_FOREACH (const CollectionObject *, collection_object, &collection.gobject) {
+    const Object *object = collection_object->ob;
+    if (object->id.recalc != 0) {
+      return false;
+    }
+    node_cache_key_add(key, object->id.session_uuid);
+  }
+  LISTBASE_FOREACH (const CollectionChild *, collection_child, &collection.children) {
+    if (!node_cache_key_add_collection(key, *collection_child->collection)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Key of a data-block used by the node tree, zero when it has been tagged for update in the
+ * current evaluation. Since cache entries which are not used by an evaluation are freed, the
+ * data-block can not have changed since an entry with the same key was stored.
+ */
+static uint64_t id_cache_key(const ID *id)
+{
+  uint64_t key = node_cache_key_init;
+  if (id == nullptr) {
+    return key;
+  }
+  if (GS(id->name) == ID_GR) {
+    /* Objects can be added to collections without tagging them. */
+    return node_cache_key_add_collection(&key, *(const Collection *)id) ? key : 0;
+  }
+  if (id->recalc != 0) {
+    return 0;
+  }
+  node_cache_key_add(&key, id->session_uuid);
+  return key;
+}
+
+static void node_cache_key_add_custom_data(uint64_t *key, const CustomData &data)
+{
+  for (const int i : IndexRange(data.totlayer)) {
+    node_cache_key_add(key, data.layers[i].type);
+    node_cache_key_add_string(key, data.layers[i].name);
+  }
+}
+
+/**
+ * The geometry passed to the modifier can only be cached when it is the original data of the
+ * object, i.e. when there are no modifiers before this one.
+ */
+static uint64_t input_geometry_cache_key(const Object &object,
+                                         const ModifierData &md,
+                                         const GeometrySet &geometry_set)
+{
+  VirtualModifierData virtual_modifier_data;
+  if (BKE_modifiers_get_virtual_modifierlist(&object, &virtual_modifier_data) != &md) {
+    return 0;
+  }
+  uint64_t key = id_cache_key((const ID *)object.data);
+  if (key == 0) {
+    return 0;
+  }
+  LISTBASE_FOREACH (const bDeformGroup *, group, &object.defbase) {
+    node_cache_key_add_string(&key, group->name);
+  }
+  /* The layers of the mesh depend on the data masks of all modifiers. */
+  const Mesh *mesh = geometry_set.get_mesh_for_read();
+  if (mesh != nullptr) {
+    node_cache_key_add_custom_data(&key, mesh->vdata);
+    node_cache_key_add_custom_data(&key, mesh->edata);
+    node_cache_key_add_custom_data(&key, mesh->ldata);
+    node_cache_key_add_custom_data(&key, mesh->pdata);
+  }
+  return key;
+}
+
+static uint64_t group_input_cache_key(const bNodeSocket &socket,
+                                      const PersistentDataHandleMap &handle_map,
+                                      const GPointer value)
+{
+  switch (socket.type) {
+    case SOCK_GEOMETRY:
+      /* Only the first geometry input is supported, other geometries are empty. */
+      return node_cache_key_init;
+    case SOCK_OBJECT:
+      return id_cache_key(
+          (const ID *)handle_map.lookup(*(const PersistentObjectHandle *)value.get()));
+    case SOCK_COLLECTION:
+      return id_cache_key(
+          (const ID *)handle_map.lookup(*(const PersistentCollectionHandle *)value.get()));
+    default: {
+      uint64_t key = node_cache_key_init;
+      node_cache_key_add(&key, value.type()->hash(value.get()));
+      return key;
+    }
+  }
+}
+
+/* Node trees are not hashed, all cached outputs are freed when one of them changes. */
+static bool node_trees_changed(const DerivedNodeTree &tree)
+{
+  for (const blender::nodes::NodeTreeRef *tree_ref : tree.used_node_tree_refs()) {
+    if (tree_ref->btree()->id.recalc != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Evaluates the nodes that are necessary to compute the group outputs.
+ *
+ * Before execution, the nodes and input sockets that are required for the group outputs are
+ * found by walking the tree backwards from the group outputs. Values are only forwarded to these
+ * inputs. Data used by unrelated nodes is freed right away instead of being copied, which also
+ * keeps geometries mutable when only one required node uses them.
+ *
+ * Every required node is a task which is scheduled once all nodes it depends on have been
+ * executed. Independent branches of the node tree are therefore evaluated on multiple threads.
+ *
+ * When a cache is passed in, every node whose inputs did not change gets a key. The outputs of
+ * such nodes which are used by changing nodes are stored in the cache, and a later evaluation with
+ * the same key skips the node and everything it depends on.
+ */
 class GeometryNodesEvaluator {
  private:
+  using InputKey = std::pair<const DInputSocket *, const DOutputSocket *>;
+
+  struct NodeTask {
+    const DNode *node;
+    /* Every node has its own allocator, so that nodes can be executed on different threads.
+     * The values computed by the node are allocated here as well. */
+    blender::LinearAllocator<> allocator;
+    /* Number of nodes which still have to be executed before this node can be executed. */
+    std::atomic<int> dependencies_left = 0;
+    /* Required nodes which use outputs of this node, without duplicates. */
+    Vector<NodeTask *> users;
+    /* True when this node or a node it depends on reported a warning. Warnings would not be
+     * reported again when the outputs are taken from the cache, so they are not stored then. */
+    bool has_warnings = false;
+  };
+
   blender::LinearAllocator<> allocator_;
-  Map<std::pair<const DInputSocket *, const DOutputSocket *>, GMutablePointer> value_by_input_;
+  /* Contains a slot for every value used by a required input socket. No slots are added or
+   * removed during execution, so that different threads can fill different slots. */
+  Map<InputKey, GMutablePointer> value_by_input_;
+  Map<const DNode *, NodeTask *> task_by_node_;
+  Vector<std::unique_ptr<NodeTask>> tasks_;
   Vector<const DInputSocket *> group_outputs_;
   blender::nodes::MultiFunctionByNode &mf_by_node_;
   const blender::nodes::DataTypeConversions &conversions_;
@@ -247,113 +481,393 @@ class GeometryNodesEvaluator {
   const Object *self_object_;
   const ModifierData *modifier_;
   Depsgraph *depsgraph_;
+  NodesModifierRuntimeData *cache_;
+  const Map<const DOutputSocket *, uint64_t> &group_input_keys_;
+  /* Zero for nodes whose outputs may be different from an earlier evaluation. Not changed during
+   * execution. */
+  Map<const DNode *, uint64_t> node_keys_;
+  /* Nodes that are executed and whose outputs are stored in the cache afterwards. */
+  Map<const DNode *, uint64_t> nodes_to_cache_;
 
  public:
   GeometryNodesEvaluator(const Map<const DOutputSocket *, GMutablePointer> &group_input_data,
+                         const Map<const DOutputSocket *, uint64_t> &group_input_keys,
                          Vector<const DInputSocket *> group_outputs,
                          blender::nodes::MultiFunctionByNode &mf_by_node,
                          const PersistentDataHandleMap &handle_map,
                          const Object *self_object,
                          const ModifierData *modifier,
-                         Depsgraph *depsgraph)
+                         Depsgraph *depsgraph,
+                         NodesModifierRuntimeData *cache)
       : group_outputs_(std::move(group_outputs)),
         mf_by_node_(mf_by_node),
         conversions_(blender::nodes::get_implicit_type_conversions()),
         handle_map_(handle_map),
         self_object_(self_object),
         modifier_(modifier),
-        depsgraph_(depsgraph)
+        depsgraph_(depsgraph),
+        cache_(cache),
+        group_input_keys_(group_input_keys)
   {
-    for (auto item : group_input_data.items()) {
-      this->forward_to_inputs(*item.key, item.value);
+    /* Values of outputs that don't have to be computed by executing nodes. */
+    Map<const DOutputSocket *, GMutablePointer> known_outputs = group_input_data;
+    if (cache_ != nullptr) {
+      this->load_cached_outputs(known_outputs);
+    }
+
+    Set<const DOutputSocket *> unavailable_outputs;
+    this->find_required_nodes(known_outputs, unavailable_outputs);
+
+    for (auto item : known_outputs.items()) {
+      this->forward_to_inputs(*item.key, item.value, allocator_);
+    }
+    /* Unavailable outputs are never computed, use a default value instead. */
+    for (const DOutputSocket *socket : unavailable_outputs) {
+      const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket->typeinfo());
+      void *buffer = allocator_.allocate(type.size(), type.alignment());
+      type.copy_to_uninitialized(type.default_value(), buffer);
+      this->forward_to_inputs(*socket, {type, buffer}, allocator_);
     }
   }
 
   Vector<GMutablePointer> execute()
   {
+    TaskPool *task_pool = BLI_task_pool_create(this, TASK_PRIORITY_HIGH);
+    for (std::unique_ptr<NodeTask> &task : tasks_) {
+      if (task->dependencies_left == 0) {
+        BLI_task_pool_push(task_pool, execute_node_task, task.get(), false, nullptr);
+      }
+    }
+    BLI_task_pool_work_and_wait(task_pool);
+    BLI_task_pool_free(task_pool);
+
     Vector<GMutablePointer> results;
     for (const DInputSocket *group_output : group_outputs_) {
-      Vector<GMutablePointer> result = this->get_input_values(*group_output);
+      Vector<GMutablePointer> result = this->get_input_values(*group_output, allocator_);
       results.append(result[0]);
     }
     for (GMutablePointer value : value_by_input_.values()) {
-      value.destruct();
+      if (value.get() != nullptr) {
+        value.destruct();
+      }
     }
     return results;
   }
 
  private:
-  Vector<GMutablePointer> get_input_values(const DInputSocket &socket_to_compute)
+  /**
+   * Create a task for every node that has to be executed to compute the group outputs, and a
+   * value slot for every input socket that is used by these nodes.
+   */
+  void find_required_nodes(const Map<const DOutputSocket *, GMutablePointer> &known_outputs,
+                           Set<const DOutputSocket *> &r_unavailable_outputs)
   {
+    blender::Stack<const DInputSocket *> sockets_to_check;
+    for (const DInputSocket *group_output : group_outputs_) {
+      sockets_to_check.push(group_output);
+    }
 
-    Span<const DOutputSocket *> from_sockets = socket_to_compute.linked_sockets();
-    Span<const DGroupInput *> from_group_inputs = socket_to_compute.linked_group_inputs();
-    const int total_inputs = from_sockets.size() + from_group_inputs.size();
+    Set<const DInputSocket *> checked_sockets;
+    while (!sockets_to_check.is_empty()) {
+      const DInputSocket *socket = sockets_to_check.pop();
+      if (!checked_sockets.add(socket)) {
+        continue;
+      }
+      /* Same as in #get_input_values, values of these inputs don't come from other nodes. */
+      if (socket->linked_sockets().is_empty() || socket->linked_group_inputs().size() == 1) {
+        continue;
+      }
+      for (const DOutputSocket *from_socket : socket->linked_sockets()) {
+        value_by_input_.add_new(std::make_pair(socket, from_socket), GMutablePointer());
+        if (!from_socket->is_available()) {
+          r_unavailable_outputs.add(from_socket);
+          continue;
+        }
+        if (known_outputs.contains(from_socket)) {
+          continue;
+        }
+        const DNode &from_node = from_socket->node();
+        if (task_by_node_.contains(&from_node)) {
+          continue;
+        }
+        std::unique_ptr<NodeTask> task = std::make_unique<NodeTask>();
+        task->node = &from_node;
+        task_by_node_.add_new(&from_node, task.get());
+        tasks_.append(std::move(task));
+        for (const DInputSocket *input_socket : from_node.inputs()) {
+          if (input_socket->is_available()) {
+            sockets_to_check.push(input_socket);
+          }
+        }
+      }
+    }
 
-    if (total_inputs == 0) {
-      /* The input is not connected, use the value from the socket itself. */
-      return {get_unlinked_input_value(socket_to_compute)};
+    /* Connect every task to the tasks computing its inputs. */
+    for (std::unique_ptr<NodeTask> &task : tasks_) {
+      for (const DInputSocket *input_socket : task->node->inputs()) {
+        if (!input_socket->is_available()) {
+          continue;
+        }
+        for (const DOutputSocket *from_socket : input_socket->linked_sockets()) {
+          NodeTask *from_task = task_by_node_.lookup_default(&from_socket->node(), nullptr);
+          if (from_task == nullptr || !from_socket->is_available() ||
+              known_outputs.contains(from_socket) || from_task->users.contains(task.get())) {
+            continue;
+          }
+          from_task->users.append(task.get());
+          task->dependencies_left++;
+        }
+      }
     }
+  }
 
-    if (from_group_inputs.size() == 1) {
-      return {get_unlinked_input_value(socket_to_compute)};
+  /**
+   * Find the unchanged nodes whose outputs are used by changed nodes or the group outputs, and
+   * take their outputs from the cache when possible. The nodes they depend on don't have to be
+   * executed then. The other unchanged nodes which are found are stored in the cache later.
+   */
+  void load_cached_outputs(Map<const DOutputSocket *, GMutablePointer> &known_outputs)
+  {
+    std::lock_guard lock{cache_->cache_mutex};
+
+    blender::Stack<const DInputSocket *> sockets_to_check;
+    for (const DInputSocket *group_output : group_outputs_) {
+      sockets_to_check.push(group_output);
     }
 
-    /* Multi-input sockets contain a vector of inputs. */
-    if (socket_to_compute.is_multi_input_socket()) {
-      Vector<GMutablePointer> values;
-      for (const DOutputSocket *from_socket : from_sockets) {
-        const std::pair<const DInputSocket *, const DOutputSocket *> key = std::make_pair(
-            &socket_to_compute, from_socket);
-        std::optional<GMutablePointer> value = value_by_input_.pop_try(key);
-        if (value.has_value()) {
-          values.append(*value);
+    Set<const DInputSocket *> checked_sockets;
+    Set<const DNode *> checked_nodes;
+    Set<const DNode *> cache_nodes;
+    while (!sockets_to_check.is_empty()) {
+      const DInputSocket *socket = sockets_to_check.pop();
+      if (!checked_sockets.add(socket)) {
+        continue;
+      }
+      if (socket->linked_sockets().is_empty() || socket->linked_group_inputs().size() == 1) {
+        continue;
+      }
+      const bool is_used_by_unchanged_node = !group_outputs_.contains(socket) &&
+                                             this->node_cache_key(socket->node()) != 0;
+      for (const DOutputSocket *from_socket : socket->linked_sockets()) {
+        if (!from_socket->is_available() || known_outputs.contains(from_socket)) {
+          continue;
+        }
+        const DNode &from_node = from_socket->node();
+        const uint64_t key = this->node_cache_key(from_node);
+        if (key != 0 && !is_used_by_unchanged_node && cache_nodes.add(&from_node)) {
+          if (this->load_cached_node_outputs(from_node, key, known_outputs)) {
+            continue;
+          }
+          nodes_to_cache_.add_new(&from_node, key);
+        }
+        if (checked_nodes.add(&from_node)) {
+          for (const DInputSocket *input_socket : from_node.inputs()) {
+            if (input_socket->is_available()) {
+              sockets_to_check.push(input_socket);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  bool load_cached_node_outputs(const DNode &node,
+                                const uint64_t key,
+                                Map<const DOutputSocket *, GMutablePointer> &known_outputs)
+  {
+    std::unique_ptr<NodeOutputCacheEntry> *entry_ptr = cache_->cache.lookup_ptr(key);
+    if (entry_ptr == nullptr) {
+      return false;
+    }
+    NodeOutputCacheEntry *entry = entry_ptr->get();
+    if (entry->values.size() != node.outputs().size()) {
+      return false;
+    }
+    for (const DOutputSocket *socket : node.outputs()) {
+      if (socket->is_available() && entry->values[socket->index()].get() == nullptr) {
+        return false;
+      }
+    }
+    entry->used = true;
+    for (const DOutputSocket *socket : node.outputs()) {
+      if (socket->is_available()) {
+        const GMutablePointer cached_value = entry->values[socket->index()];
+        const CPPType &type = *cached_value.type();
+        void *buffer = allocator_.allocate(type.size(), type.alignment());
+        type.copy_to_uninitialized(cached_value.get(), buffer);
+        known_outputs.add_new(socket, {type, buffer});
+      }
+    }
+    return true;
+  }
+
+  uint64_t node_cache_key(const DNode &node)
+  {
+    const uint64_t *cached_key = node_keys_.lookup_ptr(&node);
+    if (cached_key != nullptr) {
+      return *cached_key;
+    }
+    const uint64_t key = this->compute_node_cache_key(node);
+    node_keys_.add_new(&node, key);
+    return key;
+  }
+
+  /**
+   * The key combines the node with the keys of all its inputs. Unlinked input values are not part
+   * of the key, except for the data-blocks they reference.
+   */
+  uint64_t compute_node_cache_key(const DNode &node)
+  {
+    uint64_t key = node_cache_key_init;
+    node_cache_key_add_string(&key, node.name());
+    node_cache_key_add(&key, node.node_ref().tree().btree()->id.session_uuid);
+    for (const DParentNode *parent = node.parent(); parent != nullptr; parent = parent->parent()) {
+      node_cache_key_add_string(&key, parent->node_ref().name());
+      node_cache_key_add(&key, parent->node_ref().tree().btree()->id.session_uuid);
+    }
+
+    bool uses_ids = false;
+    for (const DInputSocket *input_socket : node.inputs()) {
+      if (!input_socket->is_available()) {
+        continue;
+      }
+      if (input_socket->linked_sockets().is_empty() ||
+          input_socket->linked_group_inputs().size() == 1) {
+        /* Same as in #get_unlinked_input_value. */
+        const bNodeSocket *bsocket = input_socket->linked_group_inputs().size() == 0 ?
+                                         input_socket->bsocket() :
+                                         input_socket->linked_group_inputs()[0]->bsocket();
+        const ID *id = nullptr;
+        if (bsocket->type == SOCK_OBJECT) {
+          id = (const ID *)((bNodeSocketValueObject *)bsocket->default_value)->value;
+        }
+        else if (bsocket->type == SOCK_COLLECTION) {
+          id = (const ID *)((bNodeSocketValueCollection *)bsocket->default_value)->value;
         }
         else {
-          this->compute_output_and_forward(*from_socket);
-          GMutablePointer value = value_by_input_.pop(key);
-          values.append(value);
+          continue;
+        }
+        const uint64_t id_key = id_cache_key(id);
+        if (id_key == 0) {
+          return 0;
+        }
+        node_cache_key_add(&key, id_key);
+        uses_ids = true;
+        continue;
+      }
+      for (const DOutputSocket *from_socket : input_socket->linked_sockets()) {
+        uint64_t from_key = node_cache_key_init;
+        const uint64_t *group_input_key = group_input_keys_.lookup_ptr(from_socket);
+        if (group_input_key != nullptr) {
+          from_key = *group_input_key;
+        }
+        else if (from_socket->is_available()) {
+          from_key = this->node_cache_key(from_socket->node());
+        }
+        if (from_key == 0) {
+          return 0;
+        }
+        node_cache_key_add(&key, from_key);
+        node_cache_key_add(&key, from_socket->index());
+        if (ELEM(from_socket->bsocket()->type, SOCK_OBJECT, SOCK_COLLECTION)) {
+          uses_ids = true;
+        }
+        if (!input_socket->is_multi_input_socket()) {
+          break;
         }
       }
-      return values;
     }
 
-    const DOutputSocket &from_socket = *from_sockets[0];
-    const std::pair<const DInputSocket *, const DOutputSocket *> key = std::make_pair(
-        &socket_to_compute, &from_socket);
-    std::optional<GMutablePointer> value = value_by_input_.pop_try(key);
-    if (value.has_value()) {
-      /* This input has been computed before, return it directly. */
-      return {*value};
+    /* Data-blocks are transformed into the space of the modified object. */
+    if (uses_ids) {
+      node_cache_key_add(&key, self_object_->imat);
     }
+    const ID *node_id = node.bnode()->id;
+    if (node_id != nullptr) {
+      const uint64_t id_key = id_cache_key(node_id);
+      if (id_key == 0) {
+        return 0;
+      }
+      node_cache_key_add(&key, id_key);
+    }
+    return key == 0 ? 1 : key;
+  }
 
-    /* Compute the socket now. */
-    this->compute_output_and_forward(from_socket);
-    return {value_by_input_.pop(key)};
+  bool node_has_warnings(const DNode &node)
+  {
+    for (const DInputSocket *input_socket : node.inputs()) {
+      for (const DOutputSocket *from_socket : input_socket->linked_sockets()) {
+        const NodeTask *from_task = task_by_node_.lookup_default(&from_socket->node(), nullptr);
+        if (from_task != nullptr && from_task->has_warnings) {
+          return true;
+        }
+      }
+    }
+    const bNodeTree *btree_original = (const bNodeTree *)DEG_get_original_id(
+        &node.node_ref().tree().btree()->id);
+    const NodeTreeEvaluationContext context(*self_object_, *modifier_);
+    return BKE_nodetree_ui_storage_node_has_warnings(*btree_original, context, *node.bnode());
   }
 
-  void compute_output_and_forward(const DOutputSocket &socket_to_compute)
+  static void execute_node_task(TaskPool *__restrict pool, void *taskdata)
   {
-    const DNode &node = socket_to_compute.node();
+    GeometryNodesEvaluator &evaluator = *static_cast<GeometryNodesEvaluator *>(
+        BLI_task_pool_user_data(pool));
+    NodeTask &task = *static_cast<NodeTask *>(taskdata);
 
-    if (!socket_to_compute.is_available()) {
-      /* If the output is not available, use a default value. */
-      const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket_to_compute.typeinfo());
-      void *buffer = allocator_.allocate(type.size(), type.alignment());
-      type.copy_to_uninitialized(type.default_value(), buffer);
-      this->forward_to_inputs(socket_to_compute, {type, buffer});
-      return;
+    evaluator.compute_node_and_forward(*task.node, task.allocator);
+
+    /* Schedule the nodes which were only waiting for this one. */
+    for (NodeTask *user : task.users) {
+      if (user->dependencies_left.fetch_sub(1) == 1) {
+        BLI_task_pool_push(pool, execute_node_task, user, false, nullptr);
+      }
+    }
+  }
+
+  Vector<GMutablePointer> get_input_values(const DInputSocket &socket_to_compute,
+                                           blender::LinearAllocator<> &allocator)
+  {
+    Span<const DOutputSocket *> from_sockets = socket_to_compute.linked_sockets();
+    Span<const DGroupInput *> from_group_inputs = socket_to_compute.linked_group_inputs();
+    const int total_inputs = from_sockets.size() + from_group_inputs.size();
+
+    if (total_inputs == 0) {
+      /* The input is not connected, use the value from the socket itself. */
+      return {get_unlinked_input_value(socket_to_compute, allocator)};
+    }
+
+    if (from_group_inputs.size() == 1) {
+      return {get_unlinked_input_value(socket_to_compute, allocator)};
     }
 
+    /* All linked values have been computed before, take them out of their slots. Multi-input
+     * sockets contain a vector of inputs. */
+    Vector<GMutablePointer> values;
+    for (const DOutputSocket *from_socket : from_sockets) {
+      GMutablePointer &slot = value_by_input_.lookup(std::make_pair(&socket_to_compute,
+                                                                    from_socket));
+      BLI_assert(slot.get() != nullptr);
+      values.append(slot);
+      slot = GMutablePointer();
+      if (!socket_to_compute.is_multi_input_socket()) {
+        break;
+      }
+    }
+    return values;
+  }
+
+  void compute_node_and_forward(const DNode &node, blender::LinearAllocator<> &allocator)
+  {
     /* Prepare inputs required to execute the node. */
-    GValueMap<StringRef> node_inputs_map{allocator_};
+    GValueMap<StringRef> node_inputs_map{allocator};
     for (const DInputSocket *input_socket : node.inputs()) {
       if (input_socket->is_available()) {
-        Vector<GMutablePointer> values = this->get_input_values(*input_socket);
+        Vector<GMutablePointer> values = this->get_input_values(*input_socket, allocator);
         for (int i = 0; i < values.size(); ++i) {
           /* Values from Multi Input Sockets are stored in input map with the format
            * <identifier>[<index>]. */
-          blender::StringRefNull key = allocator_.copy_string(
+          blender::StringRefNull key = allocator.copy_string(
               input_socket->identifier() + (i > 0 ? ("[" + std::to_string(i)) + "]" : ""));
           node_inputs_map.add_new_direct(key, std::move(values[i]));
         }
@@ -361,21 +875,44 @@ class GeometryNodesEvaluator {
     }
 
     /* Execute the node. */
-    GValueMap<StringRef> node_outputs_map{allocator_};
+    GValueMap<StringRef> node_outputs_map{allocator};
     GeoNodeExecParams params{
         node, node_inputs_map, node_outputs_map, handle_map_, self_object_, modifier_, depsgraph_};
-    this->execute_node(node, params);
+    this->execute_node(node, params, allocator);
+
+    std::unique_ptr<NodeOutputCacheEntry> cache_entry;
+    if (cache_ != nullptr && node_keys_.lookup_default(&node, 0) != 0) {
+      NodeTask &task = *task_by_node_.lookup(&node);
+      task.has_warnings = this->node_has_warnings(node);
+      if (!task.has_warnings && nodes_to_cache_.contains(&node)) {
+        cache_entry = std::make_unique<NodeOutputCacheEntry>();
+        cache_entry->values.resize(node.outputs().size());
+      }
+    }
 
     /* Forward computed outputs to linked input sockets. */
     for (const DOutputSocket *output_socket : node.outputs()) {
       if (output_socket->is_available()) {
         GMutablePointer value = node_outputs_map.extract(output_socket->identifier());
-        this->forward_to_inputs(*output_socket, value);
+        if (cache_entry) {
+          const CPPType &type = *value.type();
+          void *buffer = MEM_mallocN_aligned(type.size(), type.alignment(), __func__);
+          type.copy_to_uninitialized(value.get(), buffer);
+          cache_entry->values[output_socket->index()] = {type, buffer};
+        }
+        this->forward_to_inputs(*output_socket, value, allocator);
       }
     }
+
+    if (cache_entry) {
+      std::lock_guard lock{cache_->cache_mutex};
+      cache_->cache.add(nodes_to_cache_.lookup(&node), std::move(cache_entry));
+    }
   }
 
-  void execute_node(const DNode &node, GeoNodeExecParams params)
+  void execute_node(const DNode &node,
+                    GeoNodeExecParams params,
+                    blender::LinearAllocator<> &allocator)
   {
     const bNode &bnode = params.node();
 
@@ -388,7 +925,7 @@ class GeometryNodesEvaluator {
     /* Use the multi-function implementation if it exists. */
     const MultiFunction *multi_function = mf_by_node_.lookup_default(&node, nullptr);
     if (multi_function != nullptr) {
-      this->execute_multi_function_node(node, params, *multi_function);
+      this->execute_multi_function_node(node, params, *multi_function, allocator);
       return;
     }
 
@@ -398,7 +935,8 @@ class GeometryNodesEvaluator {
 
   void execute_multi_function_node(const DNode &node,
                                    GeoNodeExecParams params,
-                                   const MultiFunction &fn)
+                                   const MultiFunction &fn,
+                                   blender::LinearAllocator<> &allocator)
   {
     MFContextBuilder fn_context;
     MFParamsBuilder fn_params{fn, 1};
@@ -414,7 +952,7 @@ class GeometryNodesEvaluator {
     for (const DOutputSocket *dsocket : node.outputs()) {
       if (dsocket->is_available()) {
         const CPPType &type = *blender::nodes::socket_cpp_type_get(*dsocket->typeinfo());
-        void *buffer = allocator_.allocate(type.size(), type.alignment());
+        void *buffer = allocator.allocate(type.size(), type.alignment());
         fn_params.add_uninitialized_single_output(GMutableSpan(type, buffer, 1));
         output_data.append(GMutablePointer(type, buffer));
       }
@@ -444,22 +982,29 @@ class GeometryNodesEvaluator {
     }
   }
 
-  void forward_to_inputs(const DOutputSocket &from_socket, GMutablePointer value_to_forward)
+  void forward_to_inputs(const DOutputSocket &from_socket,
+                         GMutablePointer value_to_forward,
+                         blender::LinearAllocator<> &allocator)
   {
-    /* For all sockets that are linked with the from_socket push the value to their node. */
+    /* For all required sockets that are linked with the from_socket push the value to their
+     * node. */
     Span<const DInputSocket *> to_sockets_all = from_socket.linked_sockets();
 
     const CPPType &from_type = *value_to_forward.type();
     Vector<const DInputSocket *> to_sockets_same_type;
     for (const DInputSocket *to_socket : to_sockets_all) {
-      const CPPType &to_type = *blender::nodes::socket_cpp_type_get(*to_socket->typeinfo());
       const std::pair<const DInputSocket *, const DOutputSocket *> key = std::make_pair(
           to_socket, &from_socket);
+      if (!value_by_input_.contains(key)) {
+        /* The value is not used by any node that has to be executed. */
+        continue;
+      }
+      const CPPType &to_type = *blender::nodes::socket_cpp_type_get(*to_socket->typeinfo());
       if (from_type == to_type) {
         to_sockets_same_type.append(to_socket);
       }
       else {
-        void *buffer = allocator_.allocate(to_type.size(), to_type.alignment());
+        void *buffer = allocator.allocate(to_type.size(), to_type.alignment());
         if (conversions_.is_convertible(from_type, to_type)) {
           conversions_.convert(from_type, to_type, value_to_forward.get(), buffer);
         }
@@ -493,7 +1038,7 @@ class GeometryNodesEvaluator {
       for (const DInputSocket *to_socket : other_to_sockets) {
         const std::pair<const DInputSocket *, const DOutputSocket *> key = std::make_pair(
             to_socket, &from_socket);
-        void *buffer = allocator_.allocate(type.size(), type.alignment());
+        void *buffer = allocator.allocate(type.size(), type.alignment());
         type.copy_to_uninitialized(value_to_forward.get(), buffer);
         add_value_to_input_socket(key, GMutablePointer{type, buffer});
       }
@@ -503,10 +1048,14 @@ class GeometryNodesEvaluator {
   void add_value_to_input_socket(const std::pair<const DInputSocket *, const DOutputSocket *> key,
                                  GMutablePointer value)
   {
-    value_by_input_.add_new(key, value);
+    /* Only the slot is changed, the map itself may be accessed from other threads. */
+    GMutablePointer &slot = value_by_input_.lookup(key);
+    BLI_assert(slot.get() == nullptr);
+    slot = value;
   }
 
-  GMutablePointer get_unlinked_input_value(const DInputSocket &socket)
+  GMutablePointer get_unlinked_input_value(const DInputSocket &socket,
+                                           blender::LinearAllocator<> &allocator)
   {
     bNodeSocket *bsocket;
     if (socket.linked_group_inputs().size() == 0) {
@@ -516,7 +1065,7 @@ class GeometryNodesEvaluator {
       bsocket = socket.linked_group_inputs()[0]->bsocket();
     }
     const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket.typeinfo());
-    void *buffer = allocator_.allocate(type.size(), type.alignment());
+    void *buffer = allocator.allocate(type.size(), type.alignment());
 
     if (bsocket->type == SOCK_OBJECT) {
       Object *object = ((bNodeSocketValueObject *)bsocket->default_value)->value;
@@ -965,8 +1514,6 @@ static void reset_tree_ui_storage(Span<const blender::nodes::NodeTreeRef *> tree
 
 /**
  * Evaluate a node group to compute the output geometry.
- * Currently, this uses a fairly basic and inefficient algorithm that might compute things more
- * often than necessary. It's going to be replaced soon.
  */
 static GeometrySet compute_geometry(const DerivedNodeTree &tree,
                                     Span<const DOutputSocket *> group_input_sockets,
@@ -982,7 +1529,13 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   PersistentDataHandleMap handle_map;
   fill_data_handle_map(nmd->settings, tree, handle_map);
 
+  NodesModifierRuntimeData *runtime_data = nodes_modifier_ensure_runtime(nmd);
+  if (node_trees_changed(tree)) {
+    runtime_data->cache.clear();
+  }
+
   Map<const DOutputSocket *, GMutablePointer> group_inputs;
+  Map<const DOutputSocket *, uint64_t> group_input_keys;
 
   if (group_input_sockets.size() > 0) {
     Span<const DOutputSocket *> remaining_input_sockets = group_input_sockets;
@@ -994,6 +1547,9 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
       GeometrySet *geometry_set_in = allocator.construct<GeometrySet>(
           std::move(input_geometry_set));
       group_inputs.add_new(first_input_socket, geometry_set_in);
+      group_input_keys.add_new(
+          first_input_socket,
+          input_geometry_cache_key(*ctx->object, nmd->modifier, *geometry_set_in));
       remaining_input_sockets = remaining_input_sockets.drop_front(1);
     }
 
@@ -1003,6 +1559,8 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
       void *value_in = allocator.allocate(cpp_type.size(), cpp_type.alignment());
       initialize_group_input(*nmd, handle_map, *socket->bsocket(), cpp_type, value_in);
       group_inputs.add_new(socket, {cpp_type, value_in});
+      group_input_keys.add_new(
+          socket, group_input_cache_key(*socket->bsocket(), handle_map, {cpp_type, value_in}));
     }
   }
 
@@ -1010,14 +1568,17 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   group_outputs.append(&socket_to_compute);
 
   GeometryNodesEvaluator evaluator{group_inputs,
+                                   group_input_keys,
                                    group_outputs,
                                    mf_by_node,
                                    handle_map,
                                    ctx->object,
                                    (ModifierData *)nmd,
-                                   ctx->depsgraph};
+                                   ctx->depsgraph,
+                                   runtime_data};
 
   Vector<GMutablePointer> results = evaluator.execute();
+  runtime_data->remove_unused_cache_entries();
   BLI_assert(results.size() == 1);
   GMutablePointer result = results[0];
 
@@ -1267,6 +1828,8 @@ static void freeData(ModifierData *md)
     IDP_FreeProperty_ex(nmd->settings.properties, false);
     nmd->settings.properties = nullptr;
   }
+  freeRuntimeData(md->runtime);
+  md->runtime = nullptr;
 }
 
 static void requiredDataMask(Object *UNUSED(ob),
@@ -1310,7 +1873,7 @@ ModifierTypeInfo modifierType_Nodes = {
     /* dependsOnNormals */ nullptr,
     /* foreachIDLink */ foreachIDLink,
     /* foreachTexLink */ nullptr,
-    /* freeRuntimeData */ nullptr,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ blendWrite,
     /* blendRead */ blendRead,
@@ -550,23 +550,14 @@ static Mesh *normalEditModifier_do(NormalEditModifierData *enmd,
   CustomData *ldata = &result->ldata;
 
   /* Compute poly (always needed) and vert normals. */
+  BKE_mesh_ensure_normals(result);
   CustomData *pdata = &result->pdata;
   polynors = CustomData_get_layer(pdata, CD_NORMAL);
   if (!polynors) {
     polynors = CustomData_add_layer(pdata, CD_NORMAL, CD_CALLOC, NULL, num_polys);
     CustomData_set_layer_flag(pdata, CD_NORMAL, CD_FLAG_TEMPORARY);
   }
-  BKE_mesh_calc_normals_poly(mvert,
-                             NULL,
-                             num_verts,
-                             mloop,
-                             mpoly,
-                             num_loops,
-                             num_polys,
-                             polynors,
-                             (result->runtime.cd_dirty_vert & CD_MASK_NORMAL) ? false : true);
-
-  result->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
+  memcpy(polynors, BKE_mesh_poly_normals_ensure(result), sizeof(*polynors) * (size_t)num_polys);
 
   clnors = CustomData_get_layer(ldata, CD_CUSTOMLOOPNORMAL);
   if (use_current_clnors) {
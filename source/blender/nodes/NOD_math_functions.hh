@@ -21,6 +21,7 @@
 #include "BLI_float3.hh"
 #include "BLI_math_base_safe.h"
 #include "BLI_math_rotation.h"
+#include "BLI_span.hh"
 #include "BLI_string_ref.hh"
 
 namespace blender::nodes {
@@ -40,6 +41,27 @@ const FloatMathOperationInfo *get_float_math_operation_info(const int operation)
 const FloatMathOperationInfo *get_float3_math_operation_info(const int operation);
 const FloatMathOperationInfo *get_float_compare_operation_info(const int operation);
 
+/**
+ * Compute the result of an operation for contiguous arrays with explicitly vectorized kernels,
+ * which is much faster than calling the functions passed to the callbacks below for every
+ * element. The result is exactly the same.
+ * Returns false when there is no vectorized kernel for the operation (or when SIMD instructions
+ * are not available), then the caller has to fall back to the element-wise functions.
+ */
+bool try_execute_float_math_fl_fl_to_fl_vectorized(const int operation,
+                                                   const Span<float> a,
+                                                   const Span<float> b,
+                                                   MutableSpan<float> r);
+bool try_execute_float_math_fl_fl_fl_to_fl_vectorized(const int operation,
+                                                      const Span<float> a,
+                                                      const Span<float> b,
+                                                      const Span<float> c,
+                                                      MutableSpan<float> r);
+bool try_execute_float_math_fl3_fl3_to_fl3_vectorized(const NodeVectorMathOperation operation,
+                                                      const Span<float3> a,
+                                                      const Span<float3> b,
+                                                      MutableSpan<float3> r);
+
 /**
  * This calls the `callback` with two arguments:
  *  1. The math function that takes a float as input and outputs a new float.
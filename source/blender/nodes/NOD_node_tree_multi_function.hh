@@ -422,6 +422,10 @@ class DataTypeConversions {
                const CPPType &to_type,
                const void *from_value,
                void *to_value) const;
+
+  /* Convert all values of a span at once, which is much faster than converting them one by one.
+   * The destination span is expected to be uninitialized. */
+  void convert(fn::GSpan from_span, fn::GMutableSpan to_span) const;
 };
 
 const DataTypeConversions &get_implicit_type_conversions();
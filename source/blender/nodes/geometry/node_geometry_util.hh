@@ -47,4 +47,7 @@ void update_attribute_input_socket_availabilities(bNode &node,
 Array<uint32_t> get_geometry_element_ids_as_uints(const GeometryComponent &component,
                                                   const AttributeDomain domain);
 
+/* Join the components of the same type, used by the Join Geometry node. */
+GeometrySet join_geometry_sets(Span<GeometrySet> geometry_sets);
+
 }  // namespace blender::nodes
@@ -163,6 +163,11 @@ static void do_math_operation(Span<float> span_a,
                               MutableSpan<float> span_result,
                               const NodeMathOperation operation)
 {
+  if (try_execute_float_math_fl_fl_fl_to_fl_vectorized(
+          operation, span_a, span_b, span_c, span_result)) {
+    return;
+  }
+
   bool success = try_dispatch_float_math_fl_fl_fl_to_fl(
       operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
         for (const int i : IndexRange(span_result.size())) {
@@ -178,6 +183,10 @@ static void do_math_operation(Span<float> span_a,
                               MutableSpan<float> span_result,
                               const NodeMathOperation operation)
 {
+  if (try_execute_float_math_fl_fl_to_fl_vectorized(operation, span_a, span_b, span_result)) {
+    return;
+  }
+
   bool success = try_dispatch_float_math_fl_fl_to_fl(
       operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
         for (const int i : IndexRange(span_result.size())) {
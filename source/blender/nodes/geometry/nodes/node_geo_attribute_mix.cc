@@ -56,51 +56,47 @@ static void geo_node_attribute_mix_layout(uiLayout *layout, bContext *UNUSED(C),
 namespace blender::nodes {
 
 static void do_mix_operation_float(const int blend_mode,
-                                   const FloatReadAttribute &factors,
-                                   const FloatReadAttribute &inputs_a,
-                                   const FloatReadAttribute &inputs_b,
-                                   FloatWriteAttribute results)
+                                   const Span<float> factors,
+                                   const Span<float> inputs_a,
+                                   const Span<float> inputs_b,
+                                   MutableSpan<float> results)
 {
-  const int size = results.size();
-  for (const int i : IndexRange(size)) {
+  for (const int i : results.index_range()) {
     const float factor = factors[i];
     float3 a{inputs_a[i]};
     const float3 b{inputs_b[i]};
     ramp_blend(blend_mode, a, factor, b);
-    const float result = a.x;
-    results.set(i, result);
+    results[i] = a.x;
   }
 }
 
 static void do_mix_operation_float3(const int blend_mode,
-                                    const FloatReadAttribute &factors,
-                                    const Float3ReadAttribute &inputs_a,
-                                    const Float3ReadAttribute &inputs_b,
-                                    Float3WriteAttribute results)
+                                    const Span<float> factors,
+                                    const Span<float3> inputs_a,
+                                    const Span<float3> inputs_b,
+                                    MutableSpan<float3> results)
 {
-  const int size = results.size();
-  for (const int i : IndexRange(size)) {
+  for (const int i : results.index_range()) {
     const float factor = factors[i];
     float3 a = inputs_a[i];
     const float3 b = inputs_b[i];
     ramp_blend(blend_mode, a, factor, b);
-    results.set(i, a);
+    results[i] = a;
   }
 }
 
 static void do_mix_operation_color4f(const int blend_mode,
-                                     const FloatReadAttribute &factors,
-                                     const Color4fReadAttribute &inputs_a,
-                                     const Color4fReadAttribute &inputs_b,
-                                     Color4fWriteAttribute results)
+                                     const Span<float> factors,
+                                     const Span<Color4f> inputs_a,
+                                     const Span<Color4f> inputs_b,
+                                     MutableSpan<Color4f> results)
 {
-  const int size = results.size();
-  for (const int i : IndexRange(size)) {
+  for (const int i : results.index_range()) {
     const float factor = factors[i];
     Color4f a = inputs_a[i];
     const Color4f b = inputs_b[i];
     ramp_blend(blend_mode, a, factor, b);
-    results.set(i, a);
+    results[i] = a;
   }
 }
 
@@ -111,17 +107,29 @@ static void do_mix_operation(const CustomDataType result_type,
                              const ReadAttribute &attribute_b,
                              WriteAttribute &attribute_result)
 {
+  /* Work on spans, which are the attribute arrays themselves in most cases, instead of accessing
+   * the attributes with a virtual call per element. */
+  const Span<float> factors = attribute_factor.get_span();
   if (result_type == CD_PROP_FLOAT) {
-    do_mix_operation_float(
-        blend_mode, attribute_factor, attribute_a, attribute_b, attribute_result);
+    do_mix_operation_float(blend_mode,
+                           factors,
+                           attribute_a.get_span<float>(),
+                           attribute_b.get_span<float>(),
+                           attribute_result.get_span_for_write_only<float>());
   }
   else if (result_type == CD_PROP_FLOAT3) {
-    do_mix_operation_float3(
-        blend_mode, attribute_factor, attribute_a, attribute_b, attribute_result);
+    do_mix_operation_float3(blend_mode,
+                            factors,
+                            attribute_a.get_span<float3>(),
+                            attribute_b.get_span<float3>(),
+                            attribute_result.get_span_for_write_only<float3>());
   }
   else if (result_type == CD_PROP_COLOR) {
-    do_mix_operation_color4f(
-        blend_mode, attribute_factor, attribute_a, attribute_b, attribute_result);
+    do_mix_operation_color4f(blend_mode,
+                             factors,
+                             attribute_a.get_span<Color4f>(),
+                             attribute_b.get_span<Color4f>(),
+                             attribute_result.get_span_for_write_only<Color4f>());
   }
 }
 
@@ -175,7 +183,7 @@ static void attribute_mix_calc(GeometryComponent &component, const GeoNodeExecPa
                    *attribute_a,
                    *attribute_b,
                    *attribute_result);
-  attribute_result.save();
+  attribute_result.apply_span_and_save();
 }
 
 static void geo_node_attribute_mix_exec(GeoNodeExecParams params)
@@ -94,10 +94,11 @@ static void execute_on_component(GeometryComponent &component, const GeoNodeExec
   Float3ReadAttribute mapping_attribute = component.attribute_get_for_read<float3>(
       mapping_name, result_domain, {0, 0, 0});
 
+  Span<float3> mapping_span = mapping_attribute.get_span();
   MutableSpan<Color4f> colors = attribute_out->get_span<Color4f>();
-  for (const int i : IndexRange(mapping_attribute.size())) {
+  for (const int i : mapping_span.index_range()) {
     TexResult texture_result = {0};
-    const float3 position = mapping_attribute[i];
+    const float3 position = mapping_span[i];
     /* For legacy reasons we have to map [0, 1] to [-1, 1] to support uv mappings. */
     const float3 remapped_position = position * 2.0f - float3(1.0f);
     BKE_texture_get_value(nullptr, texture, remapped_position, &texture_result, false);
@@ -173,6 +173,11 @@ static void do_math_operation_fl3_fl3_to_fl3(const Float3ReadAttribute &input_a,
   Span<float3> span_b = input_b.get_span();
   MutableSpan<float3> span_result = result.get_span_for_write_only();
 
+  if (try_execute_float_math_fl3_fl3_to_fl3_vectorized(operation, span_a, span_b, span_result)) {
+    result.apply_span();
+    return;
+  }
+
   bool success = try_dispatch_float_math_fl3_fl3_to_fl3(
       operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
         for (const int i : IndexRange(size)) {
@@ -14,6 +14,8 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include "BLI_task.hh"
+
 #include "BKE_mesh.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_pointcloud.h"
@@ -44,32 +46,58 @@ static bNodeSocketTemplate geo_node_join_geometry_out[] = {
 
 namespace blender::nodes {
 
-static Mesh *join_mesh_topology_and_builtin_attributes(Span<const MeshComponent *> src_components)
+/* Components are copied in parallel, most of them are usually small. */
+static constexpr int64_t join_component_grain_size = 32;
+
+/**
+ * Compute where the elements of every component start in the joined geometry, the last element
+ * is the total size.
+ */
+template<typename GetSizeFn>
+static Array<int> compute_component_offsets(const int components_num, const GetSizeFn &get_size)
 {
-  int totverts = 0;
-  int totloops = 0;
-  int totedges = 0;
-  int totpolys = 0;
+  Array<int> offsets(components_num + 1);
+  int offset = 0;
+  for (const int i : IndexRange(components_num)) {
+    offsets[i] = offset;
+    offset += get_size(i);
+  }
+  offsets[components_num] = offset;
+  return offsets;
+}
 
+static Mesh *join_mesh_topology_and_builtin_attributes(Span<const MeshComponent *> src_components)
+{
+  Array<const Mesh *> meshes(src_components.size());
   int64_t cd_dirty_vert = 0;
   int64_t cd_dirty_poly = 0;
   int64_t cd_dirty_edge = 0;
   int64_t cd_dirty_loop = 0;
-
-  for (const MeshComponent *mesh_component : src_components) {
-    const Mesh *mesh = mesh_component->get_for_read();
-    totverts += mesh->totvert;
-    totloops += mesh->totloop;
-    totedges += mesh->totedge;
-    totpolys += mesh->totpoly;
+  for (const int i : src_components.index_range()) {
+    const Mesh *mesh = src_components[i]->get_for_read();
+    meshes[i] = mesh;
     cd_dirty_vert |= mesh->runtime.cd_dirty_vert;
     cd_dirty_poly |= mesh->runtime.cd_dirty_poly;
     cd_dirty_edge |= mesh->runtime.cd_dirty_edge;
     cd_dirty_loop |= mesh->runtime.cd_dirty_loop;
   }
 
-  const Mesh *first_input_mesh = src_components[0]->get_for_read();
-  Mesh *new_mesh = BKE_mesh_new_nomain(totverts, totedges, 0, totloops, totpolys);
+  const int meshes_num = meshes.size();
+  const Array<int> vert_offsets = compute_component_offsets(
+      meshes_num, [&](const int i) { return meshes[i]->totvert; });
+  const Array<int> edge_offsets = compute_component_offsets(
+      meshes_num, [&](const int i) { return meshes[i]->totedge; });
+  const Array<int> loop_offsets = compute_component_offsets(
+      meshes_num, [&](const int i) { return meshes[i]->totloop; });
+  const Array<int> poly_offsets = compute_component_offsets(
+      meshes_num, [&](const int i) { return meshes[i]->totpoly; });
+
+  const Mesh *first_input_mesh = meshes[0];
+  Mesh *new_mesh = BKE_mesh_new_nomain(vert_offsets.last(),
+                                       edge_offsets.last(),
+                                       0,
+                                       loop_offsets.last(),
+                                       poly_offsets.last());
   BKE_mesh_copy_settings(new_mesh, first_input_mesh);
 
   new_mesh->runtime.cd_dirty_vert = cd_dirty_vert;
@@ -77,48 +105,42 @@ static Mesh *join_mesh_topology_and_builtin_attributes(Span<const MeshComponent
   new_mesh->runtime.cd_dirty_edge = cd_dirty_edge;
   new_mesh->runtime.cd_dirty_loop = cd_dirty_loop;
 
-  int vert_offset = 0;
-  int loop_offset = 0;
-  int edge_offset = 0;
-  int poly_offset = 0;
-  for (const MeshComponent *mesh_component : src_components) {
-    const Mesh *mesh = mesh_component->get_for_read();
-    if (mesh == nullptr) {
-      continue;
+  parallel_for(meshes.index_range(), join_component_grain_size, [&](IndexRange range) {
+    for (const int mesh_index : range) {
+      const Mesh *mesh = meshes[mesh_index];
+      const int vert_offset = vert_offsets[mesh_index];
+      const int edge_offset = edge_offsets[mesh_index];
+      const int loop_offset = loop_offsets[mesh_index];
+      const int poly_offset = poly_offsets[mesh_index];
+
+      for (const int i : IndexRange(mesh->totvert)) {
+        const MVert &old_vert = mesh->mvert[i];
+        MVert &new_vert = new_mesh->mvert[vert_offset + i];
+        new_vert = old_vert;
+      }
+
+      for (const int i : IndexRange(mesh->totedge)) {
+        const MEdge &old_edge = mesh->medge[i];
+        MEdge &new_edge = new_mesh->medge[edge_offset + i];
+        new_edge = old_edge;
+        new_edge.v1 += vert_offset;
+        new_edge.v2 += vert_offset;
+      }
+      for (const int i : IndexRange(mesh->totloop)) {
+        const MLoop &old_loop = mesh->mloop[i];
+        MLoop &new_loop = new_mesh->mloop[loop_offset + i];
+        new_loop = old_loop;
+        new_loop.v += vert_offset;
+        new_loop.e += edge_offset;
+      }
+      for (const int i : IndexRange(mesh->totpoly)) {
+        const MPoly &old_poly = mesh->mpoly[i];
+        MPoly &new_poly = new_mesh->mpoly[poly_offset + i];
+        new_poly = old_poly;
+        new_poly.loopstart += loop_offset;
+      }
     }
-
-    for (const int i : IndexRange(mesh->totvert)) {
-      const MVert &old_vert = mesh->mvert[i];
-      MVert &new_vert = new_mesh->mvert[vert_offset + i];
-      new_vert = old_vert;
-    }
-
-    for (const int i : IndexRange(mesh->totedge)) {
-      const MEdge &old_edge = mesh->medge[i];
-      MEdge &new_edge = new_mesh->medge[edge_offset + i];
-      new_edge = old_edge;
-      new_edge.v1 += vert_offset;
-      new_edge.v2 += vert_offset;
-    }
-    for (const int i : IndexRange(mesh->totloop)) {
-      const MLoop &old_loop = mesh->mloop[i];
-      MLoop &new_loop = new_mesh->mloop[loop_offset + i];
-      new_loop = old_loop;
-      new_loop.v += vert_offset;
-      new_loop.e += edge_offset;
-    }
-    for (const int i : IndexRange(mesh->totpoly)) {
-      const MPoly &old_poly = mesh->mpoly[i];
-      MPoly &new_poly = new_mesh->mpoly[poly_offset + i];
-      new_poly = old_poly;
-      new_poly.loopstart += loop_offset;
-    }
-
-    vert_offset += mesh->totvert;
-    loop_offset += mesh->totloop;
-    edge_offset += mesh->totedge;
-    poly_offset += mesh->totpoly;
-  }
+  });
 
   return new_mesh;
 }
@@ -129,88 +151,99 @@ static Array<const GeometryComponent *> to_base_components(Span<const Component
   return components;
 }
 
-static Set<std::string> find_all_attribute_names(Span<const GeometryComponent *> components)
-{
-  Set<std::string> attribute_names;
-  for (const GeometryComponent *component : components) {
-    Set<std::string> names = component->attribute_names();
-    for (const std::string &name : names) {
-      attribute_names.add(name);
-    }
-  }
-  return attribute_names;
-}
+struct JoinedAttribute {
+  std::string name;
+  CustomDataType data_type;
+  AttributeDomain domain;
+  OutputAttributePtr attribute;
+  fn::GMutableSpan dst_span;
+};
 
-static void determine_final_data_type_and_domain(Span<const GeometryComponent *> components,
-                                                 StringRef attribute_name,
-                                                 CustomDataType *r_type,
-                                                 AttributeDomain *r_domain)
+/**
+ * Find the names of all attributes and the data type and domain they get in the result, with a
+ * single pass over the components.
+ */
+static Map<std::string, std::pair<CustomDataType, AttributeDomain>> find_attributes_to_join(
+    Span<const GeometryComponent *> components, Span<StringRef> ignored_attributes)
 {
-  Vector<CustomDataType> data_types;
-  Vector<AttributeDomain> domains;
+  Map<std::string, std::pair<CustomDataType, AttributeDomain>> attributes;
   for (const GeometryComponent *component : components) {
-    ReadAttributePtr attribute = component->attribute_try_get_for_read(attribute_name);
-    if (attribute) {
-      data_types.append(attribute->custom_data_type());
-      domains.append(attribute->domain());
+    for (const std::string &name : component->attribute_names()) {
+      if (ignored_attributes.contains(name)) {
+        continue;
+      }
+      ReadAttributePtr attribute = component->attribute_try_get_for_read(name);
+      if (!attribute) {
+        continue;
+      }
+      const CustomDataType data_type = attribute->custom_data_type();
+      const AttributeDomain domain = attribute->domain();
+      attributes.add_or_modify(
+          name,
+          [&](std::pair<CustomDataType, AttributeDomain> *info) {
+            new (info) std::pair<CustomDataType, AttributeDomain>(data_type, domain);
+          },
+          [&](std::pair<CustomDataType, AttributeDomain> *info) {
+            info->first = bke::attribute_data_type_highest_complexity({info->first, data_type});
+            info->second = bke::attribute_domain_highest_priority({info->second, domain});
+          });
     }
   }
-
-  *r_type = bke::attribute_data_type_highest_complexity(data_types);
-  *r_domain = bke::attribute_domain_highest_priority(domains);
-}
-
-static void fill_new_attribute(Span<const GeometryComponent *> src_components,
-                               StringRef attribute_name,
-                               const CustomDataType data_type,
-                               const AttributeDomain domain,
-                               fn::GMutableSpan dst_span)
-{
-  const CPPType *cpp_type = bke::custom_data_type_to_cpp_type(data_type);
-  BLI_assert(cpp_type != nullptr);
-
-  int offset = 0;
-  for (const GeometryComponent *component : src_components) {
-    const int domain_size = component->attribute_domain_size(domain);
-    if (domain_size == 0) {
-      continue;
-    }
-    ReadAttributePtr read_attribute = component->attribute_get_for_read(
-        attribute_name, domain, data_type, nullptr);
-
-    fn::GSpan src_span = read_attribute->get_span();
-    const void *src_buffer = src_span.data();
-    void *dst_buffer = dst_span[offset];
-    cpp_type->copy_to_initialized_n(src_buffer, dst_buffer, domain_size);
-
-    offset += domain_size;
-  }
+  return attributes;
 }
 
 static void join_attributes(Span<const GeometryComponent *> src_components,
                             GeometryComponent &result,
                             Span<StringRef> ignored_attributes = {})
 {
-  Set<std::string> attribute_names = find_all_attribute_names(src_components);
-  for (StringRef name : ignored_attributes) {
-    attribute_names.remove(name);
-  }
-
-  for (const std::string &attribute_name : attribute_names) {
-    CustomDataType data_type;
-    AttributeDomain domain;
-    determine_final_data_type_and_domain(src_components, attribute_name, &data_type, &domain);
-
+  /* Create all attributes first, since adding attributes to the result is not thread-safe. */
+  Vector<JoinedAttribute> joined_attributes;
+  for (auto item : find_attributes_to_join(src_components, ignored_attributes).items()) {
+    const CustomDataType data_type = item.value.first;
+    const AttributeDomain domain = item.value.second;
     OutputAttributePtr write_attribute = result.attribute_try_get_for_output(
-        attribute_name, domain, data_type);
+        item.key, domain, data_type);
     if (!write_attribute ||
         &write_attribute->cpp_type() != bke::custom_data_type_to_cpp_type(data_type) ||
         write_attribute->domain() != domain) {
       continue;
     }
     fn::GMutableSpan dst_span = write_attribute->get_span_for_write_only();
-    fill_new_attribute(src_components, attribute_name, data_type, domain, dst_span);
-    write_attribute.apply_span_and_save();
+    joined_attributes.append({item.key, data_type, domain, std::move(write_attribute), dst_span});
+  }
+
+  Array<Array<int>> offsets_by_domain(ATTR_DOMAIN_NUM);
+  for (const JoinedAttribute &joined_attribute : joined_attributes) {
+    Array<int> &offsets = offsets_by_domain[joined_attribute.domain];
+    if (offsets.is_empty()) {
+      offsets = compute_component_offsets(src_components.size(), [&](const int i) {
+        return src_components[i]->attribute_domain_size(joined_attribute.domain);
+      });
+    }
+  }
+
+  parallel_for(src_components.index_range(), join_component_grain_size, [&](IndexRange range) {
+    for (const int component_index : range) {
+      const GeometryComponent &component = *src_components[component_index];
+      for (const JoinedAttribute &joined_attribute : joined_attributes) {
+        const Span<int> offsets = offsets_by_domain[joined_attribute.domain];
+        const int domain_size = offsets[component_index + 1] - offsets[component_index];
+        if (domain_size == 0) {
+          continue;
+        }
+        ReadAttributePtr read_attribute = component.attribute_get_for_read(
+            joined_attribute.name, joined_attribute.domain, joined_attribute.data_type, nullptr);
+
+        fn::GSpan src_span = read_attribute->get_span();
+        const CPPType &cpp_type = src_span.type();
+        cpp_type.copy_to_initialized_n(
+            src_span.data(), joined_attribute.dst_span[offsets[component_index]], domain_size);
+      }
+    }
+  });
+
+  for (JoinedAttribute &joined_attribute : joined_attributes) {
+    joined_attribute.attribute.apply_span_and_save();
   }
 }
 
@@ -244,12 +277,7 @@ static void join_components(Span<const InstancesComponent *> src_components, Geo
 {
   InstancesComponent &dst_component = result.get_component_for_write<InstancesComponent>();
   for (const InstancesComponent *component : src_components) {
-    const int size = component->instances_amount();
-    Span<InstancedData> instanced_data = component->instanced_data();
-    Span<float4x4> transforms = component->transforms();
-    for (const int i : IndexRange(size)) {
-      dst_component.add_instance(instanced_data[i], transforms[i]);
-    }
+    dst_component.add_instances(*component);
   }
 }
 
@@ -282,15 +310,21 @@ static void join_component_type(Span<GeometrySet> src_geometry_sets, GeometrySet
   join_components(components, result);
 }
 
-static void geo_node_join_geometry_exec(GeoNodeExecParams params)
+GeometrySet join_geometry_sets(Span<GeometrySet> geometry_sets)
 {
-  Vector<GeometrySet> geometry_sets = params.extract_multi_input<GeometrySet>("Geometry");
-
   GeometrySet geometry_set_result;
   join_component_type<MeshComponent>(geometry_sets, geometry_set_result);
   join_component_type<PointCloudComponent>(geometry_sets, geometry_set_result);
   join_component_type<InstancesComponent>(geometry_sets, geometry_set_result);
   join_component_type<VolumeComponent>(geometry_sets, geometry_set_result);
+  return geometry_set_result;
+}
+
+static void geo_node_join_geometry_exec(GeoNodeExecParams params)
+{
+  Vector<GeometrySet> geometry_sets = params.extract_multi_input<GeometrySet>("Geometry");
+
+  GeometrySet geometry_set_result = join_geometry_sets(geometry_sets);
 
   params.set_output("Geometry", std::move(geometry_set_result));
 }
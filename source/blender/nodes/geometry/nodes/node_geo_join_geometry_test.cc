@@ -0,0 +1,127 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_timeit.hh"
+
+#include "BKE_idtype.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "node_geometry_util.hh"
+
+namespace blender::nodes::tests {
+
+class join_geometry : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    testing::Test::SetUpTestCase();
+    BKE_idtype_init();
+  }
+};
+
+/**
+ * A single quad moved along the X axis by its index, with an integer attribute containing the
+ * index. Only every second mesh has a float attribute on the face corners.
+ */
+static GeometrySet create_quad_geometry(const int index)
+{
+  Mesh *mesh = BKE_mesh_new_nomain(4, 4, 0, 4, 1);
+  for (const int i : IndexRange(4)) {
+    mesh->mvert[i].co[0] = (float)(index + (i == 1 || i == 2));
+    mesh->mvert[i].co[1] = (float)(i >= 2);
+    mesh->medge[i].v1 = i;
+    mesh->medge[i].v2 = (i + 1) % 4;
+    mesh->mloop[i].v = i;
+    mesh->mloop[i].e = i;
+  }
+  mesh->mpoly[0].loopstart = 0;
+  mesh->mpoly[0].totloop = 4;
+
+  GeometrySet geometry_set = GeometrySet::create_with_mesh(mesh);
+  MeshComponent &component = geometry_set.get_component_for_write<MeshComponent>();
+
+  OutputAttributePtr index_attribute = component.attribute_try_get_for_output(
+      "index", ATTR_DOMAIN_POINT, CD_PROP_INT32);
+  index_attribute->get_span_for_write_only<int>().fill(index);
+  index_attribute.apply_span_and_save();
+
+  if (index % 2 == 0) {
+    OutputAttributePtr corner_attribute = component.attribute_try_get_for_output(
+        "corner", ATTR_DOMAIN_CORNER, CD_PROP_FLOAT);
+    corner_attribute->get_span_for_write_only<float>().fill(1.0f);
+    corner_attribute.apply_span_and_save();
+  }
+  return geometry_set;
+}
+
+static Vector<GeometrySet> create_quad_geometries(const int amount)
+{
+  Vector<GeometrySet> geometry_sets;
+  for (const int i : IndexRange(amount)) {
+    geometry_sets.append(create_quad_geometry(i));
+  }
+  return geometry_sets;
+}
+
+TEST_F(join_geometry, mesh_topology_and_attributes)
+{
+  const int amount = 1000;
+  const Vector<GeometrySet> geometry_sets = create_quad_geometries(amount);
+  const GeometrySet result = join_geometry_sets(geometry_sets);
+
+  const Mesh *mesh = result.get_mesh_for_read();
+  ASSERT_NE(mesh, nullptr);
+  ASSERT_EQ(mesh->totvert, amount * 4);
+  ASSERT_EQ(mesh->totedge, amount * 4);
+  ASSERT_EQ(mesh->totloop, amount * 4);
+  ASSERT_EQ(mesh->totpoly, amount);
+
+  const MeshComponent &component = *result.get_component_for_read<MeshComponent>();
+  bke::TypedReadAttribute<int> index_attribute = component.attribute_get_for_read<int>(
+      "index", ATTR_DOMAIN_POINT, -1);
+  bke::TypedReadAttribute<float> corner_attribute = component.attribute_get_for_read<float>(
+      "corner", ATTR_DOMAIN_CORNER, -1.0f);
+  const Span<int> indices = index_attribute.get_span();
+  const Span<float> corner_values = corner_attribute.get_span();
+
+  for (const int index : IndexRange(amount)) {
+    EXPECT_EQ(mesh->mpoly[index].loopstart, index * 4);
+    EXPECT_EQ(mesh->mpoly[index].totloop, 4);
+    for (const int i : IndexRange(4)) {
+      const int element = index * 4 + i;
+      EXPECT_EQ(mesh->mvert[element].co[0], (float)(index + (i == 1 || i == 2)));
+      EXPECT_EQ(mesh->medge[element].v1, element);
+      EXPECT_EQ(mesh->medge[element].v2, index * 4 + (i + 1) % 4);
+      EXPECT_EQ(mesh->mloop[element].v, element);
+      EXPECT_EQ(mesh->mloop[element].e, element);
+      EXPECT_EQ(indices[element], index);
+      /* Meshes without the attribute get the default value of the type. */
+      EXPECT_EQ(corner_values[element], (index % 2 == 0) ? 1.0f : 0.0f);
+    }
+  }
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it is slow.
+ */
+#if 0
+class join_geometry_performance : public join_geometry {
+};
+
+TEST_F(join_geometry_performance, join_10k_quads)
+{
+  const Vector<GeometrySet> geometry_sets = create_quad_geometries(10000);
+  GeometrySet result;
+  {
+    SCOPED_TIMER("join_10k_quads");
+    result = join_geometry_sets(geometry_sets);
+  }
+  EXPECT_EQ(result.get_mesh_for_read()->totpoly, 10000);
+}
+#endif /* Benchmark */
+
+}  // namespace blender::nodes::tests
@@ -16,10 +16,11 @@
 
 #include "BLI_float3.hh"
 #include "BLI_hash.h"
-#include "BLI_kdtree.h"
+#include "BLI_map.hh"
 #include "BLI_math_vector.h"
 #include "BLI_rand.hh"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
 #include "BLI_timeit.hh"
 
 #include "DNA_mesh_types.h"
@@ -88,6 +89,47 @@ static Span<MLoopTri> get_mesh_looptris(const Mesh &mesh)
   return {looptris, looptris_len};
 }
 
+/**
+ * Every triangle has its own random number generator, so that the points on a triangle don't
+ * depend on the other triangles, and triangles can be sampled in parallel.
+ * The first random number decides whether the fractional point is added.
+ */
+static RandomNumberGenerator looptri_rng_and_point_amount(const Mesh &mesh,
+                                                          const MLoopTri &looptri,
+                                                          const int looptri_index,
+                                                          const float base_density,
+                                                          const Span<float> density_factors,
+                                                          const int seed,
+                                                          int &r_point_amount)
+{
+  const float3 v0_pos = mesh.mvert[mesh.mloop[looptri.tri[0]].v].co;
+  const float3 v1_pos = mesh.mvert[mesh.mloop[looptri.tri[1]].v].co;
+  const float3 v2_pos = mesh.mvert[mesh.mloop[looptri.tri[2]].v].co;
+
+  float looptri_density_factor = 1.0f;
+  if (!density_factors.is_empty()) {
+    const float v0_density_factor = std::max(0.0f, density_factors[looptri.tri[0]]);
+    const float v1_density_factor = std::max(0.0f, density_factors[looptri.tri[1]]);
+    const float v2_density_factor = std::max(0.0f, density_factors[looptri.tri[2]]);
+    looptri_density_factor = (v0_density_factor + v1_density_factor + v2_density_factor) / 3.0f;
+  }
+  const float area = area_tri_v3(v0_pos, v1_pos, v2_pos);
+
+  const int looptri_seed = BLI_hash_int(looptri_index + seed);
+  RandomNumberGenerator looptri_rng(looptri_seed);
+
+  const float points_amount_fl = area * base_density * looptri_density_factor;
+  const float add_point_probability = fractf(points_amount_fl);
+  const bool add_point = add_point_probability > looptri_rng.get_float();
+  r_point_amount = (int)points_amount_fl + (int)add_point;
+  return looptri_rng;
+}
+
+/**
+ * Sampling happens in two parallel passes. The first counts the points on every triangle, the
+ * second generates them at their final position in the output arrays. Therefore the result does
+ * not depend on the number of threads.
+ */
 static void sample_mesh_surface(const Mesh &mesh,
                                 const float base_density,
                                 const FloatReadAttribute *density_factors,
@@ -97,57 +139,105 @@ static void sample_mesh_surface(const Mesh &mesh,
                                 Vector<int> &r_looptri_indices)
 {
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
+  const Span<float> density_factors_span = density_factors ? density_factors->get_span() :
+                                                             Span<float>();
+
+  Array<int> point_offsets(looptris.size() + 1);
+  parallel_for(looptris.index_range(), 1024, [&](IndexRange range) {
+    for (const int looptri_index : range) {
+      looptri_rng_and_point_amount(mesh,
+                                   looptris[looptri_index],
+                                   looptri_index,
+                                   base_density,
+                                   density_factors_span,
+                                   seed,
+                                   point_offsets[looptri_index]);
+    }
+  });
 
+  int offset = 0;
   for (const int looptri_index : looptris.index_range()) {
-    const MLoopTri &looptri = looptris[looptri_index];
-    const int v0_loop = looptri.tri[0];
-    const int v1_loop = looptri.tri[1];
-    const int v2_loop = looptri.tri[2];
-    const int v0_index = mesh.mloop[v0_loop].v;
-    const int v1_index = mesh.mloop[v1_loop].v;
-    const int v2_index = mesh.mloop[v2_loop].v;
-    const float3 v0_pos = mesh.mvert[v0_index].co;
-    const float3 v1_pos = mesh.mvert[v1_index].co;
-    const float3 v2_pos = mesh.mvert[v2_index].co;
-
-    float looptri_density_factor = 1.0f;
-    if (density_factors != nullptr) {
-      const float v0_density_factor = std::max(0.0f, (*density_factors)[v0_loop]);
-      const float v1_density_factor = std::max(0.0f, (*density_factors)[v1_loop]);
-      const float v2_density_factor = std::max(0.0f, (*density_factors)[v2_loop]);
-      looptri_density_factor = (v0_density_factor + v1_density_factor + v2_density_factor) / 3.0f;
-    }
-    const float area = area_tri_v3(v0_pos, v1_pos, v2_pos);
-
-    const int looptri_seed = BLI_hash_int(looptri_index + seed);
-    RandomNumberGenerator looptri_rng(looptri_seed);
-
-    const float points_amount_fl = area * base_density * looptri_density_factor;
-    const float add_point_probability = fractf(points_amount_fl);
-    const bool add_point = add_point_probability > looptri_rng.get_float();
-    const int point_amount = (int)points_amount_fl + (int)add_point;
-
-    for (int i = 0; i < point_amount; i++) {
-      const float3 bary_coord = looptri_rng.get_barycentric_coordinates();
-      float3 point_pos;
-      interp_v3_v3v3v3(point_pos, v0_pos, v1_pos, v2_pos, bary_coord);
-      r_positions.append(point_pos);
-      r_bary_coords.append(bary_coord);
-      r_looptri_indices.append(looptri_index);
-    }
+    const int point_amount = point_offsets[looptri_index];
+    point_offsets[looptri_index] = offset;
+    offset += point_amount;
   }
+  point_offsets.last() = offset;
+
+  r_positions.resize(offset);
+  r_bary_coords.resize(offset);
+  r_looptri_indices.resize(offset);
+
+  parallel_for(looptris.index_range(), 1024, [&](IndexRange range) {
+    for (const int looptri_index : range) {
+      const MLoopTri &looptri = looptris[looptri_index];
+      int point_amount;
+      RandomNumberGenerator looptri_rng = looptri_rng_and_point_amount(mesh,
+                                                                       looptri,
+                                                                       looptri_index,
+                                                                       base_density,
+                                                                       density_factors_span,
+                                                                       seed,
+                                                                       point_amount);
+      BLI_assert(point_amount == point_offsets[looptri_index + 1] - point_offsets[looptri_index]);
+
+      const float3 v0_pos = mesh.mvert[mesh.mloop[looptri.tri[0]].v].co;
+      const float3 v1_pos = mesh.mvert[mesh.mloop[looptri.tri[1]].v].co;
+      const float3 v2_pos = mesh.mvert[mesh.mloop[looptri.tri[2]].v].co;
+
+      for (const int i : IndexRange(point_offsets[looptri_index], point_amount)) {
+        const float3 bary_coord = looptri_rng.get_barycentric_coordinates();
+        interp_v3_v3v3v3(r_positions[i], v0_pos, v1_pos, v2_pos, bary_coord);
+        r_bary_coords[i] = bary_coord;
+        r_looptri_indices[i] = looptri_index;
+      }
+    }
+  });
 }
 
-BLI_NOINLINE static KDTree_3d *build_kdtree(Span<float3> positions)
-{
-  KDTree_3d *kdtree = BLI_kdtree_3d_new(positions.size());
-  for (const int i : positions.index_range()) {
-    BLI_kdtree_3d_insert(kdtree, i, positions[i]);
+/** Integer coordinates of a cell in the grid used for Poisson disk elimination. */
+struct PoissonGridCellKey {
+  int64_t x, y, z;
+
+  uint64_t hash() const
+  {
+    return (uint64_t)x * 73856093 ^ (uint64_t)y * 19349663 ^ (uint64_t)z * 83492791;
+  }
+
+  friend bool operator==(const PoissonGridCellKey &a, const PoissonGridCellKey &b)
+  {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
   }
-  BLI_kdtree_3d_balance(kdtree);
-  return kdtree;
+};
+
+struct PoissonGridCell {
+  PoissonGridCellKey key;
+  /* All points in the cell, in increasing order. */
+  Vector<int> points;
+  /* The points in the cell that have not been eliminated. */
+  Vector<int, 4> kept_points;
+};
+
+/**
+ * Maximum number of cells along each axis of the grid. When the minimum distance is tiny compared
+ * to the size of the geometry, the cells are made larger, so that their coordinates stay in a
+ * reasonable range.
+ */
+static const int64_t poisson_grid_max_resolution = 1 << 20;
+
+static int64_t poisson_grid_phase_coord(const int64_t coord)
+{
+  return ((coord % 3) + 3) % 3;
 }
 
+/**
+ * Eliminate points that are closer than the minimum distance to a point that is kept.
+ *
+ * The points are put in a grid with cells at least as large as the minimum distance, so that only
+ * the neighboring cells have to be searched. The cells are processed in 27 phases, based on their
+ * coordinates modulo 3: cells of the same phase are at least two cells apart, so they can never
+ * eliminate points of each other and are processed in parallel. Within a cell, the points are
+ * processed in order. This makes the result independent of the number of threads.
+ */
 BLI_NOINLINE static void update_elimination_mask_for_close_points(
     Span<float3> positions, const float minimum_distance, MutableSpan<bool> elimination_mask)
 {
@@ -155,32 +245,95 @@ BLI_NOINLINE static void update_elimination_mask_for_close_points(
     return;
   }
 
-  KDTree_3d *kdtree = build_kdtree(positions);
+  const float minimum_distance_sq = minimum_distance * minimum_distance;
 
+  /* Cell coordinates are relative to the bounds of the points, so that they are not negative. */
+  float3 bounds_min, bounds_max;
+  INIT_MINMAX(bounds_min, bounds_max);
+  for (const float3 &position : positions) {
+    minmax_v3v3_v3(bounds_min, bounds_max, position);
+  }
+  const float3 extent = bounds_max - bounds_min;
+  const float max_extent = std::max({extent.x, extent.y, extent.z, 0.0f});
+  const float cell_size = std::max(minimum_distance,
+                                   max_extent / (float)poisson_grid_max_resolution);
+  const float cell_size_inv = 1.0f / cell_size;
+  auto cell_coord = [&](const float offset) {
+    /* Also clamp non-finite values, and values out of range because of rounding. */
+    const float coord = offset * cell_size_inv;
+    return (coord >= 0.0f) ? (int64_t)std::min(coord, (float)poisson_grid_max_resolution) : 0;
+  };
+  auto cell_key = [&](const float3 &position) {
+    return PoissonGridCellKey{cell_coord(position.x - bounds_min.x),
+                              cell_coord(position.y - bounds_min.y),
+                              cell_coord(position.z - bounds_min.z)};
+  };
+
+  Vector<PoissonGridCell> cells;
+  Map<PoissonGridCellKey, int> cell_indices;
   for (const int i : positions.index_range()) {
-    if (elimination_mask[i]) {
-      continue;
-    }
+    const PoissonGridCellKey key = cell_key(positions[i]);
+    const int cell_index = cell_indices.lookup_or_add_cb(key, [&]() {
+      cells.append({key});
+      return (int)cells.size() - 1;
+    });
+    cells[cell_index].points.append(i);
+  }
 
-    struct CallbackData {
-      int index;
-      MutableSpan<bool> elimination_mask;
-    } callback_data = {i, elimination_mask};
-
-    BLI_kdtree_3d_range_search_cb(
-        kdtree,
-        positions[i],
-        minimum_distance,
-        [](void *user_data, int index, const float *UNUSED(co), float UNUSED(dist_sq)) {
-          CallbackData &callback_data = *static_cast<CallbackData *>(user_data);
-          if (index != callback_data.index) {
-            callback_data.elimination_mask[index] = true;
+  Array<Vector<int>> cells_by_phase(27);
+  for (const int cell_index : cells.index_range()) {
+    const PoissonGridCellKey &key = cells[cell_index].key;
+    const int64_t phase = poisson_grid_phase_coord(key.x) * 9 +
+                          poisson_grid_phase_coord(key.y) * 3 + poisson_grid_phase_coord(key.z);
+    cells_by_phase[phase].append(cell_index);
+  }
+
+  for (const Span<int> phase_cells : cells_by_phase) {
+    parallel_for(phase_cells.index_range(), 64, [&](IndexRange range) {
+      Vector<const PoissonGridCell *, 27> neighbors;
+      for (const int cell_index : phase_cells.slice(range)) {
+        PoissonGridCell &cell = cells[cell_index];
+
+        /* Only cells of previous phases and this cell itself can have kept points already. */
+        neighbors.clear();
+        for (const int64_t dx : {-1, 0, 1}) {
+          for (const int64_t dy : {-1, 0, 1}) {
+            for (const int64_t dz : {-1, 0, 1}) {
+              const PoissonGridCellKey key{cell.key.x + dx, cell.key.y + dy, cell.key.z + dz};
+              const int *neighbor_index = cell_indices.lookup_ptr(key);
+              if (neighbor_index != nullptr && *neighbor_index != cell_index) {
+                neighbors.append(&cells[*neighbor_index]);
+              }
+            }
+          }
+        }
+        neighbors.append(&cell);
+
+        for (const int point_index : cell.points) {
+          const float3 &position = positions[point_index];
+          bool is_too_close = false;
+          for (const PoissonGridCell *neighbor : neighbors) {
+            for (const int kept_index : neighbor->kept_points) {
+              if (float3::distance_squared(position, positions[kept_index]) <
+                  minimum_distance_sq) {
+                is_too_close = true;
+                break;
+              }
+            }
+            if (is_too_close) {
+              break;
+            }
+          }
+          if (is_too_close) {
+            elimination_mask[point_index] = true;
           }
-          return true;
-        },
-        &callback_data);
+          else {
+            cell.kept_points.append(point_index);
+          }
+        }
+      }
+    });
   }
-  BLI_kdtree_3d_free(kdtree);
 }
 
 BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
@@ -191,30 +344,34 @@ BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
     MutableSpan<bool> elimination_mask)
 {
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
-  for (const int i : bary_coords.index_range()) {
-    if (elimination_mask[i]) {
-      continue;
-    }
+  Span<float> density_factors_span = density_factors.get_span();
+  parallel_for(bary_coords.index_range(), 2048, [&](IndexRange range) {
+    for (const int i : range) {
+      if (elimination_mask[i]) {
+        continue;
+      }
 
-    const MLoopTri &looptri = looptris[looptri_indices[i]];
-    const float3 bary_coord = bary_coords[i];
+      const MLoopTri &looptri = looptris[looptri_indices[i]];
+      const float3 bary_coord = bary_coords[i];
 
-    const int v0_loop = looptri.tri[0];
-    const int v1_loop = looptri.tri[1];
-    const int v2_loop = looptri.tri[2];
+      const int v0_loop = looptri.tri[0];
+      const int v1_loop = looptri.tri[1];
+      const int v2_loop = looptri.tri[2];
 
-    const float v0_density_factor = std::max(0.0f, density_factors[v0_loop]);
-    const float v1_density_factor = std::max(0.0f, density_factors[v1_loop]);
-    const float v2_density_factor = std::max(0.0f, density_factors[v2_loop]);
+      const float v0_density_factor = std::max(0.0f, density_factors_span[v0_loop]);
+      const float v1_density_factor = std::max(0.0f, density_factors_span[v1_loop]);
+      const float v2_density_factor = std::max(0.0f, density_factors_span[v2_loop]);
 
-    const float probablity = v0_density_factor * bary_coord.x + v1_density_factor * bary_coord.y +
-                             v2_density_factor * bary_coord.z;
+      const float probablity = v0_density_factor * bary_coord.x +
+                               v1_density_factor * bary_coord.y +
+                               v2_density_factor * bary_coord.z;
 
-    const float hash = BLI_hash_int_01(bary_coord.hash());
-    if (hash > probablity) {
-      elimination_mask[i] = true;
+      const float hash = BLI_hash_int_01(bary_coord.hash());
+      if (hash > probablity) {
+        elimination_mask[i] = true;
+      }
     }
-  }
+  });
 }
 
 BLI_NOINLINE static void eliminate_points_based_on_mask(Span<bool> elimination_mask,
@@ -241,22 +398,24 @@ BLI_NOINLINE static void interpolate_attribute_point(const Mesh &mesh,
   BLI_assert(data_in.size() == mesh.totvert);
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
 
-  for (const int i : bary_coords.index_range()) {
-    const int looptri_index = looptri_indices[i];
-    const MLoopTri &looptri = looptris[looptri_index];
-    const float3 &bary_coord = bary_coords[i];
+  parallel_for(bary_coords.index_range(), 2048, [&](IndexRange range) {
+    for (const int i : range) {
+      const int looptri_index = looptri_indices[i];
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 &bary_coord = bary_coords[i];
 
-    const int v0_index = mesh.mloop[looptri.tri[0]].v;
-    const int v1_index = mesh.mloop[looptri.tri[1]].v;
-    const int v2_index = mesh.mloop[looptri.tri[2]].v;
+      const int v0_index = mesh.mloop[looptri.tri[0]].v;
+      const int v1_index = mesh.mloop[looptri.tri[1]].v;
+      const int v2_index = mesh.mloop[looptri.tri[2]].v;
 
-    const T &v0 = data_in[v0_index];
-    const T &v1 = data_in[v1_index];
-    const T &v2 = data_in[v2_index];
+      const T &v0 = data_in[v0_index];
+      const T &v1 = data_in[v1_index];
+      const T &v2 = data_in[v2_index];
 
-    const T interpolated_value = attribute_math::mix3(bary_coord, v0, v1, v2);
-    data_out[i] = interpolated_value;
-  }
+      const T interpolated_value = attribute_math::mix3(bary_coord, v0, v1, v2);
+      data_out[i] = interpolated_value;
+    }
+  });
 }
 
 template<typename T>
@@ -269,22 +428,24 @@ BLI_NOINLINE static void interpolate_attribute_corner(const Mesh &mesh,
   BLI_assert(data_in.size() == mesh.totloop);
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
 
-  for (const int i : bary_coords.index_range()) {
-    const int looptri_index = looptri_indices[i];
-    const MLoopTri &looptri = looptris[looptri_index];
-    const float3 &bary_coord = bary_coords[i];
+  parallel_for(bary_coords.index_range(), 2048, [&](IndexRange range) {
+    for (const int i : range) {
+      const int looptri_index = looptri_indices[i];
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 &bary_coord = bary_coords[i];
 
-    const int loop_index_0 = looptri.tri[0];
-    const int loop_index_1 = looptri.tri[1];
-    const int loop_index_2 = looptri.tri[2];
+      const int loop_index_0 = looptri.tri[0];
+      const int loop_index_1 = looptri.tri[1];
+      const int loop_index_2 = looptri.tri[2];
 
-    const T &v0 = data_in[loop_index_0];
-    const T &v1 = data_in[loop_index_1];
-    const T &v2 = data_in[loop_index_2];
+      const T &v0 = data_in[loop_index_0];
+      const T &v1 = data_in[loop_index_1];
+      const T &v2 = data_in[loop_index_2];
 
-    const T interpolated_value = attribute_math::mix3(bary_coord, v0, v1, v2);
-    data_out[i] = interpolated_value;
-  }
+      const T interpolated_value = attribute_math::mix3(bary_coord, v0, v1, v2);
+      data_out[i] = interpolated_value;
+    }
+  });
 }
 
 BLI_NOINLINE static void interpolate_attribute(const Mesh &mesh,
@@ -367,22 +528,24 @@ BLI_NOINLINE static void compute_special_attributes(const Mesh &mesh,
   MutableSpan<float3> rotations = rotation_attribute->get_span_for_write_only<float3>();
 
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
-  for (const int i : bary_coords.index_range()) {
-    const int looptri_index = looptri_indices[i];
-    const MLoopTri &looptri = looptris[looptri_index];
-    const float3 &bary_coord = bary_coords[i];
-
-    const int v0_index = mesh.mloop[looptri.tri[0]].v;
-    const int v1_index = mesh.mloop[looptri.tri[1]].v;
-    const int v2_index = mesh.mloop[looptri.tri[2]].v;
-    const float3 v0_pos = mesh.mvert[v0_index].co;
-    const float3 v1_pos = mesh.mvert[v1_index].co;
-    const float3 v2_pos = mesh.mvert[v2_index].co;
-
-    ids[i] = (int)(bary_coord.hash()) + looptri_index;
-    normal_tri_v3(normals[i], v0_pos, v1_pos, v2_pos);
-    rotations[i] = normal_to_euler_rotation(normals[i]);
-  }
+  parallel_for(bary_coords.index_range(), 2048, [&](IndexRange range) {
+    for (const int i : range) {
+      const int looptri_index = looptri_indices[i];
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 &bary_coord = bary_coords[i];
+
+      const int v0_index = mesh.mloop[looptri.tri[0]].v;
+      const int v1_index = mesh.mloop[looptri.tri[1]].v;
+      const int v2_index = mesh.mloop[looptri.tri[2]].v;
+      const float3 v0_pos = mesh.mvert[v0_index].co;
+      const float3 v1_pos = mesh.mvert[v1_index].co;
+      const float3 v2_pos = mesh.mvert[v2_index].co;
+
+      ids[i] = (int)(bary_coord.hash()) + looptri_index;
+      normal_tri_v3(normals[i], v0_pos, v1_pos, v2_pos);
+      rotations[i] = normal_to_euler_rotation(normals[i]);
+    }
+  });
 
   id_attribute.apply_span_and_save();
   normal_attribute.apply_span_and_save();
@@ -33,6 +33,7 @@ static bNodeSocketTemplate geo_node_point_instance_in[] = {
     {SOCK_GEOMETRY, N_("Geometry")},
     {SOCK_OBJECT, N_("Object")},
     {SOCK_COLLECTION, N_("Collection")},
+    {SOCK_GEOMETRY, N_("Instance Geometry")},
     {SOCK_INT, N_("Seed"), 0, 0, 0, 0, -10000, 10000},
     {-1, ""},
 };
@@ -56,7 +57,8 @@ static void geo_node_point_instance_update(bNodeTree *UNUSED(tree), bNode *node)
 {
   bNodeSocket *object_socket = (bNodeSocket *)BLI_findlink(&node->inputs, 1);
   bNodeSocket *collection_socket = object_socket->next;
-  bNodeSocket *seed_socket = collection_socket->next;
+  bNodeSocket *instance_geometry_socket = collection_socket->next;
+  bNodeSocket *seed_socket = instance_geometry_socket->next;
 
   NodeGeometryPointInstance *node_storage = (NodeGeometryPointInstance *)node->storage;
   GeometryNodePointInstanceType type = (GeometryNodePointInstanceType)node_storage->instance_type;
@@ -65,6 +67,8 @@ static void geo_node_point_instance_update(bNodeTree *UNUSED(tree), bNode *node)
 
   nodeSetSocketAvailability(object_socket, type == GEO_NODE_POINT_INSTANCE_TYPE_OBJECT);
   nodeSetSocketAvailability(collection_socket, type == GEO_NODE_POINT_INSTANCE_TYPE_COLLECTION);
+  nodeSetSocketAvailability(instance_geometry_socket,
+                            type == GEO_NODE_POINT_INSTANCE_TYPE_GEOMETRY);
   nodeSetSocketAvailability(
       seed_socket, type == GEO_NODE_POINT_INSTANCE_TYPE_COLLECTION && !use_whole_collection);
 }
@@ -86,6 +90,22 @@ static void get_instanced_data__object(const GeoNodeExecParams &params,
   }
 }
 
+static void get_instanced_data__geometry(
+    const GeoNodeExecParams &params,
+    InstancesComponent &instances,
+    MutableSpan<std::optional<InstancedData>> r_instances_data)
+{
+  GeometrySet instance_geometry_set = params.get_input<GeometrySet>("Instance Geometry");
+  if (instance_geometry_set.get_components_for_read().is_empty()) {
+    return;
+  }
+  /* The geometry is stored once and referenced by all instances. Nested instances stay
+   * instances as well, so they don't have to be realized either. */
+  const InstancedData instance = instances.add_instanced_geometry_set(
+      std::move(instance_geometry_set));
+  r_instances_data.fill(instance);
+}
+
 static void get_instanced_data__collection(
     const GeoNodeExecParams &params,
     const GeometryComponent &component,
@@ -147,6 +167,7 @@ static void get_instanced_data__collection(
 
 static Array<std::optional<InstancedData>> get_instanced_data(const GeoNodeExecParams &params,
                                                               const GeometryComponent &component,
+                                                              InstancesComponent &instances,
                                                               const int amount)
 {
   const bNode &node = params.node();
@@ -164,6 +185,10 @@ static Array<std::optional<InstancedData>> get_instanced_data(const GeoNodeExecP
       get_instanced_data__collection(params, component, instances_data);
       break;
     }
+    case GEO_NODE_POINT_INSTANCE_TYPE_GEOMETRY: {
+      get_instanced_data__geometry(params, instances, instances_data);
+      break;
+    }
   }
   return instances_data;
 }
@@ -176,15 +201,19 @@ static void add_instances_from_geometry_component(InstancesComponent &instances,
 
   const int domain_size = src_geometry.attribute_domain_size(domain);
   Array<std::optional<InstancedData>> instances_data = get_instanced_data(
-      params, src_geometry, domain_size);
+      params, src_geometry, instances, domain_size);
 
-  Float3ReadAttribute positions = src_geometry.attribute_get_for_read<float3>(
+  Float3ReadAttribute position_attribute = src_geometry.attribute_get_for_read<float3>(
       "position", domain, {0, 0, 0});
-  Float3ReadAttribute rotations = src_geometry.attribute_get_for_read<float3>(
+  Float3ReadAttribute rotation_attribute = src_geometry.attribute_get_for_read<float3>(
       "rotation", domain, {0, 0, 0});
-  Float3ReadAttribute scales = src_geometry.attribute_get_for_read<float3>(
+  Float3ReadAttribute scale_attribute = src_geometry.attribute_get_for_read<float3>(
       "scale", domain, {1, 1, 1});
-  Int32ReadAttribute ids = src_geometry.attribute_get_for_read<int>("id", domain, -1);
+  Int32ReadAttribute id_attribute = src_geometry.attribute_get_for_read<int>("id", domain, -1);
+  Span<float3> positions = position_attribute.get_span();
+  Span<float3> rotations = rotation_attribute.get_span();
+  Span<float3> scales = scale_attribute.get_span();
+  Span<int> ids = id_attribute.get_span();
 
   for (const int i : IndexRange(domain_size)) {
     if (instances_data[i].has_value()) {
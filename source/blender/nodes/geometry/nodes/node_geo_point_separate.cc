@@ -44,19 +44,24 @@ static void fill_new_attribute_from_input(const ReadAttribute &input_attribute,
                                           Span<bool> a_or_b)
 {
   fn::GSpan in_span = input_attribute.get_span();
+  fn::GMutableSpan out_span_a = out_attribute_a.get_span();
+  fn::GMutableSpan out_span_b = out_attribute_b.get_span();
+  const CPPType &type = in_span.type();
   int i_a = 0;
   int i_b = 0;
   for (int i_in = 0; i_in < in_span.size(); i_in++) {
     const bool move_to_b = a_or_b[i_in];
     if (move_to_b) {
-      out_attribute_b.set(i_b, in_span[i_in]);
+      type.copy_to_initialized(in_span[i_in], out_span_b[i_b]);
       i_b++;
     }
     else {
-      out_attribute_a.set(i_a, in_span[i_in]);
+      type.copy_to_initialized(in_span[i_in], out_span_a[i_a]);
       i_a++;
     }
   }
+  out_attribute_a.apply_span();
+  out_attribute_b.apply_span();
 }
 
 /**
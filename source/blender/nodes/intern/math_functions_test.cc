@@ -0,0 +1,169 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "BLI_array.hh"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+
+#include "FN_multi_function_builder.hh"
+
+#include "NOD_math_functions.hh"
+
+namespace blender::nodes::tests {
+
+/* Includes a few values that need special care, like zero divisors and equal inputs. */
+static Array<float> random_floats(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float> values(size);
+  for (const int i : values.index_range()) {
+    switch (rng.get_int32(8)) {
+      case 0:
+        values[i] = 0.0f;
+        break;
+      case 1:
+        values[i] = 1.0f;
+        break;
+      default:
+        values[i] = rng.get_float() * 20.0f - 10.0f;
+        break;
+    }
+  }
+  return values;
+}
+
+/* Compare the bits, so that different NaN values or signed zeros are detected as well. */
+static void expect_same_floats(Span<float> a, Span<float> b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  EXPECT_EQ(memcmp(a.data(), b.data(), a.size_in_bytes()), 0);
+}
+
+TEST(math_functions, VectorizedMatchesElementWise)
+{
+  /* Not a multiple of the SIMD width, to test the remaining elements. */
+  const int size = 1003;
+  const Array<float> a = random_floats(size, 0);
+  const Array<float> b = random_floats(size, 1);
+  const Array<float> c = random_floats(size, 2);
+
+  for (const int operation : IndexRange(NODE_MATH_SMOOTH_MAX + 1)) {
+    Array<float> result(size);
+    if (try_execute_float_math_fl_fl_to_fl_vectorized(operation, a, b, result)) {
+      Array<float> expected(size);
+      try_dispatch_float_math_fl_fl_to_fl(
+          operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
+            for (const int i : IndexRange(size)) {
+              expected[i] = math_function(a[i], b[i]);
+            }
+          });
+      expect_same_floats(result, expected);
+    }
+    if (try_execute_float_math_fl_fl_fl_to_fl_vectorized(operation, a, b, c, result)) {
+      Array<float> expected(size);
+      try_dispatch_float_math_fl_fl_fl_to_fl(
+          operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
+            for (const int i : IndexRange(size)) {
+              expected[i] = math_function(a[i], b[i], c[i]);
+            }
+          });
+      expect_same_floats(result, expected);
+    }
+  }
+}
+
+TEST(math_functions, VectorizedMatchesElementWiseFloat3)
+{
+  const int size = 1001;
+  const Array<float> a = random_floats(size * 3, 3);
+  const Array<float> b = random_floats(size * 3, 4);
+  const Span<float3> a3(reinterpret_cast<const float3 *>(a.data()), size);
+  const Span<float3> b3(reinterpret_cast<const float3 *>(b.data()), size);
+
+  for (const int operation : IndexRange(NODE_VECTOR_MATH_TANGENT + 1)) {
+    const NodeVectorMathOperation vector_operation = (NodeVectorMathOperation)operation;
+    Array<float3> result(size);
+    if (try_execute_float_math_fl3_fl3_to_fl3_vectorized(vector_operation, a3, b3, result)) {
+      Array<float3> expected(size);
+      try_dispatch_float_math_fl3_fl3_to_fl3(
+          vector_operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
+            for (const int i : IndexRange(size)) {
+              expected[i] = math_function(a3[i], b3[i]);
+            }
+          });
+      expect_same_floats(Span<float>(reinterpret_cast<const float *>(result.data()), size * 3),
+                         Span<float>(reinterpret_cast<const float *>(expected.data()), size * 3));
+    }
+  }
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it is slow.
+ */
+#if 0
+static const int performance_size = 10000000;
+
+TEST(math_functions_performance, add_10M)
+{
+  const Array<float> a = random_floats(performance_size, 0);
+  const Array<float> b = random_floats(performance_size, 1);
+  Array<float> result(performance_size);
+
+  try_dispatch_float_math_fl_fl_to_fl(
+      NODE_MATH_ADD, [&](auto math_function, const FloatMathOperationInfo &info) {
+        {
+          /* The multi-function as it was evaluated before, element by element through virtual
+           * spans. */
+          SCOPED_TIMER("per-element virtual span");
+          const fn::VSpan<float> a_virtual = a.as_span();
+          const fn::VSpan<float> b_virtual = b.as_span();
+          for (const int i : IndexRange(performance_size)) {
+            result[i] = math_function(a_virtual[i], b_virtual[i]);
+          }
+        }
+        {
+          fn::CustomMF_SI_SI_SO<float, float, float> fn{info.title_case_name, math_function};
+          fn::MFParamsBuilder params{fn, performance_size};
+          params.add_readonly_single_input(a.as_span());
+          params.add_readonly_single_input(b.as_span());
+          params.add_uninitialized_single_output(result.as_mutable_span());
+          fn::MFContextBuilder context;
+          const IndexMask mask = IndexRange(performance_size);
+
+          SCOPED_TIMER("multi-function full array");
+          fn.call(mask, params, context);
+        }
+      });
+  {
+    SCOPED_TIMER("vectorized");
+    try_execute_float_math_fl_fl_to_fl_vectorized(NODE_MATH_ADD, a, b, result);
+  }
+}
+
+TEST(math_functions_performance, vector_divide_10M)
+{
+  const Array<float> a = random_floats(performance_size * 3, 0);
+  const Array<float> b = random_floats(performance_size * 3, 1);
+  const Span<float3> a3(reinterpret_cast<const float3 *>(a.data()), performance_size);
+  const Span<float3> b3(reinterpret_cast<const float3 *>(b.data()), performance_size);
+  Array<float3> result(performance_size);
+
+  try_dispatch_float_math_fl3_fl3_to_fl3(
+      NODE_VECTOR_MATH_DIVIDE,
+      [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
+        SCOPED_TIMER("per-element");
+        for (const int i : IndexRange(performance_size)) {
+          result[i] = math_function(a3[i], b3[i]);
+        }
+      });
+  {
+    SCOPED_TIMER("vectorized");
+    try_execute_float_math_fl3_fl3_to_fl3_vectorized(NODE_VECTOR_MATH_DIVIDE, a3, b3, result);
+  }
+}
+#endif /* Benchmark */
+
+}  // namespace blender::nodes::tests
@@ -269,6 +269,20 @@ void DataTypeConversions::convert(const CPPType &from_type,
   fn->call({0}, params, context);
 }
 
+void DataTypeConversions::convert(fn::GSpan from_span, fn::GMutableSpan to_span) const
+{
+  BLI_assert(from_span.size() == to_span.size());
+  const fn::MultiFunction *fn = this->get_conversion(MFDataType::ForSingle(from_span.type()),
+                                                     MFDataType::ForSingle(to_span.type()));
+  BLI_assert(fn != nullptr);
+
+  fn::MFContextBuilder context;
+  fn::MFParamsBuilder params{*fn, from_span.size()};
+  params.add_readonly_single_input(from_span);
+  params.add_uninitialized_single_output(to_span);
+  fn->call(IndexRange(from_span.size()), params, context);
+}
+
 static fn::MFOutputSocket &insert_default_value_for_type(CommonMFNetworkBuilderData &common,
                                                          fn::MFDataType type)
 {